@@ -56,6 +56,7 @@ optional<Action> fromString(string const& _name)
         mapAction<actions::NewTerminal>("NewTerminal"),
         mapAction<actions::OpenConfiguration>("OpenConfiguration"),
         mapAction<actions::OpenFileManager>("OpenFileManager"),
+        mapAction<actions::OpenUrlHints>("OpenUrlHints"),
         mapAction<actions::PasteClipboard>("PasteClipboard"),
         mapAction<actions::PasteSelection>("PasteSelection"),
         mapAction<actions::Quit>("Quit"),
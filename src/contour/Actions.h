@@ -36,6 +36,7 @@ struct IncreaseOpacity{};
 struct NewTerminal{ std::optional<std::string> profileName; };
 struct OpenConfiguration{};
 struct OpenFileManager{};
+struct OpenUrlHints{};
 struct PasteClipboard{};
 struct PasteSelection{};
 struct Quit{};
@@ -78,6 +79,7 @@ using Action = std::variant<CancelSelection,
                             NewTerminal,
                             OpenConfiguration,
                             OpenFileManager,
+                            OpenUrlHints,
                             PasteClipboard,
                             PasteSelection,
                             Quit,
@@ -139,6 +141,7 @@ DECLARE_ACTION_FMT(IncreaseOpacity)
 DECLARE_ACTION_FMT(NewTerminal)
 DECLARE_ACTION_FMT(OpenConfiguration)
 DECLARE_ACTION_FMT(OpenFileManager)
+DECLARE_ACTION_FMT(OpenUrlHints)
 DECLARE_ACTION_FMT(PasteClipboard)
 DECLARE_ACTION_FMT(PasteSelection)
 DECLARE_ACTION_FMT(Quit)
@@ -198,6 +201,7 @@ struct formatter<contour::actions::Action>
         HANDLE_ACTION(NewTerminal);
         HANDLE_ACTION(OpenConfiguration);
         HANDLE_ACTION(OpenFileManager);
+        HANDLE_ACTION(OpenUrlHints);
         HANDLE_ACTION(PasteClipboard);
         HANDLE_ACTION(PasteSelection);
         HANDLE_ACTION(Quit);
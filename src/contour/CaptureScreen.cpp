@@ -17,11 +17,13 @@
 #include <terminal/Parser.h>
 #include <terminal/ParserEvents.h>
 
+#include <crispy/base64.h>
 #include <crispy/utils.h>
 
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
@@ -32,6 +34,7 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
 // clang-format off
 #if defined(_WIN32)
@@ -76,10 +79,15 @@ class CaptureBufferCollector: public terminal::BasicParserEvents
   public:
     std::ostream& output;
     bool splitByWord;
+    bool base64Encoded;
     std::string capturedBuffer;
+    size_t payloadBytes = 0;
     bool done = false;
 
-    CaptureBufferCollector(ostream& out, bool words): output { out }, splitByWord { words } {}
+    CaptureBufferCollector(ostream& out, bool words, bool base64):
+        output { out }, splitByWord { words }, base64Encoded { base64 }
+    {
+    }
 
     void startPM() override { capturedBuffer.clear(); }
 
@@ -91,7 +99,21 @@ class CaptureBufferCollector: public terminal::BasicParserEvents
         auto const [code, offset] = terminal::parser::extractCodePrefix(capturedBuffer);
         if (code == terminal::CaptureBufferCode)
         {
-            auto const payload = string_view(capturedBuffer.data() + offset, capturedBuffer.size() - offset);
+            auto payload = string_view(capturedBuffer.data() + offset, capturedBuffer.size() - offset);
+            if (payload.empty())
+            {
+                done = true;
+                return;
+            }
+
+            auto decoded = string {};
+            if (base64Encoded)
+            {
+                decoded = crispy::base64::decode(payload);
+                payload = decoded;
+            }
+            payloadBytes += payload.size();
+
             if (splitByWord)
             {
                 crispy::split(payload, ' ', [&](auto word) -> bool {
@@ -102,8 +124,6 @@ class CaptureBufferCollector: public terminal::BasicParserEvents
             }
             else
                 output.write(payload.data(), static_cast<streamsize>(payload.size()));
-            if (payload.size() == 0)
-                done = true;
         }
     }
 };
@@ -255,40 +275,48 @@ namespace
         }
     };
 
-    // Reads a response chunk.
-    bool readCaptureReply(TTY& _input, timeval* timeout, bool words, ostream& output)
+    // Reads all response chunks, returning the number of payload bytes received.
+    optional<size_t> readCaptureReply(TTY& _input,
+                                      timeval const* timeout,
+                                      bool words,
+                                      terminal::CaptureFormat format,
+                                      ostream& output)
     {
-        auto captureBufferCollector = CaptureBufferCollector { output, words };
+        auto captureBufferCollector =
+            CaptureBufferCollector { output, words, format == terminal::CaptureFormat::TextWithSgr };
         auto parser = terminal::parser::Parser<CaptureBufferCollector> { captureBufferCollector };
+        auto buf = std::vector<char>(64 * 1024);
 
         // Response is of format: PM 314 ; <screen capture> ST`
         while (true)
         {
-            int rv = _input.wait(timeout);
+            // The timeout applies to each chunk rather than to the whole transfer,
+            // as select() may otherwise count down the remaining time.
+            auto chunkTimeout = *timeout;
+            int rv = _input.wait(&chunkTimeout);
             if (rv < 0)
             {
                 perror("select");
-                return false;
+                return nullopt;
             }
             else if (rv == 0)
             {
-                cerr << "Time out. VTE did not respond to CAPTURE `CSI > Ps ; Ps t`.\r\n";
-                return false;
+                cerr << "Time out. VTE did not respond to CAPTURE `CSI > Ps ; Ps ; Ps t`.\r\n";
+                return nullopt;
             }
 
-            char buf[4096];
-            rv = _input.read(buf, sizeof(buf));
+            rv = _input.read(buf.data(), buf.size());
             if (rv < 0)
             {
                 perror("read");
-                return false;
+                return nullopt;
             }
 
-            auto const inputView = string_view(buf, static_cast<size_t>(rv));
+            auto const inputView = string_view(buf.data(), static_cast<size_t>(rv));
             parser.parseFragment(inputView);
 
             if (captureBufferCollector.done)
-                return true;
+                return captureBufferCollector.payloadBytes;
         }
     }
 } // namespace
@@ -331,9 +359,29 @@ bool captureScreen(CaptureSettings const& _settings)
         output = *customOutput;
     }
 
-    tty.write(fmt::format("\033[>{};{}t", _settings.logicalLines ? '1' : '0', _settings.lineCount));
+    auto const start = std::chrono::steady_clock::now();
+
+    tty.write(fmt::format("\033[>{};{};{}t",
+                          _settings.logicalLines ? '1' : '0',
+                          _settings.lineCount,
+                          static_cast<unsigned>(_settings.format)));
+
+    auto const bytes = readCaptureReply(tty, &timeout, _settings.words, _settings.format, output);
+    if (!bytes)
+        return false;
+
+    if (_settings.stats)
+    {
+        auto const elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        cerr << fmt::format("Captured {} bytes as {} in {:.3f} seconds ({:.2f} MB/s).\r\n",
+                            *bytes,
+                            _settings.format,
+                            elapsed,
+                            elapsed > 0 ? static_cast<double>(*bytes) / elapsed / (1024 * 1024) : 0.0);
+    }
 
-    return readCaptureReply(tty, &timeout, _settings.words, output);
+    return true;
 }
 
 } // namespace contour
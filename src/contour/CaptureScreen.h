@@ -13,6 +13,7 @@
  */
 #pragma once
 
+#include <terminal/CaptureBuffer.h>
 #include <terminal/primitives.h>
 
 #include <string>
@@ -27,6 +28,8 @@ struct CaptureSettings
     double timeout = 1.0f;     // -t <timeout in seconds>
     std::string outputFile;    // -o <outputfile>
     int verbosityLevel = 0;    // -v, -q (XXX intentionally not parsed currently!)
+    bool stats = false;        // print transfer statistics to stderr
+    terminal::CaptureFormat format = terminal::CaptureFormat::Text;
     terminal::LineCount lineCount = terminal::LineCount { 0 }; // (use terminal default)
 };
 
@@ -13,6 +13,8 @@
  */
 #include "Config.h"
 
+#include <contour/ConfigCache.h>
+
 #include <terminal/ControlCode.h>
 #include <terminal/InputGenerator.h>
 #include <terminal/Process.h>
@@ -50,6 +52,7 @@
 #endif
 
 auto constexpr MinimumFontSize = text::font_size { 8.0 };
+auto constexpr MinimumSynchronizedOutputTimeout = std::chrono::milliseconds { 10 };
 
 using namespace std;
 using crispy::escape;
@@ -867,8 +870,12 @@ Config loadConfig()
 
 Config loadConfigFromFile(FileSystem::path const& _fileName)
 {
+    if (auto config = loadCachedConfig(_fileName); config.has_value())
+        return move(config.value());
+
     Config config {};
     loadConfigFromFile(config, _fileName);
+    storeCachedConfig(config);
     return config;
 }
 
@@ -1157,7 +1164,9 @@ TerminalProfile loadTerminalProfile(UsedKeys& _usedKeys,
                                     YAML::Node const& _profile,
                                     std::string const& _parentPath,
                                     std::string const& _profileName,
-                                    unordered_map<string, terminal::ColorPalette> const& _colorschemes)
+                                    unordered_map<string, terminal::ColorPalette> const& _colorschemes,
+                                    vector<FileSystem::path>& _includedFilePaths,
+                                    vector<FileSystem::path>& _absentFilePaths)
 {
     auto profile = TerminalProfile {};
 
@@ -1180,12 +1189,16 @@ TerminalProfile loadTerminalProfile(UsedKeys& _usedKeys,
                 auto const filePath = prefix / "colorschemes" / (colors.as<string>() + ".yml");
                 auto fileContents = readFile(filePath);
                 if (!fileContents)
+                {
+                    _absentFilePaths.emplace_back(filePath);
                     continue;
+                }
                 YAML::Node subDocument = YAML::Load(fileContents.value());
                 UsedKeys usedColorKeys;
                 profile.colors = loadColorScheme(usedColorKeys, "", subDocument);
                 // TODO: Check usedColorKeys for validity.
                 ConfigLog()("Loaded colors from {}.", filePath.string());
+                _includedFilePaths.emplace_back(filePath);
                 found = true;
                 break;
             }
@@ -1214,6 +1227,22 @@ TerminalProfile loadTerminalProfile(UsedKeys& _usedKeys,
     tryLoadChildRelative(_usedKeys, _profile, basePath, "maximized", profile.maximized);
     tryLoadChildRelative(_usedKeys, _profile, basePath, "fullscreen", profile.fullscreen);
     tryLoadChildRelative(_usedKeys, _profile, basePath, "refresh_rate", profile.refreshRate);
+    auto synchronizedOutputTimeout = profile.synchronizedOutputTimeout.count();
+    tryLoadChildRelative(
+        _usedKeys, _profile, basePath, "synchronized_output_timeout", synchronizedOutputTimeout);
+    profile.synchronizedOutputTimeout = chrono::milliseconds(synchronizedOutputTimeout);
+    if (profile.synchronizedOutputTimeout < MinimumSynchronizedOutputTimeout)
+    {
+        // A timeout of zero would republish the frame all the time.
+        errorlog()("Invalid synchronized output timeout {}ms set in config file. Minimum value is {}ms.",
+                   profile.synchronizedOutputTimeout.count(),
+                   MinimumSynchronizedOutputTimeout.count());
+        profile.synchronizedOutputTimeout = MinimumSynchronizedOutputTimeout;
+    }
+    auto alternateScreenReleaseTimeout = profile.alternateScreenReleaseTimeout.count();
+    tryLoadChildRelative(
+        _usedKeys, _profile, basePath, "alternate_screen_release_timeout", alternateScreenReleaseTimeout);
+    profile.alternateScreenReleaseTimeout = chrono::seconds(alternateScreenReleaseTimeout);
     tryLoadChildRelative(
         _usedKeys, _profile, basePath, "copy_last_mark_range_offset", profile.copyLastMarkRangeOffset);
     tryLoadChildRelative(_usedKeys, _profile, basePath, "show_title_bar", profile.show_title_bar);
@@ -1701,8 +1730,13 @@ void loadConfigFromFile(Config& _config, FileSystem::path const& _fileName)
             auto const profile = i->second;
             auto const parentPath = "profiles"s;
             usedKeys.emplace(fmt::format("{}.{}", parentPath, name));
-            _config.profiles[name] =
-                loadTerminalProfile(usedKeys, profile, parentPath, name, _config.colorschemes);
+            _config.profiles[name] = loadTerminalProfile(usedKeys,
+                                                         profile,
+                                                         parentPath,
+                                                         name,
+                                                         _config.colorschemes,
+                                                         _config.includedFilePaths,
+                                                         _config.absentFilePaths);
         }
     }
 
@@ -1737,4 +1771,82 @@ optional<std::string> readConfigFile(std::string const& _filename)
     return nullopt;
 }
 
+namespace
+{
+    bool operator==(CursorConfig const& a, CursorConfig const& b) noexcept
+    {
+        return a.cursorShape == b.cursorShape && a.cursorDisplay == b.cursorDisplay
+               && a.cursorBlinkInterval == b.cursorBlinkInterval;
+    }
+
+    bool operator!=(CursorConfig const& a, CursorConfig const& b) noexcept
+    {
+        return !(a == b);
+    }
+
+    // Compares all colors, but not the background image, which is reconfigured independently.
+    bool sameColors(terminal::ColorPalette const& a, terminal::ColorPalette const& b) noexcept
+    {
+        return a.useBrightColors == b.useBrightColors && a.palette == b.palette
+               && a.defaultForeground == b.defaultForeground && a.defaultBackground == b.defaultBackground
+               && a.selectionForeground == b.selectionForeground
+               && a.selectionBackground == b.selectionBackground && a.cursor == b.cursor
+               && a.mouseForeground == b.mouseForeground && a.mouseBackground == b.mouseBackground
+               && a.hyperlinkDecoration.normal == b.hyperlinkDecoration.normal
+               && a.hyperlinkDecoration.hover == b.hyperlinkDecoration.hover;
+    }
+
+    bool sameBackgroundImage(shared_ptr<terminal::BackgroundImage const> const& a,
+                             shared_ptr<terminal::BackgroundImage const> const& b) noexcept
+    {
+        if (!a || !b)
+            return !a && !b;
+
+        // The hash covers the image's location, which is all that is known before it is loaded.
+        return a->hash == b->hash && a->opacity == b->opacity && a->blur == b->blur;
+    }
+} // namespace
+
+ConfigChanges diff(Config const& _oldConfig,
+                   TerminalProfile const& _oldProfile,
+                   Config const& _newConfig,
+                   TerminalProfile const& _newProfile)
+{
+    auto changes = ConfigChanges {};
+
+    changes.terminal = _oldConfig.wordDelimiters != _newConfig.wordDelimiters
+                       || _oldConfig.bypassMouseProtocolModifier != _newConfig.bypassMouseProtocolModifier
+                       || _oldConfig.mouseBlockSelectionModifier != _newConfig.mouseBlockSelectionModifier
+                       || _oldConfig.sixelScrolling != _newConfig.sixelScrolling
+                       || _oldConfig.sixelCursorConformance != _newConfig.sixelCursorConformance
+                       || _oldConfig.maxImageSize != _newConfig.maxImageSize
+                       || _oldConfig.maxImageColorRegisters != _newConfig.maxImageColorRegisters
+                       || _oldProfile.copyLastMarkRangeOffset != _newProfile.copyLastMarkRangeOffset
+                       || _oldProfile.terminalId != _newProfile.terminalId
+                       || _oldProfile.maxHistoryLineCount != _newProfile.maxHistoryLineCount
+                       || _oldProfile.synchronizedOutputTimeout != _newProfile.synchronizedOutputTimeout
+                       || _oldProfile.alternateScreenReleaseTimeout
+                              != _newProfile.alternateScreenReleaseTimeout;
+
+    changes.cursor = _oldProfile.inputModes.insert.cursor != _newProfile.inputModes.insert.cursor
+                     || _oldProfile.inputModes.normal.cursor != _newProfile.inputModes.normal.cursor
+                     || _oldProfile.inputModes.visual.cursor != _newProfile.inputModes.visual.cursor;
+
+    changes.colors = !sameColors(_oldProfile.colors, _newProfile.colors);
+    changes.backgroundImage =
+        !sameBackgroundImage(_oldProfile.colors.backgroundImage, _newProfile.colors.backgroundImage);
+    changes.backgroundOpacity = _oldProfile.backgroundOpacity != _newProfile.backgroundOpacity;
+    changes.fonts = _oldProfile.fonts != _newProfile.fonts;
+
+    changes.window = _oldProfile.maximized != _newProfile.maximized
+                     || _oldProfile.fullscreen != _newProfile.fullscreen
+                     || _oldProfile.backgroundBlur != _newProfile.backgroundBlur;
+
+    changes.hyperlinkDecoration =
+        _oldProfile.hyperlinkDecoration.normal != _newProfile.hyperlinkDecoration.normal
+        || _oldProfile.hyperlinkDecoration.hover != _newProfile.hyperlinkDecoration.hover;
+
+    return changes;
+}
+
 } // namespace contour::config
@@ -31,13 +31,16 @@
 #include <crispy/size.h>
 #include <crispy/stdfs.h>
 
+#include <array>
 #include <chrono>
 #include <optional>
 #include <set>
 #include <string>
 #include <system_error>
 #include <unordered_map>
+#include <utility>
 #include <variant>
+#include <vector>
 
 namespace contour::config
 {
@@ -147,6 +150,8 @@ struct TerminalProfile
     bool fullscreen = false;
     bool show_title_bar = true;
     double refreshRate = 0.0; // 0=auto
+    std::chrono::milliseconds synchronizedOutputTimeout { 200 };
+    std::chrono::seconds alternateScreenReleaseTimeout { 30 };
     terminal::LineOffset copyLastMarkRangeOffset = terminal::LineOffset(0);
 
     std::string wmClass;
@@ -205,6 +210,13 @@ struct Config
 {
     FileSystem::path backingFilePath;
 
+    /// Files other than the backing file that the configuration has been loaded from, such as color schemes.
+    std::vector<FileSystem::path> includedFilePaths;
+
+    /// Files that have been looked up but did not exist, such as color schemes in search paths
+    /// of higher priority than the one they have been found in.
+    std::vector<FileSystem::path> absentFilePaths;
+
     /// Qt platform plugin to be loaded.
     /// This is equivalent to QT_QPA_PLATFORM.
     std::string platformPlugin;
@@ -281,6 +293,34 @@ struct Config
     std::set<std::string> experimentalFeatures;
 };
 
+/// Subsystems of a terminal session that are affected by a configuration change.
+struct ConfigChanges
+{
+    bool terminal = false; // terminal behavior, such as word delimiters, history or image limits
+    bool cursor = false;
+    bool colors = false;
+    bool backgroundImage = false;
+    bool backgroundOpacity = false;
+    bool fonts = false;
+    bool window = false; // window state, such as maximized, fullscreen or blur-behind
+    bool hyperlinkDecoration = false;
+
+    [[nodiscard]] bool any() const noexcept
+    {
+        return terminal || cursor || colors || backgroundImage || backgroundOpacity || fonts || window
+               || hyperlinkDecoration;
+    }
+};
+
+/// Determines which subsystems need to be reconfigured when changing from
+/// the given old configuration and profile to the given new ones.
+///
+/// Input mappings are not part of the result, as they are looked up on demand.
+ConfigChanges diff(Config const& _oldConfig,
+                   TerminalProfile const& _oldProfile,
+                   Config const& _newConfig,
+                   TerminalProfile const& _newProfile);
+
 FileSystem::path configHome(std::string const& _programName);
 
 std::optional<std::string> readConfigFile(std::string const& _filename);
@@ -363,4 +403,35 @@ struct formatter<contour::config::ScrollBarPosition>
     }
 };
 
+template <>
+struct formatter<contour::config::ConfigChanges>
+{
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx)
+    {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(contour::config::ConfigChanges const& _changes, FormatContext& ctx)
+    {
+        auto const names = std::array<std::pair<bool, char const*>, 8> {
+            std::pair { _changes.terminal, "terminal" },
+            std::pair { _changes.cursor, "cursor" },
+            std::pair { _changes.colors, "colors" },
+            std::pair { _changes.backgroundImage, "background-image" },
+            std::pair { _changes.backgroundOpacity, "background-opacity" },
+            std::pair { _changes.fonts, "fonts" },
+            std::pair { _changes.window, "window" },
+            std::pair { _changes.hyperlinkDecoration, "hyperlink-decoration" },
+        };
+        auto count = 0;
+        for (auto const& [changed, name]: names)
+            if (changed)
+                format_to(ctx.out(), "{}{}", count++ ? ", " : "", name);
+        if (!count)
+            return format_to(ctx.out(), "none");
+        return ctx.out();
+    }
+};
+
 } // namespace fmt
@@ -0,0 +1,803 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <contour/ConfigCache.h>
+
+#include <crispy/BinaryStream.h>
+#include <crispy/StrongHash.h>
+#include <crispy/boxed.h>
+#include <crispy/logstore.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if !defined(_WIN32)
+    #include <sys/stat.h>
+#endif
+
+using namespace std;
+
+namespace contour::config
+{
+
+namespace
+{
+    auto const ConfigCacheLog = logstore::Category("config.cache", "Logs binary configuration cache usage.");
+
+    constexpr auto CacheFileMagic = "contour\x1A"sv;
+
+    // {{{ serialization
+    // Each structure's fields are listed once in a fields() function, which is used for
+    // writing (via Saver) as well as for reading (via Loader).
+
+    template <typename T>
+    struct is_vector: false_type
+    {
+    };
+    template <typename T>
+    struct is_vector<vector<T>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_optional: false_type
+    {
+    };
+    template <typename T>
+    struct is_optional<optional<T>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_shared_ptr: false_type
+    {
+    };
+    template <typename T>
+    struct is_shared_ptr<shared_ptr<T>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_pair: false_type
+    {
+    };
+    template <typename A, typename B>
+    struct is_pair<pair<A, B>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_variant: false_type
+    {
+    };
+    template <typename... T>
+    struct is_variant<variant<T...>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_map: false_type
+    {
+    };
+    template <typename K, typename V>
+    struct is_map<map<K, V>>: true_type
+    {
+    };
+    template <typename K, typename V>
+    struct is_map<unordered_map<K, V>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_set: false_type
+    {
+    };
+    template <typename T>
+    struct is_set<set<T>>: true_type
+    {
+    };
+
+    template <typename T>
+    struct is_duration: false_type
+    {
+    };
+    template <typename R, typename P>
+    struct is_duration<chrono::duration<R, P>>: true_type
+    {
+    };
+
+    template <typename Variant, size_t... I>
+    Variant makeVariant(size_t _index, index_sequence<I...>)
+    {
+        using Constructor = Variant (*)();
+        static constexpr Constructor constructors[] = { []() -> Variant {
+            return variant_alternative_t<I, Variant> {};
+        }... };
+        if (_index >= sizeof...(I))
+            throw runtime_error("Invalid variant index in binary data.");
+        return constructors[_index]();
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::RGBColor& _color)
+    {
+        _ar(_color.red, _color.green, _color.blue);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::BackgroundImage& _image)
+    {
+        _ar(_image.location, _image.hash, _image.opacity, _image.blur);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::ImageData& _image)
+    {
+        _ar(_image.format, _image.rowAlignment, _image.size, _image.pixels, _image.hash);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::CursorColor& _cursor)
+    {
+        _ar(_cursor.color, _cursor.textOverrideColor);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::ColorPalette& _colors)
+    {
+        _ar(_colors.useBrightColors,
+            _colors.palette,
+            _colors.defaultForeground,
+            _colors.defaultBackground,
+            _colors.selectionForeground,
+            _colors.selectionBackground,
+            _colors.cursor,
+            _colors.mouseForeground,
+            _colors.mouseBackground,
+            _colors.hyperlinkDecoration.normal,
+            _colors.hyperlinkDecoration.hover,
+            _colors.backgroundImage);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::ImageSize& _size)
+    {
+        _ar(_size.width, _size.height);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::PageSize& _size)
+    {
+        _ar(_size.lines, _size.columns);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::Process::ExecInfo& _shell)
+    {
+        _ar(_shell.program, _shell.arguments, _shell.workingDirectory, _shell.env);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, text::DPI& _dpi)
+    {
+        _ar(_dpi.x, _dpi.y);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, text::font_size& _size)
+    {
+        _ar(_size.pt);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, text::font_description& _font)
+    {
+        _ar(_font.familyName, _font.weight, _font.slant, _font.spacing, _font.strict_spacing, _font.features);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, terminal::renderer::FontDescriptions& _fonts)
+    {
+        _ar(_fonts.dpiScale,
+            _fonts.dpi,
+            _fonts.size,
+            _fonts.regular,
+            _fonts.bold,
+            _fonts.italic,
+            _fonts.boldItalic,
+            _fonts.emoji,
+            _fonts.renderMode,
+            _fonts.textShapingEngine,
+            _fonts.fontLocator,
+            _fonts.builtinBoxDrawing);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, CursorConfig& _cursor)
+    {
+        _ar(_cursor.cursorShape, _cursor.cursorDisplay, _cursor.cursorBlinkInterval);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, InputModeConfig& _mode)
+    {
+        _ar(_mode.cursor);
+    }
+
+    // clang-format off
+    template <typename Archive> void fields(Archive& _ar, actions::ChangeProfile& _action) { _ar(_action.name); }
+    template <typename Archive> void fields(Archive& _ar, actions::NewTerminal& _action) { _ar(_action.profileName); }
+    template <typename Archive> void fields(Archive& _ar, actions::ReloadConfig& _action) { _ar(_action.profileName); }
+    template <typename Archive> void fields(Archive& _ar, actions::SendChars& _action) { _ar(_action.chars); }
+    template <typename Archive> void fields(Archive& _ar, actions::WriteScreen& _action) { _ar(_action.chars); }
+    // clang-format on
+
+    template <typename Archive, typename Input>
+    void fields(Archive& _ar, terminal::InputBinding<Input, ActionList>& _mapping)
+    {
+        _ar(_mapping.modes, _mapping.modifier, _mapping.input, _mapping.binding);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, InputMappings& _mappings)
+    {
+        _ar(_mappings.keyMappings, _mappings.charMappings, _mappings.mouseMappings);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, TerminalProfile& _profile)
+    {
+        // The shaders are not configurable via the configuration file.
+        _ar(_profile.shell,
+            _profile.maximized,
+            _profile.fullscreen,
+            _profile.show_title_bar,
+            _profile.refreshRate,
+            _profile.synchronizedOutputTimeout,
+            _profile.alternateScreenReleaseTimeout,
+            _profile.copyLastMarkRangeOffset,
+            _profile.wmClass,
+            _profile.terminalSize,
+            _profile.terminalId,
+            _profile.maxHistoryLineCount,
+            _profile.historyScrollMultiplier,
+            _profile.scrollbarPosition,
+            _profile.hideScrollbarInAltScreen,
+            _profile.autoScrollOnUpdate,
+            _profile.fonts,
+            _profile.permissions.captureBuffer,
+            _profile.permissions.changeFont,
+            _profile.drawBoldTextWithBrightColors,
+            _profile.colors,
+            _profile.inputModes.insert,
+            _profile.inputModes.normal,
+            _profile.inputModes.visual,
+            _profile.backgroundOpacity,
+            _profile.backgroundBlur,
+            _profile.hyperlinkDecoration.normal,
+            _profile.hyperlinkDecoration.hover);
+    }
+
+    template <typename Archive>
+    void fields(Archive& _ar, Config& _config)
+    {
+        _ar(_config.backingFilePath,
+            _config.includedFilePaths,
+            _config.absentFilePaths,
+            _config.platformPlugin,
+            _config.renderingBackend,
+            _config.textureAtlasDirectMapping,
+            _config.textureAtlasHashtableSlots.value,
+            _config.textureAtlasTileCount.value,
+            _config.ptyReadBufferSize,
+            _config.ptyBufferObjectSize,
+            _config.reflowOnResize,
+            _config.colorschemes,
+            _config.profiles,
+            _config.defaultProfileName,
+            _config.wordDelimiters,
+            _config.bypassMouseProtocolModifier,
+            _config.onMouseSelection,
+            _config.mouseBlockSelectionModifier,
+            _config.inputMappings,
+            _config.spawnNewProcess,
+            _config.sixelScrolling,
+            _config.sixelCursorConformance,
+            _config.maxImageSize,
+            _config.maxImageColorRegisters,
+            _config.experimentalFeatures);
+    }
+
+    class Saver
+    {
+      public:
+        explicit Saver(crispy::BinaryWriter& _writer): writer_ { _writer } {}
+
+        template <typename... T>
+        void operator()(T const&... _values)
+        {
+            (save(_values), ...);
+        }
+
+      private:
+        template <typename T>
+        void save(T const& _value)
+        {
+            if constexpr (is_arithmetic_v<T> || is_enum_v<T> || is_same_v<T, crispy::StrongHash>)
+                writer_.write(_value);
+            else if constexpr (is_same_v<T, string>)
+                writer_.writeString(_value);
+            else if constexpr (is_same_v<T, FileSystem::path>)
+                writer_.writeString(_value.string());
+            else if constexpr (is_duration<T>::value)
+                writer_.write(_value.count());
+            else if constexpr (crispy::is_boxed<T>)
+                writer_.write(_value.value);
+            else if constexpr (is_same_v<T, terminal::MatchModes>)
+            {
+                writer_.write(static_cast<uint8_t>(_value.enabled()));
+                writer_.write(static_cast<uint8_t>(_value.disabled()));
+            }
+            else if constexpr (is_same_v<T, terminal::Modifier>)
+                writer_.write(_value.value());
+            else if constexpr (is_same_v<T, text::font_feature>)
+                writer_.write(_value.name);
+            else if constexpr (is_optional<T>::value || is_shared_ptr<T>::value)
+            {
+                writer_.write(static_cast<bool>(_value));
+                if (_value)
+                    save(*_value);
+            }
+            else if constexpr (is_vector<T>::value || is_map<T>::value || is_set<T>::value
+                               || is_same_v<T, terminal::ColorPalette::Palette>)
+            {
+                writer_.writeVarUInt(_value.size());
+                for (auto const& element: _value)
+                    save(element);
+            }
+            else if constexpr (is_pair<T>::value)
+            {
+                save(_value.first);
+                save(_value.second);
+            }
+            else if constexpr (is_variant<T>::value)
+            {
+                writer_.writeVarUInt(_value.index());
+                visit([this](auto const& _alternative) { save(_alternative); }, _value);
+            }
+            else if constexpr (is_empty_v<T>)
+                ; // e.g. actions without parameters
+            else
+                fields(*this, const_cast<T&>(_value));
+        }
+
+        crispy::BinaryWriter& writer_;
+    };
+
+    class Loader
+    {
+      public:
+        explicit Loader(crispy::BinaryReader& _reader): reader_ { _reader } {}
+
+        template <typename... T>
+        void operator()(T&... _values)
+        {
+            (load(_values), ...);
+        }
+
+      private:
+        template <typename T>
+        void load(T& _value)
+        {
+            if constexpr (is_arithmetic_v<T> || is_enum_v<T> || is_same_v<T, crispy::StrongHash>)
+                _value = reader_.read<T>();
+            else if constexpr (is_same_v<T, string>)
+                _value = reader_.readString();
+            else if constexpr (is_same_v<T, FileSystem::path>)
+                _value = FileSystem::path(reader_.readString());
+            else if constexpr (is_duration<T>::value)
+                _value = T(reader_.read<typename T::rep>());
+            else if constexpr (crispy::is_boxed<T>)
+                _value = T(reader_.read<typename T::inner_type>());
+            else if constexpr (is_same_v<T, terminal::MatchModes>)
+            {
+                auto const enabled = reader_.read<uint8_t>();
+                auto const disabled = reader_.read<uint8_t>();
+                _value = terminal::MatchModes {};
+                for (unsigned bit = 1; bit <= 0x80; bit <<= 1)
+                {
+                    if (enabled & bit)
+                        _value.enable(static_cast<terminal::MatchModes::Flag>(bit));
+                    else if (disabled & bit)
+                        _value.disable(static_cast<terminal::MatchModes::Flag>(bit));
+                }
+            }
+            else if constexpr (is_same_v<T, terminal::Modifier>)
+                _value = terminal::Modifier(static_cast<terminal::Modifier::Key>(reader_.read<unsigned>()));
+            else if constexpr (is_optional<T>::value)
+            {
+                if (!reader_.read<bool>())
+                    _value.reset();
+                else
+                    load(_value.emplace());
+            }
+            else if constexpr (is_shared_ptr<T>::value)
+            {
+                if (!reader_.read<bool>())
+                    _value.reset();
+                else
+                {
+                    auto element = remove_const_t<typename T::element_type> {};
+                    load(element);
+                    _value = make_shared<typename T::element_type>(move(element));
+                }
+            }
+            else if constexpr (is_same_v<T, terminal::ColorPalette::Palette>)
+            {
+                if (reader_.readVarUInt() != _value.size())
+                    throw runtime_error("Invalid color palette size in binary data.");
+                for (auto& element: _value)
+                    load(element);
+            }
+            else if constexpr (is_same_v<T, vector<text::font_feature>>)
+            {
+                _value.clear();
+                for (auto n = reader_.readVarUInt(); n != 0; --n)
+                {
+                    auto const name = reader_.read<array<char, 4>>();
+                    _value.emplace_back(name[0], name[1], name[2], name[3]);
+                }
+            }
+            else if constexpr (is_vector<T>::value)
+            {
+                _value.clear();
+                _value.resize(reader_.readVarUInt());
+                for (auto& element: _value)
+                    load(element);
+            }
+            else if constexpr (is_map<T>::value)
+            {
+                _value.clear();
+                for (auto n = reader_.readVarUInt(); n != 0; --n)
+                {
+                    auto key = typename T::key_type {};
+                    load(key);
+                    load(_value[key]);
+                }
+            }
+            else if constexpr (is_set<T>::value)
+            {
+                _value.clear();
+                for (auto n = reader_.readVarUInt(); n != 0; --n)
+                {
+                    auto element = typename T::value_type {};
+                    load(element);
+                    _value.emplace(move(element));
+                }
+            }
+            else if constexpr (is_variant<T>::value)
+            {
+                _value = makeVariant<T>(reader_.readVarUInt(), make_index_sequence<variant_size_v<T>> {});
+                visit([this](auto& _alternative) { load(_alternative); }, _value);
+            }
+            else if constexpr (is_empty_v<T>)
+                ; // e.g. actions without parameters
+            else
+                fields(*this, _value);
+        }
+
+        crispy::BinaryReader& reader_;
+    };
+    // }}}
+
+    /// Returns the time of last modification in nanoseconds, such that modifications
+    /// within the same second are told apart.
+    optional<int64_t> modificationTimeOf(FileSystem::path const& _path)
+    {
+#if defined(_WIN32)
+        auto ec = FileSystemError {};
+        auto const modificationTime = FileSystem::last_write_time(_path, ec);
+        if (ec)
+            return nullopt;
+        // boost::filesystem represents the time of last modification as time_t.
+        if constexpr (is_arithmetic_v<decltype(modificationTime)>)
+            return static_cast<int64_t>(modificationTime);
+        else
+            return static_cast<int64_t>(
+                chrono::duration_cast<chrono::nanoseconds>(modificationTime.time_since_epoch()).count());
+#else
+        struct stat st
+        {
+        };
+        if (stat(_path.string().c_str(), &st) != 0)
+            return nullopt;
+    #if defined(__APPLE__)
+        auto const& modificationTime = st.st_mtimespec;
+    #else
+        auto const& modificationTime = st.st_mtim;
+    #endif
+        return static_cast<int64_t>(modificationTime.tv_sec) * 1'000'000'000 + modificationTime.tv_nsec;
+#endif
+    }
+
+    /// Identifies the state of a file that the configuration has been loaded from.
+    struct SourceStamp
+    {
+        string path;
+        int64_t modificationTime = 0;
+        uint64_t size = 0;
+        crispy::StrongHash contentHash;
+    };
+
+    optional<string> readFileContents(FileSystem::path const& _path)
+    {
+        auto input = ifstream(_path.string(), ios::binary);
+        if (!input.good())
+            return nullopt;
+        return string(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+
+    optional<SourceStamp> stampOf(FileSystem::path const& _path)
+    {
+        auto const modificationTime = modificationTimeOf(_path);
+        if (!modificationTime)
+            return nullopt;
+        auto ec = FileSystemError {};
+        auto const size = FileSystem::file_size(_path, ec);
+        if (ec)
+            return nullopt;
+        auto const contents = readFileContents(_path);
+        if (!contents)
+            return nullopt;
+
+        return SourceStamp { _path.string(),
+                             *modificationTime,
+                             static_cast<uint64_t>(size),
+                             crispy::StrongHash::compute(*contents) };
+    }
+
+    /// Tests whether the given file is still in the state it has been cached in.
+    ///
+    /// The content is only hashed if the modification time or size differ,
+    /// so that e.g. touching the file does not invalidate the cache.
+    bool isUnchanged(SourceStamp const& _stamp)
+    {
+        auto const path = FileSystem::path(_stamp.path);
+        auto const modificationTime = modificationTimeOf(path);
+        if (!modificationTime)
+            return false;
+        auto ec = FileSystemError {};
+        auto const size = FileSystem::file_size(path, ec);
+        if (ec)
+            return false;
+
+        if (*modificationTime == _stamp.modificationTime && size == _stamp.size)
+            return true;
+
+        auto const contents = readFileContents(path);
+        return contents && crispy::StrongHash::compute(*contents) == _stamp.contentHash;
+    }
+
+    /// Hashes the parts of the environment that the resolved configuration depends on,
+    /// such as default working directory and login shell.
+    crispy::StrongHash environmentHash()
+    {
+        auto key = string(CONTOUR_VERSION_STRING);
+        auto ec = FileSystemError {};
+        key += '\0';
+        key += FileSystem::current_path(ec).string();
+        for (auto const* name: { "HOME", "SHELL", "XDG_CONFIG_HOME", "TERMINFO_DIRS" })
+        {
+            key += '\0';
+            if (auto const* value = getenv(name); value)
+                key += value;
+        }
+        return crispy::StrongHash::compute(key);
+    }
+
+    FileSystem::path cacheHome()
+    {
+#if defined(_WIN32)
+        if (auto const* value = getenv("LOCALAPPDATA"); value && *value)
+            return FileSystem::path { value } / "contour" / "cache";
+#else
+        if (auto const* value = getenv("XDG_CACHE_HOME"); value && *value)
+            return FileSystem::path { value } / "contour";
+        if (auto const* value = getenv("HOME"); value && *value)
+            return FileSystem::path { value } / ".cache" / "contour";
+#endif
+        return FileSystem::temp_directory_path() / "contour";
+    }
+
+    bool isCacheable(Config const& _config)
+    {
+        // The mock font locator is configured as a side effect of loading the configuration.
+        return none_of(_config.profiles.begin(), _config.profiles.end(), [](auto const& _profile) {
+            return _profile.second.fonts.fontLocator == terminal::renderer::FontLocatorEngine::Mock;
+        });
+    }
+} // namespace
+
+FileSystem::path configCacheFilePath(FileSystem::path const& _configFilePath)
+{
+    auto const absolutePath = FileSystem::absolute(_configFilePath).string();
+    return cacheHome() / fmt::format("config-{:016x}.bin", hash<string> {}(absolutePath));
+}
+
+string serializeConfig(Config const& _config)
+{
+    auto writer = crispy::BinaryWriter {};
+    writer.write(ConfigCacheVersion);
+    writer.write(static_cast<uint32_t>(sizeof(Config)));
+    writer.write(static_cast<uint32_t>(sizeof(TerminalProfile)));
+    Saver { writer }(_config);
+    return writer.data();
+}
+
+optional<Config> deserializeConfig(string_view _data)
+{
+    try
+    {
+        auto reader = crispy::BinaryReader(_data);
+
+        // The structure sizes catch most changes to Config that forgot to increment the version.
+        if (reader.read<uint32_t>() != ConfigCacheVersion || reader.read<uint32_t>() != sizeof(Config)
+            || reader.read<uint32_t>() != sizeof(TerminalProfile))
+            return nullopt;
+
+        auto config = Config {};
+        Loader { reader }(config);
+        if (!reader.atEnd())
+            return nullopt;
+
+        return { move(config) };
+    }
+    catch (exception const& e)
+    {
+        ConfigCacheLog()("Failed to deserialize configuration. {}", e.what());
+        return nullopt;
+    }
+}
+
+optional<Config> loadCachedConfig(FileSystem::path const& _configFilePath)
+{
+    auto const startTime = chrono::steady_clock::now();
+    auto const cacheFilePath = configCacheFilePath(_configFilePath);
+    auto const data = readFileContents(cacheFilePath);
+    if (!data)
+        return nullopt;
+
+    try
+    {
+        auto reader = crispy::BinaryReader(*data);
+        if (reader.readBytes(CacheFileMagic.size()) != CacheFileMagic)
+            return nullopt;
+
+        if (reader.read<crispy::StrongHash>() != environmentHash())
+        {
+            ConfigCacheLog()("Configuration cache {} is stale. Environment changed.", cacheFilePath.string());
+            return nullopt;
+        }
+
+        for (auto n = reader.readVarUInt(); n != 0; --n)
+        {
+            auto stamp = SourceStamp {};
+            stamp.path = reader.readString();
+            stamp.modificationTime = reader.read<int64_t>();
+            stamp.size = reader.read<uint64_t>();
+            stamp.contentHash = reader.read<crispy::StrongHash>();
+            if (!isUnchanged(stamp))
+            {
+                ConfigCacheLog()("Configuration cache {} is stale. {} changed.", cacheFilePath.string(), stamp.path);
+                return nullopt;
+            }
+        }
+
+        auto config = deserializeConfig(reader.readBytes(reader.remaining()));
+        if (!config)
+            return nullopt;
+
+        // A file that now exists may take precedence over one that the configuration has been loaded from.
+        for (auto const& path: config->absentFilePaths)
+        {
+            auto ec = FileSystemError {};
+            if (FileSystem::exists(path, ec))
+            {
+                ConfigCacheLog()("Configuration cache {} is stale. {} has been created.",
+                                 cacheFilePath.string(),
+                                 path.string());
+                return nullopt;
+            }
+        }
+
+        ConfigCacheLog()("Loaded configuration from cache {} in {} ms.",
+                         cacheFilePath.string(),
+                         chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count());
+        return config;
+    }
+    catch (exception const& e)
+    {
+        ConfigCacheLog()("Failed to load configuration cache {}. {}", cacheFilePath.string(), e.what());
+        return nullopt;
+    }
+}
+
+void storeCachedConfig(Config const& _config)
+{
+    if (!isCacheable(_config))
+        return;
+
+    auto stamps = vector<SourceStamp> {};
+    auto sources = vector<FileSystem::path> { _config.backingFilePath };
+    sources.insert(sources.end(), _config.includedFilePaths.begin(), _config.includedFilePaths.end());
+    for (auto const& source: sources)
+    {
+        auto stamp = stampOf(source);
+        if (!stamp)
+            return;
+        stamps.emplace_back(move(*stamp));
+    }
+
+    auto const cacheFilePath = configCacheFilePath(_config.backingFilePath);
+    auto ec = FileSystemError {};
+    FileSystem::create_directories(cacheFilePath.parent_path(), ec);
+    if (ec)
+    {
+        ConfigCacheLog()("Failed to create cache directory {}. {}", cacheFilePath.parent_path().string(), ec.message());
+        return;
+    }
+
+    // Written to a temporary file first, so that concurrently starting instances never see a partial cache.
+    auto const temporaryFilePath = FileSystem::path(cacheFilePath.string() + ".tmp");
+    {
+        auto output = ofstream(temporaryFilePath.string(), ios::binary | ios::trunc);
+        auto writer = crispy::BinaryWriter(output);
+        writer.writeBytes(CacheFileMagic.data(), CacheFileMagic.size());
+        writer.write(environmentHash());
+        writer.writeVarUInt(stamps.size());
+        for (SourceStamp const& stamp: stamps)
+        {
+            writer.writeString(stamp.path);
+            writer.write(stamp.modificationTime);
+            writer.write(stamp.size);
+            writer.write(stamp.contentHash);
+        }
+        auto const payload = serializeConfig(_config);
+        writer.writeBytes(payload.data(), payload.size());
+        writer.flush();
+        if (!output.good())
+        {
+            ConfigCacheLog()("Failed to write configuration cache {}.", temporaryFilePath.string());
+            return;
+        }
+    }
+
+    FileSystem::rename(temporaryFilePath, cacheFilePath, ec);
+    if (ec)
+        ConfigCacheLog()("Failed to write configuration cache {}. {}", cacheFilePath.string(), ec.message());
+    else
+        ConfigCacheLog()("Stored configuration cache {}.", cacheFilePath.string());
+}
+
+} // namespace contour::config
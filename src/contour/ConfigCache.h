@@ -0,0 +1,51 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <contour/Config.h>
+
+#include <crispy/stdfs.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace contour::config
+{
+
+/// Version of the binary configuration cache format.
+///
+/// This must be incremented whenever the Config structure or its serialization changes.
+constexpr uint32_t ConfigCacheVersion = 4;
+
+/// Returns the path of the binary cache for the given configuration file.
+FileSystem::path configCacheFilePath(FileSystem::path const& _configFilePath);
+
+/// Serializes the given resolved configuration into the binary cache format.
+std::string serializeConfig(Config const& _config);
+
+/// Deserializes a configuration as serialized by serializeConfig().
+///
+/// @returns the configuration or std::nullopt if the data is invalid or of another version.
+std::optional<Config> deserializeConfig(std::string_view _data);
+
+/// Loads the resolved configuration for the given configuration file from its binary cache,
+/// provided that neither the configuration file nor any file it includes has changed since.
+std::optional<Config> loadCachedConfig(FileSystem::path const& _configFilePath);
+
+/// Stores the given resolved configuration in its binary cache, to be picked up by loadCachedConfig().
+void storeCachedConfig(Config const& _config);
+
+} // namespace contour::config
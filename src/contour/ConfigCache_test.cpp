@@ -0,0 +1,145 @@
+/**
+ * This file is part of the "contour" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <contour/ConfigCache.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <fstream>
+
+using namespace contour;
+using namespace contour::config;
+using namespace std::string_literals;
+
+namespace
+{
+
+Config nonDefaultConfig()
+{
+    auto config = Config {};
+    config.backingFilePath = "/tmp/contour.yml";
+    config.includedFilePaths = { "/tmp/colorschemes/included.yml" };
+    config.absentFilePaths = { "/tmp/colorschemes/absent.yml" };
+    config.platformPlugin = "xcb";
+    config.renderingBackend = RenderingBackend::Software;
+    config.textureAtlasDirectMapping = false;
+    config.ptyReadBufferSize = 4096;
+    config.reflowOnResize = false;
+    config.defaultProfileName = "main";
+    config.wordDelimiters = " ,;";
+    config.bypassMouseProtocolModifier = terminal::Modifier::Alt;
+    config.maxImageSize = terminal::ImageSize { terminal::Width(800), terminal::Height(600) };
+    config.maxImageColorRegisters = 256;
+    config.experimentalFeatures = { "feature" };
+
+    auto colors = terminal::ColorPalette {};
+    colors.defaultForeground = terminal::RGBColor(0x102030);
+    colors.selectionBackground = terminal::RGBColor(0x405060);
+    config.colorschemes["scheme"] = colors;
+
+    auto& profile = config.profiles["main"];
+    profile.shell.program = "/bin/zsh";
+    profile.shell.arguments = { "-l" };
+    profile.shell.env["TERM"] = "contour";
+    profile.fullscreen = true;
+    profile.refreshRate = 60.0;
+    profile.synchronizedOutputTimeout = std::chrono::milliseconds(100);
+    profile.alternateScreenReleaseTimeout = std::chrono::seconds(5);
+    profile.terminalSize = terminal::PageSize { terminal::LineCount(30), terminal::ColumnCount(100) };
+    profile.maxHistoryLineCount = terminal::LineCount(5000);
+    profile.fonts.size.pt = 14;
+    profile.fonts.regular.familyName = "Fira Code";
+    profile.fonts.textShapingEngine = terminal::renderer::TextShapingEngine::DWrite;
+    profile.fonts.builtinBoxDrawing = false;
+    profile.colors = colors;
+    profile.backgroundOpacity = terminal::Opacity(0x80);
+    profile.hyperlinkDecoration.hover = terminal::renderer::Decorator::DoubleUnderline;
+
+    config.inputMappings.keyMappings.push_back(
+        KeyInputMapping { terminal::MatchModes {},
+                          terminal::Modifier::Control,
+                          terminal::Key::F1,
+                          { actions::SendChars { "\x1b[A" }, actions::ChangeProfile { "other" } } });
+
+    return config;
+}
+
+} // namespace
+
+TEST_CASE("ConfigCache.roundtrip", "[config]")
+{
+    auto const config = nonDefaultConfig();
+    auto const data = serializeConfig(config);
+
+    auto const restored = deserializeConfig(data);
+    REQUIRE(restored.has_value());
+
+    // Serializing the restored configuration yields the same data, i.e. every serialized field is restored.
+    CHECK(serializeConfig(*restored) == data);
+
+    CHECK(restored->backingFilePath == config.backingFilePath);
+    CHECK(restored->absentFilePaths == config.absentFilePaths);
+    CHECK(restored->renderingBackend == RenderingBackend::Software);
+    CHECK(restored->wordDelimiters == config.wordDelimiters);
+    CHECK(restored->maxImageSize == config.maxImageSize);
+    CHECK(restored->colorschemes.at("scheme").defaultForeground == terminal::RGBColor(0x102030));
+
+    auto const& profile = restored->profile();
+    CHECK(profile.shell.program == "/bin/zsh");
+    CHECK(profile.shell.env.at("TERM") == "contour");
+    CHECK(profile.synchronizedOutputTimeout == std::chrono::milliseconds(100));
+    CHECK(profile.alternateScreenReleaseTimeout == std::chrono::seconds(5));
+    CHECK(profile.fonts == config.profile().fonts);
+    CHECK(profile.backgroundOpacity == terminal::Opacity(0x80));
+
+    REQUIRE(restored->inputMappings.keyMappings.size() == 1);
+    auto const& mapping = restored->inputMappings.keyMappings.front();
+    CHECK(mapping.modifier.value() == terminal::Modifier::Control);
+    CHECK(mapping.input == terminal::Key::F1);
+    REQUIRE(mapping.binding.size() == 2);
+    CHECK(std::get<actions::SendChars>(mapping.binding[0]).chars == "\x1b[A");
+    CHECK(std::get<actions::ChangeProfile>(mapping.binding[1]).name == "other");
+}
+
+TEST_CASE("ConfigCache.invalid", "[config]")
+{
+    auto const data = serializeConfig(nonDefaultConfig());
+    CHECK(!deserializeConfig(data.substr(0, data.size() - 1)));
+    CHECK(!deserializeConfig(data + "x"));
+    CHECK(!deserializeConfig("garbage"));
+}
+
+TEST_CASE("ConfigCache.absentFileCreated", "[config]")
+{
+    auto const directory = FileSystem::temp_directory_path() / "contour-config-cache-test";
+    FileSystem::remove_all(directory);
+    FileSystem::create_directories(directory);
+    setenv("XDG_CACHE_HOME", directory.string().c_str(), 1);
+
+    auto config = nonDefaultConfig();
+    config.backingFilePath = directory / "contour.yml";
+    config.includedFilePaths.clear();
+    config.absentFilePaths = { directory / "absent.yml" };
+    std::ofstream(config.backingFilePath.string()) << "profiles: {}\n";
+
+    storeCachedConfig(config);
+    CHECK(loadCachedConfig(config.backingFilePath).has_value());
+
+    // A color scheme file in a search path of higher priority invalidates the cache.
+    std::ofstream((directory / "absent.yml").string()) << "default: {}\n";
+    CHECK(!loadCachedConfig(config.backingFilePath).has_value());
+
+    unsetenv("XDG_CACHE_HOME");
+    FileSystem::remove_all(directory);
+}
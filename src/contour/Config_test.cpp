@@ -0,0 +1,106 @@
+/**
+ * This file is part of the "contour" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <contour/Config.h>
+
+#include <catch2/catch.hpp>
+
+#include <fstream>
+
+using namespace contour::config;
+using terminal::renderer::FontLocatorEngine;
+using terminal::renderer::TextShapingEngine;
+
+TEST_CASE("Config.diff.unchanged", "[config]")
+{
+    auto const config = Config {};
+    auto const profile = TerminalProfile {};
+    CHECK(!diff(config, profile, config, profile).any());
+}
+
+TEST_CASE("Config.diff.fonts", "[config]")
+{
+    auto const config = Config {};
+    auto const profile = TerminalProfile {};
+
+    auto const checkFontsChanged = [&](auto _change) {
+        auto newProfile = profile;
+        _change(newProfile.fonts);
+        auto const changes = diff(config, profile, config, newProfile);
+        CHECK(changes.fonts);
+        CHECK(!changes.terminal);
+        CHECK(!changes.colors);
+        CHECK(!changes.window);
+    };
+
+    checkFontsChanged([](auto& _fonts) { _fonts.size.pt += 1; });
+    checkFontsChanged([](auto& _fonts) { _fonts.regular.familyName = "monospace-changed"; });
+    checkFontsChanged([](auto& _fonts) { _fonts.textShapingEngine = TextShapingEngine::DWrite; });
+    checkFontsChanged([](auto& _fonts) { _fonts.fontLocator = FontLocatorEngine::Mock; });
+    checkFontsChanged([](auto& _fonts) { _fonts.builtinBoxDrawing = !_fonts.builtinBoxDrawing; });
+    checkFontsChanged([](auto& _fonts) { _fonts.dpi = { 192, 192 }; });
+    checkFontsChanged([](auto& _fonts) { _fonts.dpiScale = 2.0; });
+}
+
+TEST_CASE("Config.diff.subsystems", "[config]")
+{
+    auto const config = Config {};
+    auto const profile = TerminalProfile {};
+
+    auto newConfig = config;
+    newConfig.sixelScrolling = !config.sixelScrolling;
+    auto changes = diff(config, profile, newConfig, profile);
+    CHECK(changes.terminal);
+    CHECK(!changes.fonts);
+
+    auto newProfile = profile;
+    newProfile.maxHistoryLineCount = profile.maxHistoryLineCount + terminal::LineCount(1);
+    changes = diff(config, profile, config, newProfile);
+    CHECK(changes.terminal);
+    CHECK(!changes.fonts);
+
+    newProfile = profile;
+    newProfile.backgroundOpacity = terminal::Opacity(0x80);
+    changes = diff(config, profile, config, newProfile);
+    CHECK(changes.backgroundOpacity);
+    CHECK(!changes.terminal);
+
+    newProfile = profile;
+    newProfile.fullscreen = !profile.fullscreen;
+    changes = diff(config, profile, config, newProfile);
+    CHECK(changes.window);
+    CHECK(!changes.fonts);
+}
+
+TEST_CASE("Config.load.synchronizedOutputTimeout", "[config]")
+{
+    auto const directory = FileSystem::temp_directory_path() / "contour-config-test";
+    FileSystem::remove_all(directory);
+    FileSystem::create_directories(directory);
+    auto const fileName = directory / "contour.yml";
+
+    // A timeout of zero is raised to the minimum, so that the frame is not republished all the time.
+    std::ofstream(fileName.string()) << "default_profile: main\n"
+                                        "profiles:\n"
+                                        "  main:\n"
+                                        "    shell: /bin/sh\n"
+                                        "    font:\n"
+                                        "      size: 12\n"
+                                        "    synchronized_output_timeout: 0\n";
+    auto config = Config {};
+    loadConfigFromFile(config, fileName);
+    REQUIRE(config.profile("main") != nullptr);
+    CHECK(config.profile("main")->synchronizedOutputTimeout > std::chrono::milliseconds(0));
+
+    FileSystem::remove_all(directory);
+}
@@ -232,8 +232,22 @@ int ContourApp::captureAction()
     captureSettings.timeout = parameters().get<double>("contour.capture.timeout");
     captureSettings.lineCount = terminal::LineCount::cast_from(parameters().get<unsigned>("contour.capture.lines"));
     captureSettings.outputFile = parameters().get<string>("contour.capture.to");
+    captureSettings.stats = parameters().get<bool>("contour.capture.stats");
     // clang-format on
 
+    auto const format = parameters().get<string>("contour.capture.format");
+    if (format == "text")
+        captureSettings.format = terminal::CaptureFormat::Text;
+    else if (format == "sgr")
+        captureSettings.format = terminal::CaptureFormat::TextWithSgr;
+    else if (format == "json")
+        captureSettings.format = terminal::CaptureFormat::JsonLines;
+    else
+    {
+        std::cerr << fmt::format("Unknown capture format \"{}\".\n", format);
+        return EXIT_FAILURE;
+    }
+
     if (contour::captureScreen(captureSettings))
         return EXIT_SUCCESS;
     else
@@ -335,6 +349,14 @@ crispy::cli::Command ContourApp::parameterDefinition() const
                                   "Sets timeout seconds to wait for terminal to respond.",
                                   "SECONDS" },
                     CLI::Option { "lines", CLI::Value { 0u }, "The number of lines to capture", "COUNT" },
+                    CLI::Option { "format",
+                                  CLI::Value { "text"s },
+                                  "Output format, one of: text, sgr (text with colors and styles), "
+                                  "json (one JSON object per line, including line marks).",
+                                  "FORMAT" },
+                    CLI::Option { "stats",
+                                  CLI::Value { false },
+                                  "Prints the captured size and throughput to standard error." },
                     CLI::Option { "to",
                                   CLI::Value { ""s },
                                   "Output file name to store the screen capture to. If - (dash) is given, "
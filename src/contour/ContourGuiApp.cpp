@@ -19,7 +19,9 @@
 #include <terminal/Process.h>
 
 #include <text_shaper/font_locator.h>
+#include <text_shaper/fontconfig_locator.h>
 
+#include <crispy/StartupProfile.h>
 #include <crispy/logstore.h>
 
 #include <QtCore/QProcess>
@@ -84,7 +86,9 @@ crispy::cli::Command ContourGuiApp::parameterDefinition() const
                     "profile", CLI::Value { ""s }, "Terminal Profile to load (overriding config).", "NAME" },
                 CLI::Option { "debug",
                               CLI::Value { ""s },
-                              "Enables debug logging, using a comma (,) seperated list of tags.",
+                              "Enables debug logging, using a comma (,) seperated list of tags. "
+                              "A tag may be suffixed with :1/N to only log every N-th message, "
+                              "or with :N/s to log at most N messages per second.",
                               "TAGS" },
             },
         });
@@ -103,14 +107,25 @@ crispy::cli::Command ContourGuiApp::parameterDefinition() const
                     "profile", CLI::Value { ""s }, "Terminal Profile to load (overriding config).", "NAME" },
                 CLI::Option { "debug",
                               CLI::Value { ""s },
-                              "Enables debug logging, using a comma (,) seperated list of tags.",
+                              "Enables debug logging, using a comma (,) seperated list of tags. "
+                              "A tag may be suffixed with :1/N to only log every N-th message, "
+                              "or with :N/s to log at most N messages per second.",
                               "TAGS" },
                 CLI::Option { "live-config", CLI::Value { false }, "Enables live config reloading." },
+                CLI::Option { "startup-profile",
+                              CLI::Value { false },
+                              "Prints the time spent in each startup phase to standard error, "
+                              "once the terminal became interactive." },
                 CLI::Option {
                     "dump-state-at-exit",
                     CLI::Value { ""s },
                     "Dumps internal state at exit into the given directory. This is for debugging contour.",
                     "PATH" },
+                CLI::Option { "record",
+                              CLI::Value { ""s },
+                              "Records the PTY output, input and resize events of the first terminal "
+                              "into the given file, to be replayed via bench-headless.",
+                              "FILE" },
                 CLI::Option { "early-exit-threshold",
                               CLI::Value { 6u },
                               "If the spawned process exits earlier than the given threshold seconds, an "
@@ -177,6 +192,24 @@ std::optional<FileSystem::path> ContourGuiApp::dumpStateAtExit() const
     return FileSystem::path(path);
 }
 
+std::unique_ptr<terminal::PtyRecorder> ContourGuiApp::createPtyRecorder(terminal::PageSize _pageSize)
+{
+    auto const path = parameters().get<std::string>("contour.terminal.record");
+    if (path.empty() || ptyRecorderCreated_)
+        return nullptr;
+
+    ptyRecorderCreated_ = true;
+    try
+    {
+        return std::make_unique<terminal::PtyRecorder>(FileSystem::path(path), _pageSize);
+    }
+    catch (std::exception const& e)
+    {
+        errorlog()("Could not start PTY recording. {}", e.what());
+        return nullptr;
+    }
+}
+
 void ContourGuiApp::onExit(TerminalSession& _session)
 {
     auto const* localProcess = dynamic_cast<terminal::Process const*>(&_session.terminal().device());
@@ -273,8 +306,20 @@ int ContourGuiApp::fontConfigAction()
 
 int ContourGuiApp::terminalGuiAction()
 {
-    if (!loadConfig("terminal"))
-        return EXIT_FAILURE;
+    auto& startupProfile = crispy::StartupProfile::get();
+    if (parameters().get<bool>("contour.terminal.startup-profile"))
+        startupProfile.enable();
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+    // Let fontconfig load its font cache while the configuration is being parsed.
+    text::fontconfig_locator::preload();
+#endif
+
+    {
+        auto const _ = startupProfile.phase("config");
+        if (!loadConfig("terminal"))
+            return EXIT_FAILURE;
+    }
 
     switch (config_.renderingBackend)
     {
@@ -295,6 +340,13 @@ int ContourGuiApp::terminalGuiAction()
         errorlog()("Could not access configuration profile.");
         return EXIT_FAILURE;
     }
+
+    // Spawn the shell right away, so that it starts up while the GUI and fonts are being initialized.
+    {
+        auto const _ = startupProfile.phase("shell spawn");
+        initialShell_ = TerminalWindow::spawnShell(*profile, argv_[0]);
+    }
+
     auto appName = QString::fromStdString(profile->wmClass);
     QCoreApplication::setApplicationName(appName);
     QCoreApplication::setOrganizationName("contour");
@@ -331,7 +383,9 @@ int ContourGuiApp::terminalGuiAction()
 #endif
 
     auto qtArgsCount = static_cast<int>(qtArgsPtr.size());
+    auto const qtStart = crispy::StartupProfile::Clock::now();
     QApplication app(qtArgsCount, (char**) qtArgsPtr.data());
+    startupProfile.record("qt", qtStart, crispy::StartupProfile::Clock::now());
 
     QSurfaceFormat::setDefaultFormat(contour::opengl::TerminalWidget::surfaceFormat());
 
@@ -340,10 +394,13 @@ int ContourGuiApp::terminalGuiAction()
     // printf("\r%s        %s                        %s\r", TBC, HTS, HTS);
 
     // Spawn initial window.
-    if (!newWindow())
     {
-        errorlog()("Could not spawn terminal window.");
-        return EXIT_FAILURE;
+        auto const _ = startupProfile.phase("window");
+        if (!newWindow())
+        {
+            errorlog()("Could not spawn terminal window.");
+            return EXIT_FAILURE;
+        }
     }
 
     auto rv = app.exec();
@@ -389,8 +446,8 @@ TerminalWindow* ContourGuiApp::newWindow(contour::config::Config const& _config)
 TerminalWindow* ContourGuiApp::newWindow()
 {
     auto const liveConfig = parameters().get<bool>("contour.terminal.live-config");
-    auto mainWindow =
-        new TerminalWindow(earlyExitThreshold(), config_, liveConfig, profileName(), argv_[0], *this);
+    auto mainWindow = new TerminalWindow(
+        earlyExitThreshold(), config_, liveConfig, profileName(), argv_[0], *this, std::move(initialShell_));
     mainWindow->show();
 
     terminalWindows_.emplace_back(mainWindow);
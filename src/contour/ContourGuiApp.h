@@ -17,6 +17,8 @@
 #include <contour/ContourApp.h>
 
 #include <terminal/Process.h>
+#include <terminal/PtyRecording.h>
+#include <terminal/pty/Pty.h>
 
 #include <list>
 #include <memory>
@@ -54,6 +56,9 @@ class ContourGuiApp: public ContourApp
 
     std::optional<FileSystem::path> dumpStateAtExit() const;
 
+    /// Creates the PTY recorder requested on the command line, if any, for the first terminal only.
+    std::unique_ptr<terminal::PtyRecorder> createPtyRecorder(terminal::PageSize _pageSize);
+
     void onExit(TerminalSession& _session);
 
   private:
@@ -67,6 +72,11 @@ class ContourGuiApp: public ContourApp
     char const** argv_ = nullptr;
     std::optional<terminal::Process::ExitStatus> exitStatus_;
 
+    // The shell of the initial window, spawned before the GUI is initialized.
+    std::unique_ptr<terminal::Pty> initialShell_;
+
+    bool ptyRecorderCreated_ = false;
+
     std::list<TerminalWindow*> terminalWindows_;
 };
 
@@ -22,6 +22,8 @@
 #include <terminal/pty/Pty.h>
 
 #include <crispy/StackTrace.h>
+#include <crispy/StartupProfile.h>
+#include <crispy/utils.h>
 
 #include <range/v3/all.hpp>
 
@@ -138,6 +140,9 @@ TerminalSession::TerminalSession(unique_ptr<Pty> _pty,
 
     profile_ = *config_.profile(profileName_); // XXX do it again. but we've to be more efficient here
     configureTerminal();
+
+    if (auto recorder = app_.createPtyRecorder(terminal_.pageSize()))
+        terminal_.setPtyRecorder(move(recorder));
 }
 
 TerminalSession::~TerminalSession()
@@ -222,6 +227,12 @@ void TerminalSession::bufferChanged(terminal::ScreenType _type)
 
 void TerminalSession::screenUpdated()
 {
+    if (!outputReceived_)
+    {
+        outputReceived_ = true;
+        crispy::StartupProfile::get().mark("shell output");
+    }
+
     if (profile_.autoScrollOnUpdate && terminal().viewport().scrolled()
         && terminal().inputHandler().mode() == ViMode::Insert)
         terminal().viewport().scrollToBottom();
@@ -235,10 +246,36 @@ void TerminalSession::screenUpdated()
 void TerminalSession::flushInput()
 {
     terminal().flushInput();
+    updatePasteProgress();
     if (terminal().hasInput())
         display_->post(bind(&TerminalSession::flushInput, this));
 }
 
+void TerminalSession::sendPaste(string _text)
+{
+    terminal().sendPaste(move(_text));
+    flushInput();
+}
+
+void TerminalSession::updatePasteProgress()
+{
+    // Large pastes are sent as the application reads them, so show how far that got.
+    auto const progress = terminal().pasteProgress();
+    if (!progress && !pasteProgressShown_)
+        return;
+
+    pasteProgressShown_ = progress.has_value();
+    if (!display_)
+        return;
+
+    if (!progress)
+        display_->setWindowTitle(terminal().windowTitle());
+    else
+        display_->setWindowTitle(fmt::format("{} [pasting {}%, press Escape to cancel]",
+                                             terminal().windowTitle(),
+                                             progress->processed * 100 / progress->total));
+}
+
 void TerminalSession::renderBufferUpdated()
 {
     if (!display_)
@@ -247,14 +284,14 @@ void TerminalSession::renderBufferUpdated()
     display_->renderBufferUpdated();
 }
 
-void TerminalSession::requestCaptureBuffer(LineCount lines, bool logical)
+void TerminalSession::requestCaptureBuffer(LineCount lines, bool logical, terminal::CaptureFormat format)
 {
-    display_->post([this, lines, logical]() {
+    display_->post([this, lines, logical, format]() {
         if (display_->requestPermission(profile_.permissions.captureBuffer, "capture screen buffer"))
         {
-            terminal_.primaryScreen().captureBuffer(lines, logical);
-            DisplayLog()("requestCaptureBuffer: Finished. Waking up I/O thread.");
-            flushInput();
+            auto const _l = scoped_lock { terminal_ };
+            terminal_.captureBuffer(lines, logical, format);
+            DisplayLog()("requestCaptureBuffer: Started capturing {} lines as {}.", lines, format);
         }
     });
 }
@@ -377,17 +414,18 @@ void TerminalSession::pasteFromClipboard(unsigned count)
         SessionLog()("pasteFromClipboard: mime data contains {} formats.", md->formats().size());
         for (int i = 0; i < md->formats().size(); ++i)
             SessionLog()("pasteFromClipboard[{}]: {}\n", i, md->formats().at(i).toStdString());
-        string const text = clipboard->text(QClipboard::Clipboard).toUtf8().toStdString();
+        string text = clipboard->text(QClipboard::Clipboard).toUtf8().toStdString();
         if (text.empty())
             SessionLog()("Clipboard does not contain text.");
         else if (count == 1)
-            terminal().sendPaste(string_view { text });
+            sendPaste(move(text));
         else
         {
             string fullPaste;
+            fullPaste.reserve(text.size() * count);
             for (unsigned i = 0; i < count; ++i)
                 fullPaste += text;
-            terminal().sendPaste(string_view { fullPaste });
+            sendPaste(move(fullPaste));
         }
     }
     else
@@ -489,6 +527,13 @@ void TerminalSession::sendKeyPressEvent(Key _key, Modifier _modifier, Timestamp
 
     display_->setMouseCursorShape(MouseCursorShape::Hidden);
 
+    if (terminal().urlHintsMode())
+    {
+        // Keys never denote a hint label, so they just leave the URL hints mode.
+        terminal().setUrlHintsMode(false);
+        return;
+    }
+
     if (auto const* actions =
             config::apply(config_.inputMappings.keyMappings, _key, _modifier, matchModeFlags()))
         executeAllActions(*actions);
@@ -509,6 +554,16 @@ void TerminalSession::sendCharPressEvent(char32_t _value, Modifier _modifier, Ti
 
     display_->setMouseCursorShape(MouseCursorShape::Hidden);
 
+    if (terminal().urlHintsMode())
+    {
+        auto const _l = scoped_lock { terminal() };
+        auto const hyperlink = terminal().urlHintByLabel(_value);
+        terminal().setUrlHintsMode(false);
+        if (hyperlink)
+            followHyperlink(*hyperlink);
+        return;
+    }
+
     if (auto const* actions =
             config::apply(config_.inputMappings.charMappings, _value, _modifier, matchModeFlags()))
         executeAllActions(*actions);
@@ -721,6 +776,12 @@ bool TerminalSession::operator()(actions::OpenFileManager)
     return true;
 }
 
+bool TerminalSession::operator()(actions::OpenUrlHints)
+{
+    terminal().setUrlHintsMode(true);
+    return true;
+}
+
 bool TerminalSession::operator()(actions::PasteClipboard)
 {
     pasteFromClipboard(1);
@@ -731,8 +792,7 @@ bool TerminalSession::operator()(actions::PasteSelection)
 {
     if (QClipboard* clipboard = QGuiApplication::clipboard(); clipboard != nullptr)
     {
-        string const text = clipboard->text(QClipboard::Selection).toUtf8().toStdString();
-        terminal().sendPaste(string_view { text });
+        sendPaste(clipboard->text(QClipboard::Selection).toUtf8().toStdString());
     }
 
     return true;
@@ -902,8 +962,89 @@ bool TerminalSession::reloadConfig(config::Config _newConfig, string const& _pro
                  _newConfig.backingFilePath.string(), _profileName);
     // clang-format on
 
+    auto const startTime = steady_clock::now();
+
+    // Unless configured, the maximum image size is derived from the screen size at runtime.
+    if (_newConfig.maxImageSize.width <= Width(0))
+        _newConfig.maxImageSize.width = config_.maxImageSize.width;
+    if (_newConfig.maxImageSize.height <= Height(0))
+        _newConfig.maxImageSize.height = config_.maxImageSize.height;
+
+    auto const* oldProfile = config_.profile(profileName_);
+    auto const* newProfile = _newConfig.profile(_profileName);
+    if (_profileName != profileName_ || !oldProfile || !newProfile)
+    {
+        config_ = move(_newConfig);
+        activateProfile(_profileName);
+        SessionLog()("Configuration fully reloaded in {} ms.",
+                     chrono::duration<double, milli>(steady_clock::now() - startTime).count());
+        return true;
+    }
+
+    // Only reconfigure what has changed, as e.g. reloading the fonts also discards
+    // all rasterized glyphs along with the texture atlas.
+    auto const changes = config::diff(config_, *oldProfile, _newConfig, *newProfile);
     config_ = move(_newConfig);
-    activateProfile(_profileName);
+
+    // Keep runtime adjustments, such as the font size, unless the configuration changed them.
+    auto const fontSize = profile_.fonts.size;
+    auto const backgroundOpacity = profile_.backgroundOpacity;
+    profile_ = *config_.profile(profileName_);
+    if (!changes.fonts)
+        profile_.fonts.size = fontSize;
+    if (!changes.backgroundOpacity)
+        profile_.backgroundOpacity = backgroundOpacity;
+
+    auto invalidations = vector<string> {};
+    {
+        auto const _l = scoped_lock { terminal_ };
+        if (changes.terminal)
+            configureTerminalBehavior();
+        if (changes.cursor)
+            inputModeChanged(terminal_.inputHandler().mode());
+        if (changes.colors)
+            configureColors();
+    }
+
+    if (changes.colors)
+    {
+        terminal_.breakLoopAndRefreshRenderBuffer();
+        invalidations.emplace_back("render buffer");
+    }
+
+    if (display_)
+    {
+        if (changes.window)
+            configureWindowState();
+
+        if (changes.backgroundImage)
+        {
+            display_->setBackgroundImage(profile_.colors.backgroundImage);
+            invalidations.emplace_back("background image");
+        }
+
+        if (changes.backgroundOpacity)
+            display_->setBackgroundOpacity(profile_.backgroundOpacity);
+
+        if (changes.fonts)
+        {
+            display_->setFonts(profile_.fonts);
+            invalidations.emplace_back("glyph caches");
+            invalidations.emplace_back("texture atlas");
+        }
+
+        if (changes.hyperlinkDecoration)
+            display_->setHyperlinkDecoration(profile_.hyperlinkDecoration.normal,
+                                             profile_.hyperlinkDecoration.hover);
+
+        if (changes.any())
+            display_->scheduleRedraw();
+    }
+
+    SessionLog()("Configuration reloaded in {} ms. Changed: {}. Invalidated: {}.",
+                 chrono::duration<double, milli>(steady_clock::now() - startTime).count(),
+                 changes,
+                 invalidations.empty() ? "nothing"s : crispy::joinHumanReadable(invalidations));
 
     return true;
 }
@@ -996,6 +1137,18 @@ void TerminalSession::configureTerminal()
     auto const _l = scoped_lock { terminal_ };
     SessionLog()("Configuring terminal.");
 
+    configureTerminalBehavior();
+
+    // XXX
+    // if (!_terminalView.renderer().renderTargetAvailable())
+    //     return;
+
+    configureCursor(profile_.inputModes.insert.cursor);
+    configureColors();
+}
+
+void TerminalSession::configureTerminalBehavior()
+{
     terminal_.setWordDelimiters(config_.wordDelimiters);
     terminal_.setMouseProtocolBypassModifier(config_.bypassMouseProtocolModifier);
     terminal_.setMouseBlockSelectionModifier(config_.mouseBlockSelectionModifier);
@@ -1009,14 +1162,9 @@ void TerminalSession::configureTerminal()
     terminal_.setMode(terminal::DECMode::SixelScrolling, config_.sixelScrolling);
     SessionLog()("maxImageSize={}, sixelScrolling={}", config_.maxImageSize, config_.sixelScrolling);
 
-    // XXX
-    // if (!_terminalView.renderer().renderTargetAvailable())
-    //     return;
-
-    configureCursor(profile_.inputModes.insert.cursor);
-    terminal_.colorPalette() = profile_.colors;
-    terminal_.defaultColorPalette() = profile_.colors;
     terminal_.setMaxHistoryLineCount(profile_.maxHistoryLineCount);
+    terminal_.setSynchronizedOutputTimeout(profile_.synchronizedOutputTimeout);
+    terminal_.setAlternateScreenReleaseTimeout(profile_.alternateScreenReleaseTimeout);
 }
 
 void TerminalSession::configureCursor(config::CursorConfig const& cursorConfig)
@@ -1026,24 +1174,22 @@ void TerminalSession::configureCursor(config::CursorConfig const& cursorConfig)
     terminal_.setCursorShape(cursorConfig.cursorShape);
 }
 
+void TerminalSession::configureColors()
+{
+    terminal_.colorPalette() = profile_.colors;
+    terminal_.defaultColorPalette() = profile_.colors;
+}
+
 void TerminalSession::configureDisplay()
 {
     if (!display_)
         return;
 
     SessionLog()("Configuring display.");
-    display_->setBlurBehind(profile_.backgroundBlur);
+    configureWindowState();
 
     display_->setBackgroundImage(profile_.colors.backgroundImage);
 
-    if (profile_.maximized)
-        display_->setWindowMaximized();
-    else
-        display_->setWindowNormal();
-
-    if (profile_.fullscreen != display_->isFullScreen())
-        display_->toggleFullScreen();
-
     terminal_.setRefreshRate(display_->refreshRate());
     auto const pageSize = PageSize {
         LineCount(unbox<int>(display_->pixelSize().height) / unbox<int>(display_->cellSize().height)),
@@ -1058,6 +1204,19 @@ void TerminalSession::configureDisplay()
     display_->setWindowTitle(terminal_.windowTitle());
 }
 
+void TerminalSession::configureWindowState()
+{
+    display_->setBlurBehind(profile_.backgroundBlur);
+
+    if (profile_.maximized)
+        display_->setWindowMaximized();
+    else
+        display_->setWindowNormal();
+
+    if (profile_.fullscreen != display_->isFullScreen())
+        display_->toggleFullScreen();
+}
+
 uint8_t TerminalSession::matchModeFlags() const
 {
     uint8_t flags = 0;
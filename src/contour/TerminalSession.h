@@ -87,7 +87,9 @@ class TerminalSession: public QObject, public terminal::Terminal::Events
 
     // Terminal::Events
     //
-    void requestCaptureBuffer(terminal::LineCount lineCount, bool logical) override;
+    void requestCaptureBuffer(terminal::LineCount lineCount,
+                              bool logical,
+                              terminal::CaptureFormat format) override;
     void bell() override;
     void bufferChanged(terminal::ScreenType) override;
     void renderBufferUpdated() override;
@@ -142,6 +144,7 @@ class TerminalSession: public QObject, public terminal::Terminal::Events
     bool operator()(actions::NewTerminal const&);
     bool operator()(actions::OpenConfiguration);
     bool operator()(actions::OpenFileManager);
+    bool operator()(actions::OpenUrlHints);
     bool operator()(actions::PasteClipboard);
     bool operator()(actions::PasteSelection);
     bool operator()(actions::Quit);
@@ -203,10 +206,15 @@ class TerminalSession: public QObject, public terminal::Terminal::Events
     void setFontSize(text::font_size _size);
     void setDefaultCursor();
     void configureTerminal();
+    void configureTerminalBehavior();
     void configureCursor(config::CursorConfig const& cursorConfig);
+    void configureColors();
     void configureDisplay();
+    void configureWindowState();
     uint8_t matchModeFlags() const;
     void flushInput();
+    void sendPaste(std::string _text);
+    void updatePasteProgress();
     void mainLoop();
 
     // private data
@@ -229,6 +237,7 @@ class TerminalSession: public QObject, public terminal::Terminal::Events
     std::unique_ptr<QFileSystemWatcher> configFileChangeWatcher_;
 
     bool terminating_ = false;
+    bool outputReceived_ = false;
     std::thread::id mainLoopThreadID_ {};
     std::unique_ptr<std::thread> screenUpdateThread_;
 
@@ -237,6 +246,7 @@ class TerminalSession: public QObject, public terminal::Terminal::Events
     terminal::ScreenType currentScreenType_ = terminal::ScreenType::Primary;
     terminal::CellLocation currentMousePosition_ = terminal::CellLocation {};
     bool allowKeyMappings_ = true;
+    bool pasteProgressShown_ = false;
 };
 
 } // namespace contour
@@ -72,7 +72,8 @@ TerminalWindow::TerminalWindow(std::chrono::seconds _earlyExitThreshold,
                                bool _liveConfig,
                                string _profileName,
                                string _programPath,
-                               ContourGuiApp& _app):
+                               ContourGuiApp& _app,
+                               unique_ptr<terminal::Pty> _shell):
     config_ { std::move(_config) },
     liveConfig_ { _liveConfig },
     profileName_ { std::move(_profileName) },
@@ -108,20 +109,11 @@ TerminalWindow::TerminalWindow(std::chrono::seconds _earlyExitThreshold,
         config_.maxImageSize.height = defaultMaxImageSize.height;
     // }}}
 
-    auto shell = profile().shell;
-#if defined(__APPLE__) || defined(_WIN32)
-    {
-        auto const path = FileSystem::path(programPath_).parent_path();
-
-        if (shell.env.count("PATH"))
-            shell.env["PATH"] += ":"s + path.string();
-        else
-            shell.env["PATH"] = path.string();
-    }
-#endif
+    if (!_shell)
+        _shell = spawnShell(profile(), programPath_);
 
     terminalSession_ = make_unique<TerminalSession>(
-        make_unique<terminal::Process>(shell, terminal::createPty(profile().terminalSize, nullopt)),
+        move(_shell),
         _earlyExitThreshold,
         config_,
         liveConfig_,
@@ -175,6 +167,26 @@ TerminalWindow::~TerminalWindow()
     DisplayLog()("~TerminalWindow");
 }
 
+unique_ptr<terminal::Pty> TerminalWindow::spawnShell(config::TerminalProfile const& _profile,
+                                                     string const& _programPath)
+{
+    auto shell = _profile.shell;
+#if defined(__APPLE__) || defined(_WIN32)
+    {
+        auto const path = FileSystem::path(_programPath).parent_path();
+
+        if (shell.env.count("PATH"))
+            shell.env["PATH"] += ":"s + path.string();
+        else
+            shell.env["PATH"] = path.string();
+    }
+#else
+    (void) _programPath;
+#endif
+
+    return make_unique<terminal::Process>(shell, terminal::createPty(_profile.terminalSize, nullopt));
+}
+
 void TerminalWindow::onTerminalClosed()
 {
     DisplayLog()("terminal closed: {}", terminalSession_->terminal().windowTitle());
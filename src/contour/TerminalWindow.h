@@ -20,6 +20,7 @@
 #include <contour/opengl/TerminalWidget.h>
 
 #include <terminal/Metrics.h>
+#include <terminal/pty/Pty.h>
 
 #include <crispy/assert.h>
 
@@ -62,9 +63,17 @@ class TerminalWindow: public QMainWindow
                    bool _liveConfig,
                    std::string _profileName,
                    std::string _programPath,
-                   ContourGuiApp& _app);
+                   ContourGuiApp& _app,
+                   std::unique_ptr<terminal::Pty> _shell = {});
     ~TerminalWindow() override;
 
+    /// Spawns the given profile's shell on a newly created PTY.
+    ///
+    /// This does not depend on the GUI being initialized, so that the shell can be spawned
+    /// before that and start up concurrently.
+    static std::unique_ptr<terminal::Pty> spawnShell(config::TerminalProfile const& _profile,
+                                                     std::string const& _programPath);
+
     bool event(QEvent* _event) override;
     void resizeEvent(QResizeEvent* _event) override;
 
@@ -441,12 +441,14 @@ bool applyFontDescription(ImageSize _cellSize,
                           terminal::renderer::Renderer& _renderer,
                           terminal::renderer::FontDescriptions _fontDescriptions)
 {
-    if (_renderer.fontDescriptions() == _fontDescriptions)
+    // The renderer holds the sanitized font descriptions, with the DPI filled in.
+    auto fontDescriptions = sanitizeFontDescription(std::move(_fontDescriptions), _dpi);
+    if (_renderer.fontDescriptions() == fontDescriptions)
         return false;
 
     auto const windowMargin = computeMargin(_cellSize, _pageSize, _pixelSize);
 
-    _renderer.setFonts(sanitizeFontDescription(std::move(_fontDescriptions), _dpi));
+    _renderer.setFonts(std::move(fontDescriptions));
     _renderer.setMargin(windowMargin);
     _renderer.updateFontMetrics();
 
@@ -22,6 +22,7 @@
 #include <terminal/pty/Pty.h>
 
 #include <crispy/App.h>
+#include <crispy/StartupProfile.h>
 #include <crispy/logstore.h>
 #include <crispy/stdfs.h>
 
@@ -493,6 +494,7 @@ using opengl::ShaderClass;
 void TerminalWidget::initializeGL()
 {
     DisplayLog()("initializeGL: size={}x{}, scale={}", size().width(), size().height(), contentScale());
+    auto const _ = crispy::StartupProfile::get().phase("opengl");
     initializeOpenGLFunctions();
     configureScreenHooks();
     watchKdeDpiSetting();
@@ -576,6 +578,8 @@ void TerminalWidget::paintGL()
                 ? RGBAColor(profile().colors.defaultForeground, uint8_t(renderer_.backgroundOpacity()))
                 : RGBAColor(profile().colors.defaultBackground, uint8_t(renderer_.backgroundOpacity())));
         renderer_.render(terminal(), renderingPressure_);
+
+        reportStartupProfile();
     }
     catch (exception const& e)
     {
@@ -583,6 +587,18 @@ void TerminalWidget::paintGL()
     }
 }
 
+void TerminalWidget::reportStartupProfile()
+{
+    // The terminal is considered interactive with the first frame showing the shell's output.
+    auto& startupProfile = crispy::StartupProfile::get();
+    if (startupProfileReported_ || !startupProfile.enabled() || !startupProfile.contains("shell output"))
+        return;
+
+    startupProfileReported_ = true;
+    startupProfile.mark("interactive");
+    cerr << "Startup profile (milliseconds since process start):\n" << startupProfile.report();
+}
+
 float TerminalWidget::uptime() const noexcept
 {
     using namespace std::chrono;
@@ -154,6 +154,7 @@ class TerminalWidget: public QOpenGLWidget, public TerminalDisplay, private QOpe
     void configureScreenHooks();
     void logDisplayTopInfo();
     void logDisplayInfo();
+    void reportStartupProfile();
     void watchKdeDpiSetting();
     void initializeRenderer();
     float uptime() const noexcept;
@@ -192,6 +193,7 @@ class TerminalWidget: public QOpenGLWidget, public TerminalDisplay, private QOpe
     text::DPI lastFontDPI_;
     terminal::renderer::Renderer renderer_;
     bool renderingPressure_ = false;
+    bool startupProfileReported_ = false;
     std::unique_ptr<terminal::renderer::RenderTarget> renderTarget_;
     PermissionCache rememberedPermissions_ {};
     bool maximizedState_ = false;
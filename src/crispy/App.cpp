@@ -14,13 +14,16 @@
 #include <crispy/App.h>
 #include <crispy/indexed.h>
 #include <crispy/logstore.h>
+#include <crispy/logstore_async.h>
 #include <crispy/utils.h>
 
 #include <fmt/chrono.h>
 
 #include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <iomanip>
+#include <memory>
 #include <numeric>
 #include <optional>
 
@@ -106,6 +109,9 @@ FileSystem::path xdgStateHome()
 
     return FileSystem::temp_directory_path();
 }
+
+// Owned here rather than by the App instance, as the log output may be customized without one.
+std::unique_ptr<logstore::AsyncSink> asyncConsole;
 } // namespace
 
 namespace crispy
@@ -135,6 +141,7 @@ App::App(std::string _appName, std::string _appTitle, std::string _appVersion, s
 
 App::~App()
 {
+    shutdownLogStoreOutput();
     instance_ = nullptr;
 }
 
@@ -248,10 +255,33 @@ int App::run(int argc, char const* argv[])
     }
 }
 
+void App::shutdownLogStoreOutput()
+{
+    if (!asyncConsole)
+        return;
+
+    // Categories may still be written to by static destructors, so they are redirected to the
+    // synchronous console before the asynchronous sink writes its pending messages and joins its thread.
+    logstore::set_sink(logstore::Sink::console());
+    asyncConsole.reset();
+}
+
 void App::customizeLogStoreOutput()
 {
     logstore::Sink::console().set_enabled(true);
 
+    // Debug logging is written asynchronously, so that tracing does not dominate the
+    // timing of the traced code. Errors are still written synchronously to not get lost
+    // when crashing.
+    // The sink is shut down by the App's destructor, or at exit if there is no App instance.
+    if (!asyncConsole)
+    {
+        asyncConsole = std::make_unique<logstore::AsyncSink>(true, std::cout);
+        std::atexit([]() { shutdownLogStoreOutput(); });
+    }
+    logstore::set_sink(*asyncConsole);
+    logstore::ErrorLog.set_sink(logstore::Sink::console());
+
     // A curated list of colors.
     static const bool colorized =
 #if !defined(_WIN32)
@@ -293,12 +323,12 @@ void App::customizeLogStoreOutput()
             else
             {
                 // clang-format off
-                auto const now = chrono::system_clock::now();
+                auto const timestamp = _msg.timestamp();
                 auto const micros =
-                    duration_cast<chrono::microseconds>(now.time_since_epoch()).count() % 1'000'000;
+                    duration_cast<chrono::microseconds>(timestamp.time_since_epoch()).count() % 1'000'000;
                 result += sgrTag;
                 result += fmt::format("[{:%Y-%m-%d %H:%M:%S}.{:06}] [{}]",
-                                      chrono::system_clock::now(),
+                                      timestamp,
                                       micros,
                                       _msg.category().name());
                 result += sgrReset;
@@ -46,6 +46,9 @@ class App
 
     static void customizeLogStoreOutput();
 
+    /// Writes all pending log messages and stops the asynchronous log output, if customized.
+    static void shutdownLogStoreOutput();
+
   protected:
     void listDebugTags();
 
@@ -0,0 +1,153 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace crispy
+{
+
+/**
+ * Writes values in a compact binary representation.
+ *
+ * Values of trivially copyable types are written in native byte order, as the
+ * output is meant to be read back on the same machine (e.g. caches or snapshots).
+ *
+ * The output is either collected in memory or, if an output stream is given,
+ * streamed to it in chunks of about FlushThreshold bytes.
+ */
+class BinaryWriter
+{
+  public:
+    static constexpr size_t FlushThreshold = 64 * 1024;
+
+    BinaryWriter() = default;
+    explicit BinaryWriter(std::ostream& _output): output_ { &_output } { buffer_.reserve(FlushThreshold); }
+    BinaryWriter(BinaryWriter const&) = delete;
+    BinaryWriter& operator=(BinaryWriter const&) = delete;
+    ~BinaryWriter() { flush(); }
+
+    template <typename T>
+    void write(T const& _value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(&_value, sizeof(T));
+    }
+
+    void writeBytes(void const* _data, size_t _size)
+    {
+        buffer_.append(static_cast<char const*>(_data), _size);
+        if (output_ && buffer_.size() >= FlushThreshold)
+            flush();
+    }
+
+    /// Writes an unsigned integer in LEB128 encoding, i.e. small values take a single byte.
+    void writeVarUInt(uint64_t _value)
+    {
+        while (_value >= 0x80)
+        {
+            buffer_.push_back(static_cast<char>((_value & 0x7F) | 0x80));
+            _value >>= 7;
+        }
+        buffer_.push_back(static_cast<char>(_value));
+        if (output_ && buffer_.size() >= FlushThreshold)
+            flush();
+    }
+
+    /// Writes the given text, prefixed by its length.
+    void writeString(std::string_view _text)
+    {
+        writeVarUInt(_text.size());
+        writeBytes(_text.data(), _text.size());
+    }
+
+    /// Hands the buffered output to the output stream, if any.
+    void flush()
+    {
+        if (!output_ || buffer_.empty())
+            return;
+        output_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    /// Returns the output collected so far, unless streamed to an output stream.
+    [[nodiscard]] std::string const& data() const noexcept { return buffer_; }
+
+  private:
+    std::ostream* output_ = nullptr;
+    std::string buffer_;
+};
+
+/**
+ * Reads values from a contiguous block of memory, as written by BinaryWriter.
+ *
+ * The reader does not own the memory, which may as well be a memory mapped file.
+ * Reading beyond the end of the input throws std::runtime_error.
+ */
+class BinaryReader
+{
+  public:
+    explicit BinaryReader(std::string_view _input) noexcept: input_ { _input } {}
+
+    template <typename T>
+    [[nodiscard]] T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, readBytes(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    [[nodiscard]] std::string_view readBytes(size_t _size)
+    {
+        if (_size > remaining())
+            throw std::runtime_error("Unexpected end of binary data.");
+        auto const bytes = input_.substr(offset_, _size);
+        offset_ += _size;
+        return bytes;
+    }
+
+    [[nodiscard]] uint64_t readVarUInt()
+    {
+        auto value = uint64_t { 0 };
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            auto const byte = static_cast<uint8_t>(readBytes(1)[0]);
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        throw std::runtime_error("Invalid variable length integer in binary data.");
+    }
+
+    /// Returns a view into the input for a text written by BinaryWriter::writeString().
+    [[nodiscard]] std::string_view readStringView() { return readBytes(readVarUInt()); }
+    [[nodiscard]] std::string readString() { return std::string(readStringView()); }
+
+    [[nodiscard]] size_t offset() const noexcept { return offset_; }
+    [[nodiscard]] size_t remaining() const noexcept { return input_.size() - offset_; }
+    [[nodiscard]] bool atEnd() const noexcept { return offset_ == input_.size(); }
+
+  private:
+    std::string_view input_;
+    size_t offset_ = 0;
+};
+
+} // namespace crispy
@@ -0,0 +1,79 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <crispy/BinaryStream.h>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+TEST_CASE("BinaryStream.roundtrip", "[BinaryStream]")
+{
+    auto writer = crispy::BinaryWriter {};
+    writer.write(uint32_t { 0xC0FFEE });
+    writer.write(1.5);
+    writer.writeVarUInt(0);
+    writer.writeVarUInt(127);
+    writer.writeVarUInt(128);
+    writer.writeVarUInt(UINT64_MAX);
+    writer.writeString("Hello");
+    writer.writeString("");
+
+    // 4 + 8 bytes for the fixed size values, 1 + 1 + 2 + 10 bytes for the variable length ones.
+    CHECK(writer.data().size() == 4 + 8 + 1 + 1 + 2 + 10 + 6 + 1);
+
+    auto reader = crispy::BinaryReader(writer.data());
+    CHECK(reader.read<uint32_t>() == 0xC0FFEE);
+    CHECK(reader.read<double>() == 1.5);
+    CHECK(reader.readVarUInt() == 0);
+    CHECK(reader.readVarUInt() == 127);
+    CHECK(reader.readVarUInt() == 128);
+    CHECK(reader.readVarUInt() == UINT64_MAX);
+    CHECK(reader.readString() == "Hello");
+    CHECK(reader.readStringView().empty());
+    CHECK(reader.atEnd());
+}
+
+TEST_CASE("BinaryStream.truncated", "[BinaryStream]")
+{
+    auto writer = crispy::BinaryWriter {};
+    writer.writeString("Hello");
+
+    auto const data = writer.data().substr(0, 3);
+    auto reader = crispy::BinaryReader(data);
+    CHECK_THROWS_AS(reader.readString(), std::runtime_error);
+
+    auto reader2 = crispy::BinaryReader(data);
+    CHECK_THROWS_AS(reader2.read<uint64_t>(), std::runtime_error);
+}
+
+TEST_CASE("BinaryStream.streaming", "[BinaryStream]")
+{
+    auto output = ostringstream {};
+    auto const text = string(crispy::BinaryWriter::FlushThreshold, 'x');
+    {
+        auto writer = crispy::BinaryWriter(output);
+        writer.writeString(text);
+        CHECK(writer.data().empty()); // flushed already
+        writer.writeString(text);
+    }
+
+    auto const data = output.str();
+    auto reader = crispy::BinaryReader(data);
+    CHECK(reader.readStringView() == text);
+    CHECK(reader.readStringView() == text);
+    CHECK(reader.atEnd());
+}
@@ -66,8 +66,24 @@ BufferObject::~BufferObject()
 #endif
 }
 
+namespace
+{
+    void destroyBufferObject(BufferObject* ptr)
+    {
+#if defined(BUFFER_OBJECT_INLINE)
+        destroy_n(ptr, 1);
+        free(ptr);
+#else
+        delete ptr;
+#endif
+    }
+} // namespace
+
 BufferObjectPtr BufferObject::create(size_t capacity, BufferObjectRelease release)
 {
+    if (!release)
+        release = destroyBufferObject;
+
 #if defined(BUFFER_OBJECT_INLINE)
     auto const totalCapacity = nextPowerOfTwo(static_cast<uint32_t>(sizeof(BufferObject) + capacity));
     auto const nettoCapacity = totalCapacity - sizeof(BufferObject);
@@ -136,14 +152,7 @@ void BufferObjectPool::release(BufferObject* ptr)
         unusedBuffers_.emplace_back(ptr, [this](auto p) { release(p); });
     }
     else
-    {
-#if defined(BUFFER_OBJECT_INLINE)
-        destroy_n(ptr, 1);
-        free(ptr);
-#else
-        delete ptr;
-#endif
-    }
+        destroyBufferObject(ptr);
 }
 
 } // namespace crispy
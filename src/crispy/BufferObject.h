@@ -57,6 +57,8 @@ class BufferObject: public std::enable_shared_from_this<BufferObject>
     explicit BufferObject(size_t capacity) noexcept;
     ~BufferObject();
 
+    /// Creates a buffer object, which is passed to @p release once it is not referenced anymore,
+    /// or simply destroyed if no @p release callback is given.
     static BufferObjectPtr create(size_t capacity, BufferObjectRelease release = {});
 
     void reset() noexcept;
@@ -0,0 +1,97 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace crispy
+{
+
+/**
+ * A set of Unicode codepoints with constant time membership tests.
+ *
+ * ASCII codepoints are stored in a 128-bit mask. All other codepoints are
+ * stored in a two-level table: the upper bits of a codepoint select a page
+ * of 256 bits, and only pages that contain at least one member are allocated.
+ */
+class CodepointSet
+{
+  public:
+    static constexpr char32_t MaxCodepoint = 0x10FFFF;
+
+    CodepointSet() = default;
+    explicit CodepointSet(std::u32string_view _codepoints)
+    {
+        for (char32_t const codepoint: _codepoints)
+            insert(codepoint);
+    }
+
+    void insert(char32_t _codepoint)
+    {
+        if (_codepoint < 128)
+        {
+            ascii_[_codepoint / 64] |= uint64_t(1) << (_codepoint % 64);
+            return;
+        }
+
+        if (_codepoint > MaxCodepoint)
+            return;
+
+        if (pageIndex_.empty())
+        {
+            pageIndex_.resize(PageCount, 0);
+            pages_.resize(1); // page 0 is the shared empty page
+        }
+
+        auto& index = pageIndex_[_codepoint / PageSize];
+        if (!index)
+        {
+            index = static_cast<uint16_t>(pages_.size());
+            pages_.emplace_back();
+        }
+        pages_[index].set(_codepoint % PageSize);
+    }
+
+    [[nodiscard]] bool contains(char32_t _codepoint) const noexcept
+    {
+        if (_codepoint < 128)
+            return (ascii_[_codepoint / 64] >> (_codepoint % 64)) & 1;
+
+        if (pageIndex_.empty() || _codepoint > MaxCodepoint)
+            return false;
+
+        return pages_[pageIndex_[_codepoint / PageSize]].test(_codepoint % PageSize);
+    }
+
+    void clear()
+    {
+        ascii_ = {};
+        pageIndex_.clear();
+        pages_.clear();
+    }
+
+  private:
+    static constexpr char32_t PageSize = 256;
+    static constexpr size_t PageCount = (MaxCodepoint + 1) / PageSize;
+
+    std::array<uint64_t, 2> ascii_ {};
+    std::vector<uint16_t> pageIndex_;
+    std::vector<std::bitset<PageSize>> pages_;
+};
+
+} // namespace crispy
@@ -0,0 +1,52 @@
+/**
+ * This file is part of the "contour" project.
+ *   Copyright (c) 2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <crispy/CodepointSet.h>
+
+#include <catch2/catch.hpp>
+
+using namespace crispy;
+
+TEST_CASE("CodepointSet.ascii", "[CodepointSet]")
+{
+    auto const set = CodepointSet(U" ()[]{}\"'`|,;:");
+
+    CHECK(set.contains(U' '));
+    CHECK(set.contains(U'('));
+    CHECK(set.contains(U'`'));
+    CHECK(set.contains(U'|'));
+    CHECK(!set.contains(U'a'));
+    CHECK(!set.contains(U'/'));
+    CHECK(!set.contains(U'\0'));
+    CHECK(!set.contains(U'\x7F'));
+    CHECK(!set.contains(U'\u00A0'));
+}
+
+TEST_CASE("CodepointSet.non_ascii", "[CodepointSet]")
+{
+    auto set = CodepointSet(U"\u00A0\u2502\U0001F600");
+
+    CHECK(set.contains(U'\u00A0'));
+    CHECK(set.contains(U'\u2502'));
+    CHECK(set.contains(U'\U0001F600'));
+    CHECK(!set.contains(U' '));
+    CHECK(!set.contains(U'\u00A1'));
+    CHECK(!set.contains(U'\u2503'));
+    CHECK(!set.contains(U'\U0001F601'));
+    CHECK(!set.contains(U'\U0010FFFF'));
+    CHECK(!set.contains(char32_t { 0x110000 }));
+
+    set.clear();
+    CHECK(!set.contains(U'\u00A0'));
+    CHECK(!set.contains(U'\u2502'));
+}
@@ -0,0 +1,365 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <crispy/assert.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace crispy
+{
+
+/// Implements a fixed capacity LRU (Least recently used) cache that does not
+/// allocate after construction.
+///
+/// This is API compatible with LRUCache, but keeps all entries in one array,
+/// linked into the LRU order by their indices, and finds them through an
+/// open-addressed (linear probing) index table of twice the capacity.
+///
+/// All entries are constructed upfront, so Key and Value must be default constructible.
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class FlatLRUCache
+{
+  public:
+    struct Item
+    {
+        Key key;
+        Value value;
+    };
+
+  private:
+    using Index = uint32_t;
+    static constexpr Index Nil = std::numeric_limits<Index>::max();
+    static constexpr size_t NoSlot = std::numeric_limits<size_t>::max();
+
+    struct Entry
+    {
+        Item item {};
+        size_t hash = 0;
+        Index prev = Nil;
+        Index next = Nil;
+    };
+
+    template <typename Cache, typename T>
+    class basic_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        basic_iterator(Cache* _cache, Index _index) noexcept: cache_ { _cache }, index_ { _index } {}
+
+        reference operator*() const noexcept { return cache_->entries_[index_].item; }
+        pointer operator->() const noexcept { return &cache_->entries_[index_].item; }
+
+        basic_iterator& operator++() noexcept
+        {
+            index_ = cache_->entries_[index_].next;
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept
+        {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(basic_iterator const& _other) const noexcept { return index_ == _other.index_; }
+        bool operator!=(basic_iterator const& _other) const noexcept { return index_ != _other.index_; }
+
+      private:
+        friend class FlatLRUCache;
+        Cache* cache_;
+        Index index_;
+    };
+
+  public:
+    using iterator = basic_iterator<FlatLRUCache, Item>;
+    using const_iterator = basic_iterator<FlatLRUCache const, Item const>;
+
+    explicit FlatLRUCache(std::size_t _capacity):
+        entries_(_capacity), slots_(slotCountFor(_capacity), Nil), mask_ { slots_.size() - 1 }
+    {
+        Require(0 < _capacity && _capacity < Nil);
+        resetFreeList();
+    }
+
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return entries_.size(); }
+
+    void clear()
+    {
+        for (Index i = head_; i != Nil; i = entries_[i].next)
+            entries_[i].item = Item {};
+        std::fill(slots_.begin(), slots_.end(), Nil);
+        resetFreeList();
+    }
+
+    void touch(Key _key) noexcept { (void) try_get(_key); }
+
+    [[nodiscard]] bool contains(Key _key) const noexcept { return findSlot(_key, Hasher {}(_key)) != NoSlot; }
+
+    [[nodiscard]] Value* try_get(Key _key) const { return const_cast<FlatLRUCache*>(this)->try_get(_key); }
+
+    [[nodiscard]] Value* try_get(Key _key)
+    {
+        auto const slot = findSlot(_key, Hasher {}(_key));
+        if (slot == NoSlot)
+            return nullptr;
+
+        auto const index = slots_[slot];
+        moveToFront(index);
+        return &entries_[index].item.value;
+    }
+
+    [[nodiscard]] Value& at(Key _key)
+    {
+        if (Value* p = try_get(_key))
+            return *p;
+
+        throw std::out_of_range("_key");
+    }
+
+    [[nodiscard]] Value const& at(Key _key) const
+    {
+        if (Value const* p = try_get(_key))
+            return *p;
+
+        throw std::out_of_range("_key");
+    }
+
+    /// Returns the value for the given key, default-constructing it in case
+    /// if it wasn't in the cache just yet.
+    [[nodiscard]] Value& operator[](Key _key)
+    {
+        if (Value* p = try_get(_key))
+            return *p;
+
+        return emplaceToFront(_key, Value {});
+    }
+
+    /// Conditionally creates a new item to the LRU-Cache iff its key was not present yet.
+    ///
+    /// @retval true the key did not exist in cache yet, a new value was constructed.
+    /// @retval false The key is already in the cache, no entry was constructed.
+    template <typename ValueConstructFn>
+    [[nodiscard]] bool try_emplace(Key _key, ValueConstructFn _constructValue)
+    {
+        if (try_get(_key))
+            return false;
+
+        emplaceToFront(_key, _constructValue());
+        return true;
+    }
+
+    template <typename ValueConstructFn>
+    [[nodiscard]] Value& get_or_emplace(Key _key, ValueConstructFn _constructValue)
+    {
+        if (Value* p = try_get(_key))
+            return *p;
+        return emplaceToFront(_key, _constructValue());
+    }
+
+    Value& emplace(Key _key, Value&& _value)
+    {
+        Require(!contains(_key));
+        return emplaceToFront(_key, std::move(_value));
+    }
+
+    [[nodiscard]] iterator begin() { return iterator(this, head_); }
+    [[nodiscard]] iterator end() { return iterator(this, Nil); }
+
+    [[nodiscard]] const_iterator begin() const { return const_iterator(this, head_); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(this, Nil); }
+
+    [[nodiscard]] const_iterator cbegin() const { return const_iterator(this, head_); }
+    [[nodiscard]] const_iterator cend() const { return const_iterator(this, Nil); }
+
+    [[nodiscard]] std::vector<Key> keys() const
+    {
+        std::vector<Key> result;
+        result.reserve(size_);
+        for (Item const& item: *this)
+            result.emplace_back(item.key);
+        return result;
+    }
+
+    void erase(iterator _iter)
+    {
+        auto const index = _iter.index_;
+        auto const slot = findSlot(entries_[index].item.key, entries_[index].hash);
+        Require(slot != NoSlot);
+        release(slot);
+    }
+
+    void erase(Key const& _key)
+    {
+        if (auto const slot = findSlot(_key, Hasher {}(_key)); slot != NoSlot)
+            release(slot);
+    }
+
+  private:
+    static size_t slotCountFor(size_t _capacity) noexcept
+    {
+        // Keeping the load factor at or below 0.5 keeps the probe sequences short.
+        auto count = size_t { 2 };
+        while (count < 2 * _capacity)
+            count <<= 1;
+        return count;
+    }
+
+    void resetFreeList() noexcept
+    {
+        for (Index i = 0; i < entries_.size(); ++i)
+        {
+            entries_[i].prev = Nil;
+            entries_[i].next = i + 1 < entries_.size() ? i + 1 : Nil;
+        }
+        free_ = 0;
+        head_ = Nil;
+        tail_ = Nil;
+        size_ = 0;
+    }
+
+    /// @returns the index table slot referring to the given key or NoSlot if not found.
+    [[nodiscard]] size_t findSlot(Key const& _key, size_t _hash) const noexcept
+    {
+        for (auto slot = _hash & mask_;; slot = (slot + 1) & mask_)
+        {
+            auto const index = slots_[slot];
+            if (index == Nil)
+                return NoSlot;
+            if (entries_[index].hash == _hash && entries_[index].item.key == _key)
+                return slot;
+        }
+    }
+
+    void insertSlot(Index _index) noexcept
+    {
+        auto slot = entries_[_index].hash & mask_;
+        while (slots_[slot] != Nil)
+            slot = (slot + 1) & mask_;
+        slots_[slot] = _index;
+    }
+
+    /// Removes the given slot from the index table by shifting back subsequent
+    /// entries of the same probe sequence, so that no tombstones are needed.
+    void eraseSlot(size_t _slot) noexcept
+    {
+        auto hole = _slot;
+        for (auto slot = (_slot + 1) & mask_; slots_[slot] != Nil; slot = (slot + 1) & mask_)
+        {
+            auto const home = entries_[slots_[slot]].hash & mask_;
+            if (((slot - home) & mask_) >= ((slot - hole) & mask_))
+            {
+                slots_[hole] = slots_[slot];
+                hole = slot;
+            }
+        }
+        slots_[hole] = Nil;
+    }
+
+    void unlink(Index _index) noexcept
+    {
+        auto& entry = entries_[_index];
+        if (entry.prev != Nil)
+            entries_[entry.prev].next = entry.next;
+        else
+            head_ = entry.next;
+        if (entry.next != Nil)
+            entries_[entry.next].prev = entry.prev;
+        else
+            tail_ = entry.prev;
+    }
+
+    void linkToFront(Index _index) noexcept
+    {
+        auto& entry = entries_[_index];
+        entry.prev = Nil;
+        entry.next = head_;
+        if (head_ != Nil)
+            entries_[head_].prev = _index;
+        else
+            tail_ = _index;
+        head_ = _index;
+    }
+
+    void moveToFront(Index _index) noexcept
+    {
+        if (_index == head_)
+            return;
+        unlink(_index);
+        linkToFront(_index);
+    }
+
+    /// Returns the entry of the given slot to the free list.
+    void release(size_t _slot)
+    {
+        auto const index = slots_[_slot];
+        eraseSlot(_slot);
+        unlink(index);
+        entries_[index].item = Item {};
+        entries_[index].next = free_;
+        free_ = index;
+        --size_;
+    }
+
+    /// Stores a new item, evicting the least recently used one if needed.
+    Value& emplaceToFront(Key _key, Value&& _value)
+    {
+        Index index = Nil;
+        if (free_ != Nil)
+        {
+            index = free_;
+            free_ = entries_[index].next;
+            ++size_;
+        }
+        else
+        {
+            index = tail_;
+            eraseSlot(findSlot(entries_[index].item.key, entries_[index].hash));
+            unlink(index);
+        }
+
+        auto& entry = entries_[index];
+        entry.item.key = _key;
+        entry.item.value = std::move(_value);
+        entry.hash = Hasher {}(_key);
+        insertSlot(index);
+        linkToFront(index);
+        return entry.item.value;
+    }
+
+    // private data
+    //
+    std::vector<Entry> entries_;
+    std::vector<Index> slots_;
+    size_t mask_;
+    Index head_ = Nil; // most recently used
+    Index tail_ = Nil; // least recently used
+    Index free_ = Nil;
+    size_t size_ = 0;
+};
+
+} // namespace crispy
@@ -11,6 +11,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <crispy/FlatLRUCache.h>
 #include <crispy/LRUCache.h>
 
 #include <fmt/format.h>
@@ -19,6 +20,8 @@
 
 #include <functional>
 #include <iostream>
+#include <random>
+#include <tuple>
 
 using namespace std;
 using namespace std::string_view_literals;
@@ -49,25 +52,28 @@ static std::string join(std::vector<T> const& _list, std::string_view _delimiter
     return s;
 }
 
-TEST_CASE("LRUCache.ctor", "[lrucache]")
+// Both implementations must behave the same.
+using LRUCacheTypes = std::tuple<crispy::LRUCache<int, int>, crispy::FlatLRUCache<int, int>>;
+
+TEMPLATE_LIST_TEST_CASE("LRUCache.ctor", "[lrucache]", LRUCacheTypes)
 {
-    auto cache = crispy::LRUCache<int, int>(4);
+    auto cache = TestType(4);
     CHECK(cache.size() == 0);
     CHECK(cache.capacity() == 4);
 }
 
-TEST_CASE("LRUCache.at", "[lrucache]")
+TEMPLATE_LIST_TEST_CASE("LRUCache.at", "[lrucache]", LRUCacheTypes)
 {
-    auto cache = crispy::LRUCache<int, int>(2);
+    auto cache = TestType(2);
 
     CHECK_THROWS_AS(cache.at(2), std::out_of_range);
     cache[2] = 4;
     CHECK_NOTHROW(cache.at(2));
 }
 
-TEST_CASE("LRUCache.get_or_emplace", "[lrucache]")
+TEMPLATE_LIST_TEST_CASE("LRUCache.get_or_emplace", "[lrucache]", LRUCacheTypes)
 {
-    auto cache = crispy::LRUCache<int, int>(2);
+    auto cache = TestType(2);
 
     int& a = cache.get_or_emplace(2, []() { return 4; });
     CHECK(a == 4);
@@ -101,9 +107,9 @@ TEST_CASE("LRUCache.get_or_emplace", "[lrucache]")
     CHECK(cache.size() == 2);
 }
 
-TEST_CASE("LRUCache.operator[]", "[lrucache]")
+TEMPLATE_LIST_TEST_CASE("LRUCache.operator[]", "[lrucache]", LRUCacheTypes)
 {
-    auto cache = crispy::LRUCache<int, int>(2);
+    auto cache = TestType(2);
 
     (void) cache[2];
     CHECK(join(cache.keys()) == "2"sv);
@@ -135,9 +141,9 @@ TEST_CASE("LRUCache.operator[]", "[lrucache]")
     CHECK_FALSE(cache.contains(4)); // thrown out
 }
 
-TEST_CASE("LRUCache.clear", "[lrucache]")
+TEMPLATE_LIST_TEST_CASE("LRUCache.clear", "[lrucache]", LRUCacheTypes)
 {
-    auto cache = crispy::LRUCache<int, int>(4);
+    auto cache = TestType(4);
     cache[2] = 4;
     cache[3] = 6;
     CHECK(cache.size() == 2);
@@ -145,9 +151,9 @@ TEST_CASE("LRUCache.clear", "[lrucache]")
     CHECK(cache.size() == 0);
 }
 
-TEST_CASE("LRUCache.try_emplace", "[lrucache]")
+TEMPLATE_LIST_TEST_CASE("LRUCache.try_emplace", "[lrucache]", LRUCacheTypes)
 {
-    auto cache = crispy::LRUCache<int, int>(2);
+    auto cache = TestType(2);
     auto rv = cache.try_emplace(2, []() { return 4; });
     CHECK(rv);
     CHECK(join(cache.keys()) == "2");
@@ -165,3 +171,86 @@ TEST_CASE("LRUCache.try_emplace", "[lrucache]")
     CHECK(cache.at(2) == 4);
     CHECK(cache.at(3) == 6);
 }
+
+TEST_CASE("FlatLRUCache.model", "[lrucache]")
+{
+    // Runs a random mix of operations against both implementations, with a
+    // small key range to exercise collisions, evictions and erasure.
+    auto flat = crispy::FlatLRUCache<int, int>(16);
+    auto list = crispy::LRUCache<int, int>(16);
+    auto rng = std::mt19937(42);
+    auto keyDistribution = std::uniform_int_distribution<int>(0, 40);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto const key = keyDistribution(rng);
+        switch (rng() % 4)
+        {
+            case 0:
+                flat[key] = i;
+                list[key] = i;
+                break;
+            case 1:
+                flat.erase(key);
+                list.erase(key);
+                break;
+            default:
+                CHECK((flat.try_get(key) == nullptr) == (list.try_get(key) == nullptr));
+                break;
+        }
+        REQUIRE(flat.keys() == list.keys());
+    }
+
+    for (auto const key: list.keys())
+        CHECK(flat.at(key) == list.at(key));
+}
+
+namespace
+{
+template <typename Cache>
+int runCacheWorkload(Cache& _cache, std::vector<int> const& _keys)
+{
+    int sum = 0;
+    for (auto const key: _keys)
+        sum += _cache.get_or_emplace(key, [&]() { return key; });
+    return sum;
+}
+} // namespace
+
+TEST_CASE("LRUCache.benchmark", "[.benchmark]")
+{
+    auto constexpr Capacity = 1024;
+
+    // Roughly half of the lookups hit, the other half evict.
+    auto rng = std::mt19937(42);
+    auto keyDistribution = std::uniform_int_distribution<int>(0, 2 * Capacity);
+    auto keys = std::vector<int>(100'000);
+    for (auto& key: keys)
+        key = keyDistribution(rng);
+
+    BENCHMARK_ADVANCED("LRUCache.get_or_emplace")(Catch::Benchmark::Chronometer meter)
+    {
+        auto cache = crispy::LRUCache<int, int>(Capacity);
+        meter.measure([&]() { return runCacheWorkload(cache, keys); });
+    };
+
+    BENCHMARK_ADVANCED("FlatLRUCache.get_or_emplace")(Catch::Benchmark::Chronometer meter)
+    {
+        auto cache = crispy::FlatLRUCache<int, int>(Capacity);
+        meter.measure([&]() { return runCacheWorkload(cache, keys); });
+    };
+
+    BENCHMARK_ADVANCED("LRUCache.hit")(Catch::Benchmark::Chronometer meter)
+    {
+        auto cache = crispy::LRUCache<int, int>(2 * Capacity + 1);
+        (void) runCacheWorkload(cache, keys);
+        meter.measure([&]() { return runCacheWorkload(cache, keys); });
+    };
+
+    BENCHMARK_ADVANCED("FlatLRUCache.hit")(Catch::Benchmark::Chronometer meter)
+    {
+        auto cache = crispy::FlatLRUCache<int, int>(2 * Capacity + 1);
+        (void) runCacheWorkload(cache, keys);
+        meter.measure([&]() { return runCacheWorkload(cache, keys); });
+    };
+}
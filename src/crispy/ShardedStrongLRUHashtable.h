@@ -0,0 +1,278 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <crispy/StrongHash.h>
+#include <crispy/StrongLRUHashtable.h>
+#include <crispy/assert.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <immintrin.h>
+
+namespace crispy
+{
+
+/// Number of independent shards of a ShardedStrongLRUHashtable.
+struct ShardCount
+{
+    uint32_t value;
+};
+
+/**
+ * Thread-safe LRU hashtable, made of independent StrongLRUHashtable shards,
+ * each guarded by its own lock.
+ *
+ * The shard is selected by hash bits that are independent of the ones used for the
+ * shard's own hash table slots, so that concurrent threads rarely contend on the
+ * same lock. The LRU order is maintained per shard.
+ *
+ * Values are returned by copy, as references into the table could be invalidated
+ * by concurrent evictions. Big values should therefore be stored as shared pointers.
+ *
+ * Value constructors are invoked while holding the shard lock, and must not access
+ * the same table.
+ */
+template <typename Value>
+class ShardedStrongLRUHashtable
+{
+  public:
+    using Shard = StrongLRUHashtable<Value>;
+
+    /// @param hashCount total number of hash slots, split across all shards.
+    /// @param entryCount total capacity, split across all shards.
+    ShardedStrongLRUHashtable(ShardCount shardCount,
+                              StrongHashtableSize hashCount,
+                              LRUCapacity entryCount,
+                              std::string const& name = "");
+
+    [[nodiscard]] size_t shardCount() const noexcept { return _shards.size(); }
+
+    /// Returns the actual number of entries currently hold in all shards.
+    [[nodiscard]] size_t size() const;
+
+    /// Returns the maximum number of entries that can be stored in all shards.
+    [[nodiscard]] size_t capacity() const noexcept { return _shards.size() * _shardCapacity; }
+
+    /// Returns gathered stats of all shards and clears them.
+    LRUHashtableStats fetchAndClearStats();
+
+    void clear();
+    void remove(StrongHash const& hash);
+    void touch(StrongHash const& hash);
+    [[nodiscard]] bool contains(StrongHash const& hash) const;
+
+    /// Returns a copy of the value for the given hash key if found.
+    [[nodiscard]] std::optional<Value> try_get(StrongHash const& hash);
+
+    /// Assigns the given value to the given hash key.
+    void emplace(StrongHash const& hash, Value value);
+
+    /// @see StrongLRUHashtable::try_emplace()
+    ///
+    /// The entry index passed to @p constructValue is unique across all shards.
+    template <typename ValueConstructFn>
+    [[nodiscard]] bool try_emplace(StrongHash const& hash, ValueConstructFn constructValue);
+
+    /// @see StrongLRUHashtable::get_or_emplace()
+    ///
+    /// The entry index passed to @p constructValue is unique across all shards.
+    template <typename ValueConstructFn>
+    [[nodiscard]] Value get_or_emplace(StrongHash const& hash, ValueConstructFn constructValue);
+
+    /// @see StrongLRUHashtable::get_or_try_emplace()
+    ///
+    /// The entry index passed to @p constructValue is unique across all shards.
+    template <typename ValueConstructFn>
+    [[nodiscard]] std::optional<Value> get_or_try_emplace(StrongHash const& hash,
+                                                          ValueConstructFn constructValue);
+
+  private:
+    struct alignas(64) LockedShard
+    {
+        mutable std::mutex lock;
+        typename Shard::Ptr table;
+    };
+
+    [[nodiscard]] uint32_t shardIndex(StrongHash const& hash) const noexcept
+    {
+        // Fibonacci hashing spreads the same bits that the shard's slot index is taken
+        // from, while selecting the shard by the upper bits of the product.
+        auto const bits = static_cast<uint32_t>(_mm_cvtsi128_si32(hash.value));
+        return static_cast<uint32_t>((uint64_t(bits * 0x9E3779B9u) * _shards.size()) >> 32);
+    }
+
+    [[nodiscard]] LockedShard& shardOf(StrongHash const& hash) noexcept
+    {
+        return *_shards[shardIndex(hash)];
+    }
+
+    [[nodiscard]] LockedShard const& shardOf(StrongHash const& hash) const noexcept
+    {
+        return *_shards[shardIndex(hash)];
+    }
+
+    /// Wraps @p constructValue to pass an entry index that is unique across all shards.
+    template <typename ValueConstructFn>
+    auto globalEntryIndex(StrongHash const& hash, ValueConstructFn& constructValue)
+    {
+        auto const offset = shardIndex(hash) * _shardCapacity;
+        return [offset, &constructValue](uint32_t entryIndex) {
+            return constructValue(offset + entryIndex);
+        };
+    }
+
+    uint32_t _shardCapacity;
+    std::vector<std::unique_ptr<LockedShard>> _shards;
+};
+
+// {{{ implementation
+template <typename Value>
+ShardedStrongLRUHashtable<Value>::ShardedStrongLRUHashtable(ShardCount shardCount,
+                                                            StrongHashtableSize hashCount,
+                                                            LRUCapacity entryCount,
+                                                            std::string const& name):
+    _shardCapacity { std::max(2u, (entryCount.value + shardCount.value - 1) / shardCount.value) }
+{
+    Require(shardCount.value >= 1);
+
+    auto const shardHashCount = nextPowerOfTwo(std::max(1u, hashCount.value / shardCount.value));
+    _shards.reserve(shardCount.value);
+    for (uint32_t i = 0; i < shardCount.value; ++i)
+    {
+        auto shard = std::make_unique<LockedShard>();
+        shard->table = Shard::create(StrongHashtableSize { shardHashCount },
+                                     LRUCapacity { _shardCapacity },
+                                     fmt::format("{}[{}]", name, i));
+        _shards.emplace_back(std::move(shard));
+    }
+}
+
+template <typename Value>
+size_t ShardedStrongLRUHashtable<Value>::size() const
+{
+    auto total = size_t { 0 };
+    for (auto const& shard: _shards)
+    {
+        auto const _ = std::lock_guard { shard->lock };
+        total += shard->table->size();
+    }
+    return total;
+}
+
+template <typename Value>
+LRUHashtableStats ShardedStrongLRUHashtable<Value>::fetchAndClearStats()
+{
+    auto total = LRUHashtableStats {};
+    for (auto const& shard: _shards)
+    {
+        auto const _ = std::lock_guard { shard->lock };
+        auto const stats = shard->table->fetchAndClearStats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.recycles += stats.recycles;
+    }
+    return total;
+}
+
+template <typename Value>
+void ShardedStrongLRUHashtable<Value>::clear()
+{
+    for (auto const& shard: _shards)
+    {
+        auto const _ = std::lock_guard { shard->lock };
+        shard->table->clear();
+    }
+}
+
+template <typename Value>
+void ShardedStrongLRUHashtable<Value>::remove(StrongHash const& hash)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    shard.table->remove(hash);
+}
+
+template <typename Value>
+void ShardedStrongLRUHashtable<Value>::touch(StrongHash const& hash)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    shard.table->touch(hash);
+}
+
+template <typename Value>
+bool ShardedStrongLRUHashtable<Value>::contains(StrongHash const& hash) const
+{
+    auto const& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    return shard.table->contains(hash);
+}
+
+template <typename Value>
+std::optional<Value> ShardedStrongLRUHashtable<Value>::try_get(StrongHash const& hash)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    if (Value const* value = shard.table->try_get(hash))
+        return *value;
+    return std::nullopt;
+}
+
+template <typename Value>
+void ShardedStrongLRUHashtable<Value>::emplace(StrongHash const& hash, Value value)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    shard.table->emplace(hash, std::move(value));
+}
+
+template <typename Value>
+template <typename ValueConstructFn>
+bool ShardedStrongLRUHashtable<Value>::try_emplace(StrongHash const& hash, ValueConstructFn constructValue)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    return shard.table->try_emplace(hash, globalEntryIndex(hash, constructValue));
+}
+
+template <typename Value>
+template <typename ValueConstructFn>
+Value ShardedStrongLRUHashtable<Value>::get_or_emplace(StrongHash const& hash,
+                                                       ValueConstructFn constructValue)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    return shard.table->get_or_emplace(hash, globalEntryIndex(hash, constructValue));
+}
+
+template <typename Value>
+template <typename ValueConstructFn>
+std::optional<Value> ShardedStrongLRUHashtable<Value>::get_or_try_emplace(StrongHash const& hash,
+                                                                          ValueConstructFn constructValue)
+{
+    auto& shard = shardOf(hash);
+    auto const _ = std::lock_guard { shard.lock };
+    if (Value const* value = shard.table->get_or_try_emplace(hash, globalEntryIndex(hash, constructValue)))
+        return *value;
+    return std::nullopt;
+}
+// }}}
+
+} // namespace crispy
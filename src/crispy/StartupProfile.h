@@ -0,0 +1,145 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace crispy
+{
+
+/**
+ * Records the named phases of the application's startup, relative to the process start.
+ *
+ * Phases may run concurrently on different threads. Nothing is recorded unless the
+ * profile has been enabled, so that the instrumentation can stay in place.
+ */
+class StartupProfile
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase
+    {
+        std::string name;
+        Clock::time_point start;
+        Clock::time_point end; // same as start for marks
+    };
+
+    /// Records the phase from its construction until its destruction.
+    class Scope
+    {
+      public:
+        Scope(StartupProfile& _profile, std::string _name):
+            profile_ { _profile }, name_ { std::move(_name) }, start_ { Clock::now() }
+        {
+        }
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+        ~Scope() { profile_.record(std::move(name_), start_, Clock::now()); }
+
+      private:
+        StartupProfile& profile_;
+        std::string name_;
+        Clock::time_point start_;
+    };
+
+    explicit StartupProfile(Clock::time_point _origin = Clock::now()): origin_ { _origin } {}
+
+    /// Returns the process-wide startup profile.
+    static StartupProfile& get() noexcept;
+
+    void enable() noexcept { enabled_.store(true, std::memory_order_relaxed); }
+    [[nodiscard]] bool enabled() const noexcept { return enabled_.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] Scope phase(std::string _name) { return Scope(*this, std::move(_name)); }
+
+    /// Records a point in time, such as an event that has been waited for.
+    void mark(std::string _name)
+    {
+        auto const now = Clock::now();
+        record(std::move(_name), now, now);
+    }
+
+    void record(std::string _name, Clock::time_point _start, Clock::time_point _end)
+    {
+        if (!enabled())
+            return;
+        auto const _ = std::lock_guard { lock_ };
+        phases_.emplace_back(Phase { std::move(_name), _start, _end });
+    }
+
+    [[nodiscard]] bool contains(std::string const& _name) const
+    {
+        auto const _ = std::lock_guard { lock_ };
+        return std::any_of(
+            phases_.begin(), phases_.end(), [&](Phase const& _phase) { return _phase.name == _name; });
+    }
+
+    /// Returns all recorded phases, ordered by their start time.
+    [[nodiscard]] std::vector<Phase> phases() const
+    {
+        auto result = [this]() {
+            auto const _ = std::lock_guard { lock_ };
+            return phases_;
+        }();
+        std::stable_sort(result.begin(), result.end(), [](Phase const& a, Phase const& b) {
+            return a.start < b.start;
+        });
+        return result;
+    }
+
+    /// Formats the recorded phases as a table, in milliseconds since the process start.
+    [[nodiscard]] std::string report() const
+    {
+        auto const millis = [](Clock::duration _duration) {
+            return std::chrono::duration<double, std::milli>(_duration).count();
+        };
+
+        auto output = fmt::format("{:>9} {:>9} {:>9}  {}\n", "start", "end", "duration", "phase");
+        for (Phase const& phase: phases())
+            output += fmt::format("{:9.2f} {:9.2f} {:9.2f}  {}\n",
+                                  millis(phase.start - origin_),
+                                  millis(phase.end - origin_),
+                                  millis(phase.end - phase.start),
+                                  phase.name);
+        return output;
+    }
+
+  private:
+    Clock::time_point origin_;
+    std::atomic<bool> enabled_ = false;
+    mutable std::mutex lock_;
+    std::vector<Phase> phases_;
+};
+
+namespace detail
+{
+    // Initialized during static initialization, which is as close to the process start as we get.
+    inline StartupProfile startupProfile {};
+} // namespace detail
+
+inline StartupProfile& StartupProfile::get() noexcept
+{
+    return detail::startupProfile;
+}
+
+} // namespace crispy
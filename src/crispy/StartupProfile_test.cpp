@@ -0,0 +1,58 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <crispy/StartupProfile.h>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+using crispy::StartupProfile;
+
+TEST_CASE("StartupProfile.disabled", "[startup]")
+{
+    auto profile = StartupProfile();
+    {
+        auto const _ = profile.phase("config");
+    }
+    profile.mark("ready");
+    CHECK(profile.phases().empty());
+    CHECK(!profile.contains("ready"));
+}
+
+TEST_CASE("StartupProfile.phases", "[startup]")
+{
+    auto profile = StartupProfile();
+    profile.enable();
+
+    {
+        auto const _ = profile.phase("main");
+        auto worker = std::thread([&]() { auto const _ = profile.phase("worker"); });
+        worker.join();
+    }
+    profile.mark("ready");
+
+    auto const phases = profile.phases();
+    REQUIRE(phases.size() == 3);
+    CHECK(phases[0].name == "main");
+    CHECK(phases[1].name == "worker");
+    CHECK(phases[2].name == "ready");
+    CHECK(phases[0].start <= phases[1].start);
+    CHECK(phases[1].end <= phases[0].end);
+    CHECK(phases[2].start == phases[2].end);
+    CHECK(profile.contains("worker"));
+
+    auto const report = profile.report();
+    CHECK(report.find("worker") != std::string::npos);
+    CHECK(std::count(report.begin(), report.end(), '\n') == 4);
+}
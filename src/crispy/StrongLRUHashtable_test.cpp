@@ -11,13 +11,18 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <crispy/ShardedStrongLRUHashtable.h>
 #include <crispy/StrongLRUHashtable.h>
 #include <crispy/utils.h>
 
 #include <catch2/catch.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <string_view>
+#include <thread>
 
 using namespace crispy;
 using namespace std;
@@ -422,3 +427,116 @@ TEST_CASE("StrongLRUHashtable.peek", "")
         REQUIRE(joinHumanReadable(cache.hashes()) == sh(4, 3, 2, 1));
     }
 }
+
+TEST_CASE("ShardedStrongLRUHashtable.basic", "[lrucache]")
+{
+    auto cache = ShardedStrongLRUHashtable<int>(ShardCount { 4 }, StrongHashtableSize { 32 }, LRUCapacity { 16 });
+    CHECK(cache.shardCount() == 4);
+    CHECK(cache.capacity() == 16);
+
+    CHECK_FALSE(cache.try_get(h(1)).has_value());
+    CHECK(cache.get_or_emplace(h(1), [](uint32_t) { return 2; }) == 2);
+    CHECK(cache.get_or_emplace(h(1), [](uint32_t) { return -1; }) == 2);
+    CHECK(cache.try_get(h(1)) == 2);
+    CHECK_FALSE(cache.try_emplace(h(1), [](uint32_t) { return -1; }));
+    CHECK(cache.try_emplace(h(2), [](uint32_t) { return 4; }));
+    CHECK_FALSE(cache.get_or_try_emplace(h(3), [](uint32_t) { return std::optional<int> {}; }).has_value());
+    CHECK_FALSE(cache.contains(h(3)));
+    CHECK(cache.size() == 2);
+
+    cache.emplace(h(2), 5);
+    CHECK(cache.try_get(h(2)) == 5);
+
+    cache.remove(h(1));
+    CHECK_FALSE(cache.contains(h(1)));
+    CHECK(cache.size() == 1);
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+}
+
+TEST_CASE("ShardedStrongLRUHashtable.entryIndex", "[lrucache]")
+{
+    // Entry indices passed to value constructors are unique across all shards.
+    auto cache = ShardedStrongLRUHashtable<uint32_t>(ShardCount { 4 }, StrongHashtableSize { 64 }, LRUCapacity { 64 });
+    auto indices = std::set<uint32_t> {};
+    for (int i = 0; i < 32; ++i)
+        (void) cache.get_or_emplace(StrongHash::compute(i), [&](uint32_t entryIndex) {
+            indices.insert(entryIndex);
+            return entryIndex;
+        });
+    CHECK(indices.size() == 32);
+    CHECK(*indices.begin() >= 1);
+    CHECK(*indices.rbegin() <= cache.capacity());
+}
+
+TEST_CASE("ShardedStrongLRUHashtable.threads", "[lrucache]")
+{
+    auto constexpr ThreadCount = 4;
+    auto constexpr KeyCount = 2000;
+
+    // Half of the keys fit, so that lookups, insertions and evictions race against each other.
+    auto cache = ShardedStrongLRUHashtable<int>(
+        ShardCount { 8 }, StrongHashtableSize { KeyCount }, LRUCapacity { KeyCount / 2 });
+
+    auto threads = std::vector<std::thread> {};
+    auto mismatches = std::atomic<int> { 0 };
+    for (int t = 0; t < ThreadCount; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 20 * KeyCount; ++i)
+            {
+                auto const key = (i * 7919 + t * 104729) % KeyCount;
+                auto const value = cache.get_or_emplace(StrongHash::compute(key), [&](uint32_t) { return key; });
+                if (value != key)
+                    ++mismatches;
+            }
+        });
+    for (auto& thread: threads)
+        thread.join();
+
+    CHECK(mismatches.load() == 0);
+    CHECK(cache.size() <= cache.capacity());
+    auto const stats = cache.fetchAndClearStats();
+    CHECK(stats.hits + stats.misses == ThreadCount * 20 * KeyCount);
+}
+
+TEST_CASE("ShardedStrongLRUHashtable.benchmark", "[.benchmark]")
+{
+    auto constexpr ThreadCount = 4;
+    auto constexpr KeyCount = 4096;
+    auto constexpr LookupCount = 20'000;
+
+    auto keys = std::vector<StrongHash> {};
+    for (int i = 0; i < KeyCount; ++i)
+        keys.emplace_back(StrongHash::compute(i));
+
+    auto const runThreads = [&](auto lookup) {
+        auto threads = std::vector<std::thread> {};
+        for (int t = 0; t < ThreadCount; ++t)
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < LookupCount; ++i)
+                    lookup(keys[static_cast<size_t>((i * 7919 + t * 104729) % KeyCount)]);
+            });
+        for (auto& thread: threads)
+            thread.join();
+    };
+
+    BENCHMARK("StrongLRUHashtable with a global lock")
+    {
+        auto cachePtr = StrongLRUHashtable<int>::create(StrongHashtableSize { KeyCount }, LRUCapacity { KeyCount });
+        auto lock = std::mutex {};
+        runThreads([&](StrongHash const& hash) {
+            auto const _ = std::lock_guard { lock };
+            return cachePtr->get_or_emplace(hash, [](uint32_t index) { return static_cast<int>(index); });
+        });
+    };
+
+    BENCHMARK("ShardedStrongLRUHashtable")
+    {
+        auto cache = ShardedStrongLRUHashtable<int>(
+            ShardCount { 16 }, StrongHashtableSize { KeyCount }, LRUCapacity { KeyCount });
+        runThreads([&](StrongHash const& hash) {
+            return cache.get_or_emplace(hash, [](uint32_t index) { return static_cast<int>(index); });
+        });
+    };
+}
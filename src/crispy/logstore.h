@@ -19,12 +19,18 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <iterator>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 // NB: Don't do that now. It seems to only cause problems, such as
@@ -44,6 +50,18 @@ namespace logstore
 class Category;
 class Sink;
 
+namespace detail
+{
+    /// Maximum number of categories that can be registered at the same time.
+    constexpr size_t MaxCategories = 256;
+
+    /// One bit per category ID, set if the category is enabled.
+    ///
+    /// Checking whether or not a category is enabled is a single relaxed load,
+    /// which keeps disabled categories cheap even on hot paths.
+    inline std::array<std::atomic<uint64_t>, MaxCategories / 64> enabledCategories {};
+} // namespace detail
+
 class SourceLocation
 {
   public:
@@ -80,38 +98,54 @@ class MessageBuilder
   private:
     Category const& _category;
     source_location _location;
+    std::chrono::system_clock::time_point _timestamp;
     std::string _buffer;
+    bool _dispatch = true;
 
   public:
     explicit MessageBuilder(Category const& cat, source_location loc = source_location::current());
 
+    /// Reconstructs an already dispatched message, e.g. from within an asynchronous sink.
+    /// It is not written to the category's sink again on destruction.
+    MessageBuilder(Category const& cat,
+                   source_location loc,
+                   std::chrono::system_clock::time_point timestamp,
+                   std::string text);
+
     [[nodiscard]] Category const& category() const noexcept { return _category; }
     [[nodiscard]] source_location const& location() const noexcept { return _location; }
+    [[nodiscard]] std::chrono::system_clock::time_point timestamp() const noexcept { return _timestamp; }
 
     [[nodiscard]] std::string const& text() const noexcept { return _buffer; }
 
+    // Text appended to a message that is not going to be written is discarded right away.
+
     MessageBuilder& append(std::string_view msg)
     {
-        _buffer += msg;
+        if (_dispatch)
+            _buffer += msg;
         return *this;
     }
 
     template <typename... T>
     MessageBuilder& append(fmt::format_string<T...> fmt, T&&... args)
     {
-        _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
+        if (_dispatch)
+            _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
         return *this;
     }
 
     MessageBuilder& operator()(std::string const& msg)
     {
-        _buffer += msg;
+        if (_dispatch)
+            _buffer += msg;
         return *this;
     }
     template <typename... T>
     MessageBuilder& operator()(fmt::format_string<T...> fmt, T&&... args)
     {
-        _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
+        if (_dispatch)
+            _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
         return *this;
     }
 
@@ -139,22 +173,70 @@ class Category
         Hidden
     };
 
+    /// Limits the number of messages of an enabled category, such that enabling
+    /// a noisy category does not dominate the performance of the logging code.
+    ///
+    /// Throttling is applied once per message when it is built, i.e. `category()(...)`, so that
+    /// additionally testing the category via `if (category) ...` does not count it twice.
+    /// The text of a throttled message is neither formatted nor written.
+    struct Throttle
+    {
+        unsigned sampling = 0;  ///< if greater than one, only every n-th message is logged
+        unsigned rateLimit = 0; ///< if non-zero, at most this many messages are logged per second
+
+        [[nodiscard]] bool active() const noexcept { return sampling > 1 || rateLimit != 0; }
+    };
+
     Category(std::string_view name,
              std::string_view desc,
              State state = State::Disabled,
              Visibility visibility = Visibility::Public) noexcept;
     ~Category();
 
+    Category(Category const&) = delete;
+    Category(Category&&) = delete;
+    Category& operator=(Category const&) = delete;
+    Category& operator=(Category&&) = delete;
+
     [[nodiscard]] std::string_view name() const noexcept { return _name; }
     [[nodiscard]] std::string_view description() const noexcept { return _description; }
 
-    [[nodiscard]] bool is_enabled() const noexcept { return _state == State::Enabled; }
-    void enable(bool enabled = true) noexcept { _state = enabled ? State::Enabled : State::Disabled; }
-    void disable() noexcept { _state = State::Disabled; }
+    /// Dense ID of this category, unique amongst all currently registered categories.
+    [[nodiscard]] size_t id() const noexcept { return _id; }
+
+    [[nodiscard]] bool is_enabled() const noexcept
+    {
+        return detail::enabledCategories[_id / 64].load(std::memory_order_relaxed) & (uint64_t { 1 } << (_id % 64));
+    }
+
+    void enable(bool enabled = true) noexcept
+    {
+        if (enabled)
+            detail::enabledCategories[_id / 64].fetch_or(uint64_t { 1 } << (_id % 64));
+        else
+            detail::enabledCategories[_id / 64].fetch_and(~(uint64_t { 1 } << (_id % 64)));
+    }
+    void disable() noexcept { enable(false); }
 
     [[nodiscard]] bool visible() const noexcept { return _visibility == Visibility::Public; }
     void set_visible(bool visible) { _visibility = visible ? Visibility::Public : Visibility::Hidden; }
 
+    [[nodiscard]] Throttle throttle() const noexcept
+    {
+        return Throttle { _sampling.load(std::memory_order_relaxed),
+                          _rateLimit.load(std::memory_order_relaxed) };
+    }
+
+    /// Changes the throttling of this category. Safe to call while other threads are logging.
+    void set_throttle(Throttle throttle) noexcept
+    {
+        _sampling.store(throttle.sampling, std::memory_order_relaxed);
+        _rateLimit.store(throttle.rateLimit, std::memory_order_relaxed);
+    }
+
+    /// Number of messages that have not been logged due to throttling.
+    [[nodiscard]] uint64_t suppressed() const noexcept { return _suppressed.load(); }
+
     operator bool() const noexcept { return is_enabled(); }
 
     [[nodiscard]] Formatter const& formatter() const { return _formatter; }
@@ -176,12 +258,24 @@ class Category
     static std::string default_formatter(MessageBuilder const& _message);
 
   private:
+    friend class MessageBuilder;
+
+    /// Decides whether or not the next message passes the throttle, counting it either way.
+    [[nodiscard]] bool admit() const noexcept;
+
     std::string_view _name;
     std::string_view _description;
-    State _state;
+    size_t _id;
     Visibility _visibility;
     Formatter _formatter;
     std::reference_wrapper<logstore::Sink> _sink;
+
+    std::atomic<unsigned> _sampling = 0;
+    std::atomic<unsigned> _rateLimit = 0;
+    mutable std::atomic<uint64_t> _messageCount = 0;
+    mutable std::atomic<int64_t> _rateWindow = 0;
+    mutable std::atomic<unsigned> _rateWindowCount = 0;
+    mutable std::atomic<uint64_t> _suppressed = 0;
 };
 
 /// Logging Sink API.
@@ -193,6 +287,7 @@ class Sink
     using Writer = std::function<void(std::string_view const&)>;
 
     Sink(bool _enabled, Writer _writer): enabled_ { _enabled }, writer_ { std::move(_writer) } {}
+    virtual ~Sink() = default;
 
     Sink(bool _enabled, std::ostream& _output):
         Sink(_enabled, [out = &_output](std::string_view text) {
@@ -205,8 +300,9 @@ class Sink
     void set_writer(Writer _writer);
 
     /// Writes given built message to this sink.
-    void write(MessageBuilder const& _message);
+    virtual void write(MessageBuilder const& _message);
 
+    [[nodiscard]] bool is_enabled() const noexcept { return enabled_; }
     void set_enabled(bool enabled) { enabled_ = enabled; }
 
     /// Retrieves reference to standard debug-logging sink.
@@ -222,6 +318,9 @@ class Sink
         return instance;
     }
 
+  protected:
+    [[nodiscard]] Writer const& writer() const noexcept { return writer_; }
+
   private:
     bool enabled_;
     Writer writer_;
@@ -233,6 +332,13 @@ void set_sink(Sink& _sink);
 void set_formatter(Category::Formatter const& f);
 void enable(std::string_view categoryName, bool enabled = true);
 void disable(std::string_view categoryName);
+
+/// Enables exactly the categories matching the given comma separated list of filters
+/// and disables all others.
+///
+/// A filter is either a category name, a prefix followed by a '*', or "all".
+/// It may be followed by either ":1/N" to only log every N-th message, or
+/// ":N/s" to log at most N messages per second, e.g. "vt.trace.*:100/s".
 void configure(std::string_view filterString);
 
 // {{{ implementation
@@ -248,17 +354,71 @@ inline std::string MessageBuilder::message() const
         return "";
 }
 
+namespace detail
+{
+    struct Registry
+    {
+        std::vector<std::reference_wrapper<Category>> categories;
+        std::unordered_map<std::string_view, Category*> byName;
+        std::bitset<MaxCategories> usedIds;
+    };
+
+    inline Registry& registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+    struct Filter
+    {
+        std::string_view pattern;
+        Category::Throttle throttle;
+    };
+
+    inline unsigned parseUnsigned(std::string_view text) noexcept
+    {
+        auto result = unsigned { 0 };
+        for (char const ch: text)
+        {
+            if (ch < '0' || ch > '9')
+                return 0;
+            result = result * 10 + static_cast<unsigned>(ch - '0');
+        }
+        return result;
+    }
+
+    inline Filter parseFilter(std::string_view text) noexcept
+    {
+        auto const colon = text.find(':');
+        if (colon == text.npos)
+            return Filter { text, {} };
+
+        auto filter = Filter { text.substr(0, colon), {} };
+        auto const spec = text.substr(colon + 1);
+        auto const slash = spec.find('/');
+        if (slash == spec.npos)
+            return filter;
+
+        auto const numerator = spec.substr(0, slash);
+        auto const denominator = spec.substr(slash + 1);
+        if (denominator == "s")
+            filter.throttle.rateLimit = parseUnsigned(numerator);
+        else if (numerator == "1")
+            filter.throttle.sampling = parseUnsigned(denominator);
+        return filter;
+    }
+} // namespace detail
+
 inline std::vector<std::reference_wrapper<Category>>& get()
 {
-    static std::vector<std::reference_wrapper<Category>> logStore;
-    return logStore;
+    return detail::registry().categories;
 }
 
 inline Category* get(std::string_view categoryName)
 {
-    for (auto const& cat: get())
-        if (cat.get().name() == categoryName)
-            return &cat.get();
+    auto const& byName = detail::registry().byName;
+    if (auto const i = byName.find(categoryName); i != byName.end())
+        return i->second;
     return nullptr;
 }
 
@@ -276,9 +436,8 @@ inline void set_formatter(Category::Formatter const& f)
 
 inline void enable(std::string_view categoryName, bool enabled)
 {
-    for (auto const& cat: get())
-        if (cat.get().name() == categoryName)
-            cat.get().enable(enabled);
+    if (auto* category = get(categoryName))
+        category->enable(enabled);
 }
 
 inline void disable(std::string_view categoryName)
@@ -288,36 +447,73 @@ inline void disable(std::string_view categoryName)
 
 inline void configure(std::string_view filterString)
 {
-    if (filterString == "all")
+    auto prefixFilters = std::vector<detail::Filter> {};
+    auto nameFilters = std::vector<detail::Filter> {};
+    for (auto const text: crispy::split(filterString, ','))
     {
-        for (auto& category: logstore::get())
-            category.get().enable();
+        if (text.empty())
+            continue;
+        auto const filter = detail::parseFilter(text);
+        if (filter.pattern == "all")
+            prefixFilters.emplace_back(detail::Filter { "*", filter.throttle });
+        else if (!filter.pattern.empty() && filter.pattern.back() == '*')
+            prefixFilters.emplace_back(filter);
+        else
+            nameFilters.emplace_back(filter);
     }
-    else
+
+    auto enabled = std::array<uint64_t, detail::MaxCategories / 64> {};
+    auto const apply = [&](Category& category, Category::Throttle throttle) {
+        enabled[category.id() / 64] |= uint64_t { 1 } << (category.id() % 64);
+        category.set_throttle(throttle);
+    };
+
+    // TODO: '*' excludes hidden categories
+    for (Category& category: get())
     {
-        auto const filters = crispy::split(filterString, ',');
-        for (auto& category: logstore::get())
+        category.set_throttle({});
+        for (auto const& filter: prefixFilters)
         {
-            category.get().enable(crispy::any_of(filters, [&](std::string_view filterPattern) -> bool {
-                if (filterPattern.back() != '*')
-                    return category.get().name() == filterPattern;
-                // TODO: '*' excludes hidden categories
-                return std::equal(std::begin(filterPattern),
-                                  std::prev(end(filterPattern)),
-                                  std::begin(category.get().name()));
-            }));
+            auto const prefix = filter.pattern.substr(0, filter.pattern.size() - 1);
+            if (category.name().substr(0, prefix.size()) == prefix)
+                apply(category, filter.throttle);
         }
     }
+
+    // Explicitly named categories take precedence over the throttling of prefix matches.
+    for (auto const& filter: nameFilters)
+        if (auto* category = get(filter.pattern))
+            apply(*category, filter.throttle);
+
+    for (size_t i = 0; i < enabled.size(); ++i)
+        detail::enabledCategories[i].store(enabled[i]);
 }
 
 inline MessageBuilder::MessageBuilder(logstore::Category const& cat, source_location location):
-    _category { cat }, _location { location }
+    _category { cat }, _location { location }, _dispatch { cat.is_enabled() && cat.admit() }
+{
+    // Messages of disabled or throttled categories are never written, so don't pay for reading
+    // the clock either.
+    if (_dispatch)
+        _timestamp = std::chrono::system_clock::now();
+}
+
+inline MessageBuilder::MessageBuilder(Category const& cat,
+                                      source_location location,
+                                      std::chrono::system_clock::time_point timestamp,
+                                      std::string text):
+    _category { cat },
+    _location { location },
+    _timestamp { timestamp },
+    _buffer { std::move(text) },
+    _dispatch { false }
 {
 }
 
 inline MessageBuilder::~MessageBuilder()
 {
-    _category.sink().write(*this);
+    if (_dispatch)
+        _category.sink().write(*this);
 }
 
 inline Category::Category(std::string_view name,
@@ -326,26 +522,72 @@ inline Category::Category(std::string_view name,
                           Visibility visibility) noexcept:
     _name { name },
     _description { desc },
-    _state { state },
+    _id { 0 },
     _visibility { visibility },
     _sink { logstore::Sink::console() }
 {
-    assert(std::none_of(get().begin(), get().end(), [&](Category const& x) { return x.name() == _name; }));
-    get().emplace_back(*this);
+    auto& registry = detail::registry();
+    assert(registry.byName.count(_name) == 0);
+
+    while (_id < detail::MaxCategories && registry.usedIds.test(_id))
+        ++_id;
+    assert(_id < detail::MaxCategories);
+
+    registry.usedIds.set(_id);
+    registry.categories.emplace_back(*this);
+    registry.byName[_name] = this;
+    enable(state == State::Enabled);
 }
 
 inline Category::~Category()
 {
-    for (auto i = get().begin(), e = get().end(); i != e; ++i)
+    disable();
+
+    auto& registry = detail::registry();
+    registry.usedIds.reset(_id);
+    registry.byName.erase(_name);
+    for (auto i = registry.categories.begin(), e = registry.categories.end(); i != e; ++i)
     {
         if (&i->get() == this)
         {
-            get().erase(i);
+            registry.categories.erase(i);
             break;
         }
     }
 }
 
+inline bool Category::admit() const noexcept
+{
+    auto const sampling = _sampling.load(std::memory_order_relaxed);
+    auto const rateLimit = _rateLimit.load(std::memory_order_relaxed);
+
+    if (sampling > 1 && _messageCount.fetch_add(1, std::memory_order_relaxed) % sampling != 0)
+    {
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (rateLimit)
+    {
+        // Approximate, as concurrent threads may race on the start of a new window.
+        auto const now = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count();
+        if (_rateWindow.load(std::memory_order_relaxed) != now)
+        {
+            _rateWindow.store(now, std::memory_order_relaxed);
+            _rateWindowCount.store(0, std::memory_order_relaxed);
+        }
+        if (_rateWindowCount.fetch_add(1, std::memory_order_relaxed) >= rateLimit)
+        {
+            _suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 inline std::string Category::default_formatter(MessageBuilder const& _message)
 {
     return fmt::format("[{}:{}:{}]: {}\n",
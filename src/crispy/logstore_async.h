@@ -0,0 +1,345 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <crispy/logstore.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace logstore
+{
+
+/**
+ * Logging sink that moves formatting and writing off the logging threads.
+ *
+ * Every thread writing to this sink gets its own fixed size, lock-free
+ * single-producer/single-consumer ring buffer of compact binary records,
+ * holding the category, source location, timestamp and message text.
+ * A background thread drains all ring buffers in batches, applies the
+ * category formatters, and hands each batch to the writer in a single call.
+ *
+ * A logging thread never blocks on this sink. If its ring buffer is full,
+ * the message is dropped and counted instead, and the number of dropped
+ * messages is reported in the output as well as via stats().
+ *
+ * Categories writing to this sink must outlive it, and must not write to it anymore once
+ * it is destroyed. Destroying the sink writes all pending messages and joins its thread.
+ */
+class AsyncSink final: public Sink
+{
+  public:
+    /// Number of message bytes stored within a record. Longer messages are moved to the heap.
+    static constexpr size_t InlineTextSize = 200;
+
+    /// Default number of records per thread.
+    static constexpr size_t DefaultCapacity = 8192;
+
+    static constexpr auto DefaultDrainInterval = std::chrono::milliseconds(20);
+
+    struct Stats
+    {
+        uint64_t written = 0; ///< number of messages handed to the writer
+        uint64_t dropped = 0; ///< number of messages dropped due to full ring buffers
+        uint64_t batches = 0; ///< number of writer invocations
+    };
+
+    AsyncSink(bool _enabled,
+              Writer _writer,
+              size_t _capacityPerThread = DefaultCapacity,
+              std::chrono::milliseconds _drainInterval = DefaultDrainInterval):
+        Sink(_enabled, std::move(_writer)),
+        capacity_ { roundUpToPowerOfTwo(_capacityPerThread) },
+        drainInterval_ { _drainInterval }
+    {
+        start();
+    }
+
+    AsyncSink(bool _enabled, std::ostream& _output, size_t _capacityPerThread = DefaultCapacity):
+        Sink(_enabled, _output), capacity_ { roundUpToPowerOfTwo(_capacityPerThread) }
+    {
+        start();
+    }
+
+    AsyncSink(AsyncSink const&) = delete;
+    AsyncSink(AsyncSink&&) = delete;
+    AsyncSink& operator=(AsyncSink const&) = delete;
+    AsyncSink& operator=(AsyncSink&&) = delete;
+    ~AsyncSink() override;
+
+    void write(MessageBuilder const& _message) override;
+
+    /// Blocks until all messages written so far have been handed to the writer.
+    void flush() { drain(); }
+
+    [[nodiscard]] Stats stats() const noexcept
+    {
+        return Stats { written_.load(), dropped_.load(), batches_.load() };
+    }
+
+  private:
+    struct Record
+    {
+        Category const* category = nullptr;
+        char const* fileName = nullptr;
+        char const* functionName = nullptr;
+        int line = 0;
+        uint32_t length = 0;
+        std::chrono::system_clock::time_point timestamp;
+        std::unique_ptr<std::string> longText; // only set if length exceeds InlineTextSize
+        std::array<char, InlineTextSize> text;
+    };
+
+    class RingBuffer
+    {
+      public:
+        explicit RingBuffer(size_t _capacity): records_(_capacity), mask_ { _capacity - 1 } {}
+
+        /// @returns the record to be filled or nullptr if the buffer is full.
+        Record* beginPush() noexcept
+        {
+            auto const head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == records_.size())
+                return nullptr;
+            return &records_[head & mask_];
+        }
+
+        /// Publishes the record returned by beginPush() and returns the new fill level.
+        size_t endPush() noexcept
+        {
+            auto const head = head_.load(std::memory_order_relaxed) + 1;
+            head_.store(head, std::memory_order_release);
+            return head - tail_.load(std::memory_order_relaxed);
+        }
+
+        template <typename F>
+        void consume(F&& _f)
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            auto const head = head_.load(std::memory_order_acquire);
+            for (; tail != head; ++tail)
+                _f(records_[tail & mask_]);
+            tail_.store(tail, std::memory_order_release);
+        }
+
+        std::atomic<uint64_t> dropped = 0;
+
+        /// Set once the owning sink has been destroyed, so that threads can forget about this buffer.
+        std::atomic<bool> closed = false;
+
+      private:
+        std::vector<Record> records_;
+        size_t mask_;
+        alignas(64) std::atomic<size_t> head_ = 0;
+        alignas(64) std::atomic<size_t> tail_ = 0;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t _value) noexcept
+    {
+        auto result = size_t { 2 };
+        while (result < _value)
+            result <<= 1;
+        return result;
+    }
+
+    void start()
+    {
+        static std::atomic<uint64_t> nextId = 1;
+        id_ = nextId++;
+        drainer_ = std::thread([this]() { drainLoop(); });
+    }
+
+    RingBuffer& threadBuffer();
+    void drainLoop();
+    void drain();
+
+    uint64_t id_ = 0;
+    size_t capacity_;
+    std::chrono::milliseconds drainInterval_ = DefaultDrainInterval;
+
+    std::mutex buffersLock_;
+    std::vector<std::shared_ptr<RingBuffer>> buffers_;
+
+    std::mutex drainLock_; // serializes drain() invocations
+    std::mutex wakeupLock_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+    std::thread drainer_;
+
+    std::atomic<uint64_t> written_ = 0;
+    std::atomic<uint64_t> dropped_ = 0;
+    std::atomic<uint64_t> batches_ = 0;
+};
+
+// {{{ implementation
+inline AsyncSink::~AsyncSink()
+{
+    {
+        auto const _ = std::lock_guard { wakeupLock_ };
+        stopping_ = true;
+    }
+    wakeup_.notify_one();
+    drainer_.join();
+    drain();
+
+    auto const _ = std::lock_guard { buffersLock_ };
+    for (auto& buffer: buffers_)
+        buffer->closed.store(true, std::memory_order_release);
+}
+
+inline AsyncSink::RingBuffer& AsyncSink::threadBuffer()
+{
+    struct Entry
+    {
+        uint64_t sinkId;
+        std::shared_ptr<RingBuffer> buffer;
+    };
+    static thread_local std::vector<Entry> threadBuffers;
+
+    for (Entry const& entry: threadBuffers)
+        if (entry.sinkId == id_)
+            return *entry.buffer;
+
+    // Forget about the buffers of sinks that have been destroyed in the meantime.
+    threadBuffers.erase(std::remove_if(threadBuffers.begin(),
+                                       threadBuffers.end(),
+                                       [](Entry const& entry) {
+                                           return entry.buffer->closed.load(std::memory_order_acquire);
+                                       }),
+                        threadBuffers.end());
+
+    auto buffer = std::make_shared<RingBuffer>(capacity_);
+    {
+        auto const _ = std::lock_guard { buffersLock_ };
+        buffers_.emplace_back(buffer);
+    }
+    threadBuffers.emplace_back(Entry { id_, buffer });
+    return *buffer;
+}
+
+inline void AsyncSink::write(MessageBuilder const& _message)
+{
+    if (!is_enabled() || !_message.category().is_enabled())
+        return;
+
+    auto& buffer = threadBuffer();
+    auto* record = buffer.beginPush();
+    if (!record)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto const& text = _message.text();
+    record->category = &_message.category();
+    record->fileName = _message.location().file_name();
+    record->functionName = _message.location().function_name();
+    record->line = _message.location().line();
+    record->timestamp = _message.timestamp();
+    record->length = static_cast<uint32_t>(text.size());
+    if (text.size() <= InlineTextSize)
+        std::memcpy(record->text.data(), text.data(), text.size());
+    else
+        record->longText = std::make_unique<std::string>(text);
+
+    // Wake up the drainer early rather than waiting for the ring buffer to overflow.
+    if (buffer.endPush() == capacity_ / 2)
+        wakeup_.notify_one();
+}
+
+inline void AsyncSink::drainLoop()
+{
+    auto lock = std::unique_lock { wakeupLock_ };
+    while (!stopping_)
+    {
+        wakeup_.wait_for(lock, drainInterval_);
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+inline void AsyncSink::drain()
+{
+    auto const drainGuard = std::lock_guard { drainLock_ };
+
+    struct Entry
+    {
+        std::chrono::system_clock::time_point timestamp;
+        std::string text;
+    };
+    auto entries = std::vector<Entry> {};
+    auto dropped = uint64_t { 0 };
+
+    {
+        auto const _ = std::lock_guard { buffersLock_ };
+        for (auto& buffer: buffers_)
+        {
+            // A buffer whose thread has exited is only forgotten after it has been drained once more,
+            // as the thread may have pushed records right before exiting.
+            auto const orphaned = buffer.use_count() == 1;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            buffer->consume([&](Record& _record) {
+                auto text = _record.longText ? std::move(*_record.longText)
+                                             : std::string(_record.text.data(), _record.length);
+                _record.longText.reset();
+                auto const message =
+                    MessageBuilder(*_record.category,
+                                   source_location(_record.fileName, _record.line, _record.functionName),
+                                   _record.timestamp,
+                                   std::move(text));
+                entries.emplace_back(Entry { _record.timestamp, message.message() });
+            });
+            dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+            if (orphaned)
+                buffer.reset();
+        }
+
+        buffers_.erase(std::remove(buffers_.begin(), buffers_.end(), nullptr), buffers_.end());
+    }
+
+    if (entries.empty() && !dropped)
+        return;
+
+    // Each thread's records are in order already, but need to be interleaved with the others.
+    std::stable_sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) {
+        return a.timestamp < b.timestamp;
+    });
+
+    auto batch = std::string {};
+    for (Entry const& entry: entries)
+        batch += entry.text;
+    if (dropped)
+        batch += fmt::format("[logstore] {} messages dropped.\n", dropped);
+
+    writer()(batch);
+
+    written_ += entries.size();
+    dropped_ += dropped;
+    ++batches_;
+}
+// }}}
+
+} // namespace logstore
@@ -0,0 +1,236 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <crispy/logstore.h>
+#include <crispy/logstore_async.h>
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST_CASE("Category.id", "[logstore]")
+{
+    auto a = logstore::Category("test.id.a", "Category test");
+    auto bId = size_t { 0 };
+    {
+        auto b = logstore::Category("test.id.b", "Category test", logstore::Category::State::Enabled);
+        CHECK(b.id() != a.id());
+        CHECK(logstore::get("test.id.b") == &b);
+        bId = b.id();
+    }
+    CHECK(logstore::get("test.id.b") == nullptr);
+
+    // IDs are reused, keeping them dense.
+    auto c = logstore::Category("test.id.c", "Category test");
+    CHECK(c.id() == bId);
+    CHECK(!c.is_enabled());
+}
+
+TEST_CASE("Category.configure", "[logstore]")
+{
+    auto a = logstore::Category("test.configure.a", "Category test");
+    auto b = logstore::Category("test.configure.b", "Category test");
+    auto c = logstore::Category("test.configured", "Category test", logstore::Category::State::Enabled);
+    CHECK(c.is_enabled());
+
+    logstore::configure("test.configure.*,unknown");
+    CHECK(a.is_enabled());
+    CHECK(b.is_enabled());
+    CHECK(!c.is_enabled());
+
+    logstore::configure("test.configure.b:1/10,test.configure*:5/s");
+    CHECK(b.throttle().sampling == 10);
+    CHECK(b.throttle().rateLimit == 0);
+    CHECK(a.throttle().rateLimit == 5);
+    CHECK(c.throttle().rateLimit == 5);
+    CHECK(c.is_enabled());
+
+    logstore::configure("");
+    CHECK(!a.is_enabled());
+    CHECK(!b.is_enabled());
+    CHECK(!c.is_enabled());
+    CHECK(!b.throttle().active());
+
+    logstore::ErrorLog.enable();
+}
+
+TEST_CASE("Category.throttle", "[logstore]")
+{
+    auto category = logstore::Category("test.throttle", "Category test", logstore::Category::State::Enabled);
+    auto written = 0;
+    auto sink = logstore::Sink(true, [&](string_view) { ++written; });
+    category.set_sink(sink);
+
+    category.set_throttle(logstore::Category::Throttle { 4, 0 });
+    for (int i = 0; i < 100; ++i)
+        category()("message {}", i);
+    CHECK(written == 25);
+    CHECK(category.suppressed() == 75);
+
+    // Testing the category before building the message does not count the message twice.
+    written = 0;
+    for (int i = 0; i < 100; ++i)
+        if (category)
+            category()("message {}", i);
+    CHECK(written == 25);
+    CHECK(category.suppressed() == 150);
+
+    // Unless the test happens to run across a second boundary, the limit is hit exactly.
+    category.set_throttle(logstore::Category::Throttle { 0, 10 });
+    written = 0;
+    for (int i = 0; i < 100; ++i)
+        category()("message {}", i);
+    CHECK(10 <= written);
+    CHECK(written <= 20);
+
+    category.disable();
+    CHECK(!category);
+}
+
+TEST_CASE("AsyncSink.write", "[logstore]")
+{
+    auto category = logstore::Category("test.async.write", "AsyncSink test category");
+    category.enable();
+
+    auto output = string {};
+    auto sink = logstore::AsyncSink(true, [&](string_view _text) { output += _text; });
+    category.set_sink(sink);
+
+    category()("Hello, {}!", "World");
+    category()("{}", string(2 * logstore::AsyncSink::InlineTextSize, 'x'));
+    category.disable();
+    category()("not written");
+
+    sink.flush();
+    CHECK(output == "Hello, World!\n" + string(2 * logstore::AsyncSink::InlineTextSize, 'x') + '\n');
+    CHECK(sink.stats().written == 2);
+    CHECK(sink.stats().dropped == 0);
+}
+
+TEST_CASE("AsyncSink.formatter", "[logstore]")
+{
+    auto category = logstore::Category("test.async.formatter", "AsyncSink test category");
+    category.enable();
+    category.set_formatter(logstore::Category::default_formatter);
+
+    auto output = string {};
+    auto sink = logstore::AsyncSink(true, [&](string_view _text) { output += _text; });
+    category.set_sink(sink);
+
+    category(logstore::SourceLocation("file.cpp", 42, "f"))("formatted");
+
+    sink.flush();
+    CHECK(output == "[test.async.formatter:file.cpp:42]: formatted\n");
+}
+
+TEST_CASE("AsyncSink.threads", "[logstore]")
+{
+    auto category = logstore::Category("test.async.threads", "AsyncSink test category");
+    category.enable();
+
+    auto constexpr ThreadCount = 4;
+    auto constexpr MessageCount = 1000;
+
+    auto output = string {};
+    auto sink = logstore::AsyncSink(true, [&](string_view _text) { output += _text; }, 64);
+    category.set_sink(sink);
+
+    auto threads = vector<thread> {};
+    for (int i = 0; i < ThreadCount; ++i)
+        threads.emplace_back([&, i]() {
+            for (int k = 0; k < MessageCount; ++k)
+                category()("{} {}", i, k);
+        });
+    for (auto& t: threads)
+        t.join();
+    sink.flush();
+
+    // Messages are dropped rather than blocking the writer when its ring buffer runs full.
+    auto const stats = sink.stats();
+    CHECK(stats.written + stats.dropped == ThreadCount * MessageCount);
+    CHECK((stats.dropped == 0) == (output.find("messages dropped.") == string::npos));
+
+    // Each thread's messages must retain their order.
+    auto lastMessage = vector<int>(ThreadCount, -1);
+    auto written = size_t { 0 };
+    for (auto const line: crispy::split(output, '\n'))
+    {
+        int threadIndex = -1;
+        int messageIndex = -1;
+        if (sscanf(string(line).c_str(), "%d %d", &threadIndex, &messageIndex) != 2)
+            continue;
+        REQUIRE((0 <= threadIndex && threadIndex < ThreadCount));
+        CHECK(lastMessage[threadIndex] < messageIndex);
+        lastMessage[threadIndex] = messageIndex;
+        ++written;
+    }
+    CHECK(written == stats.written);
+}
+
+TEST_CASE("AsyncSink.exitedThreads", "[logstore]")
+{
+    auto category = logstore::Category("test.async.exited", "AsyncSink test category");
+    category.enable();
+
+    auto output = string {};
+    auto sink = logstore::AsyncSink(true, [&](string_view _text) { output += _text; }, 64, chrono::hours(1));
+    category.set_sink(sink);
+
+    // Records of exited threads are still written, also when the thread exits between two drains.
+    for (int i = 0; i < 3; ++i)
+    {
+        thread([&]() { category()("first"); }).join();
+        sink.flush();
+        thread([&]() { category()("second"); }).join();
+        sink.flush();
+    }
+    CHECK(sink.stats().written == 6);
+    CHECK(output == "first\nsecond\nfirst\nsecond\nfirst\nsecond\n");
+}
+
+TEST_CASE("AsyncSink.recreated", "[logstore]")
+{
+    auto category = logstore::Category("test.async.recreated", "AsyncSink test category");
+    category.enable();
+
+    // A thread writing to a sequence of sinks does not keep writing to the buffers of destroyed ones.
+    auto output = string {};
+    for (int i = 0; i < 3; ++i)
+    {
+        auto sink = logstore::AsyncSink(true, [&](string_view _text) { output += _text; });
+        category.set_sink(sink);
+        category()("{}", i);
+        sink.flush();
+        CHECK(sink.stats().written == 1);
+    }
+    CHECK(output == "0\n1\n2\n");
+}
+
+TEST_CASE("MessageBuilder.disabled", "[logstore]")
+{
+    auto category = logstore::Category("test.builder.disabled", "MessageBuilder test category");
+    auto sink = logstore::Sink(true, [](string_view) {});
+    category.set_sink(sink);
+
+    // The clock is only read for messages that are actually written.
+    CHECK(category().timestamp() == chrono::system_clock::time_point {});
+    category.enable();
+    CHECK(category().timestamp() != chrono::system_clock::time_point {});
+    category.disable();
+}
@@ -0,0 +1,207 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/CaptureBuffer.h>
+#include <terminal/Functions.h>
+#include <terminal/VTWriter.h>
+
+#include <crispy/base64.h>
+
+#include <unicode/convert.h>
+
+#include <algorithm>
+#include <iterator>
+
+using std::function;
+using std::string;
+using std::string_view;
+
+using namespace std::string_view_literals;
+
+namespace terminal
+{
+
+namespace
+{
+    /// Appends the line's text, with blank cells as spaces.
+    template <typename Cell>
+    void appendLineText(string& _output, Line<Cell> const& _line)
+    {
+        if (_line.isTrivialBuffer())
+        {
+            auto const& buffer = _line.trivialBuffer();
+            _output.append(buffer.text.data(), buffer.text.size());
+            if (buffer.text.size() < unbox<size_t>(buffer.displayWidth))
+                _output.append(unbox<size_t>(buffer.displayWidth) - buffer.text.size(), ' ');
+            return;
+        }
+
+        auto encoder = unicode::encoder<char> {};
+        auto output = std::back_inserter(_output);
+        for (Cell const& cell: _line.inflatedBuffer())
+        {
+            if (cell.codepointCount() == 0)
+                _output.push_back(' ');
+            for (size_t i = 0; i < cell.codepointCount(); ++i)
+                output = encoder(cell.codepoint(i), output);
+        }
+    }
+
+    void trimSpaceRight(string& _text, size_t _from)
+    {
+        auto end = _text.size();
+        while (end > _from && _text[end - 1] == ' ')
+            --end;
+        _text.resize(end);
+    }
+
+    void appendJsonString(string& _output, string_view _text)
+    {
+        _output.push_back('"');
+        for (char const ch: _text)
+        {
+            switch (ch)
+            {
+                case '"': _output += "\\\""; break;
+                case '\\': _output += "\\\\"; break;
+                case '\t': _output += "\\t"; break;
+                case '\n': _output += "\\n"; break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20)
+                        _output += fmt::format("\\u{:04x}", static_cast<unsigned>(ch));
+                    else
+                        _output.push_back(ch);
+                    break;
+            }
+        }
+        _output.push_back('"');
+    }
+} // namespace
+
+template <typename Cell>
+CaptureSnapshot<Cell> makeCaptureSnapshot(Grid<Cell> const& _grid, LineCount _lineCount, bool _logicalLines)
+{
+    // TODO: when capturing _lineCount < screenSize.lines, start at the lowest non-empty line.
+    auto const pageLines = _grid.pageSize().lines;
+    auto const relativeStartLine = _logicalLines ? _grid.computeLogicalLineNumberFromBottom(_lineCount)
+                                                 : unbox<int>(pageLines - _lineCount);
+    auto const startLine = LineOffset::cast_from(
+        std::clamp(relativeStartLine, -unbox<int>(_grid.historyLineCount()), unbox<int>(pageLines)));
+    auto const bottomLine = boxed_cast<LineOffset>(pageLines - 1);
+
+    auto snapshot = CaptureSnapshot<Cell> {};
+    snapshot.firstLine = startLine;
+    snapshot.logicalLines = _logicalLines;
+    if (startLine <= bottomLine)
+        snapshot.lines.reserve(unbox<size_t>(bottomLine - startLine) + 1);
+    for (auto line = startLine; line <= bottomLine; ++line)
+        snapshot.lines.emplace_back(_grid.lineAt(line));
+    return snapshot;
+}
+
+template <typename Cell>
+CaptureStats encodeCapture(CaptureSnapshot<Cell> const& _snapshot,
+                           CaptureFormat _format,
+                           size_t _chunkSize,
+                           function<void(string_view)> const& _writer)
+{
+    auto stats = CaptureStats {};
+    auto const prefix = fmt::format("\033^{};", CaptureBufferCode);
+    auto constexpr Suffix = "\033\\"sv;
+
+    auto payload = string {};
+    payload.reserve(_chunkSize + 1024);
+
+    auto const writeReply = [&](string_view _payload) {
+        auto reply = string {};
+        reply.reserve(prefix.size() + _payload.size() + Suffix.size());
+        reply += prefix;
+        reply += _payload;
+        reply += Suffix;
+        stats.bytes += reply.size();
+        _writer(reply);
+    };
+
+    auto const flushPayload = [&]() {
+        if (payload.empty())
+            return;
+        if (_format == CaptureFormat::TextWithSgr)
+            writeReply(crispy::base64::encode(payload));
+        else
+            writeReply(payload);
+        ++stats.chunks;
+        payload.clear();
+    };
+
+    auto vtWriter = VTWriter(payload);
+
+    auto const& lines = _snapshot.lines;
+    for (size_t first = 0; first < lines.size();)
+    {
+        // A logical line spans all subsequent lines that are wrapped into it.
+        auto last = first + 1;
+        if (_snapshot.logicalLines)
+            while (last < lines.size() && lines[last].wrapped())
+                ++last;
+
+        switch (_format)
+        {
+            case CaptureFormat::Text: {
+                auto const start = payload.size();
+                for (auto i = first; i < last; ++i)
+                    appendLineText(payload, lines[i]);
+                trimSpaceRight(payload, start);
+                if (payload.size() != start)
+                    payload += '\n';
+                break;
+            }
+            case CaptureFormat::TextWithSgr:
+                for (auto i = first; i < last; ++i)
+                    vtWriter.write(lines[i]);
+                vtWriter.lf();
+                break;
+            case CaptureFormat::JsonLines: {
+                auto text = string {};
+                for (auto i = first; i < last; ++i)
+                    appendLineText(text, lines[i]);
+                trimSpaceRight(text, 0);
+                payload += fmt::format(R"({{"line":{},"marked":{},"text":)",
+                                       unbox<int>(_snapshot.firstLine) + static_cast<int>(first),
+                                       lines[first].marked());
+                appendJsonString(payload, text);
+                payload += "}\n";
+                break;
+            }
+        }
+
+        stats.lines += last - first;
+        first = last;
+
+        if (payload.size() >= _chunkSize)
+            flushPayload();
+    }
+
+    vtWriter.setGraphicsAttributes({});
+    vtWriter.flush();
+    flushPayload();
+    writeReply({}); // mark the end
+    return stats;
+}
+
+} // namespace terminal
+
+#include <terminal/Cell.h>
+template terminal::CaptureSnapshot<terminal::Cell> terminal::makeCaptureSnapshot<terminal::Cell>(
+    Grid<Cell> const&, LineCount, bool);
+template terminal::CaptureStats terminal::encodeCapture<terminal::Cell>(
+    CaptureSnapshot<Cell> const&, CaptureFormat, size_t, std::function<void(std::string_view)> const&);
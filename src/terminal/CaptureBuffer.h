@@ -0,0 +1,105 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <terminal/Grid.h>
+#include <terminal/Line.h>
+#include <terminal/primitives.h>
+
+#include <fmt/format.h>
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace terminal
+{
+
+/// Output format of a screen buffer capture (CAPTURE's optional third parameter).
+enum class CaptureFormat
+{
+    /// Plain UTF-8 text, one line per line, blank lines omitted.
+    Text = 0,
+
+    /// UTF-8 text with SGR sequences for colors and styles. Each reply's payload
+    /// is base64 encoded, as it would otherwise terminate the PM string.
+    TextWithSgr = 1,
+
+    /// One JSON object per line, holding its line offset, mark and text.
+    JsonLines = 2,
+};
+
+/// A copy of the grid lines to be captured.
+///
+/// It is taken while holding the terminal lock, so that the (much more
+/// expensive) encoding can happen without it.
+template <typename Cell>
+struct CaptureSnapshot
+{
+    LineOffset firstLine;       ///< grid line offset of lines.front()
+    bool logicalLines = false;  ///< whether or not wrapped lines are to be joined
+    std::vector<Line<Cell>> lines;
+};
+
+/// Copies the given number of lines from the bottom of the grid's main page upwards.
+///
+/// @param _lineCount number of physical or, if @p _logicalLines is set, logical lines.
+template <typename Cell>
+CaptureSnapshot<Cell> makeCaptureSnapshot(Grid<Cell> const& _grid, LineCount _lineCount, bool _logicalLines);
+
+struct CaptureStats
+{
+    size_t lines = 0;  ///< number of (physical) lines encoded
+    size_t chunks = 0; ///< number of replies written, excluding the final end marker
+    size_t bytes = 0;  ///< number of bytes written, including the VT framing
+};
+
+/// Encodes the snapshot in the given format.
+///
+/// The output is handed to @p _writer as complete `PM 314 ; <payload> ST` replies
+/// of roughly @p _chunkSize payload bytes each, followed by the empty reply that
+/// marks the end of the capture.
+template <typename Cell>
+CaptureStats encodeCapture(CaptureSnapshot<Cell> const& _snapshot,
+                           CaptureFormat _format,
+                           size_t _chunkSize,
+                           std::function<void(std::string_view)> const& _writer);
+
+} // namespace terminal
+
+// {{{ fmt formatter
+namespace fmt
+{
+template <>
+struct formatter<terminal::CaptureFormat>
+{
+    template <typename ParseContext>
+    constexpr auto parse(ParseContext& ctx)
+    {
+        return ctx.begin();
+    }
+    template <typename FormatContext>
+    auto format(terminal::CaptureFormat value, FormatContext& ctx)
+    {
+        switch (value)
+        {
+            case terminal::CaptureFormat::Text: return format_to(ctx.out(), "text");
+            case terminal::CaptureFormat::TextWithSgr: return format_to(ctx.out(), "sgr");
+            case terminal::CaptureFormat::JsonLines: return format_to(ctx.out(), "json");
+        }
+        return format_to(ctx.out(), "({})", static_cast<unsigned>(value));
+    }
+};
+} // namespace fmt
+// }}}
@@ -71,7 +71,7 @@ struct CONTOUR_PACKED Owned
     Owned(Owned&& v) noexcept: ptr_ { v.release() } {}
     Owned& operator=(Owned&& v) noexcept
     {
-        ptr_ = v.release();
+        reset(v.release());
         return *this;
     }
 
@@ -111,6 +111,7 @@ class CharsetMapping
     }
 
     constexpr CharsetTable currentTable() const noexcept { return shift_; }
+    constexpr CharsetTable selectedTable() const noexcept { return selected_; }
 
   private:
     CharsetTable shift_ = CharsetTable::G0;
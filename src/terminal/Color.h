@@ -307,12 +307,32 @@ struct CellBackgroundColor
 };
 using CellRGBColor = std::variant<RGBColor, CellForegroundColor, CellBackgroundColor>;
 
+constexpr bool operator==(CellForegroundColor, CellForegroundColor) noexcept
+{
+    return true;
+}
+
+constexpr bool operator==(CellBackgroundColor, CellBackgroundColor) noexcept
+{
+    return true;
+}
+
 struct CursorColor
 {
     CellRGBColor color = CellForegroundColor {};
     CellRGBColor textOverrideColor = CellBackgroundColor {};
 };
 
+inline bool operator==(CursorColor const& a, CursorColor const& b) noexcept
+{
+    return a.color == b.color && a.textOverrideColor == b.textOverrideColor;
+}
+
+inline bool operator!=(CursorColor const& a, CursorColor const& b) noexcept
+{
+    return !(a == b);
+}
+
 // {{{ Opacity
 enum class Opacity : uint8_t
 {
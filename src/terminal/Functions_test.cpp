@@ -66,6 +66,13 @@ TEST_CASE("Functions.OSC8", "[Functions]")
     CHECK(*osc == HYPERLINK);
 }
 
+TEST_CASE("Functions.OSC133", "[Functions]")
+{
+    FunctionDefinition const* osc = terminal::selectOSCommand(133);
+    REQUIRE(osc);
+    CHECK(*osc == SEMANTICPROMPT);
+}
+
 TEST_CASE("Functions.OSC777", "[Functions]")
 {
     FunctionDefinition const* osc = terminal::selectOSCommand(777);
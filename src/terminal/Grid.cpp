@@ -19,8 +19,11 @@
 
 #include <fmt/format.h>
 
+#include <unicode/convert.h>
+
 #include <algorithm>
 #include <iostream>
+#include <iterator>
 
 using std::max;
 using std::min;
@@ -137,6 +140,7 @@ void Grid<Cell>::setMaxHistoryLineCount(LineCount _maxHistoryLineCount)
     lines_.resize(unbox<size_t>(pageSize_.lines + _maxHistoryLineCount));
     linesUsed_ = min(linesUsed_, pageSize_.lines + _maxHistoryLineCount);
     maxHistoryLineCount_ = _maxHistoryLineCount;
+    rebuildMarkers();
     verifyState();
 }
 
@@ -144,6 +148,36 @@ template <typename Cell>
 void Grid<Cell>::clearHistory()
 {
     linesUsed_ = pageSize_.lines;
+    pruneMarkers();
+    verifyState();
+}
+
+template <typename Cell>
+void Grid<Cell>::restoreLines(PageSize _pageSize, std::vector<Line<Cell>> _lines)
+{
+    Require(LineCount::cast_from(_lines.size()) >= _pageSize.lines);
+
+    auto const historyLineCount =
+        std::min(LineCount::cast_from(_lines.size()) - _pageSize.lines, maxHistoryLineCount_);
+    auto const firstLine = _lines.size() - unbox<size_t>(historyLineCount + _pageSize.lines);
+    auto const firstPageLine = firstLine + unbox<size_t>(historyLineCount);
+
+    // The ring buffer starts with the main page, while the scrollback is wrapped around
+    // to its end, the most recent scrollback line being the last one.
+    auto storage = std::vector<Line<Cell>>();
+    storage.reserve(unbox<size_t>(_pageSize.lines + maxHistoryLineCount_));
+    for (auto i = firstPageLine; i < _lines.size(); ++i)
+        storage.emplace_back(std::move(_lines[i]));
+    for (auto i = historyLineCount; i < maxHistoryLineCount_; ++i)
+        storage.emplace_back(defaultLineFlags(), _pageSize.columns, GraphicsAttributes {});
+    for (auto i = firstLine; i < firstPageLine; ++i)
+        storage.emplace_back(std::move(_lines[i]));
+
+    lines_ = Lines<Cell>(std::move(storage));
+    pageSize_ = _pageSize;
+    linesUsed_ = _pageSize.lines + historyLineCount;
+    absoluteTopLine_ = 0;
+    rebuildMarkers();
     verifyState();
 }
 
@@ -277,6 +311,34 @@ std::string Grid<Cell>::lineText(LineOffset _line) const
     return line;
 }
 
+template <typename Cell>
+void Grid<Cell>::appendText(std::string& _output,
+                            LineOffset _line,
+                            ColumnOffset _from,
+                            ColumnOffset _to) const
+{
+    Line<Cell> const& line = lineAt(_line);
+    auto const first = unbox<size_t>(_from);
+    auto const last = std::min(unbox<size_t>(_to) + 1, unbox<size_t>(line.size()));
+    if (first >= last)
+        return;
+
+    if (line.isTrivialBuffer())
+    {
+        // One byte per column, and nothing at all past the end of the text.
+        auto const& text = line.trivialBuffer().text;
+        if (first < text.size())
+            _output.append(text.data() + first, std::min(last, text.size()) - first);
+        return;
+    }
+
+    auto encoder = unicode::encoder<char> {};
+    auto output = std::back_inserter(_output);
+    for (Cell const& cell: gsl::span(line.inflatedBuffer()).subspan(first, last - first))
+        for (size_t i = 0; i < cell.codepointCount(); ++i)
+            output = encoder(cell.codepoint(i), output);
+}
+
 template <typename Cell>
 std::string Grid<Cell>::lineTextTrimmed(LineOffset _line) const
 {
@@ -319,6 +381,110 @@ bool Grid<Cell>::isLineBlank(LineOffset _line) const noexcept
     return std::all_of(line.begin(), line.end(), is_blank);
 }
 
+// }}}
+// {{{ Grid impl: markers
+template <typename Cell>
+void Grid<Cell>::markLine(LineOffset _line)
+{
+    lineAt(_line).setMarked(true);
+
+    auto const number = absoluteLineNumber(_line);
+    auto const i = std::lower_bound(markers_.begin(), markers_.end(), number);
+    if (i == markers_.end() || *i != number)
+        markers_.insert(i, number);
+}
+
+template <typename Cell>
+std::optional<LineOffset> Grid<Cell>::findMarkerUpwards(LineOffset _line) const
+{
+    auto const top = absoluteLineNumber(-boxed_cast<LineOffset>(historyLineCount()));
+    auto i = std::lower_bound(markers_.begin(), markers_.end(), absoluteLineNumber(_line));
+    while (i != markers_.begin())
+    {
+        --i;
+        if (*i < top)
+            break;
+        auto const line = relativeLineOffset(*i);
+        if (lineAt(line).marked())
+            return line;
+    }
+    return std::nullopt;
+}
+
+template <typename Cell>
+std::optional<LineOffset> Grid<Cell>::findMarkerDownwards(LineOffset _line) const
+{
+    auto const bottom = absoluteLineNumber(boxed_cast<LineOffset>(pageSize_.lines) - 1);
+    for (auto i = std::upper_bound(markers_.begin(), markers_.end(), absoluteLineNumber(_line));
+         i != markers_.end() && *i <= bottom;
+         ++i)
+    {
+        auto const line = relativeLineOffset(*i);
+        if (lineAt(line).marked())
+            return line;
+    }
+    return std::nullopt;
+}
+
+template <typename Cell>
+std::vector<LineOffset> Grid<Cell>::markers() const
+{
+    auto const top = absoluteLineNumber(-boxed_cast<LineOffset>(historyLineCount()));
+    auto const bottom = absoluteLineNumber(boxed_cast<LineOffset>(pageSize_.lines) - 1);
+
+    std::vector<LineOffset> result;
+    for (auto const number: markers_)
+    {
+        if (number < top || number > bottom)
+            continue;
+        auto const line = relativeLineOffset(number);
+        if (lineAt(line).marked())
+            result.emplace_back(line);
+    }
+    return result;
+}
+
+template <typename Cell>
+void Grid<Cell>::pruneMarkers()
+{
+    auto const top = absoluteLineNumber(-boxed_cast<LineOffset>(historyLineCount()));
+    auto const bottom = absoluteLineNumber(boxed_cast<LineOffset>(pageSize_.lines) - 1);
+
+    while (!markers_.empty() && markers_.front() < top)
+        markers_.pop_front();
+
+    while (!markers_.empty() && markers_.back() > bottom)
+        markers_.pop_back();
+}
+
+template <typename Cell>
+void Grid<Cell>::shiftMarkers(LineOffset _from, LineOffset _to, int _delta)
+{
+    auto const a = absoluteLineNumber(_from);
+    auto const b = absoluteLineNumber(_to);
+    auto const first = std::lower_bound(markers_.begin(), markers_.end(), a);
+    auto const last = std::upper_bound(first, markers_.end(), b);
+
+    for (auto i = first; i != last; ++i)
+        *i += _delta;
+
+    // Shifting all entries by the same delta keeps them sorted, and the ones shifted out
+    // of [a, b] are either at the front or at the back of that sub range.
+    markers_.erase(std::remove_if(first, last, [=](int64_t v) { return v < a || b < v; }), last);
+}
+
+template <typename Cell>
+void Grid<Cell>::rebuildMarkers()
+{
+    markers_.clear();
+    for (auto line = -boxed_cast<LineOffset>(historyLineCount());
+         line < boxed_cast<LineOffset>(pageSize_.lines);
+         ++line)
+        if (lineAt(line).marked())
+            markers_.emplace_back(absoluteLineNumber(line));
+}
+// }}}
+// {{{ Grid impl: logical lines
 /**
  * Computes the relative line number for the bottom-most @p _n logical lines.
  */
@@ -356,6 +522,7 @@ template <typename Cell>
 LineCount Grid<Cell>::scrollUp(LineCount linesCountToScrollUp, GraphicsAttributes _defaultAttributes) noexcept
 {
     verifyState();
+    absoluteTopLine_ += unbox<int64_t>(linesCountToScrollUp);
     if (unbox<size_t>(linesUsed_) == lines_.size()) // with all grid lines in-use
     {
         // TODO: ensure explicit test for this case
@@ -367,6 +534,7 @@ LineCount Grid<Cell>::scrollUp(LineCount linesCountToScrollUp, GraphicsAttribute
              ++y)
             lineAt(y).reset(defaultLineFlags(), _defaultAttributes);
 
+        pruneMarkers();
         return linesCountToScrollUp;
     }
     else
@@ -400,6 +568,7 @@ LineCount Grid<Cell>::scrollUp(LineCount linesCountToScrollUp, GraphicsAttribute
                  ++y)
                 lineAt(y).reset(defaultLineFlags(), _defaultAttributes);
         }
+        pruneMarkers();
         return LineCount::cast_from(linesAppendCount);
     }
 }
@@ -443,36 +612,18 @@ LineCount Grid<Cell>::scrollUp(LineCount _n, GraphicsAttributes _defaultAttribut
             Line<Cell>& line = lines_[lineNumber];
             line.reset(defaultLineFlags(), _defaultAttributes);
         }
+        shiftMarkers(_margin.vertical.from, _margin.vertical.to, -*n);
     }
     else
     {
         // a full "inside" scroll-up
-        auto const marginHeight = _margin.vertical.length();
-        auto const n = std::min(_n, marginHeight);
-        // auto const bottomLineOffsetToCopy = min(_margin.vertical.from + *n, _margin.vertical.to - 1);
-        auto const topTargetLineOffset = _margin.vertical.from;
-        auto const bottomTargetLineOffset = _margin.vertical.to - *n;
-        auto const columnsToMove = unbox<size_t>(_margin.horizontal.length());
+        auto const n = std::min(_n, _margin.vertical.length());
 
-        for (LineOffset targetLineOffset = topTargetLineOffset; targetLineOffset <= bottomTargetLineOffset;
-             ++targetLineOffset)
-        {
-            auto const sourceLineOffset = targetLineOffset + *n;
-            auto t = &useCellAt(targetLineOffset, _margin.horizontal.from);
-            auto s = &at(sourceLineOffset, _margin.horizontal.from);
-            std::copy_n(s, columnsToMove, t);
-        }
+        for (LineOffset target = _margin.vertical.from; target <= _margin.vertical.to - *n; ++target)
+            moveColumns(target + *n, target, _margin.horizontal);
 
         for (LineOffset line = _margin.vertical.to - *n + 1; line <= _margin.vertical.to; ++line)
-        {
-            auto a = &useCellAt(line, _margin.horizontal.from);
-            auto b = a + unbox<int>(_margin.horizontal.length());
-            while (a != b)
-            {
-                a->reset(_defaultAttributes);
-                a++;
-            }
-        }
+            clearColumns(line, _margin.horizontal, _defaultAttributes);
     }
     verifyState();
     return LineCount(0); // No full-margin lines scrolled up.
@@ -510,6 +661,9 @@ void Grid<Cell>::scrollDown(LineCount v_n,
 
         for (Line<Cell>& line: mainPage().subspan(0, unbox<size_t>(n)))
             line.reset(defaultLineFlags(), _defaultAttributes);
+
+        absoluteTopLine_ -= unbox<int64_t>(n);
+        pruneMarkers();
         return;
     }
 
@@ -522,30 +676,16 @@ void Grid<Cell>::scrollDown(LineCount v_n,
         std::rotate(a, b, c);
         for (auto const i: ranges::views::iota(*_margin.vertical.from, *_margin.vertical.from + *n))
             lines_[i].reset(defaultLineFlags(), _defaultAttributes);
+        shiftMarkers(_margin.vertical.from, _margin.vertical.to, *n);
     }
     else
     {
         // a full "inside" scroll-down
-        if (n <= _margin.vertical.length())
-        {
-            for (LineOffset line = _margin.vertical.to; line >= _margin.vertical.to - *n; --line)
-            {
-                auto s = &at(line - *n, _margin.horizontal.from);
-                auto t = &at(line, _margin.horizontal.from);
-                std::copy_n(s, unbox<size_t>(_margin.horizontal.length()), t);
-            }
+        for (LineOffset target = _margin.vertical.to; target >= _margin.vertical.from + *n; --target)
+            moveColumns(target - *n, target, _margin.horizontal);
 
-            for (LineOffset line = _margin.vertical.from; line < _margin.vertical.from + *n; ++line)
-            {
-                auto a = &at(line, _margin.horizontal.from);
-                auto b = &at(line, _margin.horizontal.to + 1);
-                while (a != b)
-                {
-                    *a = Cell { _defaultAttributes };
-                    a++;
-                }
-            }
-        }
+        for (LineOffset line = _margin.vertical.from; line < _margin.vertical.from + *n; ++line)
+            clearColumns(line, _margin.horizontal, _defaultAttributes);
     }
 }
 
@@ -554,16 +694,58 @@ void Grid<Cell>::scrollLeft(GraphicsAttributes _defaultAttributes, Margin _margi
 {
     for (LineOffset lineNo = _margin.vertical.from; lineNo <= _margin.vertical.to; ++lineNo)
     {
+        // Shifting blank cells into a blank line does not change it.
+        if (isBlankLine(lineNo, _defaultAttributes))
+            continue;
+
         auto& line = lineAt(lineNo);
         auto column0 = line.inflatedBuffer().begin() + *_margin.horizontal.from;
         auto column1 = line.inflatedBuffer().begin() + *_margin.horizontal.from + 1;
         auto column2 = line.inflatedBuffer().begin() + *_margin.horizontal.to + 1;
-        std::rotate(column0, column1, column2);
+        std::move(column1, column2, column0);
+        line.inflatedBuffer()[unbox<size_t>(_margin.horizontal.to)].reset(_defaultAttributes);
+    }
+}
+
+template <typename Cell>
+bool Grid<Cell>::isBlankLine(LineOffset _line, GraphicsAttributes const& _attributes) const noexcept
+{
+    auto const& line = lineAt(_line);
+    if (!line.isTrivialBuffer())
+        return false;
+
+    auto const& buffer = line.trivialBuffer();
+    return buffer.text.empty() && !buffer.hyperlink && buffer.attributes == _attributes;
+}
+
+template <typename Cell>
+void Grid<Cell>::moveColumns(LineOffset _source, LineOffset _target, Margin::Horizontal _margin)
+{
+    auto& sourceLine = lineAt(_source);
 
-        auto const emptyCell = Cell { _defaultAttributes };
-        auto const emptyCellsBegin = line.inflatedBuffer().begin() + *_margin.horizontal.to;
-        std::fill_n(emptyCellsBegin, 1, emptyCell);
+    // Moving a trivially stored blank line's cells does not require to unpack its cells.
+    if (sourceLine.isTrivialBuffer() && sourceLine.trivialBuffer().text.empty()
+        && !sourceLine.trivialBuffer().hyperlink)
+    {
+        clearColumns(_target, _margin, sourceLine.trivialBuffer().attributes);
+        return;
     }
+
+    auto const source = sourceLine.inflatedBuffer().begin() + unbox<long>(_margin.from);
+    auto const target = lineAt(_target).inflatedBuffer().begin() + unbox<long>(_margin.from);
+    std::move(source, source + unbox<long>(_margin.length()), target);
+}
+
+template <typename Cell>
+void Grid<Cell>::clearColumns(LineOffset _line,
+                              Margin::Horizontal _margin,
+                              GraphicsAttributes const& _attributes)
+{
+    if (isBlankLine(_line, _attributes))
+        return;
+
+    auto const cells = lineAt(_line).inflatedBuffer().begin() + unbox<long>(_margin.from);
+    std::for_each(cells, cells + unbox<long>(_margin.length()), [&](Cell& cell) { cell.reset(_attributes); });
 }
 
 // }}}
@@ -575,6 +757,15 @@ void Grid<Cell>::reset()
     lines_.rotate_right(lines_.zero_index());
     for (int i = 0; i < unbox<int>(pageSize_.lines); ++i)
         lines_[i].reset(defaultLineFlags(), GraphicsAttributes {});
+    markers_.clear();
+    verifyState();
+}
+
+template <typename Cell>
+void Grid<Cell>::clearPage(GraphicsAttributes _attributes)
+{
+    for (auto line = LineOffset(0); line < boxed_cast<LineOffset>(pageSize_.lines); ++line)
+        lineAt(line).clear(defaultLineFlags(), _attributes);
     verifyState();
 }
 
@@ -922,6 +1113,7 @@ CellLocation Grid<Cell>::resize(PageSize _newSize, CellLocation _currentCursorPo
     }
 
     Ensures(pageSize_ == _newSize);
+    rebuildMarkers();
     verifyState();
 
     return cursor;
@@ -32,6 +32,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <deque>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -384,6 +387,12 @@ class Grid
 
     void reset();
 
+    /// Clears all lines of the main page, keeping the storage of their cells.
+    ///
+    /// Unlike reset() or scrolling the page out, this avoids reallocating the cells of pages that
+    /// are cleared and redrawn repeatedly, such as the alternate screen's.
+    void clearPage(GraphicsAttributes _attributes);
+
     // {{{ grid global properties
     [[nodiscard]] LineCount maxHistoryLineCount() const noexcept { return maxHistoryLineCount_; }
     void setMaxHistoryLineCount(LineCount _maxHistoryLineCount);
@@ -422,6 +431,13 @@ class Grid
     [[nodiscard]] std::string lineTextTrimmed(LineOffset _line) const;
     [[nodiscard]] std::string lineText(Line<Cell> const& _line) const;
 
+    /// Appends the UTF-8 text of the columns [_from, _to] at line @p _line to @p _output.
+    ///
+    /// Trivial lines are copied straight from their text buffer, inflated lines are
+    /// encoded in place. Neither path inflates the line nor allocates per cell.
+    /// Empty cells (such as the right half of a wide character) contribute nothing.
+    void appendText(std::string& _output, LineOffset _line, ColumnOffset _from, ColumnOffset _to) const;
+
     void setLineText(LineOffset _line, std::string_view _text);
 
     // void resetLine(LineOffset _line, GraphicsAttributes _attribs) noexcept
@@ -436,6 +452,21 @@ class Grid
     [[nodiscard]] size_t zero_index() const noexcept { return lines_.zero_index(); }
     // }}}
 
+    // {{{ Marker API
+    /// Marks the given line (e.g. by the shell integration's prompt mark)
+    /// and records it in the marker index.
+    void markLine(LineOffset _line);
+
+    /// @returns the nearest marked line strictly above @p _line, within the scrollback and main page.
+    [[nodiscard]] std::optional<LineOffset> findMarkerUpwards(LineOffset _line) const;
+
+    /// @returns the nearest marked line strictly below @p _line, within the scrollback and main page.
+    [[nodiscard]] std::optional<LineOffset> findMarkerDownwards(LineOffset _line) const;
+
+    /// @returns all marked lines in ascending order.
+    [[nodiscard]] std::vector<LineOffset> markers() const;
+    // }}}
+
     /// Gets a reference to the cell relative to screen origin (top left, 0:0).
     [[nodiscard]] Cell& useCellAt(LineOffset _line, ColumnOffset _column) noexcept;
     [[nodiscard]] Cell& at(LineOffset _line, ColumnOffset _column) noexcept;
@@ -466,6 +497,14 @@ class Grid
     /// Completely deletes all scrollback lines.
     void clearHistory();
 
+    /// Replaces the scrollback and main page with the given lines, e.g. when restoring a snapshot.
+    ///
+    /// @param _pageSize new size of the main page area
+    /// @param _lines    lines ordered from the oldest scrollback line down to the main page's
+    ///                  bottom line. The oldest lines are dropped if they exceed the maximum
+    ///                  history line count.
+    void restoreLines(PageSize _pageSize, std::vector<Line<Cell>> _lines);
+
     /// Scrolls up by @p _n lines within the given margin.
     ///
     /// @param _n number of lines to scroll up within the given margin.
@@ -529,6 +568,41 @@ class Grid
     void rotateBuffersRight(LineCount count) noexcept { lines_.rotate_right(unbox<size_t>(count)); }
     // }}}
 
+    // {{{ margin scroll helpers
+    /// Tests whether the line is stored trivially and blank with the given attributes,
+    /// i.e. whether it would not change if any of its cells were reset to these attributes.
+    [[nodiscard]] bool isBlankLine(LineOffset _line, GraphicsAttributes const& _attributes) const noexcept;
+
+    /// Moves the cells within the horizontal margin from line @p _source to line @p _target,
+    /// leaving the source cells in a moved-from state.
+    void moveColumns(LineOffset _source, LineOffset _target, Margin::Horizontal _margin);
+
+    /// Resets the cells within the horizontal margin of the given line to blank cells.
+    void clearColumns(LineOffset _line, Margin::Horizontal _margin, GraphicsAttributes const& _attributes);
+    // }}}
+
+    // {{{ marker index helpers
+    [[nodiscard]] int64_t absoluteLineNumber(LineOffset _line) const noexcept
+    {
+        return absoluteTopLine_ + unbox<int64_t>(_line);
+    }
+
+    [[nodiscard]] LineOffset relativeLineOffset(int64_t _absoluteLine) const noexcept
+    {
+        return LineOffset::cast_from(_absoluteLine - absoluteTopLine_);
+    }
+
+    /// Drops marker entries that do not refer to a line in the scrollback or main page anymore.
+    void pruneMarkers();
+
+    /// Moves marker entries within the line range [_from, _to] by _delta lines,
+    /// dropping those that are moved out of that range.
+    void shiftMarkers(LineOffset _from, LineOffset _to, int _delta);
+
+    /// Reconstructs the marker index by scanning all lines, used after structural changes (resize).
+    void rebuildMarkers();
+    // }}}
+
     // private fields
     //
     PageSize pageSize_;
@@ -542,6 +616,17 @@ class Grid
 
     // Number of lines used in the Lines buffer.
     LineCount linesUsed_;
+
+    // Absolute line number of the main page's top line, which is increased (decreased)
+    // whenever the main page is scrolled up (down). It makes marker entries
+    // stable across scrolling without touching them.
+    int64_t absoluteTopLine_ = 0;
+
+    // Sorted absolute line numbers of lines marked via markLine().
+    //
+    // Entries may become stale (the line got reset in the meantime) and are
+    // therefore validated against the line's Marked flag upon lookup.
+    std::deque<int64_t> markers_;
 };
 
 template <typename Cell>
@@ -165,6 +165,85 @@ TEST_CASE("Grid.writeAndScrollUp", "[grid]")
     CHECK(grid.lineText(LineOffset(1)) == "     ");
 }
 
+TEST_CASE("Grid.appendText", "[grid]")
+{
+    auto grid = setupGrid5x2();
+
+    SECTION("inflated")
+    {
+        grid.lineAt(LineOffset(0)).useCellAt(ColumnOffset(1)).setCharacter(U'\u00C4');
+        string text;
+        grid.appendText(text, LineOffset(0), ColumnOffset(0), ColumnOffset(2));
+        CHECK(text == "A\u00C4C");
+        grid.appendText(text, LineOffset(1), ColumnOffset(3), ColumnOffset(9));
+        CHECK(text == "A\u00C4Cde");
+    }
+
+    SECTION("trivial")
+    {
+        auto constexpr TestText = "xyz"sv;
+        auto pool = crispy::BufferObjectPool(16);
+        auto bufferObject = pool.allocateBufferObject();
+        bufferObject->writeAtEnd(TestText);
+        grid.lineAt(LineOffset(1)).reset(GraphicsAttributes {}, HyperlinkId {}, bufferObject->ref(0, 3));
+        REQUIRE(grid.lineAt(LineOffset(1)).isTrivialBuffer());
+
+        string text;
+        grid.appendText(text, LineOffset(1), ColumnOffset(1), ColumnOffset(4));
+        CHECK(text == "yz");
+        CHECK(grid.lineAt(LineOffset(1)).isTrivialBuffer());
+    }
+}
+
+TEST_CASE("Grid.scrollWithinLeftRightMargin", "[grid]")
+{
+    auto grid = Grid<Cell>(PageSize { LineCount(5), ColumnCount(5) }, false, LineCount(0));
+    grid.setLineText(LineOffset(0), "AAAAA");
+    grid.setLineText(LineOffset(1), "BBBBB");
+    grid.setLineText(LineOffset(2), "CCCCC");
+    grid.setLineText(LineOffset(3), "DDDDD");
+    auto const margin = Margin { Margin::Vertical { LineOffset(1), LineOffset(3) },
+                                 Margin::Horizontal { ColumnOffset(1), ColumnOffset(3) } };
+
+    SECTION("up")
+    {
+        grid.scrollUp(LineCount(1), GraphicsAttributes {}, margin);
+        CHECK(grid.lineText(LineOffset(0)) == "AAAAA");
+        CHECK(grid.lineText(LineOffset(1)) == "BCCCB");
+        CHECK(grid.lineText(LineOffset(2)) == "CDDDC");
+        CHECK(grid.lineText(LineOffset(3)) == "D   D");
+        CHECK(grid.lineText(LineOffset(4)) == "     ");
+    }
+
+    SECTION("down")
+    {
+        grid.scrollDown(LineCount(1), GraphicsAttributes {}, margin);
+        CHECK(grid.lineText(LineOffset(0)) == "AAAAA");
+        CHECK(grid.lineText(LineOffset(1)) == "B   B");
+        CHECK(grid.lineText(LineOffset(2)) == "CBBBC");
+        CHECK(grid.lineText(LineOffset(3)) == "DCCCD");
+        CHECK(grid.lineText(LineOffset(4)) == "     ");
+    }
+
+    SECTION("down by more than the margin")
+    {
+        grid.scrollDown(LineCount(5), GraphicsAttributes {}, margin);
+        CHECK(grid.lineText(LineOffset(1)) == "B   B");
+        CHECK(grid.lineText(LineOffset(2)) == "C   C");
+        CHECK(grid.lineText(LineOffset(3)) == "D   D");
+    }
+
+    SECTION("blank lines")
+    {
+        grid.lineAt(LineOffset(2)).reset(LineFlags::None, GraphicsAttributes {});
+        grid.lineAt(LineOffset(3)).reset(LineFlags::None, GraphicsAttributes {});
+        grid.scrollUp(LineCount(1), GraphicsAttributes {}, margin);
+        CHECK(grid.lineText(LineOffset(1)) == "B   B");
+        CHECK(grid.lineAt(LineOffset(2)).isTrivialBuffer());
+        CHECK(grid.lineAt(LineOffset(3)).isTrivialBuffer());
+    }
+}
+
 TEST_CASE("iteratorAt", "[grid]")
 {
     auto grid = Grid<Cell>(PageSize { LineCount(3), ColumnCount(3) }, true, LineCount(0));
@@ -846,3 +925,77 @@ TEST_CASE("Grid.reflow.tripple", "[grid]")
     }
 }
 // }}}
+
+// {{{ markers
+TEST_CASE("Grid.markers.scrollUp", "[grid]")
+{
+    auto grid = Grid<Cell>(PageSize { LineCount(3), ColumnCount(5) }, false, LineCount(2));
+    grid.markLine(LineOffset(0));
+    grid.markLine(LineOffset(2));
+
+    CHECK(grid.markers() == std::vector { LineOffset(0), LineOffset(2) });
+    CHECK(grid.findMarkerUpwards(LineOffset(2)) == LineOffset(0));
+    CHECK(grid.findMarkerDownwards(LineOffset(0)) == LineOffset(2));
+
+    SECTION("into history")
+    {
+        grid.scrollUp(LineCount(2));
+        CHECK(grid.markers() == std::vector { LineOffset(-2), LineOffset(0) });
+        CHECK(grid.findMarkerUpwards(LineOffset(0)) == LineOffset(-2));
+        CHECK_FALSE(grid.findMarkerUpwards(LineOffset(-2)).has_value());
+    }
+
+    SECTION("evicted from history")
+    {
+        grid.scrollUp(LineCount(3));
+        CHECK(grid.markers() == std::vector { LineOffset(-1) });
+        CHECK_FALSE(grid.findMarkerUpwards(LineOffset(-1)).has_value());
+    }
+
+    SECTION("clearHistory")
+    {
+        grid.scrollUp(LineCount(1));
+        grid.clearHistory();
+        CHECK(grid.markers() == std::vector { LineOffset(1) });
+    }
+
+    SECTION("stale marker after line reset")
+    {
+        grid.lineAt(LineOffset(2)).reset(LineFlags::None, GraphicsAttributes {});
+        CHECK(grid.markers() == std::vector { LineOffset(0) });
+        CHECK_FALSE(grid.findMarkerDownwards(LineOffset(0)).has_value());
+    }
+}
+
+TEST_CASE("Grid.markers.scrollWithinMargin", "[grid]")
+{
+    auto grid = Grid<Cell>(PageSize { LineCount(4), ColumnCount(5) }, false, LineCount(0));
+    auto const margin = Margin { Margin::Vertical { LineOffset(1), LineOffset(2) },
+                                 Margin::Horizontal { ColumnOffset(0), ColumnOffset(4) } };
+    grid.markLine(LineOffset(1));
+    grid.markLine(LineOffset(2));
+    grid.markLine(LineOffset(3));
+
+    SECTION("up")
+    {
+        grid.scrollUp(LineCount(1), GraphicsAttributes {}, margin);
+        CHECK(grid.markers() == std::vector { LineOffset(1), LineOffset(3) });
+    }
+
+    SECTION("down")
+    {
+        grid.scrollDown(LineCount(1), GraphicsAttributes {}, margin);
+        CHECK(grid.markers() == std::vector { LineOffset(2), LineOffset(3) });
+    }
+}
+
+TEST_CASE("Grid.markers.reflow", "[grid]")
+{
+    auto grid = setupGrid5x2();
+    grid.markLine(LineOffset(1));
+
+    (void) grid.resize(PageSize { LineCount(2), ColumnCount(4) }, CellLocation {}, false);
+    REQUIRE(grid.lineText(LineOffset(0)) == "abcd");
+    CHECK(grid.findMarkerUpwards(LineOffset(1)) == LineOffset(0));
+}
+// }}}
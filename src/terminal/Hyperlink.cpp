@@ -0,0 +1,85 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Hyperlink.h>
+
+namespace terminal
+{
+
+HyperlinkId HyperlinkStorage::hyperlinkIdByUserId(std::string const& _id) const noexcept
+{
+    if (auto const i = byUserId_.find(_id); i != byUserId_.end())
+        return i->second;
+    return HyperlinkId {};
+}
+
+HyperlinkId HyperlinkStorage::hyperlinkIdOf(std::string _userId, URI _uri)
+{
+    if (!_userId.empty())
+        if (auto const i = byKey_.find(Key { _userId, _uri }); i != byKey_.end())
+            return i->second;
+
+    ++requestCount_;
+
+    auto id = HyperlinkId {};
+    if (!freeIds_.empty())
+    {
+        id = freeIds_.back();
+        freeIds_.pop_back();
+    }
+    else if (links_.size() <= MaxHyperlinkCount)
+    {
+        id = HyperlinkId(static_cast<HyperlinkId::inner_type>(links_.size()));
+        links_.emplace_back();
+    }
+    else
+        return HyperlinkId {};
+
+    auto& link = links_[unbox<size_t>(id)];
+    link = std::make_shared<HyperlinkInfo>(HyperlinkInfo { std::move(_userId), std::move(_uri) });
+    if (!link->userId.empty())
+    {
+        byKey_.emplace(Key { link->userId, link->uri }, id);
+        // The key must refer to the new link's user ID, as a previous link's may be released first.
+        byUserId_.erase(link->userId);
+        byUserId_.emplace(link->userId, id);
+    }
+    return id;
+}
+
+void HyperlinkStorage::release(HyperlinkId _id)
+{
+    auto& link = links_[unbox<size_t>(_id)];
+
+    if (!link->userId.empty())
+    {
+        if (auto const i = byUserId_.find(link->userId); i != byUserId_.end() && i->second == _id)
+            byUserId_.erase(i);
+        byKey_.erase(Key { link->userId, link->uri });
+    }
+
+    link.reset();
+    freeIds_.push_back(_id);
+}
+
+void HyperlinkStorage::clear()
+{
+    links_.resize(1);
+    freeIds_.clear();
+    byKey_.clear();
+    byUserId_.clear();
+    requestCount_ = 0;
+    gcThreshold_ = MinGarbageCollectionThreshold;
+}
+
+} // namespace terminal
@@ -13,13 +13,16 @@
  */
 #pragma once
 
-#include <crispy/LRUCache.h>
 #include <crispy/boxed.h>
 
-#include <list>
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace terminal
 {
@@ -83,41 +86,115 @@ using HyperlinkId = crispy::boxed<uint16_t, detail::HyperlinkTag>;
 
 bool is_local(HyperlinkInfo const& _hyperlink);
 
-using HyperlinkCache = crispy::LRUCache<HyperlinkId, std::shared_ptr<HyperlinkInfo>>;
-
-struct HyperlinkStorage
+/// Owns the hyperlinks referenced by grid cells and lines.
+///
+/// Hyperlinks are interned by their application provided ID and URI, so that
+/// repeated OSC 8 sequences for the same link resolve to the same HyperlinkId
+/// in constant time. Links without an application provided ID are distinct
+/// per occurrence, even if their URIs are equal.
+///
+/// Entries are not evicted by age. Instead, once enough links have been requested,
+/// the owner reports every HyperlinkId still referenced by the grid lines
+/// (see collectGarbage()), and only unreferenced entries are released.
+/// Links that are still visible or in the scrollback thus stay stable.
+class HyperlinkStorage
 {
-    HyperlinkCache cache { 1024 };
-    HyperlinkId nextHyperlinkId = HyperlinkId(1);
+  public:
+    /// Minimum number of new hyperlinks requested between two garbage collections.
+    static constexpr size_t MinGarbageCollectionThreshold = 1024;
+
+    /// Upper bound of simultaneously stored hyperlinks, dictated by the width of HyperlinkId.
+    static constexpr size_t MaxHyperlinkCount = std::numeric_limits<HyperlinkId::inner_type>::max();
 
     std::shared_ptr<HyperlinkInfo> hyperlinkById(HyperlinkId _id) noexcept
     {
-        if (!!_id)
-            if (auto href = cache.try_get(_id))
-                return *href;
+        if (!!_id && unbox<size_t>(_id) < links_.size())
+            return links_[unbox<size_t>(_id)];
         return {};
     }
 
     std::shared_ptr<HyperlinkInfo const> hyperlinkById(HyperlinkId _id) const noexcept
     {
-        if (!!_id)
-            if (auto href = cache.try_get(_id))
-                return *href;
-        return {};
+        return const_cast<HyperlinkStorage*>(this)->hyperlinkById(_id);
     }
 
-    HyperlinkId hyperlinkIdByUserId(std::string const& _id) noexcept
+    /// @returns the ID of the most recently added hyperlink with the given application
+    ///          provided ID, or an invalid ID if there is none.
+    HyperlinkId hyperlinkIdByUserId(std::string const& _id) const noexcept;
+
+    /// @returns the ID of the hyperlink with the given application provided ID and URI,
+    ///          adding it if not present yet, or an invalid ID if no more IDs are available.
+    ///          A new hyperlink is added for every call with an empty application provided ID.
+    HyperlinkId hyperlinkIdOf(std::string _userId, URI _uri);
+
+    [[nodiscard]] size_t size() const noexcept { return links_.size() - 1 - freeIds_.size(); }
+
+    /// Invokes @p _visitor with the ID and info of every stored hyperlink.
+    template <typename Visitor>
+    void forEach(Visitor&& _visitor) const
     {
-        for (auto& href: cache)
+        for (size_t i = 1; i < links_.size(); ++i)
+            if (links_[i])
+                _visitor(HyperlinkId(static_cast<HyperlinkId::inner_type>(i)), *links_[i]);
+    }
+
+    /// Tests whether enough new hyperlinks have been requested since the last collection
+    /// for collectGarbage() to be worth it.
+    [[nodiscard]] bool needsGarbageCollection() const noexcept { return requestCount_ >= gcThreshold_; }
+
+    /// Releases all hyperlinks that are not referenced anymore.
+    ///
+    /// @param _visitReferences is invoked with a callable, which must in turn be
+    ///        invoked with every HyperlinkId that is still in use.
+    template <typename Visitor>
+    void collectGarbage(Visitor&& _visitReferences);
+
+    /// Releases all hyperlinks.
+    void clear();
+
+  private:
+    using Key = std::pair<std::string_view, std::string_view>; // userId, URI
+
+    struct KeyHash
+    {
+        size_t operator()(Key const& _key) const noexcept
         {
-            if (href.value->userId == _id)
-            {
-                cache.touch(href.key);
-                return href.key;
-            }
+            auto const a = std::hash<std::string_view> {}(_key.first);
+            auto const b = std::hash<std::string_view> {}(_key.second);
+            return a ^ (b + 0x9e3779b9 + (a << 6) + (a >> 2));
         }
-        return HyperlinkId {};
-    }
+    };
+
+    void release(HyperlinkId _id);
+
+    // Indexed by HyperlinkId, slot 0 is never used. Keys in the maps below
+    // are views into the HyperlinkInfo objects owned by this vector.
+    std::vector<std::shared_ptr<HyperlinkInfo>> links_ { nullptr };
+    std::vector<HyperlinkId> freeIds_;
+    std::unordered_map<Key, HyperlinkId, KeyHash> byKey_;
+    std::unordered_map<std::string_view, HyperlinkId> byUserId_;
+    size_t requestCount_ = 0; //!< new hyperlinks requested since the last collection, added or not
+    size_t gcThreshold_ = MinGarbageCollectionThreshold;
 };
 
+template <typename Visitor>
+void HyperlinkStorage::collectGarbage(Visitor&& _visitReferences)
+{
+    auto referenced = std::vector<bool>(links_.size(), false);
+    _visitReferences([&](HyperlinkId _id) {
+        if (unbox<size_t>(_id) < referenced.size())
+            referenced[unbox<size_t>(_id)] = true;
+    });
+
+    for (size_t i = 1; i < links_.size(); ++i)
+        if (links_[i] && !referenced[i])
+            release(HyperlinkId(static_cast<HyperlinkId::inner_type>(i)));
+
+    // Collect again once the storage has doubled or its remaining IDs are used up, but never
+    // sooner than MinGarbageCollectionThreshold requests, in case this collection freed little.
+    auto const available = MaxHyperlinkCount - size();
+    requestCount_ = 0;
+    gcThreshold_ = std::max(MinGarbageCollectionThreshold, std::min(size(), available));
+}
+
 } // namespace terminal
@@ -0,0 +1,162 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Hyperlink.h>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace std;
+using namespace terminal;
+
+TEST_CASE("HyperlinkStorage.intern", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage {};
+
+    auto const a = storage.hyperlinkIdOf("a", "file:///tmp/a");
+    auto const b = storage.hyperlinkIdOf("b", "file:///tmp/b");
+    auto const c = storage.hyperlinkIdOf("c", "file:///tmp/a");
+    REQUIRE(!!a);
+    REQUIRE(!!b);
+    REQUIRE(!!c);
+    CHECK(a != b);
+    CHECK(a != c);
+    CHECK(storage.size() == 3);
+
+    CHECK(storage.hyperlinkIdOf("a", "file:///tmp/a") == a);
+    CHECK(storage.hyperlinkIdOf("c", "file:///tmp/a") == c);
+    CHECK(storage.size() == 3);
+
+    CHECK(storage.hyperlinkIdByUserId("c") == c);
+    CHECK(!storage.hyperlinkIdByUserId("d"));
+
+    REQUIRE(storage.hyperlinkById(c));
+    CHECK(storage.hyperlinkById(c)->userId == "c");
+    CHECK(storage.hyperlinkById(c)->uri == "file:///tmp/a");
+}
+
+TEST_CASE("HyperlinkStorage.collectGarbage", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage {};
+
+    auto const a = storage.hyperlinkIdOf("a", "https://example.com/a");
+    auto const b = storage.hyperlinkIdOf("b", "https://example.com/b");
+    CHECK(!storage.needsGarbageCollection());
+
+    storage.collectGarbage([&](auto&& _markReferenced) { _markReferenced(b); });
+
+    CHECK(storage.size() == 1);
+    CHECK(!storage.hyperlinkById(a));
+    CHECK(!storage.hyperlinkIdByUserId("a"));
+    REQUIRE(storage.hyperlinkById(b));
+    CHECK(storage.hyperlinkById(b)->uri == "https://example.com/b");
+    CHECK(storage.hyperlinkIdOf("b", "https://example.com/b") == b);
+
+    // The released ID is reused for the next new hyperlink.
+    auto const c = storage.hyperlinkIdOf("c", "https://example.com/c");
+    CHECK(c == a);
+    CHECK(storage.hyperlinkById(c)->userId == "c");
+}
+
+TEST_CASE("HyperlinkStorage.reuseUserId", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage {};
+
+    auto const a = storage.hyperlinkIdOf("x", "https://example.com/a");
+    auto const b = storage.hyperlinkIdOf("x", "https://example.com/b");
+    REQUIRE(a != b);
+    CHECK(storage.hyperlinkIdByUserId("x") == b);
+
+    // Releasing the link that first used the user ID keeps the lookup of the newer one intact.
+    storage.collectGarbage([&](auto&& _markReferenced) { _markReferenced(b); });
+    CHECK(!storage.hyperlinkById(a));
+    CHECK(storage.hyperlinkIdByUserId("x") == b);
+
+    for (int i = 0; i < 64; ++i)
+        (void) storage.hyperlinkIdOf("y" + to_string(i), "https://example.com/y");
+    CHECK(storage.hyperlinkIdByUserId("x") == b);
+}
+
+TEST_CASE("HyperlinkStorage.needsGarbageCollection", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage {};
+
+    for (size_t i = 0; i < HyperlinkStorage::MinGarbageCollectionThreshold; ++i)
+        (void) storage.hyperlinkIdOf("", "https://example.com/" + to_string(i));
+
+    CHECK(storage.needsGarbageCollection());
+
+    // Everything is still referenced, so nothing gets released and the threshold grows.
+    storage.collectGarbage([&](auto&& _markReferenced) {
+        for (size_t i = 1; i <= HyperlinkStorage::MinGarbageCollectionThreshold; ++i)
+            _markReferenced(HyperlinkId(static_cast<uint16_t>(i)));
+    });
+    CHECK(storage.size() == HyperlinkStorage::MinGarbageCollectionThreshold);
+    CHECK(!storage.needsGarbageCollection());
+}
+
+TEST_CASE("HyperlinkStorage.anonymous", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage {};
+
+    // Links without an ID are separate links, even if they point to the same URI.
+    auto const a = storage.hyperlinkIdOf("", "file:///tmp/a");
+    auto const b = storage.hyperlinkIdOf("", "file:///tmp/a");
+    REQUIRE(!!a);
+    REQUIRE(!!b);
+    CHECK(a != b);
+    CHECK(storage.size() == 2);
+    CHECK(!storage.hyperlinkIdByUserId(""));
+
+    storage.collectGarbage([&](auto&& _markReferenced) { _markReferenced(b); });
+    CHECK(!storage.hyperlinkById(a));
+    REQUIRE(storage.hyperlinkById(b));
+    CHECK(storage.hyperlinkById(b)->uri == "file:///tmp/a");
+    CHECK(storage.size() == 1);
+}
+
+TEST_CASE("HyperlinkStorage.garbageCollectionBackoff", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage {};
+
+    // Fill the storage up to its capacity, with every link still being referenced.
+    auto const collectNothing = [&]() {
+        storage.collectGarbage([&](auto&& _markReferenced) {
+            for (size_t i = 1; i <= HyperlinkStorage::MaxHyperlinkCount; ++i)
+                _markReferenced(HyperlinkId(static_cast<uint16_t>(i)));
+        });
+    };
+    for (size_t i = 0; i < HyperlinkStorage::MaxHyperlinkCount; ++i)
+    {
+        if (storage.needsGarbageCollection())
+            collectNothing();
+        (void) storage.hyperlinkIdOf("", "https://example.com/");
+    }
+    REQUIRE(storage.size() == HyperlinkStorage::MaxHyperlinkCount);
+    collectNothing();
+
+    // A collection that freed nothing is not repeated for every further link.
+    for (size_t i = 1; i < HyperlinkStorage::MinGarbageCollectionThreshold; ++i)
+    {
+        CHECK(!storage.hyperlinkIdOf("", "https://example.com/"));
+        REQUIRE(!storage.needsGarbageCollection());
+    }
+    CHECK(!storage.hyperlinkIdOf("", "https://example.com/"));
+    CHECK(storage.needsGarbageCollection());
+
+    // Once links are released again, their IDs are reused.
+    storage.collectGarbage([](auto&&) {});
+    CHECK(storage.size() == 0);
+    CHECK(!!storage.hyperlinkIdOf("", "https://example.com/"));
+}
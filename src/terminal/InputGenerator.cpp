@@ -29,6 +29,10 @@
 #include <unordered_map>
 #include <utility>
 
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace terminal
@@ -289,6 +293,7 @@ void InputGenerator::reset()
     mouseProtocol_ = std::nullopt;
     mouseTransport_ = MouseTransport::Default;
     mouseWheelMode_ = MouseWheelMode::Default;
+    pendingMouseReport_.reset();
 
     // pendingSequence_ = {};
     // currentlyPressedMouseButtons_ = {};
@@ -400,37 +405,169 @@ bool InputGenerator::generate(Key _key, Modifier _modifier)
     return false;
 }
 
-void InputGenerator::generatePaste(std::string_view const& _text)
+namespace
+{
+    constexpr auto BracketedPasteStart = "\033[200~"sv;
+    constexpr auto BracketedPasteEnd = "\033[201~"sv;
+
+    // C1 control characters U+0080..U+009F are encoded as C2 80..C2 9F in UTF-8.
+    constexpr auto C1Lead = static_cast<char>(0xC2);
+
+    /// Returns whether the given byte may need to be altered when pasting.
+    constexpr bool isSpecialPasteByte(char _byte) noexcept
+    {
+        return static_cast<unsigned char>(_byte) < 0x20 || _byte == 0x7F || _byte == C1Lead;
+    }
+
+    /// Finds the first byte starting at @p _i that may need to be altered when pasting.
+    size_t findSpecialPasteByte(string_view _text, size_t _i) noexcept
+    {
+#if defined(__SSE2__)
+        // Compares 16 bytes at once. Unsigned (byte < 0x20) is signed ((byte ^ 0x80) < (0x20 ^ 0x80)).
+        auto const signBit = _mm_set1_epi8(static_cast<char>(0x80));
+        auto const controlLimit = _mm_set1_epi8(static_cast<char>(0x20 ^ 0x80));
+        auto const del = _mm_set1_epi8(0x7F);
+        auto const c1Lead = _mm_set1_epi8(C1Lead);
+        for (; _i + 16 <= _text.size(); _i += 16)
+        {
+            auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(_text.data() + _i));
+            auto const matches =
+                _mm_or_si128(_mm_cmplt_epi8(_mm_xor_si128(bytes, signBit), controlLimit),
+                             _mm_or_si128(_mm_cmpeq_epi8(bytes, del), _mm_cmpeq_epi8(bytes, c1Lead)));
+            if (auto const mask = _mm_movemask_epi8(matches); mask != 0)
+                return _i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+#endif
+        while (_i < _text.size() && !isSpecialPasteByte(_text[_i]))
+            ++_i;
+        return _i;
+    }
+
+    /// Appends the sanitized @p _text to @p _output.
+    ///
+    /// Newlines (CR LF, LF) are normalized to CR, just like the Enter key sends,
+    /// and any other C0 or C1 control characters, but TAB, are dropped.
+    void appendSanitizedPaste(string_view _text, InputGenerator::Sequence& _output)
+    {
+        auto i = size_t { 0 };
+        while (i < _text.size())
+        {
+            auto const special = findSpecialPasteByte(_text, i);
+            _output.insert(_output.end(), _text.data() + i, _text.data() + special);
+            if (special == _text.size())
+                break;
+
+            i = special + 1;
+            switch (_text[special])
+            {
+                case '\t': _output.push_back('\t'); break;
+                case '\r':
+                    _output.push_back('\r');
+                    if (i < _text.size() && _text[i] == '\n')
+                        ++i;
+                    break;
+                case '\n': _output.push_back('\r'); break;
+                case C1Lead:
+                    if (i < _text.size() && static_cast<unsigned char>(_text[i]) >= 0x80
+                        && static_cast<unsigned char>(_text[i]) <= 0x9F)
+                        ++i;
+                    else
+                        _output.push_back(C1Lead);
+                    break;
+                default: break;
+            }
+        }
+    }
+} // namespace
+
+void InputGenerator::generatePaste(std::string _text)
 {
     InputLog()("Sending paste of {} bytes.", _text.size());
 
     if (_text.empty())
         return;
 
-    if (bracketedPaste_)
-        append("\033[200~"sv);
+    if (pasteInProgress())
+    {
+        pasteText_ += _text;
+        return;
+    }
+
+    pasteText_ = std::move(_text);
+    pasteOffset_ = 0;
+    pasteBracketed_ = bracketedPaste_;
+
+    if (pasteBracketed_)
+        pendingSequence_.insert(pendingSequence_.end(), begin(BracketedPasteStart), end(BracketedPasteStart));
 
-    append(_text);
+    continuePaste();
+}
+
+void InputGenerator::continuePaste()
+{
+    // Never split CR LF or a two-byte C1 control character across chunks.
+    auto chunkEnd = std::min(pasteOffset_ + PasteChunkSize, pasteText_.size());
+    if (chunkEnd < pasteText_.size())
+        if (auto const last = pasteText_[chunkEnd - 1]; last == '\r' || last == C1Lead)
+            ++chunkEnd;
+
+    pasteChunkStart_ = pendingSequence_.size();
+    appendSanitizedPaste(string_view(pasteText_).substr(pasteOffset_, chunkEnd - pasteOffset_),
+                         pendingSequence_);
+    pasteOffset_ = chunkEnd;
+
+    if (pasteOffset_ == pasteText_.size())
+        finishPaste();
+}
+
+void InputGenerator::finishPaste()
+{
+    if (pasteBracketed_)
+        pendingSequence_.insert(pendingSequence_.end(), begin(BracketedPasteEnd), end(BracketedPasteEnd));
+
+    pendingSequence_.insert(pendingSequence_.end(), inputAfterPaste_.begin(), inputAfterPaste_.end());
+    inputAfterPaste_.clear();
 
-    if (bracketedPaste_)
-        append("\033[201~"sv);
+    // Release the memory of a potentially huge paste.
+    pasteText_ = std::string {};
+    pasteOffset_ = 0;
+}
+
+std::optional<InputGenerator::PasteProgress> InputGenerator::pasteProgress() const noexcept
+{
+    if (!pasteInProgress())
+        return std::nullopt;
+
+    return PasteProgress { pasteOffset_, pasteText_.size() };
+}
+
+void InputGenerator::cancelPaste()
+{
+    if (!pasteInProgress())
+        return;
+
+    InputLog()("Cancelling paste after {} of {} bytes.", pasteOffset_, pasteText_.size());
+
+    // The queued chunk is always at the end of the pending sequence.
+    pendingSequence_.resize(std::max(pasteChunkStart_, static_cast<size_t>(consumedBytes_)));
+    finishPaste();
 }
 
 inline bool InputGenerator::append(std::string_view _sequence)
 {
-    pendingSequence_.insert(end(pendingSequence_), begin(_sequence), end(_sequence));
+    output().insert(end(output()), begin(_sequence), end(_sequence));
     return true;
 }
 
 inline bool InputGenerator::append(char _asciiChar)
 {
-    pendingSequence_.push_back(_asciiChar);
+    output().push_back(_asciiChar);
     return true;
 }
 
 inline bool InputGenerator::append(uint8_t _byte)
 {
-    pendingSequence_.push_back(static_cast<char>(_byte));
+    output().push_back(static_cast<char>(_byte));
     return true;
 }
 
@@ -712,21 +849,37 @@ bool InputGenerator::generateMousePress(Modifier _modifier,
     if (!mouseProtocol_.has_value())
         return false;
 
+    auto const offset = pendingSequence_.size();
+    auto const wheelReport =
+        PendingMouseReport { MouseEventType::Press, _button, _modifier, _pos, _pixelPosition };
+
     switch (mouseWheelMode())
     {
         case MouseWheelMode::NormalCursorKeys:
             switch (_button)
             {
-                case MouseButton::WheelUp: return logged(append("\033[A"));
-                case MouseButton::WheelDown: return logged(append("\033[B"));
+                case MouseButton::WheelUp:
+                    append("\033[A");
+                    coalesceMouseReport(wheelReport, offset);
+                    return logged(true);
+                case MouseButton::WheelDown:
+                    append("\033[B");
+                    coalesceMouseReport(wheelReport, offset);
+                    return logged(true);
                 default: break;
             }
             break;
         case MouseWheelMode::ApplicationCursorKeys:
             switch (_button)
             {
-                case MouseButton::WheelUp: return logged(append("\033OA"));
-                case MouseButton::WheelDown: return logged(append("\033OB"));
+                case MouseButton::WheelUp:
+                    append("\033OA");
+                    coalesceMouseReport(wheelReport, offset);
+                    return logged(true);
+                case MouseButton::WheelDown:
+                    append("\033OB");
+                    coalesceMouseReport(wheelReport, offset);
+                    return logged(true);
                 default: break;
             }
             break;
@@ -734,11 +887,18 @@ bool InputGenerator::generateMousePress(Modifier _modifier,
     }
 
     if (!isMouseWheel(_button))
+    {
         if (!currentlyPressedMouseButtons_.count(_button))
             currentlyPressedMouseButtons_.insert(_button);
 
-    return logged(
-        generateMouse(MouseEventType::Press, _modifier, _button, currentMousePosition_, _pixelPosition));
+        return logged(
+            generateMouse(MouseEventType::Press, _modifier, _button, currentMousePosition_, _pixelPosition));
+    }
+
+    auto const success =
+        generateMouse(MouseEventType::Press, _modifier, _button, currentMousePosition_, _pixelPosition);
+    coalesceMouseReport(wheelReport, offset);
+    return logged(success);
 }
 
 bool InputGenerator::generateMouseRelease(Modifier _modifier,
@@ -786,16 +946,92 @@ bool InputGenerator::generateMouseMove(Modifier _modifier, CellLocation _pos, Pi
     bool const report = (mouseProtocol_.value() == MouseProtocol::ButtonTracking && buttonsPressed)
                         || mouseProtocol_.value() == MouseProtocol::AnyEventTracking;
 
-    if (report)
-        return logged(generateMouse(
-            MouseEventType::Drag,
-            _modifier,
-            buttonsPressed ? *currentlyPressedMouseButtons_.begin() // what if multiple are pressed?
-                           : MouseButton::Release,
-            _pos,
-            _pixelPosition));
+    if (!report)
+        return false;
 
-    return false;
+    // what if multiple are pressed?
+    auto const button = buttonsPressed ? *currentlyPressedMouseButtons_.begin() : MouseButton::Release;
+    auto const offset = pendingSequence_.size();
+    auto const success = generateMouse(MouseEventType::Drag, _modifier, button, _pos, _pixelPosition);
+    coalesceMouseReport(PendingMouseReport { MouseEventType::Drag, button, _modifier, _pos, _pixelPosition },
+                        offset);
+    return logged(success);
+}
+
+std::optional<InputGenerator::PendingMouseReport> InputGenerator::pendingMouseReport(
+    size_t _end) const noexcept
+{
+    // Only reports right before the given end, that were not even partially written
+    // to the application, can be altered.
+    if (!pendingMouseReport_ || pendingMouseReport_->offset < static_cast<size_t>(consumedBytes_)
+        || pendingMouseReport_->offset + pendingMouseReport_->length * pendingMouseReport_->count != _end)
+        return std::nullopt;
+
+    return pendingMouseReport_;
+}
+
+void InputGenerator::coalesceMouseReport(PendingMouseReport _report, size_t _offset)
+{
+    auto const reportEnd = pendingSequence_.size();
+    if (reportEnd == _offset)
+    {
+        // Nothing was reported, so the pending report(s), if any, remain coalescable.
+        return;
+    }
+    auto const pending = pendingMouseReport(_offset);
+    pendingMouseReport_.reset();
+
+    _report.offset = _offset;
+    _report.length = reportEnd - _offset;
+    _report.count = 1;
+
+    if (pending && pending->eventType == _report.eventType)
+    {
+        if (_report.eventType == MouseEventType::Drag)
+        {
+            // The application would only ever act on the latest mouse position.
+            auto const i = pendingSequence_.begin() + static_cast<long>(pending->offset);
+            pendingSequence_.erase(i, i + static_cast<long>(pending->length));
+            _report.offset = pending->offset;
+            ++coalescingMetrics_.mergedMouseMoves;
+            InputLog()("Merged mouse move into pending one ({} total).",
+                       coalescingMetrics_.mergedMouseMoves);
+        }
+        else if (pending->modifier == _report.modifier && pending->position == _report.position
+                 && pending->pixelPosition.x.value == _report.pixelPosition.x.value
+                 && pending->pixelPosition.y.value == _report.pixelPosition.y.value)
+        {
+            if (pending->button != _report.button)
+            {
+                // Scrolling back and forth before the application noticed it nets out to nothing.
+                pendingSequence_.resize(_offset - pending->length);
+                coalescingMetrics_.mergedWheelEvents += 2;
+                InputLog()("Cancelled out pending mouse wheel event ({} total).",
+                           coalescingMetrics_.mergedWheelEvents);
+                if (pending->count > 1)
+                {
+                    pendingMouseReport_ = pending;
+                    --pendingMouseReport_->count;
+                }
+                return;
+            }
+
+            if (pending->count >= MaxPendingWheelReports)
+            {
+                pendingSequence_.resize(_offset);
+                ++coalescingMetrics_.droppedWheelEvents;
+                InputLog()("Dropped mouse wheel event as the application did not catch up ({} total).",
+                           coalescingMetrics_.droppedWheelEvents);
+                pendingMouseReport_ = pending;
+                return;
+            }
+
+            _report.offset = pending->offset;
+            _report.count = pending->count + 1;
+        }
+    }
+
+    pendingMouseReport_ = _report;
 }
 // }}}
 
@@ -291,7 +291,14 @@ class InputGenerator
     bool generate(char32_t _characterEvent, Modifier _modifier);
     bool generate(std::u32string const& _characterEvent, Modifier _modifier);
     bool generate(Key _key, Modifier _modifier);
-    void generatePaste(std::string_view const& _text);
+
+    /// Sends the given text as a paste to the application.
+    ///
+    /// Control characters are stripped and newlines normalized to CR to protect against
+    /// paste injection. The text is sanitized and queued in chunks of PasteChunkSize as the
+    /// application reads its input, so that huge pastes do not pile up in the pending sequence.
+    /// Any other input generated meanwhile is sent after the paste.
+    void generatePaste(std::string _text);
     bool generateMousePress(Modifier _modifier,
                             MouseButton _button,
                             CellLocation _pos,
@@ -324,9 +331,42 @@ class InputGenerator
         {
             consumedBytes_ = 0;
             pendingSequence_.clear();
+            pendingMouseReport_.reset();
+            if (!pasteText_.empty())
+                continuePaste();
         }
     }
 
+    /// Number of bytes of a paste to sanitize and queue at once.
+    static constexpr size_t PasteChunkSize = 32 * 1024;
+
+    struct PasteProgress
+    {
+        size_t processed; //!< number of bytes of the pasted text queued so far
+        size_t total;     //!< total number of bytes of the pasted text
+    };
+
+    [[nodiscard]] bool pasteInProgress() const noexcept { return !pasteText_.empty(); }
+    [[nodiscard]] std::optional<PasteProgress> pasteProgress() const noexcept;
+
+    /// Stops sending the paste in progress, if any, except for what was already sent.
+    void cancelPaste();
+
+    /// Maximum number of identical mouse wheel reports that may be pending to be sent
+    /// to the application. Any further ones are dropped until the application catches up.
+    static constexpr unsigned MaxPendingWheelReports = 8;
+
+    /// Counts mouse events that were not reported individually because the application
+    /// did not yet read the previous report they could be coalesced with.
+    struct CoalescingMetrics
+    {
+        uint64_t mergedMouseMoves = 0;   //!< motion reports superseded by a later position
+        uint64_t mergedWheelEvents = 0;  //!< wheel reports cancelled out by the opposite direction
+        uint64_t droppedWheelEvents = 0; //!< wheel reports exceeding MaxPendingWheelReports
+    };
+
+    [[nodiscard]] CoalescingMetrics const& coalescingMetrics() const noexcept { return coalescingMetrics_; }
+
     enum class MouseEventType
     {
         Press,
@@ -356,6 +396,32 @@ class InputGenerator
 
     bool mouseTransportURXVT(MouseEventType _type, uint8_t _button, uint8_t _modifier, CellLocation _pos);
 
+    /// Mouse report(s) at the end of the pending sequence, that the application did not yet
+    /// (partially) receive, and therefore can still be coalesced with the next mouse report.
+    struct PendingMouseReport
+    {
+        MouseEventType eventType; // Drag for motion reports, Press for wheel reports
+        MouseButton button;
+        Modifier modifier;
+        CellLocation position;
+        PixelCoordinate pixelPosition;
+        size_t offset = 0; // offset of the first report in pendingSequence_
+        size_t length = 0; // length of a single report
+        unsigned count = 0;
+    };
+
+    [[nodiscard]] std::optional<PendingMouseReport> pendingMouseReport(size_t _end) const noexcept;
+
+    void continuePaste();
+    void finishPaste();
+
+    /// Returns where generated input is queued, which is behind the paste if one is in progress.
+    [[nodiscard]] Sequence& output() noexcept
+    {
+        return pasteText_.empty() ? pendingSequence_ : inputAfterPaste_;
+    }
+    void coalesceMouseReport(PendingMouseReport _report, size_t _offset);
+
     inline bool append(std::string_view _sequence);
     inline bool append(char _asciiChar);
     inline bool append(uint8_t _byte);
@@ -372,6 +438,14 @@ class InputGenerator
     MouseWheelMode mouseWheelMode_ = MouseWheelMode::Default;
     Sequence pendingSequence_ {};
     int consumedBytes_ {};
+    std::optional<PendingMouseReport> pendingMouseReport_ {};
+    CoalescingMetrics coalescingMetrics_ {};
+
+    std::string pasteText_ {};    // text of the paste in progress
+    size_t pasteOffset_ = 0;      // offset into pasteText_ of the next chunk to queue
+    size_t pasteChunkStart_ = 0;  // offset into pendingSequence_ of the queued chunk
+    bool pasteBracketed_ = false; // whether the paste in progress is surrounded by markers
+    Sequence inputAfterPaste_ {}; // input generated while a paste is in progress
 
     std::set<MouseButton> currentlyPressedMouseButtons_ {};
     CellLocation currentMousePosition_ {}; // current mouse position
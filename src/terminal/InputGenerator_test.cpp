@@ -122,3 +122,146 @@ TEST_CASE("InputGenerator.all(Ctrl + A..Z)", "[terminal,input]")
         REQUIRE(escape(input.peek()) == escape(c0));
     }
 }
+
+namespace
+{
+using terminal::CellLocation;
+using terminal::ColumnOffset;
+using terminal::LineOffset;
+using terminal::MouseButton;
+using terminal::PixelCoordinate;
+
+constexpr CellLocation cell(int _line, int _column) noexcept
+{
+    return CellLocation { LineOffset(_line), ColumnOffset(_column) };
+}
+
+InputGenerator sgrMouseInput()
+{
+    auto input = InputGenerator {};
+    input.setMouseProtocol(terminal::MouseProtocol::AnyEventTracking, true);
+    input.setMouseTransport(terminal::MouseTransport::SGR);
+    return input;
+}
+} // namespace
+
+TEST_CASE("InputGenerator.coalesce.mouseMove", "[terminal,input]")
+{
+    auto input = sgrMouseInput();
+    input.generateMouseMove(Modifier::None, cell(0, 0), PixelCoordinate {});
+    input.generateMouseMove(Modifier::None, cell(1, 2), PixelCoordinate {});
+    input.generateMouseMove(Modifier::None, cell(3, 4), PixelCoordinate {});
+    CHECK(escape(input.peek()) == escape("\033[<35;5;4M"));
+    CHECK(input.coalescingMetrics().mergedMouseMoves == 2);
+
+    // Reports that were partially written to the application must be kept.
+    input.consume(2);
+    input.generateMouseMove(Modifier::None, cell(5, 6), PixelCoordinate {});
+    CHECK(escape(input.peek()) == escape("<35;5;4M\033[<35;7;6M"));
+
+    // Moves are not merged across other input.
+    input.generateRaw("x");
+    input.generateMouseMove(Modifier::None, cell(7, 8), PixelCoordinate {});
+    CHECK(escape(input.peek()) == escape("<35;5;4M\033[<35;7;6Mx\033[<35;9;8M"));
+    CHECK(input.coalescingMetrics().mergedMouseMoves == 2);
+
+    input.consume(static_cast<int>(input.peek().size()));
+    input.generateMouseMove(Modifier::None, cell(0, 0), PixelCoordinate {});
+    CHECK(escape(input.peek()) == escape("\033[<35;1;1M"));
+}
+
+TEST_CASE("InputGenerator.coalesce.mouseWheel", "[terminal,input]")
+{
+    auto input = sgrMouseInput();
+    auto const wheel = [&](MouseButton _button) {
+        input.generateMousePress(Modifier::None, _button, cell(0, 0), PixelCoordinate {});
+    };
+
+    // Scrolling back and forth cancels out.
+    wheel(MouseButton::WheelUp);
+    wheel(MouseButton::WheelUp);
+    wheel(MouseButton::WheelDown);
+    CHECK(escape(input.peek()) == escape("\033[<64;1;1M"));
+    CHECK(input.coalescingMetrics().mergedWheelEvents == 2);
+
+    wheel(MouseButton::WheelDown);
+    CHECK(input.peek().empty());
+    CHECK(input.coalescingMetrics().mergedWheelEvents == 4);
+
+    // Pending reports of the same direction are capped.
+    for (unsigned i = 0; i < InputGenerator::MaxPendingWheelReports + 3; ++i)
+        wheel(MouseButton::WheelDown);
+    auto expected = string {};
+    for (unsigned i = 0; i < InputGenerator::MaxPendingWheelReports; ++i)
+        expected += "\033[<65;1;1M";
+    CHECK(escape(input.peek()) == escape(expected));
+    CHECK(input.coalescingMetrics().droppedWheelEvents == 3);
+
+    // Once the application caught up, scrolling is reported again.
+    input.consume(static_cast<int>(input.peek().size()));
+    wheel(MouseButton::WheelUp);
+    CHECK(escape(input.peek()) == escape("\033[<64;1;1M"));
+}
+
+TEST_CASE("InputGenerator.coalesce.alternateScroll", "[terminal,input]")
+{
+    auto input = sgrMouseInput();
+    input.setMouseWheelMode(InputGenerator::MouseWheelMode::ApplicationCursorKeys);
+    input.generateMousePress(Modifier::None, MouseButton::WheelUp, cell(0, 0), PixelCoordinate {});
+    input.generateMousePress(Modifier::None, MouseButton::WheelUp, cell(0, 0), PixelCoordinate {});
+    input.generateMousePress(Modifier::None, MouseButton::WheelDown, cell(0, 0), PixelCoordinate {});
+    CHECK(escape(input.peek()) == escape("\033OA"));
+}
+
+TEST_CASE("InputGenerator.paste.sanitize", "[terminal,input]")
+{
+    auto input = InputGenerator {};
+    input.setBracketedPaste(true);
+    input.generatePaste("a\r\nb\nc\rd\te\033[201~\x03\x7F" "f\u0085gäĀ"s);
+    CHECK(escape(input.peek()) == escape("\033[200~a\rb\rc\rd\te[201~fgäĀ\033[201~"));
+    CHECK_FALSE(input.pasteInProgress());
+
+    // Longer text, exercising any vectorized scanning.
+    input.consume(static_cast<int>(input.peek().size()));
+    input.setBracketedPaste(false);
+    input.generatePaste("0123456789abcdef0123456789\x1b" "abcdef0123456789abcdef\n"s);
+    CHECK(escape(input.peek()) == escape("0123456789abcdef0123456789abcdef0123456789abcdef\r"));
+}
+
+TEST_CASE("InputGenerator.paste.chunked", "[terminal,input]")
+{
+    auto input = InputGenerator {};
+    input.setBracketedPaste(true);
+
+    // A CR LF pair right at the chunk boundary must not be split.
+    auto text = string(InputGenerator::PasteChunkSize - 1, 'x') + "\r\n" + string(10, 'y');
+    input.generatePaste(text);
+    REQUIRE(input.pasteInProgress());
+    CHECK(input.pasteProgress()->processed == InputGenerator::PasteChunkSize + 1);
+    CHECK(input.pasteProgress()->total == text.size());
+    CHECK(input.peek().size() == 6 + InputGenerator::PasteChunkSize);
+
+    // Input generated during the paste is sent after it.
+    input.generateRaw("REPLY"sv);
+    CHECK(input.peek().size() == 6 + InputGenerator::PasteChunkSize);
+
+    input.consume(static_cast<int>(input.peek().size()));
+    CHECK_FALSE(input.pasteInProgress());
+    CHECK(escape(input.peek()) == escape(string(10, 'y') + "\033[201~REPLY"));
+}
+
+TEST_CASE("InputGenerator.paste.cancel", "[terminal,input]")
+{
+    auto input = InputGenerator {};
+    input.setBracketedPaste(true);
+    input.generatePaste(string(3 * InputGenerator::PasteChunkSize, 'x'));
+    input.generateRaw("REPLY"sv);
+    input.consume(10);
+
+    input.cancelPaste();
+    CHECK_FALSE(input.pasteInProgress());
+    CHECK(escape(input.peek()) == escape("\033[201~REPLY"));
+
+    input.consume(static_cast<int>(input.peek().size()));
+    CHECK(input.peek().empty());
+}
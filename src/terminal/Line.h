@@ -119,6 +119,18 @@ class Line
             setBuffer(TrivialBuffer { size(), _attributes });
     }
 
+    /// Resets all cells just like reset(), but keeps the cells' storage if the line is inflated,
+    /// such that writing to it again does not need to allocate.
+    void clear(LineFlags _flags, GraphicsAttributes const& _attributes) noexcept
+    {
+        flags_ = static_cast<unsigned>(_flags);
+        if (isTrivialBuffer())
+            trivialBuffer().reset(_attributes);
+        else
+            for (Cell& cell: inflatedBuffer())
+                cell.reset(_attributes);
+    }
+
     void fill(LineFlags _flags,
               GraphicsAttributes const& _attributes,
               char32_t _codepoint,
@@ -305,7 +305,7 @@ void Parser<EventListener, TraceStateChanges>::handle(ActionClass _actionClass,
 
 #if defined(LIBTERMINAL_LOG_TRACE)
     if constexpr (TraceStateChanges)
-        if (VTTraceParserLog && _action != Action::Ignore && _action != Action::Undefined)
+        if (_action != Action::Ignore && _action != Action::Undefined && VTTraceParserLog)
             VTTraceParserLog()("handle: {} {} {} {}",
                                state_,
                                _actionClass,
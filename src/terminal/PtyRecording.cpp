@@ -0,0 +1,167 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/PtyRecording.h>
+
+#include <fmt/format.h>
+
+#include <stdexcept>
+
+using std::runtime_error;
+using std::string_view;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace terminal
+{
+
+namespace
+{
+    constexpr auto RecordingMagic = string_view("ctrec\x1A\n\0", 8);
+
+    // Recording layout:
+    //
+    //   magic, version (uint32), initial page size (lines, columns)
+    //   events: type (uint8), microseconds since the previous event, then either the
+    //           data (length prefixed) or the new page size (lines, columns).
+    //
+    // All integers but the version and event type are LEB128 encoded.
+
+    PageSize makePageSize(uint64_t _lines, uint64_t _columns)
+    {
+        if (!_lines || !_columns || _lines > 0xFFFF || _columns > 0xFFFF)
+            throw runtime_error("Invalid page size in PTY recording.");
+        return PageSize { LineCount::cast_from(_lines), ColumnCount::cast_from(_columns) };
+    }
+
+    void writePageSize(crispy::BinaryWriter& _writer, PageSize _pageSize)
+    {
+        _writer.writeVarUInt(unbox<uint64_t>(_pageSize.lines));
+        _writer.writeVarUInt(unbox<uint64_t>(_pageSize.columns));
+    }
+} // namespace
+
+PtyRecording loadPtyRecording(string_view _data)
+{
+    auto reader = crispy::BinaryReader(_data);
+    if (reader.remaining() < RecordingMagic.size() + sizeof(uint32_t)
+        || reader.readBytes(RecordingMagic.size()) != RecordingMagic)
+        throw runtime_error("Invalid PTY recording.");
+    if (auto const version = reader.read<uint32_t>(); version != PtyRecordingVersion)
+        throw runtime_error(fmt::format("Incompatible PTY recording version {}.", version));
+
+    auto recording = PtyRecording {};
+    auto time = microseconds(0);
+    auto const lines = reader.readVarUInt();
+    recording.pageSize = makePageSize(lines, reader.readVarUInt());
+
+    while (!reader.atEnd())
+    {
+        auto event = PtyEvent {};
+        event.type = static_cast<PtyEventType>(reader.read<uint8_t>());
+        if (event.type != PtyEventType::Output && event.type != PtyEventType::Input
+            && event.type != PtyEventType::Resize)
+            throw runtime_error("Invalid event type in PTY recording.");
+
+        auto newLines = uint64_t { 0 };
+        auto newColumns = uint64_t { 0 };
+        try
+        {
+            event.time = time + microseconds(reader.readVarUInt());
+            if (event.type == PtyEventType::Resize)
+            {
+                newLines = reader.readVarUInt();
+                newColumns = reader.readVarUInt();
+            }
+            else
+                event.data = reader.readStringView();
+        }
+        catch (runtime_error const&)
+        {
+            // A recorder that did not get to finish writing its last event leaves it cut off.
+            recording.truncated = true;
+            break;
+        }
+
+        if (event.type == PtyEventType::Resize)
+            event.pageSize = makePageSize(newLines, newColumns);
+
+        time = event.time;
+        recording.events.emplace_back(event);
+    }
+
+    return recording;
+}
+
+PtyRecorder::PtyRecorder(std::ostream& _output, PageSize _pageSize):
+    output_ { _output }, writer_ { _output }, lastEventTime_ { steady_clock::now() }
+{
+    writeHeader(_pageSize);
+}
+
+PtyRecorder::PtyRecorder(FileSystem::path const& _path, PageSize _pageSize):
+    file_ { _path.string(), std::ios::binary | std::ios::trunc },
+    output_ { file_ },
+    writer_ { file_ },
+    lastEventTime_ { steady_clock::now() }
+{
+    if (!file_.good())
+        throw runtime_error(fmt::format("Could not create PTY recording file {}.", _path.string()));
+
+    writeHeader(_pageSize);
+}
+
+PtyRecorder::~PtyRecorder()
+{
+    flush();
+}
+
+void PtyRecorder::writeHeader(PageSize _pageSize)
+{
+    writer_.writeBytes(RecordingMagic.data(), RecordingMagic.size());
+    writer_.write(PtyRecordingVersion);
+    writePageSize(writer_, _pageSize);
+}
+
+void PtyRecorder::writeEventHeader(PtyEventType _type)
+{
+    auto const now = steady_clock::now();
+    auto const elapsed = duration_cast<microseconds>(now - lastEventTime_);
+    lastEventTime_ = now;
+    writer_.write(static_cast<uint8_t>(_type));
+    writer_.writeVarUInt(static_cast<uint64_t>(elapsed.count()));
+}
+
+void PtyRecorder::record(PtyEventType _type, string_view _data)
+{
+    auto const _l = std::lock_guard { mutex_ };
+    writeEventHeader(_type);
+    writer_.writeString(_data);
+}
+
+void PtyRecorder::recordResize(PageSize _pageSize)
+{
+    auto const _l = std::lock_guard { mutex_ };
+    writeEventHeader(PtyEventType::Resize);
+    writePageSize(writer_, _pageSize);
+}
+
+void PtyRecorder::flush()
+{
+    auto const _l = std::lock_guard { mutex_ };
+    writer_.flush();
+    output_.flush();
+}
+
+} // namespace terminal
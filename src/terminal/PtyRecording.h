@@ -0,0 +1,108 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <terminal/primitives.h>
+
+#include <crispy/BinaryStream.h>
+#include <crispy/stdfs.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace terminal
+{
+
+/// Version of the binary PTY recording format.
+///
+/// This must be incremented whenever the recording's layout changes.
+constexpr uint32_t PtyRecordingVersion = 1;
+
+enum class PtyEventType : uint8_t
+{
+    Output = 1, //!< Bytes read from the PTY, i.e. written by the application.
+    Input = 2,  //!< Bytes written to the PTY, i.e. keyboard and mouse input or replies.
+    Resize = 3, //!< The terminal's page size changed.
+};
+
+struct PtyEvent
+{
+    std::chrono::microseconds time; //!< time since the start of the recording
+    PtyEventType type;
+    std::string_view data; //!< Output or Input bytes, pointing into the recording's memory.
+    PageSize pageSize;     //!< new page size of a Resize event
+};
+
+struct PtyRecording
+{
+    PageSize pageSize; //!< page size at the start of the recording
+    std::vector<PtyEvent> events;
+    bool truncated = false; //!< whether the last event was cut off, e.g. because the recorder crashed.
+};
+
+/**
+ * Loads a PTY recording as written by PtyRecorder.
+ *
+ * The events' data refer to @p _data, which must therefore outlive the returned recording.
+ *
+ * @throws std::runtime_error if the data is not a PTY recording of a compatible version.
+ */
+PtyRecording loadPtyRecording(std::string_view _data);
+
+/**
+ * Records the byte streams from and to the PTY, as well as resize events, into a compact
+ * binary file, along with the time at which they happened.
+ *
+ * Such recordings can be replayed via PtyReplay in order to reproduce real world
+ * workloads for performance regression tests.
+ *
+ * Events may be recorded from different threads.
+ */
+class PtyRecorder
+{
+  public:
+    PtyRecorder(std::ostream& _output, PageSize _pageSize);
+
+    /// @throws std::runtime_error if the file cannot be created.
+    PtyRecorder(FileSystem::path const& _path, PageSize _pageSize);
+
+    PtyRecorder(PtyRecorder const&) = delete;
+    PtyRecorder& operator=(PtyRecorder const&) = delete;
+    ~PtyRecorder();
+
+    void recordOutput(std::string_view _data) { record(PtyEventType::Output, _data); }
+    void recordInput(std::string_view _data) { record(PtyEventType::Input, _data); }
+    void recordResize(PageSize _pageSize);
+
+    /// Writes all recorded events to the output stream.
+    void flush();
+
+  private:
+    void writeHeader(PageSize _pageSize);
+    void record(PtyEventType _type, std::string_view _data);
+    void writeEventHeader(PtyEventType _type);
+
+    std::ofstream file_;
+    std::ostream& output_;
+    crispy::BinaryWriter writer_;
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point lastEventTime_;
+};
+
+} // namespace terminal
@@ -0,0 +1,139 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/MockTerm.h>
+#include <terminal/PtyRecording.h>
+#include <terminal/PtyReplay.h>
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace terminal;
+using namespace std::string_view_literals;
+
+TEST_CASE("PtyRecording.roundtrip", "[PtyRecording]")
+{
+    auto output = std::ostringstream {};
+    {
+        auto recorder = PtyRecorder(output, PageSize { LineCount(25), ColumnCount(80) });
+        recorder.recordOutput("Hello\r\n");
+        recorder.recordInput("\033[A");
+        recorder.recordResize(PageSize { LineCount(30), ColumnCount(100) });
+        recorder.recordOutput(std::string(300, 'x'));
+    }
+
+    auto const data = output.str();
+    auto const recording = loadPtyRecording(data);
+    CHECK(recording.pageSize == PageSize { LineCount(25), ColumnCount(80) });
+    CHECK_FALSE(recording.truncated);
+    REQUIRE(recording.events.size() == 4);
+
+    CHECK(recording.events[0].type == PtyEventType::Output);
+    CHECK(recording.events[0].data == "Hello\r\n");
+    CHECK(recording.events[1].type == PtyEventType::Input);
+    CHECK(recording.events[1].data == "\033[A");
+    CHECK(recording.events[2].type == PtyEventType::Resize);
+    CHECK(recording.events[2].pageSize == PageSize { LineCount(30), ColumnCount(100) });
+    CHECK(recording.events[3].type == PtyEventType::Output);
+    CHECK(recording.events[3].data == std::string(300, 'x'));
+
+    for (size_t i = 1; i < recording.events.size(); ++i)
+        CHECK(recording.events[i - 1].time <= recording.events[i].time);
+}
+
+TEST_CASE("PtyRecording.truncated", "[PtyRecording]")
+{
+    auto output = std::ostringstream {};
+    {
+        auto recorder = PtyRecorder(output, PageSize { LineCount(2), ColumnCount(10) });
+        recorder.recordOutput("ABC");
+        recorder.recordOutput("DEF");
+    }
+
+    auto data = output.str();
+    data.resize(data.size() - 1);
+
+    auto const recording = loadPtyRecording(data);
+    CHECK(recording.truncated);
+    REQUIRE(recording.events.size() == 1);
+    CHECK(recording.events[0].data == "ABC");
+}
+
+TEST_CASE("PtyRecording.invalid", "[PtyRecording]")
+{
+    CHECK_THROWS_AS(loadPtyRecording(""), std::runtime_error);
+    CHECK_THROWS_AS(loadPtyRecording("not a recording at all"), std::runtime_error);
+
+    auto output = std::ostringstream {};
+    {
+        auto recorder = PtyRecorder(output, PageSize { LineCount(2), ColumnCount(10) });
+    }
+    auto data = output.str();
+    data[8] = char(PtyRecordingVersion + 1); // version
+    CHECK_THROWS_AS(loadPtyRecording(data), std::runtime_error);
+}
+
+TEST_CASE("PtyRecording.terminal", "[PtyRecording]")
+{
+    auto output = std::ostringstream {};
+    auto mock = MockTerm { PageSize { LineCount(2), ColumnCount(10) } };
+    mock.terminal.setPtyRecorder(std::make_unique<PtyRecorder>(output, mock.terminal.pageSize()));
+
+    mock.writeToScreen("Hello");
+    mock.terminal.resizeScreen(PageSize { LineCount(3), ColumnCount(10) });
+    mock.writeToScreen("\r\n\033[c");
+    mock.terminal.flushInput();
+    mock.terminal.setPtyRecorder(nullptr);
+
+    auto const data = output.str();
+    auto const recording = loadPtyRecording(data);
+    CHECK(recording.pageSize == PageSize { LineCount(2), ColumnCount(10) });
+    REQUIRE(recording.events.size() == 4);
+    CHECK(recording.events[0].type == PtyEventType::Output);
+    CHECK(recording.events[0].data == "Hello");
+    CHECK(recording.events[1].type == PtyEventType::Resize);
+    CHECK(recording.events[1].pageSize == PageSize { LineCount(3), ColumnCount(10) });
+    CHECK(recording.events[2].type == PtyEventType::Output);
+    CHECK(recording.events[2].data == "\r\n\033[c");
+    CHECK(recording.events[3].type == PtyEventType::Input);
+    CHECK(recording.events[3].data == mock.mockPty().stdinBuffer());
+}
+
+TEST_CASE("PtyReplay.run", "[PtyRecording]")
+{
+    auto output = std::ostringstream {};
+    {
+        auto recorder = PtyRecorder(output, PageSize { LineCount(2), ColumnCount(5) });
+        recorder.recordOutput("12345");
+        recorder.recordResize(PageSize { LineCount(3), ColumnCount(5) });
+        recorder.recordOutput("\r\nABC\033[c");
+        recorder.recordInput("\033[?64c");
+        recorder.recordOutput("\r\nXYZ");
+    }
+
+    auto const data = output.str();
+    auto const recording = loadPtyRecording(data);
+    auto replay = PtyReplay(recording, LineCount(10));
+    auto const stats = replay.run();
+
+    CHECK(replay.terminal().pageSize() == PageSize { LineCount(3), ColumnCount(5) });
+    CHECK(replay.terminal().primaryScreen().renderMainPageText() == "12345\nABC  \nXYZ  \n");
+    CHECK(stats.outputBytes == 5 + 8 + 5);
+    CHECK(stats.outputChunks == 3);
+    CHECK(stats.inputBytes == 6);
+    CHECK(stats.resizes == 1);
+    CHECK(stats.frames >= 1);
+}
@@ -0,0 +1,111 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/PtyReplay.h>
+
+#include <thread>
+
+#if !defined(_WIN32)
+    #include <sys/resource.h>
+#endif
+
+using std::chrono::steady_clock;
+
+namespace terminal
+{
+
+namespace
+{
+    size_t peakResidentSetSize()
+    {
+#if defined(_WIN32)
+        return 0;
+#else
+        auto usage = rusage {};
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+    #if defined(__APPLE__)
+        return static_cast<size_t>(usage.ru_maxrss); // in bytes
+    #else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024; // in kilobytes
+    #endif
+#endif
+    }
+} // namespace
+
+PtyReplay::PtyReplay(PtyRecording const& _recording, LineCount _maxHistoryLineCount):
+    recording_ { _recording }, mock_ { _recording.pageSize, _maxHistoryLineCount }
+{
+}
+
+void PtyReplay::buildFrame(PtyReplayStats& _stats)
+{
+    auto const start = steady_clock::now();
+    mock_.terminal.refreshRenderBuffer();
+    _stats.frameBuildTime += steady_clock::now() - start;
+    ++_stats.frames;
+}
+
+PtyReplayStats PtyReplay::run(PtyReplayOptions const& _options)
+{
+    auto stats = PtyReplayStats {};
+    auto& pty = mock_.mockPty();
+    auto const startTime = steady_clock::now();
+    auto lastFrameTime = std::chrono::microseconds(0);
+
+    for (PtyEvent const& event: recording_.events)
+    {
+        if (_options.realTime)
+            std::this_thread::sleep_until(startTime + event.time);
+
+        switch (event.type)
+        {
+            case PtyEventType::Output: {
+                stats.outputBytes += event.data.size();
+                ++stats.outputChunks;
+                auto const start = steady_clock::now();
+                pty.setReadData(event.data);
+                while (!pty.stdoutBuffer().empty())
+                    mock_.terminal.processInputOnce();
+                stats.parseTime += steady_clock::now() - start;
+                break;
+            }
+            case PtyEventType::Input:
+                // Input is recorded for reference only, as the application's reaction to it
+                // is part of the recorded output already.
+                stats.inputBytes += event.data.size();
+                break;
+            case PtyEventType::Resize:
+                mock_.terminal.resizeScreen(event.pageSize);
+                ++stats.resizes;
+                break;
+        }
+
+        // Replies to queries would otherwise pile up, as there is no application to read them.
+        pty.stdinBuffer().clear();
+
+        if (event.time - lastFrameTime >= _options.frameInterval)
+        {
+            buildFrame(stats);
+            lastFrameTime = event.time;
+        }
+    }
+
+    buildFrame(stats);
+
+    stats.totalTime = steady_clock::now() - startTime;
+    stats.peakMemory = peakResidentSetSize();
+    return stats;
+}
+
+} // namespace terminal
@@ -0,0 +1,73 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <terminal/MockTerm.h>
+#include <terminal/PtyRecording.h>
+#include <terminal/pty/MockViewPty.h>
+
+#include <chrono>
+#include <cstddef>
+
+namespace terminal
+{
+
+struct PtyReplayOptions
+{
+    /// Whether to feed the events at the recorded speed rather than as fast as possible.
+    bool realTime = false;
+
+    /// Recorded time that needs to pass before the next frame is built, i.e. the display's refresh interval.
+    std::chrono::microseconds frameInterval = std::chrono::microseconds(1'000'000 / 60);
+};
+
+struct PtyReplayStats
+{
+    size_t outputBytes = 0;
+    size_t outputChunks = 0;
+    size_t inputBytes = 0;
+    size_t resizes = 0;
+    size_t frames = 0;
+
+    std::chrono::nanoseconds parseTime {};      //!< time spent processing the PTY output
+    std::chrono::nanoseconds frameBuildTime {}; //!< time spent building render buffers
+    std::chrono::nanoseconds totalTime {};      //!< wall clock time of the whole replay
+
+    size_t peakMemory = 0; //!< peak resident set size of the process in bytes, or 0 if unknown
+};
+
+/**
+ * Replays a PTY recording into a terminal without any PTY or display attached.
+ *
+ * The recorded output is processed just like it would be read from a PTY,
+ * and a render buffer is built whenever a frame interval of recorded time passed,
+ * which makes real world workloads usable as deterministic performance regression tests.
+ */
+class PtyReplay
+{
+  public:
+    PtyReplay(PtyRecording const& _recording, LineCount _maxHistoryLineCount);
+
+    PtyReplayStats run(PtyReplayOptions const& _options = {});
+
+    Terminal& terminal() noexcept { return mock_.terminal; }
+
+  private:
+    void buildFrame(PtyReplayStats& _stats);
+
+    PtyRecording const& recording_;
+    MockTerm<MockViewPty> mock_;
+};
+
+} // namespace terminal
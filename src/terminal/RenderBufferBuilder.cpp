@@ -84,6 +84,12 @@ RenderBufferBuilder<Cell>::RenderBufferBuilder(Terminal const& _terminal, Render
     output.clear();
     output.frameID = _terminal.lastFrameID();
     output.cursor = renderCursor();
+
+    // Both are only looked up when there is something to show, as this happens for every frame.
+    if (_terminal.isMouseHoveringHyperlink())
+        hoveredUrl = _terminal.hoveringDetectedUrl();
+    if (_terminal.urlHintsMode())
+        urlHints = _terminal.urlHints();
 }
 
 template <typename Cell>
@@ -186,7 +192,9 @@ std::tuple<RGBColor, RGBColor> RenderBufferBuilder<Cell>::makeColorsForCell(Cell
             && output.cursor->shape == CursorShape::Block;
     // clang-format on
 
-    auto const selected = terminal.isSelected(CellLocation { gridPosition.line, gridPosition.column });
+    auto const selected =
+        selectedColumns
+        && crispy::ascending(selectedColumns->fromColumn, gridPosition.column, selectedColumns->toColumn);
 
     return makeColors(terminal.colorPalette(),
                       cellFlags,
@@ -207,6 +215,8 @@ void RenderBufferBuilder<Cell>::renderTrivialLine(TriviallyStyledLineBuffer cons
     //            lineBuffer.displayWidth,
     //            lineBuffer.text.view());
 
+    updateSelectedColumns(lineOffset);
+
     auto const frontIndex = output.screen.size();
 
     auto const textMargin = min(boxed_cast<ColumnOffset>(terminal.pageSize().columns),
@@ -234,6 +244,7 @@ void RenderBufferBuilder<Cell>::renderTrivialLine(TriviallyStyledLineBuffer cons
                                                           lineBuffer.attributes.underlineColor,
                                                           lineOffset,
                                                           columnOffset));
+        decorateDetectedUrls(output.screen.back(), gridPosition);
     }
 
     for (auto columnOffset = textMargin; columnOffset < pageColumnsEnd; ++columnOffset)
@@ -268,6 +279,40 @@ void RenderBufferBuilder<Cell>::startLine(LineOffset _line) noexcept
     lineNr = _line;
     prevWidth = 0;
     prevHasCursor = false;
+    updateSelectedColumns(_line);
+}
+
+template <typename Cell>
+void RenderBufferBuilder<Cell>::updateSelectedColumns(LineOffset _line) noexcept
+{
+    auto const gridLine =
+        terminal.viewport().translateScreenToGridCoordinate(CellLocation { _line, ColumnOffset(0) }).line;
+    selectedColumns = terminal.selectionRangeAt(gridLine);
+}
+
+template <typename Cell>
+void RenderBufferBuilder<Cell>::decorateDetectedUrls(RenderCell& _cell, CellLocation _gridPosition) const
+{
+    if (!hoveredUrl && urlHints.empty())
+        return;
+
+    if (hoveredUrl && hoveredUrl->contains(_gridPosition))
+    {
+        _cell.flags |= CellFlags::Underline;
+        _cell.decorationColor = terminal.colorPalette().hyperlinkDecoration.hover;
+    }
+
+    for (size_t i = 0; i < urlHints.size(); ++i)
+    {
+        if (urlHints[i].line != _gridPosition.line || urlHints[i].from != _gridPosition.column)
+            continue;
+
+        _cell.codepoints.clear();
+        _cell.codepoints.push_back(static_cast<char32_t>(Terminal::UrlHintLabels[i]));
+        std::swap(_cell.foregroundColor, _cell.backgroundColor);
+        _cell.flags |= CellFlags::Bold;
+        break;
+    }
 }
 
 template <typename Cell>
@@ -306,6 +351,7 @@ void RenderBufferBuilder<Cell>::renderCell(Cell const& screenCell, LineOffset _l
                                                           bg,
                                                           _line,
                                                           _column));
+                decorateDetectedUrls(output.screen.back(), gridPosition);
                 output.screen.back().groupStart = true;
             }
             break;
@@ -324,6 +370,7 @@ void RenderBufferBuilder<Cell>::renderCell(Cell const& screenCell, LineOffset _l
                                                           bg,
                                                           _line,
                                                           _column));
+                decorateDetectedUrls(output.screen.back(), gridPosition);
 
                 if (isNewLine)
                     output.screen.back().groupStart = true;
@@ -44,6 +44,14 @@ class RenderBufferBuilder
   private:
     std::optional<RenderCursor> renderCursor() const;
 
+    /// Fetches the selected column interval for the given screen line,
+    /// to be applied to every cell rendered on that line.
+    void updateSelectedColumns(LineOffset _line) noexcept;
+
+    /// Underlines the hovered URL that was detected in the plain text, and
+    /// overlays the hint labels while in URL hints mode.
+    void decorateDetectedUrls(RenderCell& _cell, CellLocation _gridPosition) const;
+
     static RenderCell makeRenderCellExplicit(ColorPalette const& _colorPalette,
                                              char32_t codepoint,
                                              CellFlags flags,
@@ -84,6 +92,9 @@ class RenderBufferBuilder
     State state = State::Gap;
     LineOffset lineNr = LineOffset(0);
     bool isNewLine = false;
+    std::optional<Selection::Range> selectedColumns = std::nullopt;
+    std::optional<DetectedUrl> hoveredUrl = std::nullopt;
+    std::vector<DetectedUrl> urlHints {};
 };
 
 } // namespace terminal
@@ -88,11 +88,6 @@ namespace terminal
 
 auto constexpr inline TabWidth = ColumnCount(8);
 
-auto const inline VTCaptureBufferLog = logstore::Category("vt.ext.capturebuffer",
-                                                          "Capture Buffer debug logging.",
-                                                          logstore::Category::State::Disabled,
-                                                          logstore::Category::Visibility::Hidden);
-
 namespace // {{{ helper
 {
     std::string vtSequenceParameterString(GraphicsAttributes const& _sgr)
@@ -211,6 +206,24 @@ namespace // {{{ helper
         return v;
     }
 
+    /// Invokes @p _visit with the HyperlinkId of every line and cell in the grid, including history.
+    template <typename Cell, typename Visitor>
+    void visitHyperlinks(Grid<Cell> const& _grid, Visitor&& _visit)
+    {
+        auto const top = -boxed_cast<LineOffset>(_grid.historyLineCount());
+        auto const bottom = boxed_cast<LineOffset>(_grid.pageSize().lines);
+        for (auto line = top; line < bottom; ++line)
+        {
+            Line<Cell> const& lineBuffer = _grid.lineAt(line);
+            if (lineBuffer.isTrivialBuffer())
+                _visit(lineBuffer.trivialBuffer().hyperlink);
+            else
+                for (Cell const& cell: lineBuffer.cells())
+                    if (auto const id = cell.hyperlink(); !!id)
+                        _visit(id);
+        }
+    }
+
     // optional<CharsetTable> getCharsetTableForCode(std::string const& _intermediate)
     // {
     //     if (_intermediate.size() != 1)
@@ -414,7 +427,7 @@ void Screen<Cell, TheScreenType>::writeText(string_view _chars)
 #endif
 
     for (char const ch: _chars)
-        writeText(static_cast<char32_t>(ch));
+        writeTextUntraced(static_cast<char32_t>(ch));
 }
 
 template <typename Cell, ScreenType TheScreenType>
@@ -437,6 +450,12 @@ void Screen<Cell, TheScreenType>::writeText(char32_t _char)
         VTTraceSequenceLog()("text: \"{}\"", unicode::convert_to<char>(_char));
 #endif
 
+    writeTextUntraced(_char);
+}
+
+template <typename Cell, ScreenType TheScreenType>
+void Screen<Cell, TheScreenType>::writeTextUntraced(char32_t _char)
+{
     crlfIfWrapPending();
 
     char32_t const codepoint = _state.cursor.charsets.map(_char);
@@ -546,18 +565,24 @@ void Screen<Cell, TheScreenType>::clearAndAdvance(int _graphemeClusterWidth) noe
 template <typename Cell, ScreenType TheScreenType>
 std::string Screen<Cell, TheScreenType>::screenshot(function<string(LineOffset)> const& _postLine) const
 {
-    auto result = std::stringstream {};
+    auto result = string {};
     auto writer = VTWriter(result);
 
     for (int const line: ranges::views::iota(0, *_state.pageSize.lines))
     {
         writer.write(grid().lineAt(LineOffset(line)));
         if (_postLine)
+        {
+            writer.setGraphicsAttributes({});
             writer.write(_postLine(LineOffset(line)));
+        }
         writer.crlf();
     }
 
-    return result.str();
+    writer.setGraphicsAttributes({});
+    writer.flush();
+
+    return result;
 }
 
 template <typename Cell, ScreenType TheScreenType>
@@ -571,11 +596,7 @@ optional<LineOffset> Screen<Cell, TheScreenType>::findMarkerUpwards(LineOffset _
 
     _startLine = min(_startLine, boxed_cast<LineOffset>(_state.pageSize.lines - 1));
 
-    for (LineOffset i = _startLine - 1; i >= -boxed_cast<LineOffset>(historyLineCount()); --i)
-        if (grid().lineAt(i).marked())
-            return { i };
-
-    return nullopt;
+    return grid().findMarkerUpwards(_startLine);
 }
 
 template <typename Cell, ScreenType TheScreenType>
@@ -590,13 +611,33 @@ optional<LineOffset> Screen<Cell, TheScreenType>::findMarkerDownwards(LineOffset
 
     auto const bottom = LineOffset(0);
 
-    for (LineOffset i = top + 1; i <= bottom; ++i)
-        if (grid().lineAt(i).marked())
-            return { i };
+    auto const marker = grid().findMarkerDownwards(top);
+    if (marker && *marker <= bottom)
+        return marker;
 
     return nullopt;
 }
 
+template <typename Cell, ScreenType TheScreenType>
+vector<Range> Screen<Cell, TheScreenType>::commandBlocks() const
+{
+    if (_state.screenType != ScreenType::Primary)
+        return {};
+
+    auto const markers = grid().markers();
+    auto const lastLine = _state.cursor.position.line;
+
+    vector<Range> blocks;
+    blocks.reserve(markers.size());
+    for (size_t i = 0; i < markers.size() && markers[i] <= lastLine; ++i)
+    {
+        auto const top = markers[i];
+        auto const bottom = i + 1 < markers.size() ? min(markers[i + 1] - 1, lastLine) : lastLine;
+        blocks.emplace_back(Range { From { *top }, To { *bottom } });
+    }
+    return blocks;
+}
+
 // {{{ tabs related
 template <typename Cell, ScreenType TheScreenType>
 void Screen<Cell, TheScreenType>::clearAllTabs()
@@ -1131,19 +1172,23 @@ template <typename Cell, ScreenType TheScreenType>
 void Screen<Cell, TheScreenType>::hyperlink(string _id, string _uri)
 {
     if (_uri.empty())
+    {
         _state.cursor.hyperlink = {};
-    else if (!_id.empty())
-        _state.cursor.hyperlink = _state.hyperlinks.hyperlinkIdByUserId(_id);
-    else
+        return;
+    }
+
+    if (_state.hyperlinks.needsGarbageCollection())
     {
-        _state.cursor.hyperlink = _state.hyperlinks.nextHyperlinkId++;
-        _state.hyperlinks.cache.emplace(_state.cursor.hyperlink,
-                                        make_shared<HyperlinkInfo>(HyperlinkInfo { move(_id), move(_uri) }));
+        _state.hyperlinks.collectGarbage([&](auto&& _markReferenced) {
+            _markReferenced(_state.cursor.hyperlink);
+            _markReferenced(_state.savedCursor.hyperlink);
+            _markReferenced(_state.savedPrimaryCursor.hyperlink);
+            visitHyperlinks(_state.primaryBuffer, _markReferenced);
+            visitHyperlinks(_state.alternateBuffer, _markReferenced);
+        });
     }
-    // TODO:
-    // Care about eviction.
-    // Move hyperlink store into ScreenBuffer, so it gets reset upon every switch into
-    // alternate screen (not for main screen!)
+
+    _state.cursor.hyperlink = _state.hyperlinks.hyperlinkIdOf(move(_id), move(_uri));
 }
 
 template <typename Cell, ScreenType TheScreenType>
@@ -1264,74 +1309,6 @@ void Screen<Cell, TheScreenType>::notify(string const& _title, string const& _co
     _terminal.notify(_title, _content);
 }
 
-template <typename Cell, ScreenType TheScreenType>
-void Screen<Cell, TheScreenType>::captureBuffer(LineCount _lineCount, bool _logicalLines)
-{
-    // TODO: Unit test case! (for ensuring line numbering and limits are working as expected)
-
-    auto capturedBuffer = std::string();
-
-    // TODO: when capturing _lineCount < screenSize.lines, start at the lowest non-empty line.
-    auto const relativeStartLine =
-        _logicalLines ? grid().computeLogicalLineNumberFromBottom(LineCount::cast_from(_lineCount))
-                      : unbox<int>(_state.pageSize.lines - _lineCount);
-    auto const startLine = LineOffset::cast_from(
-        clamp(relativeStartLine, -unbox<int>(historyLineCount()), unbox<int>(_state.pageSize.lines)));
-
-    VTCaptureBufferLog()("Capture buffer: {} lines {}", _lineCount, _logicalLines ? "logical" : "actual");
-
-    size_t constexpr MaxChunkSize = 4096;
-    size_t currentChunkSize = 0;
-    auto const pushContent = [&](auto const data) -> void {
-        if (data.empty())
-            return;
-        if (currentChunkSize == 0) // initiate chunk
-            _terminal.reply("\033^{};", CaptureBufferCode);
-        else if (currentChunkSize + data.size() >= MaxChunkSize)
-        {
-            VTCaptureBufferLog()("Transferred chunk of {} bytes.", currentChunkSize);
-            _terminal.reply("\033\\"); // ST
-            _terminal.reply("\033^{};", CaptureBufferCode);
-            currentChunkSize = 0;
-        }
-        _terminal.reply(data);
-        currentChunkSize += data.size();
-    };
-    LineOffset const bottomLine = boxed_cast<LineOffset>(_state.pageSize.lines - 1);
-    VTCaptureBufferLog()("Capturing buffer. top: {}, bottom: {}", relativeStartLine, bottomLine);
-
-    for (LineOffset line = startLine; line <= bottomLine; ++line)
-    {
-        if (_logicalLines && grid().lineAt(line).wrapped() && !capturedBuffer.empty())
-            capturedBuffer.pop_back();
-
-        auto const& lineBuffer = grid().lineAt(line);
-        auto lineCellsTrimmed = lineBuffer.trim_blank_right();
-        if (lineCellsTrimmed.empty())
-        {
-            VTCaptureBufferLog()("Skipping blank line {}", line);
-            continue;
-        }
-        auto const tl = lineCellsTrimmed.size();
-        while (!lineCellsTrimmed.empty())
-        {
-            auto const available = MaxChunkSize - currentChunkSize;
-            auto const n = min(available, lineCellsTrimmed.size());
-            for (auto const& cell: lineCellsTrimmed.subspan(0, n))
-                pushContent(cell.toUtf8());
-            lineCellsTrimmed = lineCellsTrimmed.subspan(n);
-        }
-        VTCaptureBufferLog()("NL ({} len)", tl);
-        pushContent("\n"sv);
-    }
-
-    if (currentChunkSize != 0)
-        _terminal.reply("\033\\"); // ST
-
-    VTCaptureBufferLog()("Capturing buffer finished.");
-    _terminal.reply("\033^{};\033\\", CaptureBufferCode); // mark the end
-}
-
 template <typename Cell, ScreenType TheScreenType>
 void Screen<Cell, TheScreenType>::cursorForwardTab(TabStopCount _count)
 {
@@ -1456,7 +1433,7 @@ void Screen<Cell, TheScreenType>::setGraphicsRendition(GraphicsRendition _rendit
 template <typename Cell, ScreenType TheScreenType>
 void Screen<Cell, TheScreenType>::setMark()
 {
-    currentLine().setMarked(true);
+    grid().markLine(_state.cursor.position.line);
 }
 
 template <typename Cell, ScreenType TheScreenType>
@@ -2698,6 +2675,29 @@ namespace impl
             return ApplyResult::Unsupported;
     }
 
+    template <typename Cell, ScreenType ST>
+    ApplyResult SEMANTICPROMPT(Sequence const& _seq, Screen<Cell, ST>& _screen)
+    {
+        // OSC 133 ; A ST   prompt start
+        // OSC 133 ; B ST   command start (end of prompt)
+        // OSC 133 ; C ST   command output start
+        // OSC 133 ; D [; exit code] ST   command end
+        //
+        // Only the prompt start is of interest, as it marks the line starting a command block.
+        auto const& value = _seq.intermediateCharacters();
+        if (value.empty())
+            return ApplyResult::Invalid;
+
+        switch (value[0])
+        {
+            case 'A': _screen.setMark(); return ApplyResult::Ok;
+            case 'B':
+            case 'C':
+            case 'D': return ApplyResult::Ok;
+            default: return ApplyResult::Unsupported;
+        }
+    }
+
     template <typename Cell, ScreenType ST>
     ApplyResult SETCWD(Sequence const& _seq, Screen<Cell, ST>& _screen)
     {
@@ -2708,13 +2708,17 @@ namespace impl
 
     ApplyResult CAPTURE(Sequence const& _seq, Terminal& terminal)
     {
-        // CSI Mode ; [; Count] t
+        // CSI Mode ; [; Count [; Format]] t
         //
         // Mode: 0 = physical lines
         //       1 = logical lines (unwrapped)
         //
         // Count: number of lines to capture from main page aera's bottom upwards
         //        If omitted or 0, the main page area's line count will be used.
+        //
+        // Format: 0 = plain text (default)
+        //         1 = text with SGR, base64 encoded
+        //         2 = JSON lines
 
         auto const logicalLines = _seq.param_or(0, 0);
         if (logicalLines != 0 && logicalLines != 1)
@@ -2722,7 +2726,11 @@ namespace impl
 
         auto const lineCount = LineCount(_seq.param_or(1, *terminal.pageSize().lines));
 
-        terminal.requestCaptureBuffer(lineCount, logicalLines);
+        auto const format = _seq.param_or(2, 0);
+        if (format > static_cast<int>(CaptureFormat::JsonLines))
+            return ApplyResult::Invalid;
+
+        terminal.requestCaptureBuffer(lineCount, logicalLines, static_cast<CaptureFormat>(format));
 
         return ApplyResult::Ok;
     }
@@ -3283,6 +3291,7 @@ ApplyResult Screen<Cell, TheScreenType>::apply(FunctionDefinition const& functio
         case RCOLORMOUSEBG: resetDynamicColor(DynamicColorName::MouseBackgroundColor); break;
         case RCOLORHIGHLIGHTFG: resetDynamicColor(DynamicColorName::HighlightForegroundColor); break;
         case RCOLORHIGHLIGHTBG: resetDynamicColor(DynamicColorName::HighlightBackgroundColor); break;
+        case SEMANTICPROMPT: return impl::SEMANTICPROMPT(seq, *this);
         case NOTIFY: return impl::NOTIFY(seq, *this);
         case DUMPSTATE: inspect(); break;
 
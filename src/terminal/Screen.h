@@ -194,8 +194,6 @@ class Screen: public ScreenBase, public capabilities::StaticDatabase
     void hyperlink(std::string _id, std::string _uri);                   // OSC 8
     void notify(std::string const& _title, std::string const& _content); // OSC 777
 
-    void captureBuffer(LineCount _lineCount, bool _logicalLines);
-
     void setForegroundColor(Color _color);
     void setBackgroundColor(Color _color);
     void setUnderlineColor(Color _color);
@@ -395,6 +393,10 @@ class Screen: public ScreenBase, public capabilities::StaticDatabase
     ///         in the screen area, and in the savedLines area otherwise.
     [[nodiscard]] std::optional<LineOffset> findMarkerUpwards(LineOffset _currentCursorLine) const;
 
+    /// Lists all command blocks, i.e. the line ranges starting at a marked (prompt) line
+    /// and ending right before the next marked line, or at the cursor line for the last one.
+    [[nodiscard]] std::vector<Range> commandBlocks() const;
+
     /// ScreenBuffer's type, such as main screen or alternate screen.
     [[nodiscard]] ScreenType bufferType() const noexcept { return _state.screenType; }
 
@@ -483,6 +485,9 @@ class Screen: public ScreenBase, public capabilities::StaticDatabase
     void fail(std::string const& _message) const override;
 
   private:
+    /// Writes a single codepoint without tracing it, e.g. as part of already traced text.
+    void writeTextUntraced(char32_t _char);
+
     std::string_view tryEmplaceChars(std::string_view chars) noexcept;
     std::string_view tryEmplaceContinuousChars(std::string_view chars) noexcept;
     size_t emplaceCharsIntoCurrentLine(std::string_view chars) noexcept;
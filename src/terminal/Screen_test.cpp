@@ -11,11 +11,13 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <terminal/CaptureBuffer.h>
 #include <terminal/MockTerm.h>
 #include <terminal/Screen.h>
 #include <terminal/Viewport.h>
 #include <terminal/primitives.h>
 
+#include <crispy/base64.h>
 #include <crispy/escape.h>
 #include <crispy/utils.h>
 
@@ -2452,51 +2454,70 @@ TEST_CASE("captureBuffer", "[screen]")
     //           [...      history ...  ...][main page area]
     mock.writeToScreen("12345\r\n67890\r\nABCDE\r\nFGHIJ\r\nKLMNO");
 
+    auto const capture = [&](LineCount _lineCount,
+                             CaptureFormat _format = CaptureFormat::Text,
+                             size_t _chunkSize = Terminal::CaptureChunkSize) {
+        auto output = string {};
+        encodeCapture(makeCaptureSnapshot(screen.grid(), _lineCount, false),
+                      _format,
+                      _chunkSize,
+                      [&](string_view _reply) { output += _reply; });
+        return output;
+    };
+
     SECTION("lines: 0")
     {
-        screen.captureBuffer(LineCount(0), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput()) == e("\033^314;\033\\"));
+        CHECK(e(capture(LineCount(0))) == e("\033^314;\033\\"));
     }
     SECTION("lines: 1")
     {
-        screen.captureBuffer(LineCount(1), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput()) == e("\033^314;KLMNO\n\033\\\033^314;\033\\"));
+        CHECK(e(capture(LineCount(1))) == e("\033^314;KLMNO\n\033\\\033^314;\033\\"));
     }
     SECTION("lines: 2")
     {
-        screen.captureBuffer(LineCount(2), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput()) == e("\033^314;FGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
+        CHECK(e(capture(LineCount(2))) == e("\033^314;FGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
     }
     SECTION("lines: 3")
     {
-        screen.captureBuffer(LineCount(3), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput()) == e("\033^314;ABCDE\nFGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
+        CHECK(e(capture(LineCount(3))) == e("\033^314;ABCDE\nFGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
     }
     SECTION("lines: 4")
     {
-        screen.captureBuffer(LineCount(4), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput())
+        CHECK(e(capture(LineCount(4)))
               == e("\033^314;67890\nABCDE\nFGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
     }
     SECTION("lines: 5")
     {
-        screen.captureBuffer(LineCount(5), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput())
+        CHECK(e(capture(LineCount(5)))
               == e("\033^314;12345\n67890\nABCDE\nFGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
     }
     SECTION("lines: 5 (+1 overflow)")
     {
-        screen.captureBuffer(LineCount(6), false);
-        INFO(e(mock.terminal.peekInput()));
-        CHECK(e(mock.terminal.peekInput())
+        CHECK(e(capture(LineCount(6)))
               == e("\033^314;12345\n67890\nABCDE\nFGHIJ\nKLMNO\n\033\\\033^314;\033\\"));
     }
+    SECTION("chunked")
+    {
+        CHECK(e(capture(LineCount(3), CaptureFormat::Text, 8))
+              == e("\033^314;ABCDE\nFGHIJ\n\033\\\033^314;KLMNO\n\033\\\033^314;\033\\"));
+    }
+    SECTION("JSON lines")
+    {
+        CHECK(e(capture(LineCount(2), CaptureFormat::JsonLines))
+              == e("\033^314;{\"line\":0,\"marked\":false,\"text\":\"FGHIJ\"}\n"
+                   "{\"line\":1,\"marked\":false,\"text\":\"KLMNO\"}\n\033\\\033^314;\033\\"));
+    }
+    SECTION("text with SGR")
+    {
+        mock.writeToScreen("\r\033[1;32mKL\033[m");
+        auto const output = capture(LineCount(1), CaptureFormat::TextWithSgr);
+        auto const prefix = "\033^314;"sv;
+        REQUIRE(output.substr(0, prefix.size()) == prefix);
+        auto const payloadEnd = output.find('\033', prefix.size());
+        auto const payload =
+            crispy::base64::decode(string_view(output).substr(prefix.size(), payloadEnd - prefix.size()));
+        CHECK(e(payload) == e("\033[1;32mKL\033[mMNO\n"));
+    }
 }
 
 TEST_CASE("render into history", "[screen]")
@@ -2927,6 +2948,46 @@ TEST_CASE("findMarkerUpwards", "[screen]")
     }
 }
 
+TEST_CASE("commandBlocks", "[screen]")
+{
+    auto mock = MockTerm { PageSize { LineCount(4), ColumnCount(10) }, LineCount(10) };
+    auto& screen = mock.terminal.primaryScreen();
+    CHECK(screen.commandBlocks().empty());
+
+    auto const checkBlocks = [&](std::vector<std::pair<int, int>> const& _expected) {
+        auto const blocks = mock.terminal.commandBlocks();
+        REQUIRE(blocks.size() == _expected.size());
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            INFO(fmt::format("block {}", i));
+            CHECK(blocks[i].from.value == _expected[i].first);
+            CHECK(blocks[i].to.value == _expected[i].second);
+        }
+    };
+
+    // Only the prompt start (A) marks a line, the other semantic prompt markers do not.
+    mock.writeToScreen("\033]133;A\033\\$ ls\033]133;B\033\\\r\n\033]133;C\033\\");
+    mock.writeToScreen("a b\r\n\033]133;D;0\033\\");
+    mock.writeToScreen("\033]133;A\033\\$ pwd\r\n");
+    mock.writeToScreen("/tmp");
+    CHECK(screen.grid().lineAt(LineOffset(0)).marked());
+    CHECK(!screen.grid().lineAt(LineOffset(1)).marked());
+    CHECK(screen.grid().lineAt(LineOffset(2)).marked());
+    CHECK(!screen.grid().lineAt(LineOffset(3)).marked());
+
+    // The last block ends at the cursor line.
+    checkBlocks({ { 0, 1 }, { 2, 3 } });
+
+    // Blocks scrolled into the history keep their extent.
+    mock.writeToScreen("\r\n\033]133;A\033\\$ \r\n");
+    REQUIRE(screen.historyLineCount() == LineCount(2));
+    checkBlocks({ { -2, -1 }, { 0, 1 }, { 2, 3 } });
+
+    // The alternate screen has no command blocks.
+    mock.writeToScreen("\033[?1049h");
+    CHECK(mock.terminal.alternateScreen().commandBlocks().empty());
+}
+
 TEST_CASE("DECTABSR", "[screen]")
 {
     auto mock = MockTerm { PageSize { LineCount(2), ColumnCount(35) } };
@@ -3318,6 +3379,50 @@ TEST_CASE("Screen.tcap.string", "[screen, tcap]")
     REQUIRE(e(mock.terminal.peekInput()) == e("\033P1+r687061=1B5B2569257031256447\033\\"));
 }
 
+TEST_CASE("Screen.Hyperlink.id", "[screen]")
+{
+    auto mock = MockTerm(PageSize { LineCount(2), ColumnCount(5) }, LineCount(2));
+    auto& screen = mock.terminal.primaryScreen();
+    mock.writeToScreen("\033]8;id=x;https://example.com/\033\\A");
+    mock.writeToScreen("\033]8;;\033\\B");
+    mock.writeToScreen("\033]8;id=x;https://example.com/\033\\C\033]8;;\033\\");
+
+    auto const a = screen.hyperlinkIdAt(CellLocation { LineOffset(0), ColumnOffset(0) });
+    auto const b = screen.hyperlinkIdAt(CellLocation { LineOffset(0), ColumnOffset(1) });
+    auto const c = screen.hyperlinkIdAt(CellLocation { LineOffset(0), ColumnOffset(2) });
+    REQUIRE(!!a);
+    CHECK(!b);
+    CHECK(a == c);
+
+    auto const link = screen.hyperlinkAt(CellLocation { LineOffset(0), ColumnOffset(0) });
+    REQUIRE(link);
+    CHECK(link->userId == "x");
+    CHECK(link->uri == "https://example.com/");
+}
+
+TEST_CASE("Screen.Hyperlink.anonymous", "[screen]")
+{
+    auto mock = MockTerm(PageSize { LineCount(2), ColumnCount(5) }, LineCount(2));
+    auto& screen = mock.terminal.primaryScreen();
+    mock.writeToScreen("\033]8;;https://example.com/\033\\AB\033]8;;\033\\ ");
+    mock.writeToScreen("\033]8;;https://example.com/\033\\C\033]8;;\033\\");
+
+    // Each occurrence of a link without an ID is a link on its own.
+    auto const a = screen.hyperlinkIdAt(CellLocation { LineOffset(0), ColumnOffset(0) });
+    auto const b = screen.hyperlinkIdAt(CellLocation { LineOffset(0), ColumnOffset(1) });
+    auto const c = screen.hyperlinkIdAt(CellLocation { LineOffset(0), ColumnOffset(3) });
+    REQUIRE(!!a);
+    REQUIRE(!!c);
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK(mock.terminal.state().hyperlinks.size() == 2);
+
+    // A hard reset releases all hyperlinks.
+    mock.writeToScreen("\033c");
+    CHECK(mock.terminal.state().hyperlinks.size() == 0);
+    CHECK(!screen.hyperlinkAt(CellLocation { LineOffset(0), ColumnOffset(0) }));
+}
+
 TEST_CASE("Sixel.simple", "[screen]")
 {
     auto const pageSize = PageSize { LineCount(10), ColumnCount(10) };
@@ -27,24 +27,6 @@ namespace terminal
 namespace // {{{ helper
 {
 
-    tuple<vector<Selection::Range>, CellLocation const, CellLocation const> prepare(
-        Selection const& _selection)
-    {
-        vector<Selection::Range> result;
-
-        auto const [from, to] = [&]() {
-            if (_selection.from() <= _selection.to())
-                return pair { _selection.from(), _selection.to() };
-            else
-                return pair { _selection.to(), _selection.from() };
-        }();
-
-        auto const numLines = to.line - from.line + 1;
-        result.resize(numLines.as<size_t>());
-
-        return { move(result), from, to };
-    }
-
     // Constructs a top-left and bottom-right coordinate-pair from given input.
     constexpr pair<CellLocation, CellLocation> orderedPoints(CellLocation a, CellLocation b) noexcept
     {
@@ -99,34 +81,33 @@ bool Selection::intersects(Rect _area) const noexcept
     return false;
 }
 
-std::vector<Selection::Range> Selection::ranges() const
+optional<Selection::Range> Selection::rangeAt(LineOffset _line) const noexcept
 {
-    auto [result, from, to] = prepare(*this);
-    auto const rightMargin = boxed_cast<ColumnOffset>(helper_.pageSize().columns - 1);
+    auto const [from, to] = from_ <= to_ ? pair { from_, to_ } : pair { to_, from_ };
+    if (_line < from.line || to.line < _line)
+        return nullopt;
 
-    switch (result.size())
-    {
-        case 1: result[0] = Range { from.line, from.column, min(to.column, rightMargin) }; break;
-        case 2:
-            // Render first line partial from selected column to end.
-            result[0] = Range { from.line, from.column, rightMargin };
-            // Render last (second) line partial from beginning to last selected column.
-            result[1] = Range { to.line, ColumnOffset(0), min(to.column, rightMargin) };
-            break;
-        default:
-            // Render first line partial from selected column to end.
-            result[0] = Range { from.line, from.column, rightMargin };
-
-            // Render inner full.
-            for (size_t n = 1; n < result.size(); ++n)
-                result[n] = Range { from.line + LineOffset::cast_from(n), ColumnOffset(0), rightMargin };
+    auto const rightMargin = boxed_cast<ColumnOffset>(helper_.pageSize().columns - 1);
+    auto const left = _line == from.line ? from.column : ColumnOffset(0);
+    auto const right = _line == to.line ? min(to.column, rightMargin) : rightMargin;
+    return Range { _line, left, right };
+}
 
-            // Render last (second) line partial from beginning to last selected column.
-            result[result.size() - 1] = Range { to.line, ColumnOffset(0), min(to.column, rightMargin) };
-            break;
-    }
+vector<Selection::Range> const& Selection::ranges() const
+{
+    auto const key = RangesKey { from_, to_, helper_.pageSize().columns };
+    if (rangesKey_ == key)
+        return ranges_;
 
-    return result;
+    auto const [from, to] = orderedPoints(from_, to_);
+    ranges_.clear();
+    ranges_.reserve(unbox<size_t>(to.line - from.line) + 1);
+    for (auto line = from.line; line <= to.line; ++line)
+        if (auto const range = rangeAt(line))
+            ranges_.emplace_back(*range);
+
+    rangesKey_ = key;
+    return ranges_;
 }
 // }}}
 // {{{ LinearSelection
@@ -225,10 +206,9 @@ RectangularSelection::RectangularSelection(SelectionHelper const& _helper, CellL
 
 bool RectangularSelection::contains(CellLocation _coord) const noexcept
 {
-    auto const [from, to] = orderedPoints(from_, to_);
-
-    return crispy::ascending(from.line, _coord.line, to.line)
-           && crispy::ascending(from.column, _coord.column, to.column);
+    // The same columns as rendered, including the right half of a wide character at the right edge.
+    auto const range = rangeAt(_coord.line);
+    return range && crispy::ascending(range->fromColumn, _coord.column, range->toColumn);
 }
 
 bool RectangularSelection::intersects(Rect _area) const noexcept
@@ -255,23 +235,14 @@ bool RectangularSelection::intersects(Rect _area) const noexcept
     return _area.top.as<LineOffset>() < from.line && to.line < _area.bottom.as<LineOffset>();
 }
 
-vector<Selection::Range> RectangularSelection::ranges() const
+optional<Selection::Range> RectangularSelection::rangeAt(LineOffset _line) const noexcept
 {
     auto const [from, to] = orderedPoints(from_, to_);
+    if (_line < from.line || to.line < _line)
+        return nullopt;
 
-    vector<Selection::Range> result;
-    auto const numLines = to.line - from.line + 1;
-    result.resize(numLines.as<size_t>());
-
-    for (size_t i = 0; i < result.size(); ++i)
-    {
-        auto const line = from.line + LineOffset::cast_from(i);
-        auto const left = from.column;
-        auto const right = stretchedColumn(helper_, CellLocation { line, to.column }).column;
-        result[i] = Range { line, left, right };
-    }
-
-    return result;
+    auto const right = stretchedColumn(helper_, CellLocation { _line, to.column }).column;
+    return Range { _line, from.column, right };
 }
 // }}}
 // {{{ FullLineSelection
@@ -22,6 +22,8 @@
 #include <fmt/format.h>
 
 #include <functional>
+#include <optional>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -108,8 +110,19 @@ class Selection
     /// Extends the selection to the given coordinate.
     virtual void extend(CellLocation _to);
 
-    /// Constructs a vector of ranges for this selection.
-    [[nodiscard]] virtual std::vector<Range> ranges() const;
+    /// Returns the selected column interval at the given absolute line, if any.
+    ///
+    /// This is computed in constant time from the selection's end points and
+    /// does not depend on the number of selected lines.
+    [[nodiscard]] virtual std::optional<Range> rangeAt(LineOffset _line) const noexcept;
+
+    /// Returns the ranges of this selection, one per selected line, top to bottom.
+    ///
+    /// The ranges are computed once per selection change and cached until invalidateRanges() is called.
+    [[nodiscard]] std::vector<Range> const& ranges() const;
+
+    /// Discards the cached ranges, as they may depend on the grid's contents, e.g. wide characters.
+    void invalidateRanges() noexcept { rangesKey_.reset(); }
 
     /// Marks the selection as completed.
     void complete();
@@ -124,6 +137,11 @@ class Selection
     SelectionHelper const& helper_;
     CellLocation from_;
     CellLocation to_;
+
+  private:
+    using RangesKey = std::tuple<CellLocation, CellLocation, ColumnCount>;
+    mutable std::optional<RangesKey> rangesKey_;
+    mutable std::vector<Range> ranges_;
 };
 
 class RectangularSelection: public Selection
@@ -132,7 +150,7 @@ class RectangularSelection: public Selection
     RectangularSelection(SelectionHelper const& _helper, CellLocation _start);
     bool contains(CellLocation _coord) const noexcept override;
     bool intersects(Rect _area) const noexcept override;
-    std::vector<Range> ranges() const override;
+    std::optional<Range> rangeAt(LineOffset _line) const noexcept override;
 };
 
 class LinearSelection: public Selection
@@ -262,3 +262,85 @@ TEST_CASE("Selector.Rectangular", "[selector]")
 {
     // TODO
 }
+
+TEST_CASE("Selector.rangeAt", "[selector]")
+{
+    auto term = MockTerm(PageSize { LineCount(3), ColumnCount(11) }, LineCount(5));
+    auto& screen = term.terminal.primaryScreen();
+    auto selectionHelper = TestSelectionHelper(screen);
+
+    SECTION("linear")
+    {
+        auto selector = LinearSelection(selectionHelper, CellLocation { LineOffset(2), ColumnOffset(3) });
+        selector.extend(CellLocation { LineOffset(0), ColumnOffset(5) });
+        selector.complete();
+
+        CHECK(!selector.rangeAt(LineOffset(-1)).has_value());
+        CHECK(!selector.rangeAt(LineOffset(3)).has_value());
+
+        auto const r0 = selector.rangeAt(LineOffset(0)).value();
+        CHECK(r0.fromColumn == ColumnOffset(5));
+        CHECK(r0.toColumn == ColumnOffset(10));
+
+        auto const r1 = selector.rangeAt(LineOffset(1)).value();
+        CHECK(r1.fromColumn == ColumnOffset(0));
+        CHECK(r1.toColumn == ColumnOffset(10));
+
+        auto const r2 = selector.rangeAt(LineOffset(2)).value();
+        CHECK(r2.fromColumn == ColumnOffset(0));
+        CHECK(r2.toColumn == ColumnOffset(3));
+    }
+
+    SECTION("rectangular")
+    {
+        auto selector = RectangularSelection(selectionHelper, CellLocation { LineOffset(0), ColumnOffset(6) });
+        selector.extend(CellLocation { LineOffset(1), ColumnOffset(2) });
+        selector.complete();
+
+        CHECK(!selector.rangeAt(LineOffset(2)).has_value());
+        for (auto const line: { LineOffset(0), LineOffset(1) })
+        {
+            auto const range = selector.rangeAt(line).value();
+            CHECK(range.fromColumn == ColumnOffset(2));
+            CHECK(range.toColumn == ColumnOffset(6));
+        }
+    }
+
+    SECTION("rectangular with wide character")
+    {
+        auto selector = RectangularSelection(selectionHelper, CellLocation { LineOffset(0), ColumnOffset(6) });
+        selector.extend(CellLocation { LineOffset(1), ColumnOffset(2) });
+        selector.complete();
+        REQUIRE(selector.ranges().size() == 2);
+        CHECK(selector.ranges()[1].toColumn == ColumnOffset(6));
+
+        // A wide character at the right edge is selected as a whole.
+        term.writeToScreen("\033[2;7H\xE4\xB8\xAD"); // U+4E2D, two columns wide
+        REQUIRE(screen.at(CellLocation { LineOffset(1), ColumnOffset(6) }).width() == 2);
+        selector.invalidateRanges();
+
+        REQUIRE(selector.ranges().size() == 2);
+        CHECK(selector.ranges()[0].toColumn == ColumnOffset(6));
+        CHECK(selector.ranges()[1].toColumn == ColumnOffset(7));
+
+        // Membership agrees with the rendered ranges.
+        CHECK(selector.contains(CellLocation { LineOffset(1), ColumnOffset(7) }));
+        CHECK(!selector.contains(CellLocation { LineOffset(0), ColumnOffset(7) }));
+        CHECK(!selector.contains(CellLocation { LineOffset(1), ColumnOffset(8) }));
+        CHECK(selector.contains(CellLocation { LineOffset(0), ColumnOffset(2) }));
+        CHECK(!selector.contains(CellLocation { LineOffset(2), ColumnOffset(2) }));
+    }
+
+    SECTION("ranges follow selection changes")
+    {
+        auto selector = LinearSelection(selectionHelper, CellLocation { LineOffset(0), ColumnOffset(1) });
+        selector.extend(CellLocation { LineOffset(1), ColumnOffset(2) });
+
+        REQUIRE(selector.ranges().size() == 2);
+        CHECK(selector.ranges().back().toColumn == ColumnOffset(2));
+
+        selector.extend(CellLocation { LineOffset(2), ColumnOffset(4) });
+        REQUIRE(selector.ranges().size() == 3);
+        CHECK(selector.ranges().back().toColumn == ColumnOffset(4));
+    }
+}
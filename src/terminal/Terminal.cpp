@@ -13,6 +13,7 @@
  */
 #include <terminal/ControlCode.h>
 #include <terminal/InputGenerator.h>
+#include <terminal/PtyRecording.h>
 #include <terminal/RenderBuffer.h>
 #include <terminal/RenderBufferBuilder.h>
 #include <terminal/Terminal.h>
@@ -95,6 +96,7 @@ Terminal::Terminal(unique_ptr<Pty> _pty,
     cursorBlinkInterval_ { _cursorBlinkInterval },
     cursorBlinkState_ { 1 },
     wordDelimiters_ { unicode::from_utf8(_wordDelimiters) },
+    wordDelimiterSet_ { wordDelimiters_ },
     mouseProtocolBypassModifier_ { _mouseProtocolBypassModifier },
     copyLastMarkRangeOffset_ { _copyLastMarkRangeOffset },
     // clang-format off
@@ -128,6 +130,18 @@ Terminal::Terminal(unique_ptr<Pty> _pty,
 #endif
 }
 
+Terminal::~Terminal()
+{
+    captureCancelled_ = true;
+    if (captureThread_.joinable())
+        captureThread_.join();
+}
+
+void Terminal::setPtyRecorder(std::unique_ptr<PtyRecorder> _recorder)
+{
+    ptyRecorder_ = std::move(_recorder);
+}
+
 void Terminal::setRefreshRate(double _refreshRate)
 {
     refreshInterval_ = std::chrono::milliseconds(static_cast<long long>(1000.0 / _refreshRate));
@@ -140,10 +154,18 @@ void Terminal::setLastMarkRangeOffset(LineOffset _value) noexcept
 
 bool Terminal::processInputOnce()
 {
-    auto const timeout = renderBuffer_.state == RenderBufferState::WaitingForRefresh && !screenDirty_
-                             ? std::chrono::seconds(4)
-                             //: refreshInterval_ : std::chrono::seconds(0)
-                             : std::chrono::seconds(30);
+    auto timeout = std::chrono::milliseconds(renderBuffer_.state == RenderBufferState::WaitingForRefresh
+                                                     && !screenDirty_
+                                                 ? std::chrono::seconds(4)
+                                                 //: refreshInterval_ : std::chrono::seconds(0)
+                                                 : std::chrono::seconds(30));
+
+    // Wake up in time to publish a frame if the synchronized output is not ended in time.
+    if (state_.modes.enabled(DECMode::BatchedRendering) && synchronizedOutputPending_)
+        timeout = std::clamp(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 synchronizedOutputStart_ + synchronizedOutputTimeout_ - steady_clock::now()),
+                             std::chrono::milliseconds(0),
+                             timeout);
 
     // Request a new Buffer Object if the current one cannot sufficiently
     // store a single text line.
@@ -162,8 +184,11 @@ bool Terminal::processInputOnce()
         {
             TerminalLog()("PTY read failed (timeout: {}). {}", timeout, strerror(errno));
             pty_->close();
+            return false;
         }
-        return errno == EINTR || errno == EAGAIN;
+        checkSynchronizedOutputTimeout();
+        releaseIdleAlternateScreen();
+        return true;
     }
     string_view const buf = get<0>(*readResult);
     state_.usingStdoutFastPipe = get<1>(*readResult);
@@ -175,15 +200,28 @@ bool Terminal::processInputOnce()
         return true;
     }
 
+    if (ptyRecorder_)
+        ptyRecorder_->recordOutput(buf);
+
     {
         auto const _l = std::lock_guard { *this };
         state_.parser.maxCharCount =
             static_cast<size_t>(state_.pageSize.columns.value - state_.cursor.position.column.value);
         state_.parser.parseFragment(buf);
+        if (selection_)
+            selection_->invalidateRanges();
     }
+    invalidateDetectedUrls();
 
     if (!state_.modes.enabled(DECMode::BatchedRendering))
         screenUpdated();
+    else
+    {
+        ++synchronizedOutputStats_.avoidedUpdates;
+        synchronizedOutputPending_ = true;
+        checkSynchronizedOutputTimeout();
+    }
+    releaseIdleAlternateScreen();
 
 #if defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
     ensureFreshRenderBuffer();
@@ -273,14 +311,12 @@ bool Terminal::SelectionHelper::wordDelimited(CellLocation _pos) const noexcept
     if (terminal->isPrimaryScreen())
     {
         auto const& cell = terminal->primaryScreen().at(_pos);
-        return cell.empty()
-               || terminal->wordDelimiters_.find(cell.codepoint(0)) != terminal->wordDelimiters_.npos;
+        return cell.empty() || terminal->wordDelimiterSet_.contains(cell.codepoint(0));
     }
     else
     {
         auto const& cell = terminal->alternateScreen().at(_pos);
-        return cell.empty()
-               || terminal->wordDelimiters_.find(cell.codepoint(0)) != terminal->wordDelimiters_.npos;
+        return cell.empty() || terminal->wordDelimiterSet_.contains(cell.codepoint(0));
     }
 }
 
@@ -373,6 +409,12 @@ bool Terminal::sendCharPressEvent(char32_t _value, Modifier _modifier, Timestamp
     cursorBlinkState_ = 1;
     lastCursorBlink_ = _now;
 
+    if (_value == 0x1B && _modifier.none() && pasteInProgress())
+    {
+        cancelPaste();
+        return true;
+    }
+
     if (state_.inputHandler.sendCharPressEvent(_value, _modifier))
         return true;
 
@@ -566,9 +608,15 @@ bool Terminal::sendFocusOutEvent()
     return false;
 }
 
-void Terminal::sendPaste(string_view _text)
+void Terminal::sendPaste(string _text)
 {
-    state_.inputGenerator.generatePaste(_text);
+    state_.inputGenerator.generatePaste(move(_text));
+    flushInput();
+}
+
+void Terminal::cancelPaste()
+{
+    state_.inputGenerator.cancelPaste();
     flushInput();
 }
 
@@ -584,7 +632,7 @@ bool Terminal::hasInput() const noexcept
 
 size_t Terminal::pendingInputBytes() const noexcept
 {
-    return !state_.inputGenerator.peek().size();
+    return state_.inputGenerator.peek().size();
 }
 
 void Terminal::flushInput()
@@ -596,7 +644,11 @@ void Terminal::flushInput()
     auto const input = state_.inputGenerator.peek();
     auto const rv = pty_->write(input.data(), input.size());
     if (rv > 0)
+    {
+        if (ptyRecorder_)
+            ptyRecorder_->recordInput(input.substr(0, static_cast<size_t>(rv)));
         state_.inputGenerator.consume(rv);
+    }
 }
 
 void Terminal::writeToScreen(string_view _data)
@@ -612,11 +664,18 @@ void Terminal::writeToScreen(string_view _data)
             _data.remove_prefix(chunk.size());
             state_.parser.parseFragment(currentPtyBuffer_->writeAtEnd(chunk));
         }
+        if (selection_)
+            selection_->invalidateRanges();
     }
+    invalidateDetectedUrls();
 
     if (!state_.modes.enabled(DECMode::BatchedRendering))
-    {
         screenUpdated();
+    else
+    {
+        ++synchronizedOutputStats_.avoidedUpdates;
+        synchronizedOutputPending_ = true;
+        checkSynchronizedOutputTimeout();
     }
 }
 
@@ -644,12 +703,81 @@ bool Terminal::updateCursorHoveringState()
 
     auto const relCursorPos = viewport_.translateScreenToGridCoordinate(currentMousePosition_);
     auto const mouseInView2 = currentScreen_.get().contains(currentMousePosition_);
-    auto const newState = mouseInView2 && !!currentScreen_.get().hyperlinkIdAt(relCursorPos);
+    auto const newState = mouseInView2
+                          && (!!currentScreen_.get().hyperlinkIdAt(relCursorPos)
+                              || detectedUrlAt(relCursorPos).has_value());
 
     auto const oldState = hoveringHyperlink_.exchange(newState);
     return newState != oldState;
 }
 
+// {{{ URL detection
+void Terminal::invalidateDetectedUrls()
+{
+    auto const _l = scoped_lock { urlCacheLock_ };
+    urlCache_.invalidate();
+}
+
+optional<DetectedUrl> Terminal::detectedUrlAt(CellLocation _gridPosition) const
+{
+    auto const _l = scoped_lock { urlCacheLock_ };
+    auto const* url = isPrimaryScreen() ? urlCache_.urlAt(primaryScreen_.grid(), _gridPosition)
+                                        : urlCache_.urlAt(alternateScreen_.grid(), _gridPosition);
+    if (url)
+        return *url;
+    return nullopt;
+}
+
+optional<DetectedUrl> Terminal::hoveringDetectedUrl() const
+{
+    if (auto const gridPosition = currentMouseGridPosition())
+        if (!currentScreen_.get().hyperlinkIdAt(*gridPosition))
+            return detectedUrlAt(*gridPosition);
+    return nullopt;
+}
+
+void Terminal::setUrlHintsMode(bool _enabled)
+{
+    urlHintsMode_ = _enabled;
+    breakLoopAndRefreshRenderBuffer();
+}
+
+vector<DetectedUrl> Terminal::urlHints() const
+{
+    auto hints = vector<DetectedUrl> {};
+    if (!urlHintsMode_)
+        return hints;
+
+    auto const _l = scoped_lock { urlCacheLock_ };
+    for (auto line = LineOffset(0); line < boxed_cast<LineOffset>(pageSize().lines); ++line)
+    {
+        auto const gridLine = viewport_.translateScreenToGridCoordinate(CellLocation { line, {} }).line;
+        auto const& urls = isPrimaryScreen() ? urlCache_.urlsAt(primaryScreen_.grid(), gridLine)
+                                             : urlCache_.urlsAt(alternateScreen_.grid(), gridLine);
+        for (DetectedUrl const& url: urls)
+        {
+            if (hints.size() == UrlHintLabels.size())
+                return hints;
+            hints.emplace_back(url);
+        }
+    }
+    return hints;
+}
+
+shared_ptr<HyperlinkInfo const> Terminal::urlHintByLabel(char32_t _label) const
+{
+    auto const i = UrlHintLabels.find(static_cast<char>(_label));
+    if (_label >= 0x80 || i == UrlHintLabels.npos)
+        return {};
+
+    auto const hints = urlHints();
+    if (i >= hints.size())
+        return {};
+
+    return hints[i].hyperlink;
+}
+// }}}
+
 optional<chrono::milliseconds> Terminal::nextRender() const
 {
     if (!state_.cursor.visible)
@@ -682,9 +810,13 @@ void Terminal::resizeScreen(PageSize _cells, optional<ImageSize> _pixels)
                              Margin::Horizontal { {}, _cells.columns.as<ColumnOffset>() - 1 } };
 
     applyPageSizeToCurrentBuffer();
+    invalidateDetectedUrls();
 
     pty_->resizeScreen(_cells, _pixels);
 
+    if (ptyRecorder_)
+        ptyRecorder_->recordResize(_cells);
+
     verifyState();
 }
 
@@ -759,37 +891,58 @@ void Terminal::setCursorShape(CursorShape _shape)
 void Terminal::setWordDelimiters(string const& _wordDelimiters)
 {
     wordDelimiters_ = unicode::from_utf8(_wordDelimiters);
+    wordDelimiterSet_ = crispy::CodepointSet { wordDelimiters_ };
 }
 
-string Terminal::extractSelectionText() const
+void Terminal::extractSelectionText(std::function<void(std::string_view)> const& _sink) const
 {
-    using namespace terminal;
-    ColumnOffset lastColumn = {};
-    string text;
-    string currentLine;
-
     auto const _lock = scoped_lock { *this };
+    if (!selection_)
+        return;
+
     auto const rightPage = pageSize().columns.as<ColumnOffset>() - 1;
-    renderSelection([&](CellLocation const& _pos, Cell const& _cell) {
-        auto const isNewLine = _pos.column < lastColumn || (_pos.column == lastColumn && !text.empty());
-        bool const touchesRightPage = isSelected({ _pos.line, rightPage });
-        if (isNewLine && (!isLineWrapped(_pos.line) || !touchesRightPage))
+    auto const appendRange = [&](string& _output, Selection::Range const& _range) {
+        if (isPrimaryScreen())
+            primaryScreen_.grid().appendText(_output, _range.line, _range.fromColumn, _range.toColumn);
+        else
+            alternateScreen_.grid().appendText(_output, _range.line, _range.fromColumn, _range.toColumn);
+    };
+
+    string text;
+    text.reserve(SelectionTextChunkSize);
+
+    bool firstRange = true;
+    for (Selection::Range const& range: selection_->ranges())
+    {
+        bool const touchesRightPage = selection_->contains({ range.line, rightPage });
+        if (!firstRange && (!isLineWrapped(range.line) || !touchesRightPage))
         {
             // TODO: handle logical line in word-selection (don't include LF in wrapped lines)
-            trimSpaceRight(currentLine);
-            text += currentLine;
+            trimSpaceRight(text);
             text += '\n';
-            currentLine.clear();
+            if (text.size() >= SelectionTextChunkSize)
+            {
+                _sink(text);
+                text.clear();
+            }
         }
-        currentLine += _cell.toUtf8();
-        lastColumn = _pos.column;
-    });
+        appendRange(text, range);
+        firstRange = false;
+    }
 
-    trimSpaceRight(currentLine);
-    text += currentLine;
+    trimSpaceRight(text);
 
-    if (dynamic_cast<FullLineSelection const*>(selector()))
+    if (dynamic_cast<FullLineSelection const*>(selection_.get()))
         text += '\n';
+
+    if (!text.empty())
+        _sink(text);
+}
+
+string Terminal::extractSelectionText() const
+{
+    string text;
+    extractSelectionText([&](string_view _chunk) { text += _chunk; });
     return text;
 }
 
@@ -822,10 +975,82 @@ string Terminal::extractLastMarkRange() const
     return text;
 }
 
+vector<Range> Terminal::commandBlocks() const
+{
+    auto const _l = std::lock_guard { *this };
+    return primaryScreen_.commandBlocks();
+}
+
+// {{{ screen buffer capture
+void Terminal::captureBuffer(LineCount _lineCount, bool _logicalLines, CaptureFormat _format)
+{
+    if (captureRunning_)
+    {
+        VTCaptureBufferLog()("Ignoring capture request, as a capture is still in progress.");
+        return;
+    }
+
+    if (captureThread_.joinable())
+        captureThread_.join();
+
+    auto snapshot = makeCaptureSnapshot(primaryScreen_.grid(), _lineCount, _logicalLines);
+    VTCaptureBufferLog()("Capturing {} {} lines starting at line {} as {}.",
+                         snapshot.lines.size(),
+                         _logicalLines ? "logical" : "physical",
+                         snapshot.firstLine,
+                         _format);
+
+    captureRunning_ = true;
+    captureThread_ = std::thread([this, snapshot = move(snapshot), _format]() {
+        auto const start = steady_clock::now();
+
+        // Only ever keep about one chunk queued up for the PTY, so that a slowly
+        // reading application does not make the whole capture pile up in memory.
+        auto const drainInput = [this](size_t _watermark) {
+            while (!captureCancelled_)
+            {
+                {
+                    auto const _l = std::lock_guard { *this };
+                    flushInput();
+                    if (pendingInputBytes() <= _watermark)
+                        return;
+                }
+                std::this_thread::sleep_for(1ms);
+            }
+        };
+
+        auto const stats = encodeCapture(snapshot, _format, CaptureChunkSize, [&](string_view _reply) {
+            drainInput(CaptureChunkSize);
+            if (captureCancelled_)
+                return;
+            auto const _l = std::lock_guard { *this };
+            reply(_reply);
+            flushInput();
+        });
+        drainInput(0);
+
+        auto const elapsed = duration_cast<duration<double>>(steady_clock::now() - start).count();
+        VTCaptureBufferLog()("Captured {} lines in {} chunks, {} bytes in {:.3f} seconds ({:.2f} MB/s).",
+                             stats.lines,
+                             stats.chunks,
+                             stats.bytes,
+                             elapsed,
+                             elapsed > 0 ? static_cast<double>(stats.bytes) / elapsed / (1024 * 1024) : 0.0);
+        captureRunning_ = false;
+    });
+}
+
+void Terminal::waitForCaptureBuffer()
+{
+    if (captureThread_.joinable())
+        captureThread_.join();
+}
+// }}}
+
 // {{{ ScreenEvents overrides
-void Terminal::requestCaptureBuffer(LineCount lines, bool logical)
+void Terminal::requestCaptureBuffer(LineCount lines, bool logical, CaptureFormat format)
 {
-    return eventListener_.requestCaptureBuffer(lines, logical);
+    return eventListener_.requestCaptureBuffer(lines, logical, format);
 }
 
 void Terminal::bell()
@@ -1109,7 +1334,10 @@ void Terminal::setMode(DECMode _mode, bool _enable)
             {
                 state_.savedPrimaryCursor = cursor();
                 setMode(DECMode::UseAlternateScreen, true);
-                clearScreen();
+                // Cleared in place rather than scrolled out, in order to reuse the cells of
+                // the previous use.
+                state_.alternateBuffer.clearPage(state_.cursor.graphicsRendition);
+                alternateScreen_.updateCursorIterator();
             }
             else
             {
@@ -1324,6 +1552,11 @@ void Terminal::hardReset()
     state_.cursor = {};
     state_.tabs.clear();
 
+    // Neither buffer refers to any hyperlink anymore.
+    state_.savedCursor.hyperlink = {};
+    state_.savedPrimaryCursor.hyperlink = {};
+    state_.hyperlinks.clear();
+
     state_.lastCursorPosition = state_.cursor.position;
 
     state_.margin =
@@ -1352,9 +1585,11 @@ void Terminal::setScreen(ScreenType _type)
         case ScreenType::Primary:
             currentScreen_ = primaryScreen_;
             setMouseWheelMode(InputGenerator::MouseWheelMode::Default);
+            alternateScreenLeft_ = steady_clock::now();
             break;
         case ScreenType::Alternate:
             currentScreen_ = alternateScreen_;
+            alternateScreenAllocated_ = true;
             if (isModeEnabled(DECMode::MouseAlternateScroll))
                 setMouseWheelMode(InputGenerator::MouseWheelMode::ApplicationCursorKeys);
             else
@@ -1435,21 +1670,66 @@ void Terminal::markRegionDirty(Rect _area) noexcept
 
 void Terminal::synchronizedOutput(bool _enabled)
 {
+    // While the synchronized output is in progress, the renderer keeps showing the last published frame.
     renderBufferUpdateEnabled_ = !_enabled;
     if (_enabled)
+    {
+        synchronizedOutputStart_ = steady_clock::now();
+        synchronizedOutputPending_ = false;
         return;
+    }
 
-    tick(steady_clock::now());
+    // The completed frame is published right away, regardless of the refresh interval,
+    // as there might be no further screen update to publish it later.
+    ++synchronizedOutputStats_.frames;
+    publishSynchronizedFrame(true);
+}
 
-    auto const diff = currentTime_ - renderBuffer_.lastUpdate;
-    if (diff < refreshInterval_)
+void Terminal::checkSynchronizedOutputTimeout()
+{
+    if (!state_.modes.enabled(DECMode::BatchedRendering))
         return;
 
-    if (renderBuffer_.state == RenderBufferState::TrySwapBuffers)
+    auto const now = steady_clock::now();
+    if (now - synchronizedOutputStart_ < synchronizedOutputTimeout_)
+        return;
+
+    synchronizedOutputStart_ = now;
+
+    // Nothing has been drawn since the last published frame, so it is still up to date.
+    if (!synchronizedOutputPending_)
+        return;
+
+    // The application did not end its synchronized output in time, e.g. because it crashed.
+    // Show what has been drawn so far, and keep holding back updates for another timeout period.
+    TerminalLog()("Synchronized output timed out after {}.", synchronizedOutputTimeout_);
+    ++synchronizedOutputStats_.timeouts;
+    publishSynchronizedFrame(false);
+}
+
+void Terminal::releaseIdleAlternateScreen()
+{
+    if (!alternateScreenAllocated_ || !isPrimaryScreen())
         return;
 
-    refreshRenderBuffer(true);
+    if (steady_clock::now() - alternateScreenLeft_ < alternateScreenReleaseTimeout_)
+        return;
+
+    // Resetting turns all lines back into trivial ones, which do not hold any cells.
+    TerminalLog()("Releasing alternate screen after being unused for {}.", alternateScreenReleaseTimeout_);
+    auto const _l = std::lock_guard { *this };
+    state_.alternateBuffer.reset();
+    alternateScreenAllocated_ = false;
+}
+
+void Terminal::publishSynchronizedFrame(bool _locked)
+{
+    auto const updateEnabled = renderBufferUpdateEnabled_.exchange(true);
+    synchronizedOutputPending_ = false;
+    tick(steady_clock::now());
+    refreshRenderBuffer(_locked);
     eventListener_.screenUpdated();
+    renderBufferUpdateEnabled_ = updateEnabled;
 }
 
 void Terminal::onBufferScrolled(LineCount _n) noexcept
@@ -13,6 +13,7 @@
  */
 #pragma once
 
+#include <terminal/CaptureBuffer.h>
 #include <terminal/InputGenerator.h>
 #include <terminal/InputHandler.h>
 #include <terminal/RenderBuffer.h>
@@ -20,11 +21,14 @@
 #include <terminal/Selector.h>
 #include <terminal/Sequence.h>
 #include <terminal/TerminalState.h>
+#include <terminal/UrlDetector.h>
 #include <terminal/ViInputHandler.h>
 #include <terminal/Viewport.h>
 #include <terminal/primitives.h>
 #include <terminal/pty/Pty.h>
 
+#include <crispy/CodepointSet.h>
+
 #include <fmt/format.h>
 
 #include <atomic>
@@ -32,7 +36,9 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -42,6 +48,8 @@ namespace terminal
 template <typename Cell, ScreenType TheScreenType>
 class Screen;
 
+class PtyRecorder;
+
 /// Terminal API to manage input and output devices of a pseudo terminal, such as keyboard, mouse, and screen.
 ///
 /// With a terminal being attached to a Process, the terminal's screen
@@ -56,7 +64,7 @@ class Terminal
       public:
         virtual ~Events() = default;
 
-        virtual void requestCaptureBuffer(LineCount /*lines*/, bool /*logical*/) {}
+        virtual void requestCaptureBuffer(LineCount /*lines*/, bool /*logical*/, CaptureFormat /*format*/) {}
         virtual void bell() {}
         virtual void bufferChanged(ScreenType) {}
         virtual void renderBufferUpdated() {}
@@ -93,11 +101,36 @@ class Terminal
              ColorPalette _colorPalette = {},
              double _refreshRate = 30.0,
              bool _allowReflowOnResize = true);
-    ~Terminal() = default;
+    ~Terminal();
 
     void start();
 
     void setRefreshRate(double _refreshRate);
+
+    /// Sets the time after which a frame is shown even though the application did not end
+    /// its synchronized output (mode 2026) yet.
+    void setSynchronizedOutputTimeout(std::chrono::milliseconds _timeout) noexcept
+    {
+        synchronizedOutputTimeout_ = _timeout;
+    }
+
+    /// Sets the time after which the alternate screen's cells are released once it is not in use anymore.
+    ///
+    /// Its cells are kept until then, such that applications switching to the alternate screen
+    /// frequently, such as pagers, do not need them to be reallocated each time.
+    void setAlternateScreenReleaseTimeout(std::chrono::milliseconds _timeout) noexcept
+    {
+        alternateScreenReleaseTimeout_ = _timeout;
+    }
+
+    struct SynchronizedOutputStats
+    {
+        uint64_t frames = 0;         //!< frames published at the end of a synchronized output
+        uint64_t timeouts = 0;       //!< frames published because a synchronized output timed out
+        uint64_t avoidedUpdates = 0; //!< screen updates withheld, i.e. partially drawn frames avoided
+    };
+
+    SynchronizedOutputStats synchronizedOutputStats() const noexcept { return synchronizedOutputStats_; }
     void setLastMarkRangeOffset(LineOffset _value) noexcept;
 
     void setMaxHistoryLineCount(LineCount _maxHistoryLineCount);
@@ -211,6 +244,9 @@ class Terminal
     /// Retrieves reference to the underlying PTY device.
     Pty& device() noexcept { return *pty_; }
 
+    /// Records all PTY output, input and resize events from now on, or stops recording if null.
+    void setPtyRecorder(std::unique_ptr<PtyRecorder> _recorder);
+
     PageSize pageSize() const noexcept { return pty_->pageSize(); }
     void resizeScreen(PageSize _cells, std::optional<ImageSize> _pixels = std::nullopt);
 
@@ -240,7 +276,14 @@ class Terminal
                                Timestamp _now);
     bool sendFocusInEvent();
     bool sendFocusOutEvent();
-    void sendPaste(std::string_view _text); // Sends verbatim text in bracketed mode to application.
+    /// Sends sanitized text in bracketed mode to application, in chunks as it reads its input.
+    void sendPaste(std::string _text);
+    bool pasteInProgress() const noexcept { return state_.inputGenerator.pasteInProgress(); }
+    std::optional<InputGenerator::PasteProgress> pasteProgress() const noexcept
+    {
+        return state_.inputGenerator.pasteProgress();
+    }
+    void cancelPaste();
     void sendPasteFromClipboard(unsigned count = 1) { eventListener_.pasteFromClipboard(count); }
 
     void sendRaw(std::string_view _text); // Sends raw string to the application.
@@ -441,6 +484,14 @@ class Terminal
         return selection_ && selection_->state() != Selection::State::Waiting && selection_->contains(_coord);
     }
 
+    /// Returns the selected column interval at the given absolute line, if any.
+    std::optional<Selection::Range> selectionRangeAt(LineOffset _line) const noexcept
+    {
+        if (!isSelectionAvailable())
+            return std::nullopt;
+        return selection_->rangeAt(_line);
+    }
+
     /// Sets or resets to a new selection.
     void setSelector(std::unique_ptr<Selection> _selector) { selection_ = std::move(_selector); }
 
@@ -448,21 +499,80 @@ class Terminal
     bool selectionAvailable() const noexcept { return !!selection_; }
     // }}}
 
+    /// Streams the currently selected text as UTF-8 to @p _sink.
+    ///
+    /// The text is handed over in chunks of roughly SelectionTextChunkSize bytes,
+    /// each chunk ending on a line boundary unless a single logical line exceeds it.
+    /// The sink is invoked while the terminal lock is held.
+    void extractSelectionText(std::function<void(std::string_view)> const& _sink) const;
     std::string extractSelectionText() const;
     std::string extractLastMarkRange() const;
 
+    /// Lists the command blocks of the primary screen.
+    ///
+    /// @see Screen::commandBlocks()
+    std::vector<Range> commandBlocks() const;
+
+    static constexpr size_t SelectionTextChunkSize = 64 * 1024;
+
+    // {{{ screen buffer capture
+    /// Captures the given number of lines from the bottom of the primary screen
+    /// upwards and sends them to the application as CAPTURE replies.
+    ///
+    /// The lines are copied right away, whereas encoding and sending happen in a
+    /// background thread. Must be called with the terminal lock held.
+    void captureBuffer(LineCount _lineCount, bool _logicalLines, CaptureFormat _format);
+
+    /// Blocks until a previously started capture has been sent completely.
+    /// Must be called without holding the terminal lock.
+    void waitForCaptureBuffer();
+
+    static constexpr size_t CaptureChunkSize = 64 * 1024;
+    // }}}
+
     /// Tests whether or not the mouse is currently hovering a hyperlink.
     bool isMouseHoveringHyperlink() const noexcept { return hoveringHyperlink_.load(); }
 
     /// Retrieves the HyperlinkInfo that is currently behing hovered by the mouse, if so,
     /// or a nothing otherwise.
-    std::shared_ptr<HyperlinkInfo const> tryGetHoveringHyperlink() const noexcept
+    ///
+    /// URLs detected in the plain text are considered, too, unless the application
+    /// explicitly marked up a hyperlink at that position.
+    std::shared_ptr<HyperlinkInfo const> tryGetHoveringHyperlink() const
     {
         if (auto const gridPosition = currentMouseGridPosition())
-            return currentScreen_.get().hyperlinkAt(*gridPosition);
+        {
+            if (auto hyperlink = currentScreen_.get().hyperlinkAt(*gridPosition))
+                return hyperlink;
+            if (auto const url = detectedUrlAt(*gridPosition))
+                return url->hyperlink;
+        }
         return {};
     }
 
+    // {{{ URL detection
+    /// Returns the URL or absolute file path found in the plain text at the given
+    /// grid position, if any.
+    std::optional<DetectedUrl> detectedUrlAt(CellLocation _gridPosition) const;
+
+    /// Returns the detected URL currently being hovered by the mouse, unless
+    /// the application explicitly marked up a hyperlink at that position.
+    std::optional<DetectedUrl> hoveringDetectedUrl() const;
+
+    /// Enables or disables the URL hints mode, in which every URL on the visible
+    /// page is labeled with a single character to be followed by typing it.
+    void setUrlHintsMode(bool _enabled);
+    bool urlHintsMode() const noexcept { return urlHintsMode_; }
+
+    /// Returns the URLs on the visible page, in the order of UrlHintLabels.
+    std::vector<DetectedUrl> urlHints() const;
+
+    /// Returns the URL labeled with the given hint label, if any.
+    std::shared_ptr<HyperlinkInfo const> urlHintByLabel(char32_t _label) const;
+
+    static constexpr std::string_view UrlHintLabels = "asdfghjklqwertyuiopzxcvbnm";
+    // }}}
+
     bool processInputOnce();
 
     void markScreenDirty() { screenDirty_ = true; }
@@ -472,7 +582,7 @@ class Terminal
 
     // Screen's EventListener implementation
     //
-    void requestCaptureBuffer(LineCount lines, bool logical);
+    void requestCaptureBuffer(LineCount lines, bool logical, CaptureFormat format);
     void bell();
     void bufferChanged(ScreenType);
     void scrollbackBufferCleared();
@@ -512,6 +622,9 @@ class Terminal
     void markCellDirty(CellLocation _position) noexcept;
     void markRegionDirty(Rect _area) noexcept;
     void synchronizedOutput(bool _enabled);
+    void publishSynchronizedFrame(bool _locked);
+    void checkSynchronizedOutputTimeout();
+    void releaseIdleAlternateScreen();
     void onBufferScrolled(LineCount _n) noexcept;
 
     void setMaxImageColorRegisters(unsigned value) noexcept { state_.maxImageColorRegisters = value; }
@@ -540,6 +653,9 @@ class Terminal
     void updateCursorVisibilityState() const;
     bool updateCursorHoveringState();
 
+    /// Forgets the URLs detected so far, as the grid contents may have changed.
+    void invalidateDetectedUrls();
+
     // private data
     //
 
@@ -553,6 +669,7 @@ class Terminal
     RenderDoubleBuffer renderBuffer_ {};
 
     std::unique_ptr<Pty> pty_;
+    std::unique_ptr<PtyRecorder> ptyRecorder_;
 
     std::chrono::steady_clock::time_point startTime_;
     std::chrono::steady_clock::time_point currentTime_;
@@ -564,6 +681,7 @@ class Terminal
     mutable unsigned cursorBlinkState_;
 
     std::u32string wordDelimiters_;
+    crispy::CodepointSet wordDelimiterSet_;
 
     // helpers for detecting double/tripple clicks
     std::chrono::steady_clock::time_point lastClick_ {};
@@ -590,7 +708,20 @@ class Terminal
     Viewport viewport_;
     std::unique_ptr<Selection> selection_;
     std::atomic<bool> hoveringHyperlink_ = false;
+    std::thread captureThread_;
+    std::atomic<bool> captureRunning_ = false;
+    std::atomic<bool> captureCancelled_ = false;
+    std::mutex mutable urlCacheLock_;
+    UrlCache mutable urlCache_;
+    std::atomic<bool> urlHintsMode_ = false;
     std::atomic<bool> renderBufferUpdateEnabled_ = true;
+    std::chrono::milliseconds synchronizedOutputTimeout_ { 200 };
+    std::chrono::steady_clock::time_point synchronizedOutputStart_ {};
+    bool synchronizedOutputPending_ = false; //!< screen updates withheld since the last published frame
+    SynchronizedOutputStats synchronizedOutputStats_ {};
+    std::chrono::milliseconds alternateScreenReleaseTimeout_ { 30'000 };
+    std::chrono::steady_clock::time_point alternateScreenLeft_ {};
+    bool alternateScreenAllocated_ = false; //!< whether the alternate screen may hold inflated lines
 
     std::atomic<uint64_t> lastFrameID_ = 0;
 
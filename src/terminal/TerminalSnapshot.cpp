@@ -0,0 +1,850 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Terminal.h>
+#include <terminal/TerminalSnapshot.h>
+
+#include <crispy/BufferObject.h>
+
+#include <algorithm>
+#include <optional>
+#include <stack>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using crispy::BinaryReader;
+using crispy::BinaryWriter;
+
+using std::nullopt;
+using std::optional;
+using std::runtime_error;
+using std::shared_ptr;
+using std::string;
+using std::string_view;
+using std::unordered_map;
+using std::vector;
+
+namespace terminal
+{
+
+namespace
+{
+    constexpr auto SnapshotMagic = string_view("ctsnap\x1A\n", 8);
+
+    enum class LineKind : uint8_t
+    {
+        Trivial,
+        Inflated,
+    };
+
+    // Bits of a cell record, denoting which of the cell's properties are stored.
+    // Absent properties have their default value.
+    enum CellRecord : unsigned
+    {
+        HasCodepoint = 0x0001,
+        HasCombiningCodepoints = 0x0002,
+        HasWidth = 0x0004,
+        HasForegroundColor = 0x0008,
+        HasBackgroundColor = 0x0010,
+        HasUnderlineColor = 0x0020,
+        HasStyles = 0x0040,
+        HasHyperlink = 0x0080,
+        HasImageFragment = 0x0100,
+    };
+
+    [[noreturn]] void invalidSnapshot()
+    {
+        throw runtime_error("Invalid terminal snapshot.");
+    }
+
+    bool sameCell(Cell const& a, Cell const& b) noexcept
+    {
+        if (a.imageFragment() || b.imageFragment())
+            return false;
+
+        auto const count = a.codepointCount();
+        if (count != b.codepointCount())
+            return false;
+        for (size_t i = 0; i < count; ++i)
+            if (a.codepoint(i) != b.codepoint(i))
+                return false;
+
+        return a.width() == b.width() && a.foregroundColor() == b.foregroundColor()
+               && a.backgroundColor() == b.backgroundColor() && a.underlineColor() == b.underlineColor()
+               && a.styles() == b.styles() && a.hyperlink() == b.hyperlink();
+    }
+
+    // {{{ SnapshotWriter
+    class SnapshotWriter
+    {
+      public:
+        explicit SnapshotWriter(BinaryWriter& _writer): writer_ { _writer } {}
+
+        void writeBool(bool _value) { writer_.write(static_cast<uint8_t>(_value)); }
+
+        void writeHyperlinks(HyperlinkStorage const& _hyperlinks)
+        {
+            writer_.writeVarUInt(_hyperlinks.size());
+            _hyperlinks.forEach([&](HyperlinkId _id, HyperlinkInfo const& _info) {
+                writer_.writeVarUInt(unbox<uint64_t>(_id));
+                writer_.writeString(_info.userId);
+                writer_.writeString(_info.uri);
+            });
+        }
+
+        void writeColorPalette(ColorPalette const& _palette)
+        {
+            writeBool(_palette.useBrightColors);
+            writer_.write(_palette.palette);
+            writer_.write(_palette.defaultForeground);
+            writer_.write(_palette.defaultBackground);
+            writeOptionalColor(_palette.selectionForeground);
+            writeOptionalColor(_palette.selectionBackground);
+            writeCellColor(_palette.cursor.color);
+            writeCellColor(_palette.cursor.textOverrideColor);
+            writer_.write(_palette.mouseForeground);
+            writer_.write(_palette.mouseBackground);
+            writer_.write(_palette.hyperlinkDecoration.normal);
+            writer_.write(_palette.hyperlinkDecoration.hover);
+        }
+
+        void writeOptionalColor(optional<RGBColor> _color)
+        {
+            writeBool(_color.has_value());
+            if (_color)
+                writer_.write(*_color);
+        }
+
+        void writeCellColor(CellRGBColor const& _color)
+        {
+            writer_.write(static_cast<uint8_t>(_color.index()));
+            if (auto const* rgb = std::get_if<RGBColor>(&_color))
+                writer_.write(*rgb);
+        }
+
+        void writeModes(Modes const& _modes)
+        {
+            auto const ansiModes = _modes.enabledAnsiModes();
+            writer_.writeVarUInt(ansiModes.size());
+            for (auto const mode: ansiModes)
+                writer_.writeVarUInt(static_cast<unsigned>(mode));
+
+            auto const decModes = _modes.enabledDECModes();
+            writer_.writeVarUInt(decModes.size());
+            for (auto const mode: decModes)
+                writer_.writeVarUInt(static_cast<unsigned>(mode));
+
+            writer_.writeVarUInt(_modes.savedModes().size());
+            for (auto const& [mode, stack]: _modes.savedModes())
+            {
+                writer_.writeVarUInt(static_cast<unsigned>(mode));
+                writer_.writeVarUInt(stack.size());
+                for (bool const enabled: stack)
+                    writeBool(enabled);
+            }
+        }
+
+        void writeInputGenerator(InputGenerator const& _input)
+        {
+            writeBool(_input.applicationCursorKeys());
+            writeBool(_input.applicationKeypad());
+            writeBool(_input.bracketedPaste());
+            writeBool(_input.mouseProtocol().has_value());
+            if (_input.mouseProtocol())
+                writer_.write(*_input.mouseProtocol());
+            writer_.write(_input.mouseTransport());
+            writer_.write(_input.mouseWheelMode());
+            writeBool(_input.generateFocusEvents());
+        }
+
+        void writeCursor(Cursor const& _cursor)
+        {
+            writer_.write(_cursor.position);
+            writeBool(_cursor.autoWrap);
+            writeBool(_cursor.originMode);
+            writeBool(_cursor.visible);
+            writer_.write(_cursor.graphicsRendition);
+            for (auto const table: { CharsetTable::G0, CharsetTable::G1, CharsetTable::G2, CharsetTable::G3 })
+            {
+                auto id = CharsetId::USASCII;
+                for (auto i = 0; i <= static_cast<int>(CharsetId::USASCII); ++i)
+                    if (_cursor.charsets.isSelected(table, static_cast<CharsetId>(i)))
+                        id = static_cast<CharsetId>(i);
+                writer_.write(static_cast<uint8_t>(id));
+            }
+            writer_.write(static_cast<uint8_t>(_cursor.charsets.selectedTable()));
+            writer_.write(static_cast<uint8_t>(_cursor.charsets.currentTable()));
+            writer_.writeVarUInt(unbox<uint64_t>(_cursor.hyperlink));
+        }
+
+        void writeGrid(Grid<Cell> const& _grid)
+        {
+            auto const top = -boxed_cast<LineOffset>(_grid.historyLineCount());
+            auto const bottom = boxed_cast<LineOffset>(_grid.pageSize().lines);
+
+            // The text of all trivial lines is restored into a single buffer object.
+            auto trivialTextSize = size_t { 0 };
+            for (auto line = top; line < bottom; ++line)
+                if (_grid.lineAt(line).isTrivialBuffer())
+                    trivialTextSize += _grid.lineAt(line).trivialBuffer().text.size();
+
+            writer_.write(_grid.pageSize());
+            writer_.writeVarUInt(unbox<uint64_t>(_grid.historyLineCount()));
+            writer_.writeVarUInt(trivialTextSize);
+            for (auto line = top; line < bottom; ++line)
+                writeLine(_grid.lineAt(line));
+        }
+
+      private:
+        void writeLine(Line<Cell> const& _line)
+        {
+            writer_.write(static_cast<uint8_t>(_line.flags()));
+            writer_.writeVarUInt(unbox<uint64_t>(_line.size()));
+
+            if (_line.isTrivialBuffer())
+            {
+                auto const& buffer = _line.trivialBuffer();
+                writer_.write(LineKind::Trivial);
+                writer_.write(buffer.attributes);
+                writer_.writeVarUInt(unbox<uint64_t>(buffer.hyperlink));
+                writer_.writeString(buffer.text.view());
+                return;
+            }
+
+            writer_.write(LineKind::Inflated);
+            auto const cells = _line.cells();
+            for (size_t i = 0; i < cells.size();)
+            {
+                auto j = i + 1;
+                while (j < cells.size() && sameCell(cells[i], cells[j]))
+                    ++j;
+                writer_.writeVarUInt(j - i);
+                writeCell(cells[i]);
+                i = j;
+            }
+        }
+
+        void writeCell(Cell const& _cell)
+        {
+            auto const codepointCount = _cell.codepointCount();
+            auto const imageFragment = _cell.imageFragment();
+
+            auto record = 0u;
+            if (codepointCount != 0)
+                record |= HasCodepoint;
+            if (codepointCount > 1)
+                record |= HasCombiningCodepoints;
+            if (_cell.width() != 1)
+                record |= HasWidth;
+            if (_cell.foregroundColor() != DefaultColor())
+                record |= HasForegroundColor;
+            if (_cell.backgroundColor() != DefaultColor())
+                record |= HasBackgroundColor;
+            if (_cell.underlineColor() != DefaultColor())
+                record |= HasUnderlineColor;
+            if (_cell.styles() != CellFlags::None)
+                record |= HasStyles;
+            if (!!_cell.hyperlink())
+                record |= HasHyperlink;
+            if (imageFragment)
+                record |= HasImageFragment;
+
+            writer_.writeVarUInt(record);
+            if (record & HasCodepoint)
+                writer_.writeVarUInt(_cell.codepoint(0));
+            if (record & HasCombiningCodepoints)
+            {
+                writer_.writeVarUInt(codepointCount - 1);
+                for (size_t i = 1; i < codepointCount; ++i)
+                    writer_.writeVarUInt(_cell.codepoint(i));
+            }
+            if (record & HasWidth)
+                writer_.write(_cell.width());
+            if (record & HasForegroundColor)
+                writer_.write(_cell.foregroundColor());
+            if (record & HasBackgroundColor)
+                writer_.write(_cell.backgroundColor());
+            if (record & HasUnderlineColor)
+                writer_.write(_cell.underlineColor());
+            if (record & HasStyles)
+                writer_.write(_cell.styles());
+            if (record & HasHyperlink)
+                writer_.writeVarUInt(unbox<uint64_t>(_cell.hyperlink()));
+            if (record & HasImageFragment)
+            {
+                writeRasterizedImage(imageFragment->rasterizedImage());
+                writer_.write(imageFragment->offset());
+            }
+        }
+
+        // Images are written inline upon their first reference, and referred to by index afterwards.
+        void writeRasterizedImage(RasterizedImage const& _image)
+        {
+            if (auto const i = rasterizedImages_.find(&_image); i != rasterizedImages_.end())
+            {
+                writer_.writeVarUInt(i->second);
+                return;
+            }
+
+            auto const index = rasterizedImages_.size();
+            rasterizedImages_.emplace(&_image, index);
+            writer_.writeVarUInt(index);
+            writeImage(_image.image());
+            writer_.write(_image.alignmentPolicy());
+            writer_.write(_image.resizePolicy());
+            writer_.write(_image.defaultColor());
+            writer_.write(_image.cellSpan());
+            writer_.write(_image.cellSize());
+        }
+
+        void writeImage(Image const& _image)
+        {
+            if (auto const i = images_.find(&_image); i != images_.end())
+            {
+                writer_.writeVarUInt(i->second);
+                return;
+            }
+
+            auto const index = images_.size();
+            images_.emplace(&_image, index);
+            writer_.writeVarUInt(index);
+            writer_.write(_image.format());
+            writer_.write(_image.size());
+            writer_.writeVarUInt(_image.data().size());
+            writer_.writeBytes(_image.data().data(), _image.data().size());
+        }
+
+        BinaryWriter& writer_;
+        unordered_map<Image const*, size_t> images_;
+        unordered_map<RasterizedImage const*, size_t> rasterizedImages_;
+    };
+    // }}}
+
+    // {{{ SnapshotReader
+    struct GridSnapshot
+    {
+        PageSize pageSize;
+        vector<Line<Cell>> lines;
+    };
+
+    struct Snapshot
+    {
+        PageSize pageSize;
+        ScreenType screenType = ScreenType::Primary;
+        HyperlinkStorage hyperlinks;
+        ColorPalette colorPalette;
+        Modes modes;
+        bool applicationCursorKeys = false;
+        bool applicationKeypad = false;
+        bool bracketedPaste = false;
+        optional<MouseProtocol> mouseProtocol;
+        MouseTransport mouseTransport = MouseTransport::Default;
+        InputGenerator::MouseWheelMode mouseWheelMode = InputGenerator::MouseWheelMode::Default;
+        bool generateFocusEvents = false;
+        Margin margin;
+        vector<ColumnOffset> tabs;
+        Cursor cursor;
+        Cursor savedCursor;
+        Cursor savedPrimaryCursor;
+        CellLocation lastCursorPosition;
+        bool wrapPending = false;
+        CursorDisplay cursorDisplay = CursorDisplay::Steady;
+        CursorShape cursorShape = CursorShape::Block;
+        string currentWorkingDirectory;
+        string windowTitle;
+        std::stack<string> savedWindowTitles;
+        GridSnapshot primaryBuffer;
+        GridSnapshot alternateBuffer;
+    };
+
+    class SnapshotReader
+    {
+      public:
+        SnapshotReader(string_view _data, ImagePool& _imagePool): reader_ { _data }, imagePool_ { _imagePool } {}
+
+        /// Reads the snapshot, starting off with the given color palette in order to keep
+        /// the properties that are not part of the snapshot.
+        Snapshot read(ColorPalette _colorPalette)
+        {
+            if (reader_.remaining() < SnapshotMagic.size() + sizeof(uint32_t)
+                || reader_.readBytes(SnapshotMagic.size()) != SnapshotMagic
+                || reader_.read<uint32_t>() != TerminalSnapshotVersion)
+                throw runtime_error("Incompatible terminal snapshot version.");
+
+            auto snapshot = Snapshot {};
+            snapshot.pageSize = readPageSize();
+            snapshot.screenType = readEnum(ScreenType::Alternate);
+            readHyperlinks(snapshot.hyperlinks);
+            snapshot.colorPalette = std::move(_colorPalette);
+            readColorPalette(snapshot.colorPalette);
+            snapshot.modes = readModes();
+
+            snapshot.applicationCursorKeys = readBool();
+            snapshot.applicationKeypad = readBool();
+            snapshot.bracketedPaste = readBool();
+            if (readBool())
+                snapshot.mouseProtocol = reader_.read<MouseProtocol>();
+            snapshot.mouseTransport = readEnum(MouseTransport::URXVT);
+            snapshot.mouseWheelMode = readEnum(InputGenerator::MouseWheelMode::ApplicationCursorKeys);
+            snapshot.generateFocusEvents = readBool();
+
+            snapshot.margin = readMargin(snapshot.pageSize);
+            auto const tabCount = reader_.readVarUInt();
+            if (tabCount > reader_.remaining())
+                invalidSnapshot();
+            for (uint64_t i = 0; i < tabCount; ++i)
+            {
+                auto const tab = reader_.readVarUInt();
+                if (tab >= unbox<uint64_t>(snapshot.pageSize.columns))
+                    invalidSnapshot();
+                snapshot.tabs.emplace_back(ColumnOffset::cast_from(tab));
+            }
+
+            snapshot.cursor = readCursor(snapshot.pageSize);
+            snapshot.savedCursor = readCursor(snapshot.pageSize);
+            snapshot.savedPrimaryCursor = readCursor(snapshot.pageSize);
+            snapshot.lastCursorPosition = readPosition(snapshot.pageSize);
+            snapshot.wrapPending = readBool();
+            snapshot.cursorDisplay = readEnum(CursorDisplay::Blink);
+            snapshot.cursorShape = readEnum(CursorShape::Bar);
+
+            snapshot.currentWorkingDirectory = reader_.readString();
+            snapshot.windowTitle = reader_.readString();
+            auto savedWindowTitles = vector<string>(checkedCount(reader_.readVarUInt()));
+            for (auto& title: savedWindowTitles)
+                title = reader_.readString();
+            std::for_each(savedWindowTitles.rbegin(), savedWindowTitles.rend(), [&](string& _title) {
+                snapshot.savedWindowTitles.emplace(std::move(_title));
+            });
+
+            snapshot.primaryBuffer = readGrid();
+            snapshot.alternateBuffer = readGrid();
+
+            if (!reader_.atEnd())
+                invalidSnapshot();
+
+            return snapshot;
+        }
+
+      private:
+        // Bounds a count of items that take at least one byte each, before allocating for them.
+        size_t checkedCount(uint64_t _count) const
+        {
+            if (_count > reader_.remaining())
+                invalidSnapshot();
+            return static_cast<size_t>(_count);
+        }
+
+        bool readBool() { return reader_.read<uint8_t>() != 0; }
+
+        template <typename T>
+        T readEnum(T _max)
+        {
+            auto const value = reader_.read<T>();
+            if (static_cast<unsigned>(value) > static_cast<unsigned>(_max))
+                invalidSnapshot();
+            return value;
+        }
+
+        PageSize readPageSize()
+        {
+            auto const pageSize = reader_.read<PageSize>();
+            if (*pageSize.lines <= 0 || *pageSize.columns <= 0)
+                invalidSnapshot();
+            return pageSize;
+        }
+
+        CellLocation readPosition(PageSize _pageSize)
+        {
+            auto const position = reader_.read<CellLocation>();
+            if (position.line < LineOffset(0) || position.line >= boxed_cast<LineOffset>(_pageSize.lines)
+                || position.column < ColumnOffset(0)
+                || position.column >= boxed_cast<ColumnOffset>(_pageSize.columns))
+                invalidSnapshot();
+            return position;
+        }
+
+        Margin readMargin(PageSize _pageSize)
+        {
+            auto const margin = reader_.read<Margin>();
+            if (margin.vertical.from < LineOffset(0) || margin.vertical.from > margin.vertical.to
+                || margin.vertical.to >= boxed_cast<LineOffset>(_pageSize.lines)
+                || margin.horizontal.from < ColumnOffset(0) || margin.horizontal.from > margin.horizontal.to
+                || margin.horizontal.to >= boxed_cast<ColumnOffset>(_pageSize.columns))
+                invalidSnapshot();
+            return margin;
+        }
+
+        void readHyperlinks(HyperlinkStorage& _hyperlinks)
+        {
+            auto const count = reader_.readVarUInt();
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                auto const id = reader_.readVarUInt();
+                auto userId = reader_.readString();
+                auto uri = reader_.readString();
+                if (id == 0 || id > HyperlinkStorage::MaxHyperlinkCount)
+                    invalidSnapshot();
+                if (hyperlinkIds_.size() <= id)
+                    hyperlinkIds_.resize(id + 1);
+                hyperlinkIds_[id] = _hyperlinks.hyperlinkIdOf(std::move(userId), std::move(uri));
+            }
+        }
+
+        optional<RGBColor> readOptionalColor()
+        {
+            if (readBool())
+                return reader_.read<RGBColor>();
+            return nullopt;
+        }
+
+        CellRGBColor readCellColor()
+        {
+            switch (reader_.read<uint8_t>())
+            {
+                case 0: return reader_.read<RGBColor>();
+                case 1: return CellForegroundColor {};
+                case 2: return CellBackgroundColor {};
+                default: invalidSnapshot();
+            }
+        }
+
+        void readColorPalette(ColorPalette& _palette)
+        {
+            _palette.useBrightColors = readBool();
+            _palette.palette = reader_.read<ColorPalette::Palette>();
+            _palette.defaultForeground = reader_.read<RGBColor>();
+            _palette.defaultBackground = reader_.read<RGBColor>();
+            _palette.selectionForeground = readOptionalColor();
+            _palette.selectionBackground = readOptionalColor();
+            _palette.cursor.color = readCellColor();
+            _palette.cursor.textOverrideColor = readCellColor();
+            _palette.mouseForeground = reader_.read<RGBColor>();
+            _palette.mouseBackground = reader_.read<RGBColor>();
+            _palette.hyperlinkDecoration.normal = reader_.read<RGBColor>();
+            _palette.hyperlinkDecoration.hover = reader_.read<RGBColor>();
+        }
+
+        template <typename Mode>
+        Mode readMode(size_t _count)
+        {
+            auto const value = reader_.readVarUInt();
+            if (value >= _count)
+                invalidSnapshot();
+            return static_cast<Mode>(value);
+        }
+
+        Modes readModes()
+        {
+            auto modes = Modes {};
+
+            auto const ansiModeCount = reader_.readVarUInt();
+            for (uint64_t i = 0; i < ansiModeCount; ++i)
+                modes.set(readMode<AnsiMode>(Modes::AnsiModeCount), true);
+
+            auto const decModeCount = reader_.readVarUInt();
+            for (uint64_t i = 0; i < decModeCount; ++i)
+                modes.set(readMode<DECMode>(Modes::DECModeCount), true);
+
+            auto savedModes = std::map<DECMode, vector<bool>> {};
+            auto const savedModeCount = reader_.readVarUInt();
+            for (uint64_t i = 0; i < savedModeCount; ++i)
+            {
+                auto& stack = savedModes[readMode<DECMode>(Modes::DECModeCount)];
+                auto const depth = reader_.readVarUInt();
+                for (uint64_t k = 0; k < depth; ++k)
+                    stack.push_back(readBool());
+            }
+            modes.setSavedModes(std::move(savedModes));
+
+            return modes;
+        }
+
+        CharsetTable readCharsetTable()
+        {
+            return static_cast<CharsetTable>(readEnum(static_cast<uint8_t>(CharsetTable::G3)));
+        }
+
+        Cursor readCursor(PageSize _pageSize)
+        {
+            auto cursor = Cursor {};
+            cursor.position = readPosition(_pageSize);
+            cursor.autoWrap = readBool();
+            cursor.originMode = readBool();
+            cursor.visible = readBool();
+            cursor.graphicsRendition = reader_.read<GraphicsAttributes>();
+            for (auto const table: { CharsetTable::G0, CharsetTable::G1, CharsetTable::G2, CharsetTable::G3 })
+                cursor.charsets.select(table,
+                                       static_cast<CharsetId>(readEnum(static_cast<uint8_t>(CharsetId::USASCII))));
+            cursor.charsets.selectDefaultTable(readCharsetTable());
+            cursor.charsets.singleShift(readCharsetTable());
+            cursor.hyperlink = readHyperlinkId();
+            return cursor;
+        }
+
+        HyperlinkId readHyperlinkId()
+        {
+            auto const id = reader_.readVarUInt();
+            if (id < hyperlinkIds_.size())
+                return hyperlinkIds_[id];
+            return HyperlinkId {};
+        }
+
+        GridSnapshot readGrid()
+        {
+            auto grid = GridSnapshot {};
+            grid.pageSize = readPageSize();
+            auto const historyLineCount = reader_.readVarUInt();
+            auto const trivialTextSize = checkedCount(reader_.readVarUInt());
+            auto const lineCount = checkedCount(unbox<uint64_t>(grid.pageSize.lines) + historyLineCount);
+
+            trivialText_ = crispy::BufferObject::create(std::max<size_t>(trivialTextSize, 1));
+            grid.lines.reserve(lineCount);
+            for (size_t i = 0; i < lineCount; ++i)
+                grid.lines.emplace_back(readLine(grid.pageSize.columns));
+            return grid;
+        }
+
+        Line<Cell> readLine(ColumnCount _columns)
+        {
+            auto const flags = static_cast<LineFlags>(reader_.read<uint8_t>());
+            auto const width = reader_.readVarUInt();
+            if (width != unbox<uint64_t>(_columns))
+                invalidSnapshot();
+            auto const columns = ColumnCount::cast_from(width);
+
+            if (readEnum(LineKind::Inflated) == LineKind::Trivial)
+            {
+                auto const attributes = reader_.read<GraphicsAttributes>();
+                auto const hyperlink = readHyperlinkId();
+                auto const text = reader_.readStringView();
+                auto line = Line<Cell>(flags, columns, attributes);
+                if (!text.empty() || !!hyperlink)
+                {
+                    if (text.size() > trivialText_->bytesAvailable())
+                        invalidSnapshot();
+                    auto const region = trivialText_->writeAtEnd(text);
+                    trivialText_->advance(region.size());
+                    line.reset(attributes, hyperlink, crispy::BufferFragment(trivialText_, region));
+                }
+                return line;
+            }
+
+            auto cells = Line<Cell>::InflatedBuffer {};
+            cells.reserve(width);
+            while (cells.size() < width)
+            {
+                auto const count = reader_.readVarUInt();
+                if (count == 0 || count > width - cells.size())
+                    invalidSnapshot();
+                auto cell = readCell();
+                for (uint64_t i = 1; i < count; ++i)
+                    cells.emplace_back(cell);
+                cells.emplace_back(std::move(cell));
+            }
+            return Line<Cell>(flags, std::move(cells));
+        }
+
+        Cell readCell()
+        {
+            auto const record = reader_.readVarUInt();
+
+            auto const codepoint = static_cast<char32_t>(record & HasCodepoint ? reader_.readVarUInt() : 0);
+            auto combiningCodepoints = std::u32string {};
+            if (record & HasCombiningCodepoints)
+            {
+                auto const count = reader_.readVarUInt();
+                if (count >= Cell::MaxCodepoints)
+                    invalidSnapshot();
+                for (uint64_t i = 0; i < count; ++i)
+                    combiningCodepoints.push_back(static_cast<char32_t>(reader_.readVarUInt()));
+            }
+
+            auto const width = record & HasWidth ? reader_.read<uint8_t>() : uint8_t(1);
+            if (width >= Cell::MaxCodepoints)
+                invalidSnapshot();
+
+            auto attributes = GraphicsAttributes {};
+            if (record & HasForegroundColor)
+                attributes.foregroundColor = reader_.read<Color>();
+            if (record & HasBackgroundColor)
+                attributes.backgroundColor = reader_.read<Color>();
+            if (record & HasUnderlineColor)
+                attributes.underlineColor = reader_.read<Color>();
+            if (record & HasStyles)
+                attributes.styles = reader_.read<CellFlags>();
+            auto const hyperlink = record & HasHyperlink ? readHyperlinkId() : HyperlinkId {};
+
+            auto cell = Cell {};
+            cell.write(attributes, codepoint, width, hyperlink);
+            if (!combiningCodepoints.empty())
+                cell.extra().codepoints = std::move(combiningCodepoints);
+
+            if (record & HasImageFragment)
+            {
+                auto image = readRasterizedImage();
+                cell.setImageFragment(std::move(image), reader_.read<CellLocation>());
+            }
+
+            return cell;
+        }
+
+        shared_ptr<RasterizedImage> readRasterizedImage()
+        {
+            auto const index = reader_.readVarUInt();
+            if (index < rasterizedImages_.size())
+                return rasterizedImages_[index];
+            if (index != rasterizedImages_.size())
+                invalidSnapshot();
+
+            auto image = readImage();
+            auto const alignmentPolicy = readEnum(ImageAlignment::BottomEnd);
+            auto const resizePolicy = readEnum(ImageResize::StretchToFill);
+            auto const defaultColor = reader_.read<RGBAColor>();
+            auto const cellSpan = reader_.read<GridSize>();
+            auto const cellSize = reader_.read<ImageSize>();
+            return rasterizedImages_.emplace_back(imagePool_.rasterize(
+                std::move(image), alignmentPolicy, resizePolicy, defaultColor, cellSpan, cellSize));
+        }
+
+        shared_ptr<Image const> readImage()
+        {
+            auto const index = reader_.readVarUInt();
+            if (index < images_.size())
+                return images_[index];
+            if (index != images_.size())
+                invalidSnapshot();
+
+            auto const format = readEnum(ImageFormat::RGBA);
+            auto const size = reader_.read<ImageSize>();
+            auto const bytes = reader_.readBytes(reader_.readVarUInt());
+            auto const bytesPerPixel = format == ImageFormat::RGBA ? 4u : 3u;
+            if (bytes.size() != size.area() * bytesPerPixel)
+                invalidSnapshot();
+            auto data = Image::Data(bytes.begin(), bytes.end());
+            return images_.emplace_back(imagePool_.create(format, size, std::move(data)));
+        }
+
+        BinaryReader reader_;
+        ImagePool& imagePool_;
+        vector<HyperlinkId> hyperlinkIds_; // hyperlink ID in the snapshot to the restored hyperlink ID
+        vector<shared_ptr<Image const>> images_;
+        vector<shared_ptr<RasterizedImage>> rasterizedImages_;
+        crispy::BufferObjectPtr trivialText_;
+    };
+    // }}}
+
+} // namespace
+
+void writeSnapshot(Terminal const& _terminal, BinaryWriter& _writer)
+{
+    auto const& state = _terminal.state();
+    auto writer = SnapshotWriter(_writer);
+
+    _writer.writeBytes(SnapshotMagic.data(), SnapshotMagic.size());
+    _writer.write(TerminalSnapshotVersion);
+
+    _writer.write(state.pageSize);
+    _writer.write(state.screenType);
+    writer.writeHyperlinks(state.hyperlinks);
+    writer.writeColorPalette(state.colorPalette);
+    writer.writeModes(state.modes);
+    writer.writeInputGenerator(state.inputGenerator);
+
+    _writer.write(state.margin);
+    _writer.writeVarUInt(state.tabs.size());
+    for (auto const column: state.tabs)
+        _writer.writeVarUInt(unbox<uint64_t>(column));
+
+    writer.writeCursor(state.cursor);
+    writer.writeCursor(state.savedCursor);
+    writer.writeCursor(state.savedPrimaryCursor);
+    _writer.write(state.lastCursorPosition);
+    writer.writeBool(state.wrapPending);
+    _writer.write(state.cursorDisplay);
+    _writer.write(state.cursorShape);
+
+    _writer.writeString(state.currentWorkingDirectory);
+    _writer.writeString(state.windowTitle);
+    auto savedWindowTitles = state.savedWindowTitles;
+    _writer.writeVarUInt(savedWindowTitles.size());
+    for (; !savedWindowTitles.empty(); savedWindowTitles.pop())
+        _writer.writeString(savedWindowTitles.top());
+
+    writer.writeGrid(state.primaryBuffer);
+    writer.writeGrid(state.alternateBuffer);
+}
+
+string createSnapshot(Terminal const& _terminal)
+{
+    auto writer = BinaryWriter();
+    writeSnapshot(_terminal, writer);
+    return writer.data();
+}
+
+void restoreSnapshot(Terminal& _terminal, std::string_view _data)
+{
+    // Decode everything upfront, so that an invalid snapshot leaves the terminal untouched.
+    auto snapshot = [&]() {
+        auto const _l = std::lock_guard { _terminal };
+        auto& state = _terminal.state();
+        return SnapshotReader(_data, state.imagePool).read(state.colorPalette);
+    }();
+
+    if (snapshot.pageSize != _terminal.state().pageSize)
+        _terminal.resizeScreen(snapshot.pageSize);
+
+    auto const _l = std::lock_guard { _terminal };
+    auto& state = _terminal.state();
+
+    state.hyperlinks = std::move(snapshot.hyperlinks);
+    state.colorPalette = std::move(snapshot.colorPalette);
+    state.modes = std::move(snapshot.modes);
+    state.margin = snapshot.margin;
+    state.tabs = std::move(snapshot.tabs);
+
+    state.primaryBuffer.restoreLines(snapshot.primaryBuffer.pageSize, std::move(snapshot.primaryBuffer.lines));
+    state.alternateBuffer.restoreLines(snapshot.alternateBuffer.pageSize,
+                                       std::move(snapshot.alternateBuffer.lines));
+    _terminal.setScreen(snapshot.screenType);
+    _terminal.viewport().forceScrollToBottom();
+
+    state.cursor = snapshot.cursor;
+    state.savedCursor = snapshot.savedCursor;
+    state.savedPrimaryCursor = snapshot.savedPrimaryCursor;
+    state.lastCursorPosition = snapshot.lastCursorPosition;
+    state.wrapPending = snapshot.wrapPending;
+    state.cursorDisplay = snapshot.cursorDisplay;
+    state.cursorShape = snapshot.cursorShape;
+
+    // Restored after switching the screen, which adjusts the mouse wheel mode.
+    auto& input = state.inputGenerator;
+    input.setCursorKeysMode(snapshot.applicationCursorKeys ? KeyMode::Application : KeyMode::Normal);
+    input.setApplicationKeypadMode(snapshot.applicationKeypad);
+    input.setBracketedPaste(snapshot.bracketedPaste);
+    if (snapshot.mouseProtocol)
+        input.setMouseProtocol(*snapshot.mouseProtocol, true);
+    else if (auto const mouseProtocol = input.mouseProtocol())
+        input.setMouseProtocol(*mouseProtocol, false);
+    input.setMouseTransport(snapshot.mouseTransport);
+    input.setMouseWheelMode(snapshot.mouseWheelMode);
+    input.setGenerateFocusEvents(snapshot.generateFocusEvents);
+
+    state.currentWorkingDirectory = std::move(snapshot.currentWorkingDirectory);
+    state.windowTitle = std::move(snapshot.windowTitle);
+    state.savedWindowTitles = std::move(snapshot.savedWindowTitles);
+}
+
+} // namespace terminal
@@ -0,0 +1,61 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <crispy/BinaryStream.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace terminal
+{
+
+class Terminal;
+
+/// Version of the binary terminal snapshot format.
+///
+/// This must be incremented whenever the snapshot's layout changes.
+constexpr uint32_t TerminalSnapshotVersion = 1;
+
+/**
+ * Writes a binary snapshot of the terminal's state.
+ *
+ * The snapshot contains both screen buffers including their scrollback, the cursors,
+ * modes, color palette, tab stops, hyperlinks and images referenced by grid cells,
+ * so that a session can be restored from it later on (e.g. across application restarts).
+ *
+ * Lines that share their graphics rendition are stored as is, all other lines
+ * are stored as runs of equal cells.
+ *
+ * The terminal must be locked by the caller.
+ */
+void writeSnapshot(Terminal const& _terminal, crispy::BinaryWriter& _writer);
+
+/// Convenience wrapper around writeSnapshot(), returning the snapshot in memory.
+std::string createSnapshot(Terminal const& _terminal);
+
+/**
+ * Restores the terminal's state from a snapshot as created by writeSnapshot().
+ *
+ * The snapshot's memory is only read from, so it may as well be a memory mapped file.
+ * The terminal is resized to the snapshot's page size if needed and locked
+ * while being restored, so it must not be locked by the caller.
+ *
+ * @throws std::runtime_error if the snapshot is invalid or of an incompatible version,
+ *         in which case the terminal's screen contents are left untouched.
+ */
+void restoreSnapshot(Terminal& _terminal, std::string_view _snapshot);
+
+} // namespace terminal
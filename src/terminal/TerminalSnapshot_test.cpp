@@ -0,0 +1,183 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/MockTerm.h>
+#include <terminal/TerminalSnapshot.h>
+
+#include <fmt/format.h>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace terminal;
+using namespace std::string_literals;
+
+namespace
+{
+
+std::string gridText(Grid<Cell> const& _grid)
+{
+    auto text = std::string {};
+    for (auto line = -boxed_cast<LineOffset>(_grid.historyLineCount());
+         line < boxed_cast<LineOffset>(_grid.pageSize().lines);
+         ++line)
+        text += _grid.lineText(line) + '\n';
+    return text;
+}
+
+} // namespace
+
+TEST_CASE("TerminalSnapshot.roundtrip", "[snapshot]")
+{
+    auto const pageSize = PageSize { LineCount(4), ColumnCount(12) };
+    auto source = MockTerm { pageSize, LineCount(10) };
+    for (int i = 0; i < 8; ++i)
+        source.writeToScreen(fmt::format("line {}\r\n", i));
+    source.writeToScreen("\033[1;31mred\033[m "s);
+    source.writeToScreen("\033]8;id=x;https://example.com/\033\\link\033]8;;\033\\ ");
+    source.writeToScreen(u8"ä̈\U0001F600");
+    source.writeToScreen("\033[?2004h\033[?1006h\033[?1000h\033[5 q\033]2;Title\033\\");
+    source.writeToScreen("\033[3;5H\0337\033[1;1H");
+
+    auto const snapshot = createSnapshot(source.terminal);
+
+    auto target = MockTerm { PageSize { LineCount(6), ColumnCount(20) }, LineCount(10) };
+    target.writeToScreen("old contents");
+    restoreSnapshot(target.terminal, snapshot);
+
+    // Taking a snapshot of the restored terminal yields the same snapshot.
+    // (Done first, as inspecting the lines' text below may change their representation.)
+    CHECK(createSnapshot(target.terminal) == snapshot);
+
+    auto const& sourceState = source.terminal.state();
+    auto const& targetState = target.terminal.state();
+    CHECK(targetState.pageSize == pageSize);
+    CHECK(targetState.primaryBuffer.historyLineCount() == sourceState.primaryBuffer.historyLineCount());
+    CHECK(gridText(targetState.primaryBuffer) == gridText(sourceState.primaryBuffer));
+    CHECK(targetState.cursor.position == sourceState.cursor.position);
+    CHECK(targetState.savedCursor.position == CellLocation { LineOffset(2), ColumnOffset(4) });
+    CHECK(targetState.cursorShape == CursorShape::Bar);
+    CHECK(targetState.windowTitle == "Title");
+    CHECK(target.terminal.isModeEnabled(DECMode::BracketedPaste));
+    CHECK(targetState.inputGenerator.bracketedPaste());
+    CHECK(targetState.inputGenerator.mouseProtocol() == MouseProtocol::NormalTracking);
+    CHECK(targetState.inputGenerator.mouseTransport() == MouseTransport::SGR);
+
+    // The last line is inflated, containing styled text, a hyperlink and combining characters.
+    auto const& line = targetState.primaryBuffer.lineAt(LineOffset(3));
+    CHECK(line.cells()[0].styles() == CellFlags::Bold);
+    CHECK(line.cells()[0].foregroundColor() == Color::Indexed(IndexedColor::Red));
+    auto const hyperlink = targetState.hyperlinks.hyperlinkById(line.cells()[4].hyperlink());
+    REQUIRE(hyperlink);
+    CHECK(hyperlink->uri == "https://example.com/");
+    CHECK(hyperlink->userId == "x");
+    CHECK(line.cells()[9].codepointCount() == 2);
+    CHECK(line.cells()[10].width() == 2);
+}
+
+TEST_CASE("TerminalSnapshot.alternateScreen", "[snapshot]")
+{
+    auto const pageSize = PageSize { LineCount(3), ColumnCount(8) };
+    auto source = MockTerm { pageSize, LineCount(5) };
+    source.writeToScreen("primary");
+    source.writeToScreen("\033[?1049h\033[2;3Halt");
+
+    auto target = MockTerm { pageSize, LineCount(5) };
+    restoreSnapshot(target.terminal, createSnapshot(source.terminal));
+
+    CHECK(target.terminal.isAlternateScreen());
+    CHECK(target.terminal.primaryScreen().grid().lineText(LineOffset(0)) == "primary ");
+    CHECK(target.terminal.alternateScreen().grid().lineText(LineOffset(1)) == "  alt   ");
+    CHECK(target.terminal.state().cursor.position == CellLocation { LineOffset(1), ColumnOffset(5) });
+
+    target.writeToScreen("\033[?1049l");
+    CHECK(target.terminal.isPrimaryScreen());
+    CHECK(target.terminal.state().cursor.position == CellLocation { LineOffset(0), ColumnOffset(7) });
+}
+
+TEST_CASE("TerminalSnapshot.streaming", "[snapshot]")
+{
+    auto source = MockTerm { PageSize { LineCount(3), ColumnCount(8) }, LineCount(5) };
+    source.writeToScreen("Hello");
+
+    auto output = std::ostringstream {};
+    {
+        auto writer = crispy::BinaryWriter(output);
+        writeSnapshot(source.terminal, writer);
+    }
+    CHECK(output.str() == createSnapshot(source.terminal));
+}
+
+TEST_CASE("TerminalSnapshot.invalid", "[snapshot]")
+{
+    auto const pageSize = PageSize { LineCount(3), ColumnCount(8) };
+    auto source = MockTerm { pageSize, LineCount(5) };
+    source.writeToScreen("\033[31msource");
+    auto const snapshot = createSnapshot(source.terminal);
+
+    auto target = MockTerm { pageSize, LineCount(5) };
+    target.writeToScreen("target");
+
+    CHECK_THROWS_AS(restoreSnapshot(target.terminal, "garbage"), std::runtime_error);
+    CHECK_THROWS_AS(restoreSnapshot(target.terminal, snapshot.substr(0, snapshot.size() - 1)),
+                    std::runtime_error);
+
+    // Snapshots of states that are inconsistent with the page size are rejected, too.
+    auto const checkInvalidState = [&](auto _corrupt) {
+        auto invalid = MockTerm { pageSize, LineCount(5) };
+        invalid.writeToScreen("\033[31minvalid");
+        _corrupt(invalid.terminal.state());
+        CHECK_THROWS_AS(restoreSnapshot(target.terminal, createSnapshot(invalid.terminal)),
+                        std::runtime_error);
+    };
+    checkInvalidState([](TerminalState& _state) {
+        _state.primaryBuffer.lineAt(LineOffset(1)).resize(ColumnCount(4));
+    });
+    checkInvalidState([](TerminalState& _state) { _state.cursor.position.line = LineOffset(3); });
+    checkInvalidState([](TerminalState& _state) { _state.savedCursor.position.column = ColumnOffset(8); });
+    checkInvalidState([](TerminalState& _state) { _state.margin.vertical.to = LineOffset(3); });
+    checkInvalidState([](TerminalState& _state) {
+        auto image =
+            _state.imagePool.create(ImageFormat::RGBA, ImageSize { Width(2), Height(2) }, Image::Data(15));
+        auto rasterizedImage = _state.imagePool.rasterize(std::move(image),
+                                                          ImageAlignment::TopStart,
+                                                          ImageResize::NoResize,
+                                                          RGBAColor {},
+                                                          GridSize { LineCount(1), ColumnCount(1) },
+                                                          ImageSize { Width(2), Height(2) });
+        _state.primaryBuffer.lineAt(LineOffset(0))
+            .useCellAt(ColumnOffset(0))
+            .setImageFragment(std::move(rasterizedImage), CellLocation {});
+    });
+
+    CHECK(target.terminal.primaryScreen().grid().lineText(LineOffset(0)) == "target  ");
+}
+
+TEST_CASE("TerminalSnapshot.benchmark", "[.benchmark]")
+{
+    auto const pageSize = PageSize { LineCount(50), ColumnCount(120) };
+    auto const historyLineCount = LineCount(100'000);
+    auto source = MockTerm { pageSize, historyLineCount, 1024 * 1024 };
+    auto text = std::string {};
+    for (int i = 0; i < unbox<int>(historyLineCount + pageSize.lines); ++i)
+        text += fmt::format("\033[{}mLine {} of the scrollback with some text in it.\033[m\r\n", 31 + i % 7, i);
+    source.writeToScreen(text);
+
+    auto const snapshot = createSnapshot(source.terminal);
+    auto target = MockTerm { pageSize, historyLineCount };
+
+    BENCHMARK("createSnapshot") { return createSnapshot(source.terminal); };
+    BENCHMARK("restoreSnapshot") { restoreSnapshot(target.terminal, snapshot); };
+}
@@ -48,7 +48,6 @@ TerminalState::TerminalState(Terminal& _terminal,
     alternateBuffer { Grid<Cell>(_pageSize, false, LineCount(0)) },
     cursor {},
     lastCursorPosition {},
-    hyperlinks { HyperlinkCache { 1024 } },
     sequencer { _terminal },
     parser { std::ref(sequencer) },
     viCommands { terminal },
@@ -50,6 +50,9 @@ class Terminal;
 class Modes
 {
   public:
+    static constexpr size_t AnsiModeCount = 32;
+    static constexpr size_t DECModeCount = 8452 + 1;
+
     void set(AnsiMode _mode, bool _enabled) { ansi_.set(static_cast<size_t>(_mode), _enabled); }
 
     void set(DECMode _mode, bool _enabled) { dec_.set(static_cast<size_t>(_mode), _enabled); }
@@ -80,11 +83,41 @@ class Modes
         }
     }
 
+    /// @returns all enabled ANSI modes.
+    [[nodiscard]] std::vector<AnsiMode> enabledAnsiModes() const
+    {
+        auto modes = std::vector<AnsiMode> {};
+        for (size_t i = 0; i < ansi_.size(); ++i)
+            if (ansi_.test(i))
+                modes.push_back(static_cast<AnsiMode>(i));
+        return modes;
+    }
+
+    /// @returns all enabled DEC modes.
+    [[nodiscard]] std::vector<DECMode> enabledDECModes() const
+    {
+        auto modes = std::vector<DECMode> {};
+        for (size_t i = 0; i < dec_.size(); ++i)
+            if (dec_.test(i))
+                modes.push_back(static_cast<DECMode>(i));
+        return modes;
+    }
+
+    [[nodiscard]] std::map<DECMode, std::vector<bool>> const& savedModes() const noexcept
+    {
+        return savedModes_;
+    }
+
+    void setSavedModes(std::map<DECMode, std::vector<bool>> _savedModes)
+    {
+        savedModes_ = std::move(_savedModes);
+    }
+
   private:
     // TODO: make this a vector<bool> by casting from Mode, but that requires ensured small linearity in Mode
     // enum values.
-    std::bitset<32> ansi_;                            // AnsiMode
-    std::bitset<8452 + 1> dec_;                       // DECMode
+    std::bitset<AnsiModeCount> ansi_;                 // AnsiMode
+    std::bitset<DECModeCount> dec_;                   // DECMode
     std::map<DECMode, std::vector<bool>> savedModes_; //!< saved DEC modes
 };
 // }}}
@@ -128,9 +128,9 @@ class MockTerm: public terminal::Terminal::Events
 
     string const& replyData() const noexcept { return pty_.stdinBuffer(); }
 
-    void requestCaptureBuffer(LineCount lines, bool logical) override
+    void requestCaptureBuffer(LineCount lines, bool logical, terminal::CaptureFormat format) override
     {
-        terminal_.primaryScreen().captureBuffer(lines, logical);
+        terminal_.captureBuffer(lines, logical, format);
     }
 
     void logScreenText(std::string const& headline = "")
@@ -285,6 +285,7 @@ TEST_CASE("Terminal.CaptureScreenBuffer")
     REQUIRE("6\n7\n8\n9\n10" == actualScreen1);
 
     mock.writeToStdout(fmt::format("\033[>{};{}t", NoLogicalLines, NumberOfLinesToCapture));
+    mock.terminal().waitForCaptureBuffer();
     mock.terminal().flushInput();
 
     mock.terminal().tick(ClockBase + chrono::seconds(1));
@@ -323,6 +324,49 @@ TEST_CASE("Terminal.SynchronizedOutput", "[terminal]")
     CHECK("Hello  World" == trimmedTextScreenshot(mc));
 }
 
+TEST_CASE("Terminal.SynchronizedOutput.timeout", "[terminal]")
+{
+    auto mc = MockTerm { ColumnCount(20), LineCount(1) };
+    mc.terminal().setSynchronizedOutputTimeout(chrono::milliseconds(0));
+
+    // The application never ends its synchronized output, so the frame is published anyway.
+    mc.writeToStdout("\033[?2026hHello");
+    CHECK("Hello" == trimmedTextScreenshot(mc));
+    CHECK(mc.terminal().synchronizedOutputStats().timeouts == 1);
+    CHECK(mc.terminal().synchronizedOutputStats().avoidedUpdates == 1);
+
+    mc.terminal().setSynchronizedOutputTimeout(chrono::seconds(60));
+    mc.writeToStdout(" World");
+    CHECK("Hello" == trimmedTextScreenshot(mc));
+
+    mc.writeToStdout("\033[?2026l");
+    CHECK("Hello World" == trimmedTextScreenshot(mc));
+    CHECK(mc.terminal().synchronizedOutputStats().frames == 1);
+    CHECK(mc.terminal().synchronizedOutputStats().timeouts == 1);
+}
+
+TEST_CASE("Terminal.AlternateScreen.release", "[terminal]")
+{
+    auto mc = MockTerm { ColumnCount(10), LineCount(2) };
+    auto const& grid = mc.terminal().alternateScreen().grid();
+    mc.terminal().setAlternateScreenReleaseTimeout(chrono::seconds(60));
+
+    mc.writeToStdout("\033[?1049h\033[31mA\033[32mB\033[?1049l");
+    REQUIRE(grid.lineAt(LineOffset(0)).isInflatedBuffer());
+
+    // Switching again clears the page, but keeps the cells of its lines.
+    mc.writeToStdout("\033[?1049h");
+    CHECK(grid.lineAt(LineOffset(0)).isInflatedBuffer());
+    CHECK(trimmedTextScreenshot(mc).empty());
+    mc.writeToStdout("X\033[?1049l");
+    CHECK(grid.lineAt(LineOffset(0)).isInflatedBuffer());
+
+    // The cells are released once the alternate screen has not been used for a while.
+    mc.terminal().setAlternateScreenReleaseTimeout(chrono::milliseconds(0));
+    mc.writeToStdout("Y");
+    CHECK(grid.lineAt(LineOffset(0)).isTrivialBuffer());
+}
+
 TEST_CASE("Terminal.CurlyUnderline", "[terminal]")
 {
     auto const now = chrono::steady_clock::now();
@@ -345,3 +389,86 @@ TEST_CASE("Terminal.CurlyUnderline", "[terminal]")
     CHECK(!screen.at(LineOffset(0), ColumnOffset(2)).isFlagEnabled(CellFlags::Italic));
     CHECK(!screen.at(LineOffset(0), ColumnOffset(3)).isFlagEnabled(CellFlags::Italic));
 }
+
+TEST_CASE("Terminal.extractSelectionText", "[terminal]")
+{
+    using terminal::CellLocation;
+    auto mc = MockTerm { ColumnCount(10), LineCount(3) };
+    mc.writeToStdout("Hello   \r\n\033[1mWor\033[mld!\r\nFoo");
+    auto& terminal = mc.terminal();
+
+    SECTION("linear")
+    {
+        terminal.setSelector(make_unique<terminal::LinearSelection>(
+            terminal.selectionHelper(), CellLocation { LineOffset(0), ColumnOffset(1) }));
+        terminal.selector()->extend(CellLocation { LineOffset(2), ColumnOffset(1) });
+        CHECK(e(terminal.extractSelectionText()) == e("ello\nWorld!\nFo"));
+    }
+
+    SECTION("full line")
+    {
+        terminal.setSelector(make_unique<terminal::FullLineSelection>(
+            terminal.selectionHelper(), CellLocation { LineOffset(1), ColumnOffset(3) }));
+        terminal.selector()->extend(CellLocation { LineOffset(1), ColumnOffset(3) });
+        CHECK(e(terminal.extractSelectionText()) == e("World!\n"));
+    }
+
+    SECTION("rectangular")
+    {
+        terminal.setSelector(make_unique<terminal::RectangularSelection>(
+            terminal.selectionHelper(), CellLocation { LineOffset(0), ColumnOffset(1) }));
+        terminal.selector()->extend(CellLocation { LineOffset(2), ColumnOffset(2) });
+        CHECK(e(terminal.extractSelectionText()) == e("el\nor\noo"));
+    }
+
+    SECTION("streamed")
+    {
+        terminal.setSelector(make_unique<terminal::LinearSelection>(
+            terminal.selectionHelper(), CellLocation { LineOffset(0), ColumnOffset(0) }));
+        terminal.selector()->extend(CellLocation { LineOffset(2), ColumnOffset(9) });
+        string text;
+        size_t chunks = 0;
+        terminal.extractSelectionText([&](string_view _chunk) {
+            text += _chunk;
+            ++chunks;
+        });
+        CHECK(chunks == 1);
+        CHECK(e(text) == e("Hello\nWorld!\nFoo"));
+    }
+}
+
+TEST_CASE("Terminal.detectedUrls", "[terminal]")
+{
+    using terminal::CellLocation;
+    auto mc = MockTerm { ColumnCount(20), LineCount(3) };
+    mc.writeToStdout("see /tmp/x/y\r\nhttps://b.c/d");
+    auto& terminal = mc.terminal();
+
+    auto const url = terminal.detectedUrlAt(CellLocation { LineOffset(1), ColumnOffset(3) });
+    REQUIRE(url.has_value());
+    CHECK(url->hyperlink->uri == "https://b.c/d");
+    CHECK(!terminal.detectedUrlAt(CellLocation { LineOffset(0), ColumnOffset(2) }));
+
+    CHECK(terminal.urlHints().empty());
+    terminal.setUrlHintsMode(true);
+    auto const hints = terminal.urlHints();
+    REQUIRE(hints.size() == 2);
+    CHECK(hints[0].from == ColumnOffset(4));
+    REQUIRE(terminal.urlHintByLabel('a'));
+    CHECK(terminal.urlHintByLabel('a')->uri == "file:///tmp/x/y");
+    REQUIRE(terminal.urlHintByLabel('s'));
+    CHECK(terminal.urlHintByLabel('s')->uri == "https://b.c/d");
+    CHECK(!terminal.urlHintByLabel('d'));
+
+    // The labels are rendered over the first cell of each URL.
+    terminal.ensureFreshRenderBuffer();
+    CHECK(e("see atmp/x/y\nsttps://b.c/d") == e(trimmedTextScreenshot(mc)));
+
+    terminal.setUrlHintsMode(false);
+    terminal.ensureFreshRenderBuffer();
+    CHECK(e("see /tmp/x/y\nhttps://b.c/d") == e(trimmedTextScreenshot(mc)));
+
+    // New output invalidates what has been detected so far.
+    mc.writeToStdout("\033[2J\033[H");
+    CHECK(!terminal.detectedUrlAt(CellLocation { LineOffset(1), ColumnOffset(3) }));
+}
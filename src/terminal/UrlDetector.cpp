@@ -0,0 +1,243 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/UrlDetector.h>
+
+#include <algorithm>
+#include <array>
+
+using std::array;
+using std::make_shared;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace terminal
+{
+
+namespace
+{
+    constexpr bool isAlphaNumeric(char _ch) noexcept
+    {
+        return ('a' <= _ch && _ch <= 'z') || ('A' <= _ch && _ch <= 'Z') || ('0' <= _ch && _ch <= '9');
+    }
+
+    constexpr bool isSchemeChar(char _ch) noexcept
+    {
+        return isAlphaNumeric(_ch) || _ch == '+' || _ch == '-' || _ch == '.';
+    }
+
+    /// Unreserved, reserved and percent-encoding characters as of RFC 3986.
+    constexpr bool isUrlChar(char _ch) noexcept
+    {
+        if (isAlphaNumeric(_ch))
+            return true;
+
+        switch (_ch)
+        {
+            case '-':
+            case '.':
+            case '_':
+            case '~':
+            case ':':
+            case '/':
+            case '?':
+            case '#':
+            case '[':
+            case ']':
+            case '@':
+            case '!':
+            case '$':
+            case '&':
+            case '\'':
+            case '(':
+            case ')':
+            case '*':
+            case '+':
+            case ',':
+            case ';':
+            case '=':
+            case '%': return true;
+            default: return false;
+        }
+    }
+
+    /// Path characters. The colon is deliberately left out, so that
+    /// compiler diagnostics like "/path/to/file.cpp:12:5" yield the plain path.
+    constexpr bool isPathChar(char _ch) noexcept
+    {
+        if (isAlphaNumeric(_ch))
+            return true;
+
+        switch (_ch)
+        {
+            case '-':
+            case '.':
+            case '_':
+            case '~':
+            case '/':
+            case '+':
+            case '@':
+            case '%':
+            case ',':
+            case '=':
+            case '#': return true;
+            default: return false;
+        }
+    }
+
+    /// Characters that may immediately precede an absolute path.
+    constexpr bool isPathBoundary(char _ch) noexcept
+    {
+        switch (_ch)
+        {
+            case ' ':
+            case '\0':
+            case '"':
+            case '\'':
+            case '`':
+            case '(':
+            case '[':
+            case '<':
+            case '=': return true;
+            default: return false;
+        }
+    }
+
+    constexpr auto Schemes = array<string_view, 4> { "http", "https", "ftp", "file" };
+
+    /// Strips trailing characters that are much more likely to be sentence
+    /// punctuation than part of the URL, including unbalanced closing brackets.
+    size_t trimTrailing(string_view _text, size_t _begin, size_t _end)
+    {
+        auto const unbalanced = [&](char _open, char _close) {
+            auto const span = _text.substr(_begin, _end - _begin);
+            return std::count(span.begin(), span.end(), _close) > std::count(span.begin(), span.end(), _open);
+        };
+
+        while (_end > _begin)
+        {
+            switch (_text[_end - 1])
+            {
+                case '.':
+                case ',':
+                case ';':
+                case ':':
+                case '!':
+                case '?':
+                case '\'': --_end; continue;
+                case ')':
+                    if (!unbalanced('(', ')'))
+                        return _end;
+                    --_end;
+                    continue;
+                case ']':
+                    if (!unbalanced('[', ']'))
+                        return _end;
+                    --_end;
+                    continue;
+                default: return _end;
+            }
+        }
+        return _end;
+    }
+
+    void addUrl(vector<DetectedUrl>& _output, LineOffset _line, size_t _begin, size_t _end, string _uri)
+    {
+        _output.emplace_back(DetectedUrl { _line,
+                                           ColumnOffset::cast_from(_begin),
+                                           ColumnOffset::cast_from(_end - 1),
+                                           make_shared<HyperlinkInfo>(HyperlinkInfo { "", move(_uri) }) });
+    }
+
+    void detectSchemeUrls(string_view _text, LineOffset _line, vector<DetectedUrl>& _output)
+    {
+        for (auto separator = _text.find("://"); separator != _text.npos;
+             separator = _text.find("://", separator + 3))
+        {
+            auto begin = separator;
+            while (begin > 0 && isSchemeChar(_text[begin - 1]))
+                --begin;
+
+            // Let the scheme start at its first letter (e.g. "1.http://").
+            while (begin < separator && !isAlphaNumeric(_text[begin]))
+                ++begin;
+
+            auto const scheme = _text.substr(begin, separator - begin);
+            if (std::none_of(Schemes.begin(), Schemes.end(), [&](auto s) { return s == scheme; }))
+                continue;
+
+            auto end = separator + 3;
+            while (end < _text.size() && isUrlChar(_text[end]))
+                ++end;
+
+            end = trimTrailing(_text, separator + 3, end);
+            if (end == separator + 3)
+                continue;
+
+            addUrl(_output, _line, begin, end, string(_text.substr(begin, end - begin)));
+            separator = end - 3;
+        }
+    }
+
+    void detectPaths(string_view _text, LineOffset _line, vector<DetectedUrl>& _output)
+    {
+        auto const covered = [&](size_t _pos) {
+            return std::any_of(_output.begin(), _output.end(), [&](DetectedUrl const& url) {
+                return url.from <= ColumnOffset::cast_from(_pos) && ColumnOffset::cast_from(_pos) <= url.to;
+            });
+        };
+
+        for (size_t begin = 0; begin < _text.size(); ++begin)
+        {
+            if (_text[begin] != '/' || (begin > 0 && !isPathBoundary(_text[begin - 1])) || covered(begin))
+                continue;
+
+            auto end = begin + 1;
+            while (end < _text.size() && isPathChar(_text[end]))
+                ++end;
+
+            end = trimTrailing(_text, begin, end);
+
+            // Require at least two path components to not match fractions or lone slashes.
+            auto const path = _text.substr(begin, end - begin);
+            if (path.size() <= 2 || path.find('/', 1) == path.npos)
+            {
+                begin = end;
+                continue;
+            }
+
+            addUrl(_output, _line, begin, end, "file://" + string(path));
+            begin = end;
+        }
+    }
+} // namespace
+
+vector<DetectedUrl> detectUrls(string_view _text, LineOffset _line)
+{
+    auto urls = vector<DetectedUrl> {};
+
+    if (_text.find('/') == _text.npos)
+        return urls;
+
+    detectSchemeUrls(_text, _line, urls);
+    auto const schemeUrlCount = urls.size();
+    detectPaths(_text, _line, urls);
+
+    if (schemeUrlCount != 0 && schemeUrlCount != urls.size())
+        std::sort(urls.begin(), urls.end(), [](auto const& a, auto const& b) { return a.from < b.from; });
+
+    return urls;
+}
+
+} // namespace terminal
@@ -0,0 +1,117 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <terminal/Grid.h>
+#include <terminal/Hyperlink.h>
+#include <terminal/primitives.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace terminal
+{
+
+/// A URL or absolute file path that was found in the plain text of a grid line,
+/// i.e. without the application having marked it up as an OSC 8 hyperlink.
+struct DetectedUrl
+{
+    LineOffset line;
+    ColumnOffset from; ///< first column of the URL
+    ColumnOffset to;   ///< last column of the URL (inclusive)
+    std::shared_ptr<HyperlinkInfo const> hyperlink;
+
+    [[nodiscard]] bool contains(CellLocation _pos) const noexcept
+    {
+        return _pos.line == line && from <= _pos.column && _pos.column <= to;
+    }
+};
+
+/// Finds http(s), ftp and file URLs as well as absolute file paths in a line of text.
+///
+/// @param _text one byte per grid column. Columns that do not hold a single
+///              ASCII codepoint must be passed as NUL, as they can never be
+///              part of a match.
+/// @param _line the grid line the text was taken from.
+std::vector<DetectedUrl> detectUrls(std::string_view _text, LineOffset _line);
+
+/// Returns the text of the given line as expected by detectUrls().
+template <typename Cell>
+std::string urlScanText(Line<Cell> const& _line)
+{
+    if (_line.isTrivialBuffer())
+    {
+        auto const& buffer = _line.trivialBuffer();
+        auto text = std::string(buffer.text.view());
+        text.resize(unbox<size_t>(buffer.displayWidth), ' ');
+        return text;
+    }
+
+    auto text = std::string {};
+    text.reserve(unbox<size_t>(_line.size()));
+    for (Cell const& cell: _line.inflatedBuffer())
+    {
+        if (cell.codepointCount() == 0)
+            text.push_back(' ');
+        else if (cell.codepointCount() == 1 && cell.codepoint(0) < 0x80)
+            text.push_back(static_cast<char>(cell.codepoint(0)));
+        else
+            text.push_back('\0');
+    }
+    return text;
+}
+
+/**
+ * Caches the URLs detected per grid line.
+ *
+ * Lines are only scanned when being queried, e.g. when the mouse hovers them,
+ * and the results are kept until invalidate() is called, which the owner must
+ * do whenever the grid contents (or their line offsets) may have changed.
+ */
+class UrlCache
+{
+  public:
+    void invalidate() noexcept { lines_.clear(); }
+
+    template <typename Cell>
+    std::vector<DetectedUrl> const& urlsAt(Grid<Cell> const& _grid, LineOffset _line)
+    {
+        if (auto const i = lines_.find(_line); i != lines_.end())
+            return i->second;
+
+        return lines_[_line] = detectUrls(urlScanText(_grid.lineAt(_line)), _line);
+    }
+
+    template <typename Cell>
+    DetectedUrl const* urlAt(Grid<Cell> const& _grid, CellLocation _pos)
+    {
+        for (DetectedUrl const& url: urlsAt(_grid, _pos.line))
+            if (url.contains(_pos))
+                return &url;
+        return nullptr;
+    }
+
+  private:
+    struct LineHash
+    {
+        size_t operator()(LineOffset _line) const noexcept { return std::hash<int> {}(unbox<int>(_line)); }
+    };
+
+    std::unordered_map<LineOffset, std::vector<DetectedUrl>, LineHash> lines_;
+};
+
+} // namespace terminal
@@ -0,0 +1,100 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2021 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Cell.h>
+#include <terminal/UrlDetector.h>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace std;
+using namespace std::string_view_literals;
+using namespace terminal;
+
+namespace
+{
+string uriAt(vector<DetectedUrl> const& _urls, size_t _index)
+{
+    REQUIRE(_index < _urls.size());
+    return _urls[_index].hyperlink->uri;
+}
+} // namespace
+
+TEST_CASE("UrlDetector.schemes", "[url]")
+{
+    auto const urls = detectUrls("see https://example.com/a?b=c#d and ftp://host/file now", LineOffset(3));
+    REQUIRE(urls.size() == 2);
+
+    CHECK(urls[0].line == LineOffset(3));
+    CHECK(urls[0].from == ColumnOffset(4));
+    CHECK(urls[0].to == ColumnOffset(30));
+    CHECK(uriAt(urls, 0) == "https://example.com/a?b=c#d");
+
+    CHECK(urls[1].from == ColumnOffset(36));
+    CHECK(uriAt(urls, 1) == "ftp://host/file");
+
+    CHECK(detectUrls("ssh://host/path", LineOffset(0)).empty());
+    CHECK(detectUrls("https://", LineOffset(0)).empty());
+}
+
+TEST_CASE("UrlDetector.trailing_punctuation", "[url]")
+{
+    CHECK(uriAt(detectUrls("Go to http://example.com/x.", LineOffset(0)), 0) == "http://example.com/x");
+    CHECK(uriAt(detectUrls("(http://example.com/x)", LineOffset(0)), 0) == "http://example.com/x");
+    CHECK(uriAt(detectUrls("http://en.wiki/Foo_(bar)", LineOffset(0)), 0) == "http://en.wiki/Foo_(bar)");
+    CHECK(uriAt(detectUrls("'http://example.com/'", LineOffset(0)), 0) == "http://example.com/");
+}
+
+TEST_CASE("UrlDetector.paths", "[url]")
+{
+    auto const urls = detectUrls("/src/main.cpp:12:5: error in /usr/include/stdio.h", LineOffset(0));
+    REQUIRE(urls.size() == 2);
+    CHECK(urls[0].from == ColumnOffset(0));
+    CHECK(urls[0].to == ColumnOffset(12));
+    CHECK(uriAt(urls, 0) == "file:///src/main.cpp");
+    CHECK(uriAt(urls, 1) == "file:///usr/include/stdio.h");
+
+    CHECK(detectUrls("1/2 and a/b/c and /tmp", LineOffset(0)).empty());
+}
+
+TEST_CASE("UrlDetector.non_ascii", "[url]")
+{
+    // Columns holding non-ASCII codepoints are passed as NUL and terminate a URL.
+    auto const urls = detectUrls("\0\0https://example.com/a\0b"sv, LineOffset(0));
+    REQUIRE(urls.size() == 1);
+    CHECK(urls[0].from == ColumnOffset(2));
+    CHECK(uriAt(urls, 0) == "https://example.com/a");
+}
+
+TEST_CASE("UrlCache.urlAt", "[url]")
+{
+    auto grid = Grid<Cell>(PageSize { LineCount(2), ColumnCount(30) }, true, LineCount(0));
+    grid.setLineText(LineOffset(1), "open https://a.example/ now");
+
+    auto cache = UrlCache {};
+    CHECK(cache.urlsAt(grid, LineOffset(0)).empty());
+    CHECK(cache.urlAt(grid, CellLocation { LineOffset(1), ColumnOffset(4) }) == nullptr);
+
+    auto const* url = cache.urlAt(grid, CellLocation { LineOffset(1), ColumnOffset(5) });
+    REQUIRE(url != nullptr);
+    CHECK(url->hyperlink->uri == "https://a.example/");
+    CHECK(cache.urlAt(grid, CellLocation { LineOffset(1), ColumnOffset(22) }) == url);
+
+    // Results are kept until being invalidated.
+    grid.setLineText(LineOffset(1), "nothing to see here");
+    CHECK(cache.urlAt(grid, CellLocation { LineOffset(1), ColumnOffset(5) }) == url);
+
+    cache.invalidate();
+    CHECK(cache.urlAt(grid, CellLocation { LineOffset(1), ColumnOffset(5) }) == nullptr);
+}
@@ -13,224 +13,413 @@
  */
 #include <terminal/VTWriter.h>
 
-#include <numeric>
+#include <unicode/convert.h>
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
 
 using std::string;
 using std::string_view;
-using std::vector;
 
 namespace terminal
 {
 
-// TODO: compare with old sgr value set instead to be more generic in reusing stuff
-
-VTWriter::VTWriter(Writer writer): writer_ { std::move(writer) }
+namespace
 {
-}
+    /// Builds SGR sequences, splitting them up whenever they would exceed the maximum parameter count.
+    class SgrBuilder
+    {
+      public:
+        explicit SgrBuilder(string& _output): output_ { _output } { output_.clear(); }
 
-VTWriter::VTWriter(std::ostream& output):
-    VTWriter { [&](char const* d, size_t n) {
-        output.write(d, static_cast<std::streamsize>(n));
-    } }
-{
-}
+        /// Adds one attribute, whose parameters are all but the first sub-parameters
+        /// if @p _separator is ':'.
+        void add(std::initializer_list<unsigned> _params, char _separator = ';')
+        {
+            if (parameterCount_ + _params.size() > VTWriter::MaxParameterCount)
+                finish();
+
+            output_ += parameterCount_ == 0 ? "\033[" : ";";
+            for (auto i = _params.begin(); i != _params.end(); ++i)
+            {
+                if (i != _params.begin())
+                    output_ += _separator;
+                auto const number = fmt::format_int(*i);
+                output_.append(number.data(), number.size());
+            }
+            parameterCount_ += _params.size();
+        }
+
+        void finish()
+        {
+            if (parameterCount_ == 0)
+                return;
+            output_ += 'm';
+            parameterCount_ = 0;
+        }
+
+      private:
+        string& output_;
+        size_t parameterCount_ = 0;
+    };
+
+    /// Adds the SGR for the foreground (@p _base = 30) or background (@p _base = 40) color.
+    void addColor(SgrBuilder& _sgr, Color _color, unsigned _base)
+    {
+        switch (_color.type())
+        {
+            case ColorType::Default: _sgr.add({ _base + 9 }); break;
+            case ColorType::Indexed:
+                if (static_cast<unsigned>(_color.index()) < 8)
+                    _sgr.add({ _base + static_cast<unsigned>(_color.index()) });
+                else
+                    _sgr.add({ _base + 8, 5, static_cast<unsigned>(_color.index()) });
+                break;
+            case ColorType::Bright: _sgr.add({ _base + 60 + getBrightColor(_color) }); break;
+            case ColorType::RGB:
+                _sgr.add({ _base + 8,
+                           2,
+                           static_cast<unsigned>(_color.rgb().red),
+                           static_cast<unsigned>(_color.rgb().green),
+                           static_cast<unsigned>(_color.rgb().blue) });
+                break;
+            case ColorType::Undefined: break;
+        }
+    }
 
-VTWriter::VTWriter(std::vector<char>& output):
-    VTWriter { [&](char const* d, size_t n) {
-        output.insert(output.end(), d, d + n);
-    } }
+    /// Adds the SGR for the underline color, which cannot be reset to the default on its own.
+    void addUnderlineColor(SgrBuilder& _sgr, Color _color)
+    {
+        switch (_color.type())
+        {
+            case ColorType::Indexed: _sgr.add({ 58, 5, static_cast<unsigned>(_color.index()) }); break;
+            case ColorType::Bright: _sgr.add({ 58, 5, 8u + getBrightColor(_color) }); break;
+            case ColorType::RGB:
+                _sgr.add({ 58,
+                           2,
+                           static_cast<unsigned>(_color.rgb().red),
+                           static_cast<unsigned>(_color.rgb().green),
+                           static_cast<unsigned>(_color.rgb().blue) });
+                break;
+            case ColorType::Default:
+            case ColorType::Undefined: break;
+        }
+    }
+
+    struct StyleGroup
+    {
+        CellFlags mask;
+        unsigned reset; // SGR that disables all styles of this group at once.
+    };
+
+    struct Style
+    {
+        CellFlags flag;
+        unsigned sgr;
+        unsigned subParameter; // 4:N for the underline variants, 0 if none.
+    };
+
+    // clang-format off
+    auto constexpr StyleGroups = std::array {
+        StyleGroup { CellFlags::Bold | CellFlags::Faint, 22 },
+        StyleGroup { CellFlags::Italic, 23 },
+        StyleGroup { CellFlags::Underline | CellFlags::DoublyUnderlined | CellFlags::CurlyUnderlined
+                     | CellFlags::DottedUnderline | CellFlags::DashedUnderline, 24 },
+        StyleGroup { CellFlags::Blinking, 25 },
+        StyleGroup { CellFlags::Inverse, 27 },
+        StyleGroup { CellFlags::Hidden, 28 },
+        StyleGroup { CellFlags::CrossedOut, 29 },
+        StyleGroup { CellFlags::Framed, 54 },
+        StyleGroup { CellFlags::Overline, 55 },
+    };
+
+    auto constexpr Styles = std::array {
+        Style { CellFlags::Bold, 1, 0 },
+        Style { CellFlags::Faint, 2, 0 },
+        Style { CellFlags::Italic, 3, 0 },
+        Style { CellFlags::Underline, 4, 0 },
+        Style { CellFlags::DoublyUnderlined, 21, 0 },
+        Style { CellFlags::CurlyUnderlined, 4, 3 },
+        Style { CellFlags::DottedUnderline, 4, 4 },
+        Style { CellFlags::DashedUnderline, 4, 5 },
+        Style { CellFlags::Blinking, 5, 0 },
+        Style { CellFlags::Inverse, 7, 0 },
+        Style { CellFlags::Hidden, 8, 0 },
+        Style { CellFlags::CrossedOut, 9, 0 },
+        Style { CellFlags::Framed, 51, 0 },
+        Style { CellFlags::Overline, 53, 0 },
+    };
+    // clang-format on
+
+    /// Adds the SGR parameters needed to change the graphics rendition from @p _from to @p _to.
+    void addGraphicsAttributes(SgrBuilder& _sgr,
+                               GraphicsAttributes const& _from,
+                               GraphicsAttributes const& _to)
+    {
+        if (_from.styles != _to.styles)
+            for (StyleGroup const& group: StyleGroups)
+            {
+                auto const removed = (static_cast<unsigned>(_from.styles) & static_cast<unsigned>(group.mask)
+                                      & ~static_cast<unsigned>(_to.styles))
+                                     != 0;
+                if (removed)
+                    _sgr.add({ group.reset });
+                auto const active = removed ? CellFlags::None : _from.styles;
+                for (Style const& style: Styles)
+                {
+                    if (!(style.flag & group.mask) || !(_to.styles & style.flag) || (active & style.flag))
+                        continue;
+                    if (style.subParameter)
+                        _sgr.add({ style.sgr, style.subParameter }, ':');
+                    else
+                        _sgr.add({ style.sgr });
+                }
+            }
+
+        if (_from.foregroundColor != _to.foregroundColor)
+            addColor(_sgr, _to.foregroundColor, 30);
+        if (_from.backgroundColor != _to.backgroundColor)
+            addColor(_sgr, _to.backgroundColor, 40);
+        if (_from.underlineColor != _to.underlineColor)
+            addUnderlineColor(_sgr, _to.underlineColor);
+
+        _sgr.finish();
+    }
+
+    constexpr bool isDefaultOrUndefined(Color _color) noexcept
+    {
+        return isDefaultColor(_color) || isUndefined(_color);
+    }
+} // namespace
+
+VTWriter::VTWriter(string& _output): buffer_ { _output }
 {
 }
 
-void VTWriter::write(char32_t v)
+VTWriter::VTWriter(std::ostream& _output): buffer_ { ownedBuffer_ }, stream_ { &_output }
 {
-    sgrFlush();
-    char buf[4];
-    auto enc = unicode::encoder<char> {};
-    auto count = std::distance(buf, enc(v, buf));
-    write(string_view(buf, static_cast<size_t>(count)));
+    buffer_.reserve(FlushThreshold + FlushThreshold / 4);
 }
 
-void VTWriter::write(string_view s)
+VTWriter::~VTWriter()
 {
-    sgrFlush();
-    writer_(s.data(), s.size());
+    if (stream_)
+        stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
 }
 
-void VTWriter::sgrFlush()
+void VTWriter::flush()
 {
-    if (sgr_.empty())
-        return;
+    prepareWrite();
 
-    auto const f = sgrFlush(sgr_);
-    if (sgr_ != lastSGR_)
-        writer_(f.data(), f.size());
+    if (!stream_)
+        return;
 
-    sgrRewind();
+    stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    stream_->flush();
+    buffer_.clear();
 }
 
-string VTWriter::sgrFlush(vector<unsigned> const& sgr)
+void VTWriter::flushBufferIfFull()
 {
-    if (sgr.empty())
-        return "";
-
-    auto const params =
-        sgr.size() != 1 || sgr[0] != 0 ? accumulate(
-            begin(sgr),
-            end(sgr),
-            string {},
-            [](auto a, auto b) { return a.empty() ? fmt::format("{}", b) : fmt::format("{};{}", a, b); })
-                                       : string();
-
-    return fmt::format("\033[{}m", params);
+    if (!stream_ || buffer_.size() < FlushThreshold)
+        return;
+
+    stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
 }
 
-void VTWriter::sgrAddExplicit(unsigned n)
+void VTWriter::applyGraphicsAttributes()
 {
-    if (n == 0)
+    if (desired_ == GraphicsAttributes {})
     {
-        currentForegroundColor_ = DefaultColor();
-        currentBackgroundColor_ = DefaultColor();
-        currentUnderlineColor_ = DefaultColor();
+        append("\033[m");
+        current_ = desired_;
+        return;
     }
 
-    sgr_.push_back(n);
-}
+    // Emits either the delta to the current rendition or a reset followed by the full rendition,
+    // whichever is shorter. The latter can only be shorter if the delta disables something.
+    // Resetting is the only way to get back to the default underline color.
+    auto const mustReset =
+        isDefaultOrUndefined(desired_.underlineColor) && !isDefaultOrUndefined(current_.underlineColor);
+    auto const disablesAttributes =
+        (static_cast<unsigned>(current_.styles) & ~static_cast<unsigned>(desired_.styles)) != 0
+        || (isDefaultColor(desired_.foregroundColor) && !isDefaultColor(current_.foregroundColor))
+        || (isDefaultColor(desired_.backgroundColor) && !isDefaultColor(current_.backgroundColor));
 
-void VTWriter::sgrAdd(unsigned n)
-{
-    if (n == 0)
+    if (!mustReset)
     {
-        sgr_.clear();
-        sgr_.push_back(n);
-        currentForegroundColor_ = DefaultColor();
-        currentBackgroundColor_ = DefaultColor();
-        currentUnderlineColor_ = DefaultColor();
+        auto delta = SgrBuilder { sgrDelta_ };
+        addGraphicsAttributes(delta, current_, desired_);
     }
-    else
+
+    if (mustReset || disablesAttributes)
     {
-        if (sgr_.empty() || sgr_.back() != n)
-            sgr_.push_back(n);
+        auto full = SgrBuilder { sgrFull_ };
+        full.add({ 0 });
+        addGraphicsAttributes(full, GraphicsAttributes {}, desired_);
+    }
+
+    if (mustReset || (disablesAttributes && sgrFull_.size() < sgrDelta_.size()))
+        append(sgrFull_);
+    else
+        append(sgrDelta_);
+
+    current_ = desired_;
+}
+
+void VTWriter::applyCursorPosition()
+{
+    auto const target = *pendingCursorPosition_;
+    pendingCursorPosition_.reset();
+
+    if (cursorPosition_ == target)
+        return;
+
+    auto const line = unbox<unsigned>(target.line) + 1;
+    auto const column = unbox<unsigned>(target.column) + 1;
 
-        if (sgr_.size() == MaxParameterCount)
+    auto& sequence = sgrDelta_;
+    if (line == 1 && column == 1)
+        sequence = "\033[H";
+    else if (column == 1)
+        sequence = fmt::format("\033[{}H", line);
+    else
+        sequence = fmt::format("\033[{};{}H", line, column);
+
+    if (cursorPosition_ && cursorPosition_->line <= target.line)
+    {
+        auto const lineDelta = unbox<size_t>(target.line - cursorPosition_->line);
+        if (lineDelta == 0 && cursorPosition_->column < target.column)
         {
-            sgrFlush();
+            auto const columnDelta = unbox<unsigned>(target.column - cursorPosition_->column);
+            auto forward = columnDelta == 1 ? string("\033[C") : fmt::format("\033[{}C", columnDelta);
+            if (forward.size() < sequence.size())
+                sequence = std::move(forward);
+        }
+        else if (*target.column == 0 && 1 + lineDelta < sequence.size())
+        {
+            sequence = '\r';
+            sequence.append(lineDelta, '\n');
         }
     }
+
+    append(sequence);
+    cursorPosition_ = target;
 }
 
-void VTWriter::sgrRewind()
+void VTWriter::appendCodepoint(char32_t _codepoint)
 {
-    swap(lastSGR_, sgr_);
-    sgr_.clear();
+    if (_codepoint < 0x80)
+    {
+        buffer_ += static_cast<char>(_codepoint);
+        ++bytesWritten_;
+        return;
+    }
+
+    char buf[4];
+    auto enc = unicode::encoder<char> {};
+    auto const count = std::distance(buf, enc(_codepoint, buf));
+    append(string_view(buf, static_cast<size_t>(count)));
 }
 
-void VTWriter::sgrAdd(GraphicsRendition m)
+void VTWriter::write(char32_t v)
 {
-    sgrAdd(static_cast<unsigned>(m));
+    prepareWrite();
+    appendCodepoint(v);
+    cursorPosition_.reset();
+    flushBufferIfFull();
 }
 
-void VTWriter::setForegroundColor(Color _color)
+void VTWriter::write(string_view s)
 {
-    // if (_color == currentForegroundColor_)
-    //     return;
-
-    currentForegroundColor_ = _color;
-    switch (_color.type())
-    {
-        case ColorType::Default:
-            //.
-            sgrAdd(39);
-            break;
-        case ColorType::Indexed:
-            if (static_cast<unsigned>(_color.index()) < 8)
-                sgrAdd(30 + static_cast<unsigned>(_color.index()));
-            else
-                sgrAdd(38, 5, static_cast<unsigned>(_color.index()));
-            break;
-        case ColorType::Bright:
-            //.
-            sgrAdd(90 + static_cast<unsigned>(getBrightColor(_color)));
-            break;
-        case ColorType::RGB:
-            // clang-format off
-            sgrAdd(38, 2, static_cast<unsigned>(_color.rgb().red),
-                          static_cast<unsigned>(_color.rgb().green),
-                          static_cast<unsigned>(_color.rgb().blue));
-            // clang-format on
-            break;
-        case ColorType::Undefined: break;
-    }
+    prepareWrite();
+    append(s);
+    cursorPosition_.reset();
+    flushBufferIfFull();
 }
 
-void VTWriter::setBackgroundColor(Color _color)
+void VTWriter::lineBreak(string_view _lineBreak, bool _carriageReturn)
 {
-    // if (_color == currentBackgroundColor_)
-    //     return;
+    if (pendingCursorPosition_)
+        applyCursorPosition();
 
-    currentBackgroundColor_ = _color;
-    switch (_color.type())
+    if (!isDefaultOrUndefined(current_.backgroundColor))
     {
-        case ColorType::Default: sgrAdd(49); break;
-        case ColorType::Indexed:
-            if (static_cast<unsigned>(_color.index()) < 8)
-                sgrAdd(40 + static_cast<unsigned>(_color.index()));
-            else
-            {
-                sgrAdd(48);
-                sgrAdd(5);
-                sgrAdd(static_cast<unsigned>(_color.index()));
-            }
-            break;
-        case ColorType::Bright:
-            //.
-            sgrAdd(100 + static_cast<unsigned>(getBrightColor(_color)));
-            break;
-        case ColorType::RGB:
-            sgrAdd(48);
-            sgrAdd(2);
-            sgrAdd(static_cast<unsigned>(_color.rgb().red));
-            sgrAdd(static_cast<unsigned>(_color.rgb().green));
-            sgrAdd(static_cast<unsigned>(_color.rgb().blue));
-            break;
-        case ColorType::Undefined:
-            //.
-            break;
+        auto const desired = desired_;
+        desired_ = current_;
+        desired_.backgroundColor = DefaultColor();
+        applyGraphicsAttributes();
+        desired_ = desired;
     }
+
+    append(_lineBreak);
+
+    if (cursorPosition_ && _carriageReturn)
+        cursorPosition_ = CellLocation { cursorPosition_->line + 1, ColumnOffset(0) };
+    else
+        cursorPosition_.reset();
+
+    flushBufferIfFull();
 }
 
 template <typename Cell>
 void VTWriter::write(Line<Cell> const& line)
 {
+    auto columnsWritten = size_t { 0 };
+
     if (line.isTrivialBuffer())
     {
         TriviallyStyledLineBuffer const& lineBuffer = line.trivialBuffer();
-        setForegroundColor(lineBuffer.attributes.foregroundColor);
-        setBackgroundColor(lineBuffer.attributes.backgroundColor);
-        // TODO: hyperlinks, underlineColor and other styles (curly underline etc.)
-        write(line.toUtf8());
+        // TODO: hyperlinks
+        desired_ = lineBuffer.attributes;
+        prepareWrite();
+        append(lineBuffer.text.view());
+        columnsWritten = unbox<size_t>(lineBuffer.displayWidth);
+        if (lineBuffer.text.size() < columnsWritten)
+        {
+            // Just like inflate(), the columns right to the text are only styled if there is no text.
+            if (!lineBuffer.text.empty())
+            {
+                desired_ = GraphicsAttributes {};
+                prepareWrite();
+            }
+            appendSpaces(columnsWritten - lineBuffer.text.size());
+        }
     }
     else
     {
-        for (Cell const& cell: line.inflatedBuffer())
+        auto const& cells = line.inflatedBuffer();
+        while (columnsWritten < cells.size())
         {
-            if (cell.styles() & CellFlags::Bold)
-                sgrAdd(GraphicsRendition::Bold);
-            else
-                sgrAdd(GraphicsRendition::Normal);
-
-            setForegroundColor(cell.foregroundColor());
-            setBackgroundColor(cell.backgroundColor());
-            // TODO: other styles (such as underline), hyperlinks, image fragments.
+            Cell const& cell = cells[columnsWritten];
+            desired_.foregroundColor = cell.foregroundColor();
+            desired_.backgroundColor = cell.backgroundColor();
+            desired_.underlineColor = cell.underlineColor();
+            desired_.styles = cell.styles();
+            prepareWrite();
+            // TODO: hyperlinks, image fragments.
 
             if (!cell.codepointCount())
-                write(' ');
+            {
+                appendCodepoint(' ');
+                ++columnsWritten;
+            }
             else
-                write(cell.toUtf8());
+            {
+                for (size_t i = 0; i < cell.codepointCount(); ++i)
+                    appendCodepoint(cell.codepoint(i));
+                // Wide characters are followed by blank cells that the terminal skips on its own.
+                columnsWritten += std::max(size_t { 1 }, static_cast<size_t>(cell.width()));
+            }
         }
     }
 
-    sgrAdd(GraphicsRendition::Reset);
+    if (cursorPosition_)
+        cursorPosition_->column += ColumnOffset::cast_from(columnsWritten);
+
+    flushBufferIfFull();
 }
 
 } // namespace terminal
@@ -14,35 +14,62 @@
 #pragma once
 
 #include <terminal/Color.h>
+#include <terminal/GraphicsAttributes.h>
 #include <terminal/Line.h>
 #include <terminal/primitives.h>
 
-#include <unicode/convert.h>
-
 #include <fmt/format.h>
 
-#include <functional>
+#include <optional>
 #include <ostream>
-#include <sstream>
-#include <vector>
+#include <string>
+#include <string_view>
 
 namespace terminal
 {
 
-// Serializes text and SGR attributes into a valid VT stream.
+/**
+ * Serializes text and SGR attributes into a valid VT stream.
+ *
+ * All output is appended to one contiguous buffer, which is either owned by the caller
+ * or flushed into an output stream whenever it grows beyond FlushThreshold.
+ *
+ * Graphics renditions and cursor movements are not emitted right away but only
+ * right before the next text is written, such that only the difference between
+ * the currently active and the desired graphics rendition is emitted, and
+ * consecutive cursor movements collapse into a single one.
+ */
 class VTWriter
 {
   public:
-    using Writer = std::function<void(char const*, size_t)>;
+    /// Maximum number of (sub-)parameters within a single SGR sequence, as supported by our parser.
+    static constexpr inline size_t MaxParameterCount = 16;
 
-    static constexpr inline auto MaxParameterCount = 16;
+    /// Number of buffered bytes at which the buffer is flushed into the output stream.
+    static constexpr inline size_t FlushThreshold = 64 * 1024;
 
-    explicit VTWriter(Writer writer);
-    explicit VTWriter(std::ostream& output);
-    explicit VTWriter(std::vector<char>& output);
+    /// Appends all output directly to @p _output.
+    explicit VTWriter(std::string& _output);
 
+    /// Buffers all output and writes it to @p _output once FlushThreshold is reached,
+    /// and on flush() or destruction.
+    explicit VTWriter(std::ostream& _output);
+
+    VTWriter(VTWriter const&) = delete;
+    VTWriter(VTWriter&&) = delete;
+    VTWriter& operator=(VTWriter const&) = delete;
+    VTWriter& operator=(VTWriter&&) = delete;
+    ~VTWriter();
+
+    /// Moves the cursor to the beginning of the next line.
+    ///
+    /// A non-default background color is reset beforehand, so that it does not
+    /// bleed into the new line when the screen scrolls.
     void crlf();
 
+    /// Same as crlf() but with a single LF as line separator.
+    void lf();
+
     // Writes the given Line<> to the output stream without the trailing newline.
     template <typename Cell>
     void write(Line<Cell> const& line);
@@ -52,34 +79,46 @@ class VTWriter
     void write(std::string_view s);
     void write(char32_t v);
 
-    void sgrFlush();
-    std::string sgrFlush(std::vector<unsigned> const& sgr);
-    void sgrAdd(unsigned n);
-    void sgrRewind();
-    void sgrAdd(GraphicsRendition m);
-    void setForegroundColor(Color color);
-    void setBackgroundColor(Color color);
+    /// Sets the graphics rendition to be used for subsequently written text.
+    void setGraphicsAttributes(GraphicsAttributes const& _attributes) noexcept { desired_ = _attributes; }
 
-    void sgrAddExplicit(unsigned n);
+    /// Moves the cursor to the given 0-based screen position before writing the next text.
+    ///
+    /// The writer keeps track of the cursor position for text written via write(Line<>)
+    /// and crlf(), assuming the output does not scroll, and emits the shortest sequence
+    /// to get to the target position. Any other output makes the position unknown,
+    /// in which case an absolute cursor movement is emitted.
+    void moveCursorTo(CellLocation _position) noexcept { pendingCursorPosition_ = _position; }
 
-    template <typename... Args>
-    void sgrAdd(unsigned n, Args... values)
-    {
-        if (sgr_.size() + sizeof...(values) > MaxParameterCount)
-            sgrFlush();
+    /// Emits any pending graphics rendition or cursor movement and, if writing to
+    /// an output stream, writes out the buffered output.
+    void flush();
 
-        sgrAddExplicit(n);
-        (sgrAddExplicit(static_cast<unsigned>(values)), ...);
-    }
+    /// @returns the total number of bytes emitted so far.
+    [[nodiscard]] size_t bytesWritten() const noexcept { return bytesWritten_; }
 
   private:
-    Writer writer_;
-    std::vector<unsigned> sgr_;
-    std::stringstream sstr;
-    std::vector<unsigned> lastSGR_;
-    Color currentForegroundColor_ = DefaultColor();
-    Color currentUnderlineColor_ = DefaultColor();
-    Color currentBackgroundColor_ = DefaultColor();
+    void prepareWrite();
+    void lineBreak(std::string_view _lineBreak, bool _carriageReturn);
+    void applyGraphicsAttributes();
+    void applyCursorPosition();
+    void appendCodepoint(char32_t _codepoint);
+    void append(std::string_view _text);
+    void appendSpaces(size_t _count);
+    void flushBufferIfFull();
+
+    std::string ownedBuffer_;
+    std::string& buffer_;
+    std::ostream* stream_ = nullptr;
+    size_t bytesWritten_ = 0;
+
+    GraphicsAttributes current_ {};
+    GraphicsAttributes desired_ {};
+    std::string sgrDelta_;
+    std::string sgrFull_;
+
+    std::optional<CellLocation> cursorPosition_;
+    std::optional<CellLocation> pendingCursorPosition_;
 };
 
 template <typename... T>
@@ -90,7 +129,32 @@ inline void VTWriter::write(fmt::format_string<T...> fmt, T&&... args)
 
 inline void VTWriter::crlf()
 {
-    write("\r\n");
+    lineBreak("\r\n", true);
+}
+
+inline void VTWriter::lf()
+{
+    lineBreak("\n", false);
+}
+
+inline void VTWriter::append(std::string_view _text)
+{
+    buffer_.append(_text.data(), _text.size());
+    bytesWritten_ += _text.size();
+}
+
+inline void VTWriter::appendSpaces(size_t _count)
+{
+    buffer_.append(_count, ' ');
+    bytesWritten_ += _count;
+}
+
+inline void VTWriter::prepareWrite()
+{
+    if (pendingCursorPosition_)
+        applyCursorPosition();
+    if (desired_ != current_)
+        applyGraphicsAttributes();
 }
 
 } // namespace terminal
@@ -0,0 +1,243 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/MockTerm.h>
+#include <terminal/VTWriter.h>
+
+#include <crispy/escape.h>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace terminal;
+using namespace std::string_literals;
+using namespace std::string_view_literals;
+using crispy::escape;
+
+namespace
+{
+
+std::string writeLine(Line<Cell> const& _line)
+{
+    auto output = std::string {};
+    auto writer = VTWriter(output);
+    writer.write(_line);
+    return output;
+}
+
+std::string cellText(Cell const& _cell)
+{
+    return _cell.codepointCount() ? _cell.toUtf8() : " "s;
+}
+
+} // namespace
+
+TEST_CASE("VTWriter.minimalSGR", "[VTWriter]")
+{
+    auto mock = MockTerm { PageSize { LineCount(1), ColumnCount(10) } };
+    mock.writeToScreen("\033[1;31mAB\033[32mCD\033[3mEF\033[23;22mGH\033[mIJ");
+
+    auto const& line = mock.terminal.primaryScreen().grid().lineAt(LineOffset(0));
+    CHECK(escape(writeLine(line)) == escape("\033[1;31mAB\033[32mCD\033[3mEF\033[0;32mGH\033[mIJ"));
+}
+
+TEST_CASE("VTWriter.resetIfShorter", "[VTWriter]")
+{
+    auto output = std::string {};
+    auto writer = VTWriter(output);
+
+    auto attributes = GraphicsAttributes {};
+    attributes.styles = CellFlags::Bold | CellFlags::Italic | CellFlags::Underline | CellFlags::Inverse;
+    writer.setGraphicsAttributes(attributes);
+    writer.write("A");
+
+    // Disabling bold only.
+    attributes.styles = CellFlags::Italic | CellFlags::Underline | CellFlags::Inverse;
+    writer.setGraphicsAttributes(attributes);
+    writer.write("B");
+
+    // Disabling all but one style is shorter by resetting.
+    attributes.styles = CellFlags::Faint;
+    writer.setGraphicsAttributes(attributes);
+    writer.write("C");
+
+    // Nothing is emitted if nothing changes.
+    writer.setGraphicsAttributes(attributes);
+    writer.write("D");
+
+    CHECK(escape(output) == escape("\033[1;3;4;7mA\033[22mB\033[0;2mCD"));
+}
+
+TEST_CASE("VTWriter.underlineColor", "[VTWriter]")
+{
+    auto output = std::string {};
+    auto writer = VTWriter(output);
+
+    auto attributes = GraphicsAttributes {};
+    attributes.styles = CellFlags::CurlyUnderlined;
+    attributes.foregroundColor = Color::Indexed(IndexedColor::Green);
+    attributes.underlineColor = RGBColor(0x102030);
+    writer.setGraphicsAttributes(attributes);
+    writer.write("A");
+
+    // The underline color can only be reset to the default by resetting everything.
+    attributes.underlineColor = DefaultColor();
+    writer.setGraphicsAttributes(attributes);
+    writer.write("B");
+
+    CHECK(escape(output) == escape("\033[4:3;32;58;2;16;32;48mA\033[0;4:3;32mB"));
+}
+
+TEST_CASE("VTWriter.maxParameterCount", "[VTWriter]")
+{
+    auto output = std::string {};
+    auto writer = VTWriter(output);
+
+    auto attributes = GraphicsAttributes {};
+    attributes.styles = CellFlags::Bold | CellFlags::Italic;
+    attributes.foregroundColor = RGBColor(0x010203);
+    attributes.backgroundColor = RGBColor(0x040506);
+    attributes.underlineColor = RGBColor(0x070809);
+    writer.setGraphicsAttributes(attributes);
+    writer.write("A");
+
+    CHECK(escape(output) == escape("\033[1;3;38;2;1;2;3;48;2;4;5;6m\033[58;2;7;8;9mA"));
+}
+
+TEST_CASE("VTWriter.trivialLine", "[VTWriter]")
+{
+    auto pool = crispy::BufferObjectPool(16);
+    auto bufferObject = pool.allocateBufferObject();
+    bufferObject->writeAtEnd("Hello");
+
+    auto attributes = GraphicsAttributes {};
+    attributes.foregroundColor = Color::Indexed(IndexedColor::Blue);
+    auto line = Line<Cell>(LineFlags::None, ColumnCount(8), attributes);
+    line.setBuffer(TriviallyStyledLineBuffer {
+        ColumnCount(8), attributes, HyperlinkId {}, bufferObject->ref(0, 5) });
+    REQUIRE(line.isTrivialBuffer());
+
+    CHECK(escape(writeLine(line)) == escape("\033[34mHello\033[m   "));
+}
+
+TEST_CASE("VTWriter.wideCharacters", "[VTWriter]")
+{
+    auto mock = MockTerm { PageSize { LineCount(1), ColumnCount(6) } };
+    mock.writeToScreen(u8"A一B");
+
+    auto const& line = mock.terminal.primaryScreen().grid().lineAt(LineOffset(0));
+    CHECK(writeLine(line) == u8"A一B  ");
+}
+
+TEST_CASE("VTWriter.cursorMovement", "[VTWriter]")
+{
+    auto mock = MockTerm { PageSize { LineCount(1), ColumnCount(4) } };
+    mock.writeToScreen("ABCD");
+    auto const& line = mock.terminal.primaryScreen().grid().lineAt(LineOffset(0));
+
+    auto output = std::string {};
+    auto writer = VTWriter(output);
+
+    // Consecutive movements collapse into one, using an absolute position initially.
+    writer.moveCursorTo(CellLocation { LineOffset(0), ColumnOffset(0) });
+    writer.moveCursorTo(CellLocation { LineOffset(2), ColumnOffset(3) });
+    writer.write(line);
+    CHECK(escape(output) == escape("\033[3;4HABCD"));
+
+    // Moving to the start of one of the next lines.
+    output.clear();
+    writer.moveCursorTo(CellLocation { LineOffset(4), ColumnOffset(0) });
+    writer.write(line);
+    CHECK(escape(output) == escape("\r\n\nABCD"));
+
+    // Moving forward on the current line, and nothing if already there.
+    output.clear();
+    writer.crlf();
+    writer.moveCursorTo(CellLocation { LineOffset(5), ColumnOffset(0) });
+    writer.write(line);
+    writer.crlf();
+    writer.moveCursorTo(CellLocation { LineOffset(6), ColumnOffset(12) });
+    writer.write(line);
+    CHECK(escape(output) == escape("\r\nABCD\r\n\033[12CABCD"));
+
+    // Moving backwards uses an absolute position.
+    output.clear();
+    writer.moveCursorTo(CellLocation { LineOffset(1), ColumnOffset(2) });
+    writer.write(line);
+    CHECK(escape(output) == escape("\033[2;3HABCD"));
+}
+
+TEST_CASE("VTWriter.backgroundColorAtLineBreak", "[VTWriter]")
+{
+    auto mock = MockTerm { PageSize { LineCount(2), ColumnCount(3) } };
+    mock.writeToScreen("\033[1;41mABC\r\nDEF");
+    auto const& grid = mock.terminal.primaryScreen().grid();
+
+    auto output = std::string {};
+    auto writer = VTWriter(output);
+    writer.write(grid.lineAt(LineOffset(0)));
+    writer.crlf();
+    writer.write(grid.lineAt(LineOffset(1)));
+
+    CHECK(escape(output) == escape("\033[1;41mABC\033[49m\r\n\033[41mDEF"));
+}
+
+TEST_CASE("VTWriter.stream", "[VTWriter]")
+{
+    auto mock = MockTerm { PageSize { LineCount(1), ColumnCount(4) } };
+    mock.writeToScreen("\033[35mABCD");
+    auto const& line = mock.terminal.primaryScreen().grid().lineAt(LineOffset(0));
+
+    auto output = std::ostringstream {};
+    {
+        auto writer = VTWriter(output);
+        writer.write(line);
+        writer.setGraphicsAttributes({});
+        writer.flush();
+        CHECK(writer.bytesWritten() == output.str().size());
+        writer.write(line);
+    }
+    CHECK(escape(output.str()) == escape("\033[35mABCD\033[m\033[35mABCD"));
+}
+
+TEST_CASE("VTWriter.roundtrip", "[VTWriter]")
+{
+    auto const pageSize = PageSize { LineCount(3), ColumnCount(10) };
+    auto source = MockTerm { pageSize };
+    source.writeToScreen("\033[1;4:3;38;2;1;2;3;58;5;200mAB\033[22;2;7mCD\033[m \033[9;53;103mEF\r\n");
+    source.writeToScreen("\033[44mplain\033[m\r\n");
+    source.writeToScreen("\033[5;8;51;48;5;123mXY\033[24;25;21mZ");
+
+    // One more line, as the screenshot ends with a line break.
+    auto target = MockTerm { PageSize { pageSize.lines + LineCount(1), pageSize.columns } };
+    target.writeToScreen(source.terminal.primaryScreen().screenshot());
+
+    auto const& sourceGrid = source.terminal.primaryScreen().grid();
+    auto const& targetGrid = target.terminal.primaryScreen().grid();
+    for (auto line = LineOffset(0); line < boxed_cast<LineOffset>(pageSize.lines); ++line)
+    {
+        auto const sourceCells = sourceGrid.lineAt(line).cells();
+        auto const targetCells = targetGrid.lineAt(line).cells();
+        for (size_t column = 0; column < sourceCells.size(); ++column)
+        {
+            INFO(fmt::format("line {} column {}", line, column));
+            CHECK(cellText(targetCells[column]) == cellText(sourceCells[column]));
+            CHECK(targetCells[column].styles() == sourceCells[column].styles());
+            CHECK(targetCells[column].foregroundColor() == sourceCells[column].foregroundColor());
+            CHECK(targetCells[column].backgroundColor() == sourceCells[column].backgroundColor());
+            CHECK(targetCells[column].underlineColor() == sourceCells[column].underlineColor());
+        }
+    }
+}
@@ -13,7 +13,10 @@
  */
 
 #include <terminal/MockTerm.h>
+#include <terminal/PtyRecording.h>
+#include <terminal/PtyReplay.h>
 #include <terminal/Terminal.h>
+#include <terminal/VTWriter.h>
 #include <terminal/logging.h>
 #include <terminal/pty/MockViewPty.h>
 
@@ -23,6 +26,8 @@
 
 #include <fmt/format.h>
 
+#include <array>
+#include <fstream>
 #include <iostream>
 #include <optional>
 #include <random>
@@ -158,6 +163,9 @@ class ContourHeadlessBench: public crispy::App
         link("bench-headless.parser", bind(&ContourHeadlessBench::benchParserOnly, this));
         link("bench-headless.grid", bind(&ContourHeadlessBench::benchGrid, this));
         link("bench-headless.pty", bind(&ContourHeadlessBench::benchPTY, this));
+        link("bench-headless.writer", bind(&ContourHeadlessBench::benchWriter, this));
+        link("bench-headless.margins", bind(&ContourHeadlessBench::benchMargins, this));
+        link("bench-headless.replay", bind(&ContourHeadlessBench::benchReplay, this));
         link("bench-headless.meta", bind(&ContourHeadlessBench::showMetaInfo, this));
 
         char const* logFilterString = getenv("LOG");
@@ -197,6 +205,39 @@ class ContourHeadlessBench: public crispy::App
                 CLI::Command {
                     "pty",
                     "Performs performance tests utilizing the underlying operating system's PTY only." },
+                CLI::Command {
+                    "writer",
+                    "Performs performance tests serializing the full scrollback into a VT stream.",
+                    CLI::OptionList {
+                        CLI::Option {
+                            "lines", CLI::Value { 100'000u }, "Number of scrollback lines.", "COUNT" },
+                        CLI::Option {
+                            "sgr", CLI::Value { false }, "Use a different graphics rendition per cell." },
+                    } },
+                CLI::Command {
+                    "margins",
+                    "Performs performance tests scrolling within top/bottom (DECSTBM) and "
+                    "left/right (DECSLRM) margins.",
+                    CLI::OptionList {
+                        CLI::Option {
+                            "size", CLI::Value { 32u }, "Number of megabyte to process per test.", "MB" },
+                    } },
+                CLI::Command {
+                    "replay",
+                    "Performs performance tests replaying a PTY recording, as created via contour's "
+                    "--record option.",
+                    CLI::OptionList {
+                        CLI::Option { "file",
+                                      CLI::Value { ""s },
+                                      "PTY recording to replay.",
+                                      "FILE",
+                                      CLI::Presence::Required },
+                        CLI::Option { "realtime",
+                                      CLI::Value { false },
+                                      "Replays at the recorded speed rather than as fast as possible." },
+                        CLI::Option {
+                            "history", CLI::Value { 4000u }, "Number of scrollback lines.", "COUNT" },
+                    } },
             }
         };
     }
@@ -334,6 +375,197 @@ class ContourHeadlessBench: public crispy::App
         return EXIT_SUCCESS;
     }
 
+    int benchWriter()
+    {
+        using std::chrono::steady_clock;
+        using terminal::ColumnCount;
+        using terminal::LineCount;
+        using terminal::LineOffset;
+        using terminal::PageSize;
+
+        auto const historyLineCount = LineCount::cast_from(parameters().uint("bench-headless.writer.lines"));
+        auto const sgrPerCell = parameters().boolean("bench-headless.writer.sgr");
+        auto const pageSize = PageSize { LineCount(25), ColumnCount(80) };
+
+        // Setup benchmark
+        fmt::print("Filling {} lines of scrollback ...\n", *historyLineCount);
+        auto vt = terminal::MockTerm(pageSize, historyLineCount, 1'000'000);
+        auto text = std::string {};
+        for (int i = 0; i < unbox<int>(historyLineCount + pageSize.lines); ++i)
+        {
+            if (sgrPerCell)
+                for (int column = 0; column < 60; ++column)
+                    text += fmt::format(
+                        "\033[{};{}m{}", 31 + column % 7, 41 + i % 7, char('A' + column % 26));
+            else
+                text += fmt::format("\033[{}mLine {} of the scrollback with some text in it.", 31 + i % 7, i);
+            text += "\033[m\r\n";
+        }
+        vt.writeToScreen(text);
+        auto const& grid = vt.terminal.primaryScreen().grid();
+
+        // Perform benchmark
+        fmt::print("Running VT writer benchmark ...\n");
+        auto output = std::string {};
+        auto const startTime = steady_clock::now();
+        auto writer = terminal::VTWriter(output);
+        for (auto line = -boxed_cast<LineOffset>(grid.historyLineCount());
+             line < boxed_cast<LineOffset>(pageSize.lines);
+             ++line)
+        {
+            writer.write(grid.lineAt(line));
+            writer.crlf();
+        }
+        writer.setGraphicsAttributes({});
+        writer.flush();
+        auto const stopTime = steady_clock::now();
+
+        // Create summary
+        auto const usecs = std::chrono::duration_cast<std::chrono::microseconds>(stopTime - startTime);
+        auto const bytesPerSecond = static_cast<long double>(writer.bytesWritten()) * 1'000'000
+                                    / static_cast<long double>(std::max<int64_t>(usecs.count(), 1));
+
+        fmt::print("\n");
+        fmt::print("VT writer full scrollback dump test\n");
+        fmt::print("===================================\n\n");
+        fmt::print("Lines written   : {}\n", *grid.historyLineCount() + *pageSize.lines);
+        fmt::print("Bytes emitted   : {} ({})\n",
+                   writer.bytesWritten(),
+                   crispy::humanReadableBytes(writer.bytesWritten()));
+        fmt::print("Test time       : {}.{:03} ms\n", usecs.count() / 1000, usecs.count() % 1000);
+        fmt::print("Transfer speed  : {} per second\n", crispy::humanReadableBytes(bytesPerSecond));
+
+        return EXIT_SUCCESS;
+    }
+
+    int benchMargins()
+    {
+        using std::chrono::steady_clock;
+        using terminal::ColumnCount;
+        using terminal::LineCount;
+        using terminal::PageSize;
+
+        auto const testSize = size_t { parameters().uint("bench-headless.margins.size") } * 1024 * 1024;
+        auto const pageSize = PageSize { LineCount(25), ColumnCount(80) };
+
+        // Each test sets up its margins and then repeatedly scrolls within them,
+        // via line feeds at the bottom margin, reverse index at the top margin, and SU/SD.
+        struct MarginTest
+        {
+            std::string_view name;
+            std::string_view setup;
+        };
+        auto constexpr Tests = std::array {
+            MarginTest { "DECSTBM", "\033[5;20r" },
+            MarginTest { "DECSTBM+DECSLRM", "\033[?69h\033[5;20r\033[11;70s" },
+        };
+
+        auto chunk = std::string {};
+        for (int i = 0; i < 16; ++i)
+        {
+            chunk += fmt::format("\033[20;11H\033[3{}mScrolling up within margins, line {}.\n", i % 8, i);
+            chunk += fmt::format("\033[5;11H\033[4{}mScrolling down within margins.\033M", i % 8);
+            chunk += "\033[m\033[2S\033[2T";
+        }
+
+        fmt::print("\n");
+        fmt::print("Margin scrolling test\n");
+        fmt::print("=====================\n\n");
+        for (auto const& test: Tests)
+        {
+            auto vt = terminal::MockTerm(pageSize, LineCount(4000), 1'000'000);
+            vt.writeToScreen(createText(static_cast<size_t>(pageSize.area())));
+            vt.writeToScreen(test.setup);
+
+            auto bytesWritten = size_t { 0 };
+            auto const startTime = steady_clock::now();
+            while (bytesWritten < testSize)
+            {
+                vt.writeToScreen(chunk);
+                bytesWritten += chunk.size();
+            }
+            auto const usecs =
+                std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - startTime);
+            auto const bytesPerSecond = static_cast<long double>(bytesWritten) * 1'000'000
+                                        / static_cast<long double>(std::max<int64_t>(usecs.count(), 1));
+
+            fmt::print("{:<16}: {}.{:03} ms, {} per second\n",
+                       test.name,
+                       usecs.count() / 1000,
+                       usecs.count() % 1000,
+                       crispy::humanReadableBytes(bytesPerSecond));
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    int benchReplay()
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        auto const path = parameters().get<std::string>("bench-headless.replay.file");
+        auto file = std::ifstream(path, std::ios::binary);
+        if (!file.good())
+        {
+            fmt::print(stderr, "Could not open PTY recording {}.\n", path);
+            return EXIT_FAILURE;
+        }
+        auto const data = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+        auto recording = terminal::PtyRecording {};
+        try
+        {
+            recording = terminal::loadPtyRecording(data);
+        }
+        catch (std::exception const& e)
+        {
+            fmt::print(stderr, "{}\n", e.what());
+            return EXIT_FAILURE;
+        }
+        if (recording.truncated)
+            fmt::print(stderr, "Warning: The recording's last event is cut off and will be ignored.\n");
+
+        auto options = terminal::PtyReplayOptions {};
+        options.realTime = parameters().boolean("bench-headless.replay.realtime");
+        auto const maxHistoryLineCount =
+            terminal::LineCount::cast_from(parameters().uint("bench-headless.replay.history"));
+
+        fmt::print("Replaying {} events ...\n", recording.events.size());
+        auto replay = terminal::PtyReplay(recording, maxHistoryLineCount);
+        auto const stats = replay.run(options);
+
+        // Create summary
+        auto const formatTime = [](auto duration) {
+            auto const usecs = duration_cast<microseconds>(duration).count();
+            return fmt::format("{}.{:03} ms", usecs / 1000, usecs % 1000);
+        };
+        auto const parseUsecs = duration_cast<microseconds>(stats.parseTime).count();
+        auto const bytesPerSecond = static_cast<long double>(stats.outputBytes) * 1'000'000
+                                    / static_cast<long double>(std::max<int64_t>(parseUsecs, 1));
+
+        fmt::print("\n");
+        fmt::print("PTY recording replay test\n");
+        fmt::print("=========================\n\n");
+        fmt::print("Page size       : {}\n", recording.pageSize);
+        fmt::print("Recorded time   : {}\n",
+                   formatTime(recording.events.empty() ? microseconds(0) : recording.events.back().time));
+        fmt::print("Output          : {} in {} chunks\n",
+                   crispy::humanReadableBytes(stats.outputBytes),
+                   stats.outputChunks);
+        fmt::print("Input           : {}\n", crispy::humanReadableBytes(stats.inputBytes));
+        fmt::print("Resizes         : {}\n", stats.resizes);
+        fmt::print("Frames built    : {}\n", stats.frames);
+        fmt::print("Parse time      : {}\n", formatTime(stats.parseTime));
+        fmt::print("Frame time      : {}\n", formatTime(stats.frameBuildTime));
+        fmt::print("Total time      : {}\n", formatTime(stats.totalTime));
+        fmt::print("Parse speed     : {} per second\n", crispy::humanReadableBytes(bytesPerSecond));
+        if (stats.peakMemory)
+            fmt::print("Peak memory     : {}\n", crispy::humanReadableBytes(stats.peakMemory));
+
+        return EXIT_SUCCESS;
+    }
+
     int benchParserOnly()
     {
         auto po = NullParserEvents {};
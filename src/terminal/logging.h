@@ -33,4 +33,9 @@ auto const inline VTTraceSequenceLog = logstore::Category("vt.trace.sequence", "
 
 auto const inline RenderBufferLog = logstore::Category("vt.renderbuffer", "Render Buffer Objects");
 
+auto const inline VTCaptureBufferLog = logstore::Category("vt.ext.capturebuffer",
+                                                          "Capture Buffer debug logging.",
+                                                          logstore::Category::State::Disabled,
+                                                          logstore::Category::Visibility::Hidden);
+
 } // namespace terminal
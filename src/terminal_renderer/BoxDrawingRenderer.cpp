@@ -17,13 +17,16 @@
 
 #include <crispy/logstore.h>
 
+#include <fmt/chrono.h>
 #include <fmt/format.h>
 
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/zip.hpp>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 
 using namespace std::string_view_literals;
 
@@ -483,6 +486,34 @@ namespace detail
 
         // {{{ block element construction
 
+        /// Fills a rectangle of the image solid, row by row, using vectorized memory fills.
+        inline void fillRect(atlas::Buffer& image,
+                             unsigned imageWidth,
+                             unsigned x0,
+                             unsigned y0,
+                             unsigned width,
+                             unsigned height)
+        {
+            for (auto y = y0; y < y0 + height; ++y)
+                std::fill_n(image.begin() + y * imageWidth + x0, width, uint8_t { 0xFF });
+        }
+
+        // Arguments from and to are passed as percentage. Fills solid.
+        template <typename Container>
+        void fillBlock(Container& image, ImageSize size, Ratio from, Ratio to)
+        {
+            auto const h = unbox<int>(size.height) - 1;
+            auto const x0 = int(unbox<double>(size.width) * from.x);
+            auto const x1 = int(unbox<double>(size.width) * to.x);
+            if (x1 <= x0)
+                return;
+
+            for (auto y = int(unbox<double>(size.height) * from.y);
+                 y < int(unbox<double>(size.height) * to.y);
+                 ++y)
+                std::fill_n(image.begin() + (h - y) * unbox<int>(size.width) + x0, x1 - x0, uint8_t { 0xFF });
+        }
+
         // Arguments from and to are passed as percentage.
         template <typename Container, typename F>
         constexpr void fillBlock(Container& image, ImageSize size, Ratio from, Ratio to, F const& filler)
@@ -864,23 +895,59 @@ namespace detail
             // fmt::print("- block sextant pos {}: x={} y={} x0={} y0={} x1={} y1={}\n",
             //            position, x, y, x0, y0, x1, y1);
 
-            fillBlock(image, size, { x0 / 2_th, y0 / 3_th }, { x1 / 2_th, y1 / 3_th }, [](int, int) {
-                return 0xFF;
-            });
+            fillBlock(image, size, { x0 / 2_th, y0 / 3_th }, { x1 / 2_th, y1 / 3_th });
         }
 
-        template <typename Container, typename A, typename... B>
-        constexpr inline void blockSextant(Container& image, ImageSize size, A first, B... others)
+        /// Constructs the sextants whose bits are set in the given pattern, sextant 1 being the lowest bit.
+        inline atlas::Buffer blockSextants(ImageSize size, unsigned pattern)
         {
-            blockSextant(image, size, first);
-            blockSextant(image, size, others...);
+            auto image = atlas::Buffer(size.area(), 0x00);
+            for (auto position = 1u; position <= 6; ++position)
+                if (pattern & (1u << (position - 1)))
+                    blockSextant(image, size, position);
+            return image;
         }
 
-        template <typename... T>
-        inline atlas::Buffer blockSextant(ImageSize size, T... positions)
+        /// Maps a codepoint of U+1FB00..U+1FB3B to its sextant pattern.
+        ///
+        /// The block enumerates all patterns in ascending order, but leaves out the empty and full
+        /// pattern as well as the left and right half blocks, which are already encoded elsewhere.
+        constexpr unsigned sextantPattern(char32_t codepoint) noexcept
+        {
+            auto pattern = static_cast<unsigned>(codepoint - 0x1FB00) + 1;
+            if (pattern >= 0b010101)
+                ++pattern;
+            if (pattern >= 0b101010)
+                ++pattern;
+            return pattern;
+        }
+        // }}}
+        // {{{ braille construction
+        /// Constructs the braille pattern of U+2800..U+28FF from the codepoint's lower 8 bits.
+        ///
+        /// Dots 1 to 6 are laid out column-wise in the upper three rows, and dots 7 and 8 in the bottom row.
+        inline atlas::Buffer braille(ImageSize size, unsigned pattern)
         {
             auto image = atlas::Buffer(size.area(), 0x00);
-            blockSextant(image, size, positions...);
+            auto const width = unbox<unsigned>(size.width);
+            auto const height = unbox<unsigned>(size.height);
+            auto const columnWidth = width / 2;
+            auto const rowHeight = height / 4;
+            auto const dotSize = max(1u, (min(columnWidth, rowHeight) + 1) / 2);
+            if (dotSize > columnWidth || dotSize > rowHeight)
+                return image;
+
+            constexpr auto DotColumns = std::array<unsigned, 8> { 0, 0, 0, 1, 1, 1, 0, 1 };
+            constexpr auto DotRows = std::array<unsigned, 8> { 0, 1, 2, 0, 1, 2, 3, 3 };
+            for (auto dot = 0u; dot < 8; ++dot)
+            {
+                if (!(pattern & (1u << dot)))
+                    continue;
+                auto const x = DotColumns[dot] * columnWidth + (columnWidth - dotSize) / 2;
+                auto const y = DotRows[dot] * rowHeight + (rowHeight - dotSize) / 2;
+                // Rows are stored bottom-up, just like in fillBlock().
+                fillRect(image, width, x, height - y - dotSize, dotSize, dotSize);
+            }
             return image;
         }
         // }}}
@@ -888,6 +955,48 @@ namespace detail
     } // namespace
 } // namespace detail
 
+namespace
+{
+    // Sorted, such that the prepared tiles are sorted by codepoint, too.
+    struct CodepointRange
+    {
+        char32_t first;
+        char32_t last;
+    };
+
+    // clang-format off
+    constexpr auto RenderableCodepoints = std::array {
+        CodepointRange { 0x23A1, 0x23A6 },   // mathematical square brackets
+        CodepointRange { 0x2500, 0x2590 },   // box drawing, block elements
+        CodepointRange { 0x2594, 0x259F },   // Terminal graphic characters
+        CodepointRange { 0x2800, 0x28FF },   // braille patterns
+        CodepointRange { 0xE0B0, 0xE0B0 },   // 
+        CodepointRange { 0xE0B2, 0xE0B2 },   // 
+        CodepointRange { 0xE0B4, 0xE0B4 },   // 
+        CodepointRange { 0xE0B6, 0xE0B6 },   // 
+        CodepointRange { 0xE0BA, 0xE0BA },   // 
+        CodepointRange { 0xE0BC, 0xE0BC },   // 
+        CodepointRange { 0xE0BE, 0xE0BE },   // 
+        CodepointRange { 0xEE00, 0xEE05 },   // progress bar (Fira Code)
+        CodepointRange { 0x1FB00, 0x1FBAF }, // more block sextants
+        CodepointRange { 0x1FBF0, 0x1FBF9 }, // digits
+    };
+    // clang-format on
+
+    /// Tests whether tiles built for either grid metrics are identical.
+    bool sameTileMetrics(GridMetrics const& a, GridMetrics const& b) noexcept
+    {
+        return a.cellSize == b.cellSize && a.baseline == b.baseline
+               && a.underline.position == b.underline.position
+               && a.underline.thickness == b.underline.thickness;
+    }
+
+    crispy::StrongHash tileHash(char32_t codepoint) noexcept
+    {
+        return crispy::StrongHash { 31, 13, 8, static_cast<uint32_t>(codepoint) };
+    }
+} // namespace
+
 void BoxDrawingRenderer::setRenderTarget(RenderTarget& renderTarget,
                                          DirectMappingAllocator& directMappingAllocator)
 {
@@ -895,14 +1004,75 @@ void BoxDrawingRenderer::setRenderTarget(RenderTarget& renderTarget,
     clearCache();
 }
 
+void BoxDrawingRenderer::setTextureAtlas(TextureAtlas& atlas)
+{
+    Renderable::setTextureAtlas(atlas);
+    preparedTilesUploaded_ = false;
+}
+
 void BoxDrawingRenderer::clearCache()
 {
     // As we're reusing the upper layer's texture atlas, we do not need
     // to clear here anything. It's done for us already.
 }
 
+void BoxDrawingRenderer::startTilePreparation()
+{
+    if (tilePreparation_.valid())
+        tilePreparation_.wait();
+
+    preparedTiles_.reset();
+    preparedTilesUploaded_ = false;
+    tilePreparation_ = std::async(std::launch::async, [metrics = _gridMetrics]() {
+        auto const start = std::chrono::steady_clock::now();
+        auto prepared = PreparedTiles { metrics, {} };
+        for (auto const range: RenderableCodepoints)
+            for (auto codepoint = range.first; codepoint <= range.last; ++codepoint)
+                if (auto pixels = rasterize(codepoint, metrics))
+                    prepared.tiles.emplace_back(codepoint, std::move(*pixels));
+
+        BoxDrawingLog()("Prepared {} tiles of {} in {}.",
+                        prepared.tiles.size(),
+                        metrics.cellSize,
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start));
+        return prepared;
+    });
+}
+
+void BoxDrawingRenderer::uploadPreparedTiles()
+{
+    if (preparedTilesUploaded_)
+        return;
+
+    if (!preparedTiles_)
+    {
+        // Never stall rendering on the preparation, but rasterize on demand until it is done.
+        if (!tilePreparation_.valid()
+            || tilePreparation_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return;
+        preparedTiles_ = tilePreparation_.get();
+    }
+
+    preparedTilesUploaded_ = true;
+    if (!sameTileMetrics(preparedTiles_->metrics, _gridMetrics))
+    {
+        preparedTiles_.reset();
+        return;
+    }
+
+    // All tiles are scheduled for upload at once, which ends up in a single atlas upload batch.
+    for (auto const& [codepoint, pixels]: preparedTiles_->tiles)
+        (void) textureAtlas().get_or_try_emplace(
+            tileHash(codepoint),
+            [this, &pixels = pixels](atlas::TileLocation tileLocation)
+                -> optional<TextureAtlas::TileCreateData> { return createTileData(tileLocation, pixels); });
+}
+
 bool BoxDrawingRenderer::render(LineOffset _line, ColumnOffset _column, char32_t _codepoint, RGBColor _color)
 {
+    uploadPreparedTiles();
+
     Renderable::AtlasTileAttributes const* data = getOrCreateCachedTileAttributes(_codepoint);
     if (!data)
         return false;
@@ -931,63 +1101,71 @@ constexpr inline bool containsNonCanonicalLines(char32_t codepoint)
     return box.diagonal_ != detail::NoDiagonal || box.arc_ != NoArc;
 }
 
+optional<atlas::Buffer> BoxDrawingRenderer::rasterize(char32_t codepoint, GridMetrics const& _metrics)
+{
+    if (optional<atlas::Buffer> image = buildElements(codepoint, _metrics))
+        return image;
+
+    if (!containsNonCanonicalLines(codepoint))
+        return buildBoxElements(codepoint, _metrics.cellSize, _metrics.underline.thickness);
+
+    auto const supersamplingFactor = []() {
+        auto constexpr envName = "SSA_FACTOR";
+        if (!getenv(envName))
+            return 2;
+        auto const val = atoi(getenv(envName));
+        if (!(val >= 1 && val <= 8))
+            return 1;
+        return val;
+    }();
+    auto const supersamplingSize = _metrics.cellSize * supersamplingFactor;
+    auto const supersamplingLineThickness = _metrics.underline.thickness * 2;
+    auto tmp = buildBoxElements(codepoint, supersamplingSize, supersamplingLineThickness);
+    if (!tmp)
+        return nullopt;
+
+    // pixels = downsample(*tmp, _gridMetrics.cellSize, supersamplingFactor);
+    return downsample(*tmp, 1, supersamplingSize, _metrics.cellSize);
+}
+
+auto BoxDrawingRenderer::createTileData(atlas::TileLocation tileLocation, atlas::Buffer pixels)
+    -> TextureAtlas::TileCreateData
+{
+    return createTileData(tileLocation,
+                          move(pixels),
+                          atlas::Format::Red,
+                          _gridMetrics.cellSize,
+                          RenderTileAttributes::X { 0 },
+                          RenderTileAttributes::Y { 0 },
+                          FRAGMENT_SELECTOR_GLYPH_ALPHA);
+}
+
 auto BoxDrawingRenderer::createTileData(char32_t codepoint, atlas::TileLocation tileLocation)
     -> optional<TextureAtlas::TileCreateData>
 {
-    if (optional<atlas::Buffer> image = buildElements(codepoint))
+    // Tiles evicted from the atlas are recreated from the prepared ones, if still matching.
+    if (preparedTiles_ && sameTileMetrics(preparedTiles_->metrics, _gridMetrics))
     {
-        return { createTileData(tileLocation,
-                                move(*image),
-                                atlas::Format::Red,
-                                _gridMetrics.cellSize,
-                                RenderTileAttributes::X { 0 },
-                                RenderTileAttributes::Y { 0 },
-                                FRAGMENT_SELECTOR_GLYPH_ALPHA) };
+        auto const i = std::lower_bound(
+            preparedTiles_->tiles.begin(),
+            preparedTiles_->tiles.end(),
+            codepoint,
+            [](auto const& tile, char32_t value) { return tile.first < value; });
+        if (i != preparedTiles_->tiles.end() && i->first == codepoint)
+            return { createTileData(tileLocation, i->second) };
     }
 
-    auto const antialiasing = containsNonCanonicalLines(codepoint);
-    atlas::Buffer pixels;
-    if (antialiasing)
-    {
-        auto const supersamplingFactor = []() {
-            auto constexpr envName = "SSA_FACTOR";
-            if (!getenv(envName))
-                return 2;
-            auto const val = atoi(getenv(envName));
-            if (!(val >= 1 && val <= 8))
-                return 1;
-            return val;
-        }();
-        auto const supersamplingSize = _gridMetrics.cellSize * supersamplingFactor;
-        auto const supersamplingLineThickness = _gridMetrics.underline.thickness * 2;
-        auto tmp = buildBoxElements(codepoint, supersamplingSize, supersamplingLineThickness);
-        if (!tmp)
-            return nullopt;
-
-        // pixels = downsample(*tmp, _gridMetrics.cellSize, supersamplingFactor);
-        pixels = downsample(*tmp, 1, supersamplingSize, _gridMetrics.cellSize);
-    }
-    else
-    {
-        auto tmp = buildBoxElements(codepoint, _gridMetrics.cellSize, _gridMetrics.underline.thickness);
-        if (!tmp)
-            return nullopt;
-        pixels = move(*tmp);
-    }
+    auto pixels = rasterize(codepoint, _gridMetrics);
+    if (!pixels)
+        return nullopt;
 
-    return { createTileData(tileLocation,
-                            move(pixels),
-                            atlas::Format::Red,
-                            _gridMetrics.cellSize,
-                            RenderTileAttributes::X { 0 },
-                            RenderTileAttributes::Y { 0 },
-                            FRAGMENT_SELECTOR_GLYPH_ALPHA) };
+    return { createTileData(tileLocation, move(*pixels)) };
 }
 
 Renderable::AtlasTileAttributes const* BoxDrawingRenderer::getOrCreateCachedTileAttributes(char32_t codepoint)
 {
     return textureAtlas().get_or_try_emplace(
-        crispy::StrongHash { 31, 13, 8, static_cast<uint32_t>(codepoint) },
+        tileHash(codepoint),
         [this, codepoint](atlas::TileLocation tileLocation) -> optional<TextureAtlas::TileCreateData> {
             return createTileData(codepoint, tileLocation);
         });
@@ -995,31 +1173,22 @@ Renderable::AtlasTileAttributes const* BoxDrawingRenderer::getOrCreateCachedTile
 
 bool BoxDrawingRenderer::renderable(char32_t codepoint) const noexcept
 {
-    auto const ascending = [codepoint](char32_t a, char32_t b) noexcept -> bool {
-        return a <= codepoint && codepoint <= b;
-    };
+    if (codepoint < RenderableCodepoints.front().first)
+        return false;
 
-    return ascending(0x23A1, 0x23A6)      // mathematical square brackets
-           || ascending(0x2500, 0x2590)   // box drawing, block elements
-           || ascending(0x2594, 0x259F)   // Terminal graphic characters
-           || ascending(0x1FB00, 0x1FBAF) // more block sextants
-           || ascending(0x1FBF0, 0x1FBF9) // digits
-           || ascending(0xEE00, 0xEE05)   // progress bar (Fira Code)
-           || codepoint == 0xE0B0         // 
-           || codepoint == 0xE0B2         // 
-           || codepoint == 0xE0B4         // 
-           || codepoint == 0xE0B6         // 
-           || codepoint == 0xE0BA         // 
-           || codepoint == 0xE0BC         // 
-           || codepoint == 0xE0BE         // 
-        ;
+    return std::any_of(RenderableCodepoints.begin(), RenderableCodepoints.end(), [=](auto const& range) {
+        return range.first <= codepoint && codepoint <= range.last;
+    });
 }
 
-optional<atlas::Buffer> BoxDrawingRenderer::buildElements(char32_t codepoint)
+optional<atlas::Buffer> BoxDrawingRenderer::buildElements(char32_t codepoint, GridMetrics const& _metrics)
 {
     using namespace detail;
 
-    auto const size = _gridMetrics.cellSize;
+    auto const size = _metrics.cellSize;
+    auto const lineThickness = _metrics.underline.thickness;
+    auto const underlinePosition = _metrics.underline.position;
+    auto const baseline = _metrics.baseline;
 
     auto const ud = [=](Ratio a, Ratio b) {
         return upperDiagonalMosaic(size, a, b);
@@ -1027,38 +1196,26 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildElements(char32_t codepoint)
     auto const ld = [=](Ratio a, Ratio b) {
         return lowerDiagonalMosaic(size, a, b);
     };
-    auto const lineArt =
-#if __cplusplus > 201703L
-        [=, this]
-#else
-        [=]
-#endif
-        () {
-            auto b = blockElement<2>(size);
-            b.lineThickness(_gridMetrics.underline.thickness);
-            return b;
-        };
-    auto const progressBar =
-#if __cplusplus > 201703L
-        [=, this]
-#else
-        [=]
-#endif
-        () {
-            return ProgressBar { size, _gridMetrics.underline.position };
-        };
-    auto const segmentArt =
-#if __cplusplus > 201703L
-        [=, this]
-#else
-        [=]
-#endif
-        () {
-            auto constexpr AntiAliasingSamplingFactor = 1;
-            return blockElement<AntiAliasingSamplingFactor>(size)
-                .lineThickness(_gridMetrics.underline.thickness)
-                .baseline(_gridMetrics.baseline * AntiAliasingSamplingFactor);
-        };
+    auto const lineArt = [=]() {
+        auto b = blockElement<2>(size);
+        b.lineThickness(lineThickness);
+        return b;
+    };
+    auto const progressBar = [=]() {
+        return ProgressBar { size, underlinePosition };
+    };
+    auto const segmentArt = [=]() {
+        auto constexpr AntiAliasingSamplingFactor = 1;
+        return blockElement<AntiAliasingSamplingFactor>(size)
+            .lineThickness(lineThickness)
+            .baseline(baseline * AntiAliasingSamplingFactor);
+    };
+
+    // Patterns that are encoded in the codepoint's bits are constructed procedurally.
+    if (0x2800 <= codepoint && codepoint <= 0x28FF)
+        return braille(size, static_cast<unsigned>(codepoint - 0x2800));
+    if (0x1FB00 <= codepoint && codepoint <= 0x1FB3B)
+        return blockSextants(size, sextantPattern(codepoint));
 
     // TODO: just check notcurses-info to get an idea what may be missing
     switch (codepoint)
@@ -1240,69 +1397,6 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildElements(char32_t codepoint)
         // TODO: ◾ U+25FE  BLACK MEDIUM SMALL SQUARE
         // TODO: ◿  U+25FF  LOWER RIGHT TRIANGLE
         // }}}
-        // {{{ 1FB00..1FB3B sextant blocks
-        case 0x1FB00: return blockSextant(size, 1);             // 🬀  BLOCK SEXTANT-1
-        case 0x1FB01: return blockSextant(size, 2);             // 🬁  BLOCK SEXTANT-2
-        case 0x1FB02: return blockSextant(size, 1, 2);          // 🬂  BLOCK SEXTANT-12
-        case 0x1FB03: return blockSextant(size, 3);             // 🬃  BLOCK SEXTANT-3
-        case 0x1FB04: return blockSextant(size, 1, 3);          // 🬄  BLOCK SEXTANT-13
-        case 0x1FB05: return blockSextant(size, 2, 3);          // 🬅  BLOCK SEXTANT-23
-        case 0x1FB06: return blockSextant(size, 1, 2, 3);       // 🬆  BLOCK SEXTANT-123
-        case 0x1FB07: return blockSextant(size, 4);             // 🬇  BLOCK SEXTANT-4
-        case 0x1FB08: return blockSextant(size, 1, 4);          // 🬈  BLOCK SEXTANT-14
-        case 0x1FB09: return blockSextant(size, 2, 4);          // 🬉  BLOCK SEXTANT-24
-        case 0x1FB0A: return blockSextant(size, 1, 2, 4);       // 🬊  BLOCK SEXTANT-124
-        case 0x1FB0B: return blockSextant(size, 3, 4);          // 🬋  BLOCK SEXTANT-34
-        case 0x1FB0C: return blockSextant(size, 1, 3, 4);       // 🬌  BLOCK SEXTANT-134
-        case 0x1FB0D: return blockSextant(size, 2, 3, 4);       // 🬍  BLOCK SEXTANT-234
-        case 0x1FB0E: return blockSextant(size, 1, 2, 3, 4);    // 🬎  BLOCK SEXTANT-1234
-        case 0x1FB0F: return blockSextant(size, 5);             // 🬏  BLOCK SEXTANT-5
-        case 0x1FB10: return blockSextant(size, 1, 5);          // 🬐  BLOCK SEXTANT-15
-        case 0x1FB11: return blockSextant(size, 2, 5);          // 🬑  BLOCK SEXTANT-25
-        case 0x1FB12: return blockSextant(size, 1, 2, 5);       // 🬒  BLOCK SEXTANT-125
-        case 0x1FB13: return blockSextant(size, 3, 5);          // 🬓  BLOCK SEXTANT-35
-        case 0x1FB14: return blockSextant(size, 2, 3, 5);       // 🬔  BLOCK SEXTANT-235
-        case 0x1FB15: return blockSextant(size, 1, 2, 3, 5);    // 🬕  BLOCK SEXTANT-1235
-        case 0x1FB16: return blockSextant(size, 4, 5);          // 🬖  BLOCK SEXTANT-45
-        case 0x1FB17: return blockSextant(size, 1, 4, 5);       // 🬗  BLOCK SEXTANT-145
-        case 0x1FB18: return blockSextant(size, 2, 4, 5);       // 🬘  BLOCK SEXTANT-245
-        case 0x1FB19: return blockSextant(size, 1, 2, 4, 5);    // 🬙  BLOCK SEXTANT-1245
-        case 0x1FB1A: return blockSextant(size, 3, 4, 5);       // 🬚  BLOCK SEXTANT-345
-        case 0x1FB1B: return blockSextant(size, 1, 3, 4, 5);    // 🬛  BLOCK SEXTANT-1345
-        case 0x1FB1C: return blockSextant(size, 2, 3, 4, 5);    // 🬜  BLOCK SEXTANT-2345
-        case 0x1FB1D: return blockSextant(size, 1, 2, 3, 4, 5); // 🬝  BLOCK SEXTANT-12345
-        case 0x1FB1E: return blockSextant(size, 6);             // 🬞  BLOCK SEXTANT-6
-        case 0x1FB1F: return blockSextant(size, 1, 6);          // 🬟  BLOCK SEXTANT-16
-        case 0x1FB20: return blockSextant(size, 2, 6);          // 🬠  BLOCK SEXTANT-26
-        case 0x1FB21: return blockSextant(size, 1, 2, 6);       // 🬡  BLOCK SEXTANT-126
-        case 0x1FB22: return blockSextant(size, 3, 6);          // 🬢  BLOCK SEXTANT-36
-        case 0x1FB23: return blockSextant(size, 1, 3, 6);       // 🬣  BLOCK SEXTANT-136
-        case 0x1FB24: return blockSextant(size, 2, 3, 6);       // 🬤  BLOCK SEXTANT-236
-        case 0x1FB25: return blockSextant(size, 1, 2, 3, 6);    // 🬥  BLOCK SEXTANT-1236
-        case 0x1FB26: return blockSextant(size, 4, 6);          // 🬦  BLOCK SEXTANT-46
-        case 0x1FB27: return blockSextant(size, 1, 4, 6);       // 🬧  BLOCK SEXTANT-146
-        case 0x1FB28: return blockSextant(size, 1, 2, 4, 6);    // 🬨  BLOCK SEXTANT-1246
-        case 0x1FB29: return blockSextant(size, 3, 4, 6);       // 🬩  BLOCK SEXTANT-346
-        case 0x1FB2A: return blockSextant(size, 1, 3, 4, 6);    // 🬪  BLOCK SEXTANT-1346
-        case 0x1FB2B: return blockSextant(size, 2, 3, 4, 6);    // 🬫  BLOCK SEXTANT-2346
-        case 0x1FB2C: return blockSextant(size, 1, 2, 3, 4, 6); // 🬬  BLOCK SEXTANT-12346
-        case 0x1FB2D: return blockSextant(size, 5, 6);          // 🬭  BLOCK SEXTANT-56
-        case 0x1FB2E: return blockSextant(size, 1, 5, 6);       // 🬮  BLOCK SEXTANT-156
-        case 0x1FB2F: return blockSextant(size, 2, 5, 6);       // 🬯  BLOCK SEXTANT-256
-        case 0x1FB30: return blockSextant(size, 1, 2, 5, 6);    // 🬰  BLOCK SEXTANT-1256
-        case 0x1FB31: return blockSextant(size, 3, 5, 6);       // 🬱  BLOCK SEXTANT-356
-        case 0x1FB32: return blockSextant(size, 1, 3, 5, 6);    // 🬲  BLOCK SEXTANT-1356
-        case 0x1FB33: return blockSextant(size, 2, 3, 5, 6);    // 🬳  BLOCK SEXTANT-2356
-        case 0x1FB34: return blockSextant(size, 1, 2, 3, 5, 6); // 🬴  BLOCK SEXTANT-12356
-        case 0x1FB35: return blockSextant(size, 4, 5, 6);       // 🬵  BLOCK SEXTANT-456
-        case 0x1FB36: return blockSextant(size, 1, 4, 5, 6);    // 🬶  BLOCK SEXTANT-1456
-        case 0x1FB37: return blockSextant(size, 2, 4, 5, 6);    // 🬷  BLOCK SEXTANT-2456
-        case 0x1FB38: return blockSextant(size, 1, 2, 4, 5, 6); // 🬸  BLOCK SEXTANT-12456
-        case 0x1FB39: return blockSextant(size, 3, 4, 5, 6);    // 🬹  BLOCK SEXTANT-3456
-        case 0x1FB3A: return blockSextant(size, 1, 3, 4, 5, 6); // 🬺  BLOCK SEXTANT-13456
-        case 0x1FB3B:
-            return blockSextant(size, 2, 3, 4, 5, 6); // 🬻  BLOCK SEXTANT-23456
-        // }}}
         // {{{ 1FB3C..1FBAF diagonals, nth, block elements
         case 0x1FB3C: return /* 🬼  */ ld({ 0, 3 / 4_th }, { 1 / 4_th, 1 });
         case 0x1FB3D: return /* 🬽  */ ld({ 0, 3 / 4_th }, { 1, 1 });
@@ -1556,10 +1650,8 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildBoxElements(char32_t _codepoint
         auto x0 = round(p / 2.0);
         for ([[maybe_unused]] auto const _: iota(0u, dashCount))
         {
-            auto const x0_ = static_cast<int>(round(x0));
-            for (auto const y: iota(y0, y0 + w))
-                for (auto const x: iota(x0_, x0_ + static_cast<int>(p)))
-                    image[y * *width + unsigned(x)] = 0xFF;
+            auto const x0_ = static_cast<unsigned>(round(x0));
+            detail::fillRect(image, *width, x0_, y0, static_cast<unsigned>(p), w);
             x0 += unbox<double>(width) / static_cast<double>(dashCount);
         }
 
@@ -1579,9 +1671,7 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildBoxElements(char32_t _codepoint
         for ([[maybe_unused]] auto const i: iota(0u, dashCount))
         {
             auto const y0_ = static_cast<unsigned>(round(y0));
-            for (auto const y: iota(y0_, y0_ + static_cast<unsigned>(p)))
-                for (auto const x: iota(x0, x0 + w))
-                    image[y * *width + unsigned(x)] = 0xFF;
+            detail::fillRect(image, *width, x0, y0_, w, static_cast<unsigned>(p));
             y0 += unbox<double>(height) / static_cast<double>(dashCount);
         }
 
@@ -1611,28 +1701,20 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildBoxElements(char32_t _codepoint
                     //                 y0,
                     //                 y0 + lightThickness - 1,
                     //                 offset);
-                    for (auto const yi: iota(0u, lightThickness))
-                        for (auto const xi: iota(0u, x1 - x0))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, x1 - x0, lightThickness);
                     break;
                 }
                 case detail::Double: {
                     auto y0 = offset - lightThickness / 2 - lightThickness;
-                    for (auto const yi: iota(0u, lightThickness))
-                        for (auto const xi: iota(0u, x1 - x0))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, x1 - x0, lightThickness);
 
                     y0 = offset + lightThickness / 2;
-                    for (auto const yi: iota(0u, lightThickness))
-                        for (auto const xi: iota(0u, x1 - x0))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, x1 - x0, lightThickness);
                     break;
                 }
                 case detail::Heavy: {
                     auto const y0 = offset - heavyThickness / 2;
-                    for (auto const yi: iota(0u, heavyThickness))
-                        for (auto const xi: iota(0u, x1 - x0))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, x1 - x0, heavyThickness);
                     break;
                 }
                 case detail::Light2:
@@ -1665,28 +1747,20 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildBoxElements(char32_t _codepoint
                 case detail::NoLine: break;
                 case detail::Light: {
                     auto const x0 = offset - lightThickness / 2;
-                    for (auto const yi: iota(0u, y1 - y0))
-                        for (auto const xi: iota(0u, lightThickness))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, lightThickness, y1 - y0);
                     break;
                 }
                 case detail::Double: {
                     auto x0 = offset - lightThickness / 2 - lightThickness;
-                    for (auto const yi: iota(0u, y1 - y0))
-                        for (auto const xi: iota(0u, lightThickness))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, lightThickness, y1 - y0);
 
                     x0 = offset - lightThickness / 2 + lightThickness;
-                    for (auto const yi: iota(0u, y1 - y0))
-                        for (auto const xi: iota(0u, lightThickness))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, lightThickness, y1 - y0);
                     break;
                 }
                 case detail::Heavy: {
                     auto const x0 = offset - (lightThickness * 3) / 2;
-                    for (auto const yi: iota(0u, y1 - y0))
-                        for (auto const xi: iota(0u, lightThickness * 3))
-                            image[(y0 + yi) * *width + x0 + xi] = 0xFF;
+                    detail::fillRect(image, *width, x0, y0, lightThickness * 3, y1 - y0);
                     break;
                 }
                 case detail::Light2:
@@ -22,6 +22,10 @@
 #include <crispy/point.h>
 
 #include <array>
+#include <future>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace terminal::renderer
 {
@@ -41,8 +45,16 @@ class BoxDrawingRenderer: public Renderable
     explicit BoxDrawingRenderer(GridMetrics const& gridMetrics): Renderable { gridMetrics } {}
 
     void setRenderTarget(RenderTarget& renderTarget, DirectMappingAllocator& directMappingAllocator) override;
+    void setTextureAtlas(TextureAtlas& atlas) override;
     void clearCache() override;
 
+    /// Rasterizes all renderable codepoints for the current grid metrics in the background.
+    ///
+    /// Once done, they are uploaded to the texture atlas at once, so that the first frames
+    /// drawing lots of different box drawing characters do not stall on rasterizing them.
+    /// Until then, tiles are rasterized on demand.
+    void startTilePreparation();
+
     [[nodiscard]] bool renderable(char32_t codepoint) const noexcept;
 
     /// Renders boxdrawing character.
@@ -53,16 +65,33 @@ class BoxDrawingRenderer: public Renderable
     void inspect(std::ostream& output) const override;
 
   private:
+    struct PreparedTiles
+    {
+        GridMetrics metrics;
+        std::vector<std::pair<char32_t, atlas::Buffer>> tiles; // sorted by codepoint
+    };
+
+    void uploadPreparedTiles();
+
     AtlasTileAttributes const* getOrCreateCachedTileAttributes(char32_t codepoint);
 
     using Renderable::createTileData;
     [[nodiscard]] std::optional<TextureAtlas::TileCreateData> createTileData(
         char32_t codepoint, atlas::TileLocation tileLocation);
+    [[nodiscard]] TextureAtlas::TileCreateData createTileData(atlas::TileLocation tileLocation,
+                                                              atlas::Buffer pixels);
+
+    [[nodiscard]] static std::optional<atlas::Buffer> rasterize(char32_t codepoint,
+                                                                GridMetrics const& _metrics);
+    [[nodiscard]] static std::optional<atlas::Buffer> buildBoxElements(char32_t codepoint,
+                                                                       ImageSize _size,
+                                                                       int _lineThickness);
+    [[nodiscard]] static std::optional<atlas::Buffer> buildElements(char32_t codepoint,
+                                                                    GridMetrics const& _metrics);
 
-    [[nodiscard]] std::optional<atlas::Buffer> buildBoxElements(char32_t codepoint,
-                                                                ImageSize _size,
-                                                                int _lineThickness);
-    [[nodiscard]] std::optional<atlas::Buffer> buildElements(char32_t codepoint);
+    std::optional<PreparedTiles> preparedTiles_;
+    bool preparedTilesUploaded_ = false;
+    std::future<PreparedTiles> tilePreparation_;
 };
 
 } // namespace terminal::renderer
@@ -57,7 +57,25 @@ namespace
         pair { CellFlags::Framed, Decorator::Framed },
         pair { CellFlags::Encircled, Decorator::Encircle },
     };
-}
+
+    /// Tests whether the decoration's tile is the same in every column, and can thus be stretched.
+    constexpr bool isHorizontallyUniform(Decorator decoration) noexcept
+    {
+        switch (decoration)
+        {
+            case Decorator::Underline:
+            case Decorator::DoubleUnderline:
+            case Decorator::Overline:
+            case Decorator::CrossedOut:
+            case Decorator::Framed:
+            case Decorator::Encircle: return true;
+            case Decorator::CurlyUnderline:
+            case Decorator::DottedUnderline:
+            case Decorator::DashedUnderline: return false;
+        }
+        return false;
+    }
+} // namespace
 
 DecorationRenderer::DecorationRenderer(GridMetrics const& _gridMetrics,
                                        Decorator _hyperlinkNormal,
@@ -66,7 +84,9 @@ DecorationRenderer::DecorationRenderer(GridMetrics const& _gridMetrics,
 {
 }
 
-constexpr inline uint32_t DirectMappedDecorationCount = std::numeric_limits<Decorator>::count();
+// The left and right edges of framed runs are direct mapped after all decorations.
+constexpr inline uint32_t FrameEdgeIndex = std::numeric_limits<Decorator>::count();
+constexpr inline uint32_t DirectMappedDecorationCount = FrameEdgeIndex + 1;
 
 void DecorationRenderer::setRenderTarget(RenderTarget& renderTarget,
                                          DirectMappingAllocator& directMappingAllocator)
@@ -97,6 +117,10 @@ void DecorationRenderer::initializeDirectMapping()
         TextureAtlas::TileCreateData tileData = createTileData(decoration, tileLocation);
         _textureAtlas->setDirectMapping(tileIndex, move(tileData));
     }
+
+    auto const edgeTileIndex = _directMapping.toTileIndex(FrameEdgeIndex);
+    auto const edgeTileLocation = _textureAtlas->tileLocation(edgeTileIndex);
+    _textureAtlas->setDirectMapping(edgeTileIndex, createFrameEdgeTileData(edgeTileLocation));
 }
 
 void DecorationRenderer::inspect(std::ostream& /*output*/) const
@@ -106,9 +130,36 @@ void DecorationRenderer::inspect(std::ostream& /*output*/) const
 void DecorationRenderer::renderCell(RenderCell const& _cell)
 {
     for (auto const& mapping: CellFlagDecorationMappings)
-        if (_cell.flags & mapping.first)
-            renderDecoration(
-                mapping.second, _gridMetrics.map(_cell.position), ColumnCount(1), _cell.decorationColor);
+    {
+        if (!(_cell.flags & mapping.first))
+            continue;
+
+        auto& run = pendingRuns_[static_cast<size_t>(mapping.second)];
+
+        if (run && run->start.line == _cell.position.line
+            && run->start.column + boxed_cast<ColumnOffset>(run->columnCount) == _cell.position.column
+            && run->color == _cell.decorationColor)
+        {
+            ++run->columnCount;
+            continue;
+        }
+
+        if (run)
+            renderDecoration(mapping.second, _gridMetrics.map(run->start), run->columnCount, run->color);
+        run = DecorationRun { _cell.position, ColumnCount(1), _cell.decorationColor };
+    }
+}
+
+void DecorationRenderer::endFrame()
+{
+    for (auto const decoration: each_element<Decorator>())
+    {
+        auto& run = pendingRuns_[static_cast<size_t>(decoration)];
+        if (!run)
+            continue;
+        renderDecoration(decoration, _gridMetrics.map(run->start), run->columnCount, run->color);
+        run.reset();
+    }
 }
 
 auto DecorationRenderer::createTileData(Decorator decoration, atlas::TileLocation tileLocation)
@@ -235,27 +286,18 @@ auto DecorationRenderer::createTileData(Decorator decoration, atlas::TileLocatio
             });
         }
         case Decorator::Framed: {
+            // Only the top and bottom lines, as the left and right ones are drawn at the run's edges.
             auto const cellHeight = _gridMetrics.cellSize.height;
             auto const thickness = max(1u, unsigned(underlineThickness()) / 2);
             auto const imageSize = ImageSize { width, cellHeight };
             return create(imageSize, [&]() -> atlas::Buffer {
                 auto image = atlas::Buffer(unbox<size_t>(width) * unbox<size_t>(cellHeight), 0);
-                auto const gap = 0; // thickness;
-                // Draws the top and bottom horizontal lines
-                for (unsigned y = gap; y < thickness + gap; ++y)
-                    for (unsigned x = gap; x < unbox<unsigned>(width) - gap; ++x)
+                for (unsigned y = 0; y < thickness; ++y)
+                    for (unsigned x = 0; x < unbox<unsigned>(width); ++x)
                     {
                         image[y * *width + x] = 0xFF;
                         image[(*cellHeight - 1 - y) * *width + x] = 0xFF;
                     }
-
-                // Draws the left and right vertical lines
-                for (unsigned y = gap; y < unbox<unsigned>(cellHeight) - gap; y++)
-                    for (unsigned x = gap; x < thickness + gap; ++x)
-                    {
-                        image[y * *width + x] = 0xFF;
-                        image[y * *width + (*width - 1 - x)] = 0xFF;
-                    }
                 return image;
             });
         }
@@ -288,22 +330,56 @@ auto DecorationRenderer::createTileData(Decorator decoration, atlas::TileLocatio
     return {};
 }
 
+auto DecorationRenderer::createFrameEdgeTileData(atlas::TileLocation tileLocation)
+    -> TextureAtlas::TileCreateData
+{
+    auto const thickness = max(1u, unsigned(underlineThickness()) / 2);
+    auto const imageSize = ImageSize { Width(thickness), _gridMetrics.cellSize.height };
+    return createTileData(tileLocation,
+                          atlas::Buffer(imageSize.area(), 0xFF),
+                          atlas::Format::Red,
+                          imageSize,
+                          RenderTileAttributes::X { 0 },
+                          RenderTileAttributes::Y { 0 },
+                          FRAGMENT_SELECTOR_GLYPH_ALPHA);
+}
+
+void DecorationRenderer::renderStretchedTile(crispy::Point pos,
+                                             Width width,
+                                             RGBColor const& color,
+                                             uint32_t tileIndex)
+{
+    auto tileAttributes = _textureAtlas->directMapped(tileIndex);
+    tileAttributes.metadata.targetSize = ImageSize { width, tileAttributes.bitmapSize.height };
+    renderTile({ pos.x }, { pos.y }, color, tileAttributes);
+}
+
 void DecorationRenderer::renderDecoration(Decorator decoration,
                                           crispy::Point pos,
                                           ColumnCount columnCount,
                                           RGBColor const& color)
 {
-    for (auto i = ColumnCount(0); i < columnCount; ++i)
+    auto const tileIndex = _directMapping.toTileIndex(static_cast<uint32_t>(decoration));
+    auto const cellWidth = unbox<int>(_gridMetrics.cellSize.width);
+
+    if (isHorizontallyUniform(decoration))
     {
-        auto const tileIndex = _directMapping.toTileIndex(static_cast<uint32_t>(decoration));
-        auto const tileLocation = _textureAtlas->tileLocation(tileIndex);
-        TextureAtlas::TileCreateData tileData = createTileData(decoration, tileLocation);
-        AtlasTileAttributes const& tileAttributes = _textureAtlas->directMapped(tileIndex);
-        renderTile({ pos.x + unbox<int>(i) * unbox<int>(_gridMetrics.cellSize.width) },
-                   { pos.y },
-                   color,
-                   tileAttributes);
+        auto const width = Width::cast_from(cellWidth * unbox<int>(columnCount));
+        renderStretchedTile(pos, width, color, tileIndex);
+        if (decoration == Decorator::Framed)
+        {
+            auto const edgeTileIndex = _directMapping.toTileIndex(FrameEdgeIndex);
+            auto const& edgeAttributes = _textureAtlas->directMapped(edgeTileIndex);
+            auto const right = pos.x + unbox<int>(width) - unbox<int>(edgeAttributes.bitmapSize.width);
+            renderTile({ pos.x }, { pos.y }, color, edgeAttributes);
+            renderTile({ right }, { pos.y }, color, edgeAttributes);
+        }
+        return;
     }
+
+    AtlasTileAttributes const& tileAttributes = _textureAtlas->directMapped(tileIndex);
+    for (auto i = 0; i < unbox<int>(columnCount); ++i)
+        renderTile({ pos.x + i * cellWidth }, { pos.y }, color, tileAttributes);
 }
 
 } // namespace terminal::renderer
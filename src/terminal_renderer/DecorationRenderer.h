@@ -20,12 +20,18 @@
 #include <terminal_renderer/RenderTarget.h>
 #include <terminal_renderer/TextureAtlas.h>
 
+#include <array>
+#include <optional>
+
 namespace terminal::renderer
 {
 
 struct GridMetrics;
 
 /// Renders any kind of grid cell decorations, ranging from basic underline to surrounding boxes.
+///
+/// Horizontally adjacent cells of the same decoration and color are joined into runs,
+/// each of which is rendered at once when the run ends.
 class DecorationRenderer: public Renderable
 {
   public:
@@ -51,6 +57,13 @@ class DecorationRenderer: public Renderable
 
     void renderCell(RenderCell const& _cell);
 
+    /// Renders all decoration runs that are still pending. Must be called at the end of each frame.
+    void endFrame();
+
+    /// Renders a decoration spanning @p columnCount columns.
+    ///
+    /// Decorations that do not vary horizontally are rendered by stretching their tile across
+    /// all columns, and the others by repeating their tile for each column.
     void renderDecoration(Decorator _decoration,
                           crispy::Point _pos,
                           ColumnCount columnCount,
@@ -63,13 +76,23 @@ class DecorationRenderer: public Renderable
     constexpr int underlinePosition() const noexcept { return _gridMetrics.underline.position; }
 
   private:
+    struct DecorationRun
+    {
+        CellLocation start;
+        ColumnCount columnCount;
+        RGBColor color;
+    };
+
     void initializeDirectMapping();
     using Renderable::createTileData;
     TextureAtlas::TileCreateData createTileData(Decorator decoration, atlas::TileLocation tileLocation);
+    TextureAtlas::TileCreateData createFrameEdgeTileData(atlas::TileLocation tileLocation);
+    void renderStretchedTile(crispy::Point _pos, Width _width, RGBColor const& _color, uint32_t _tileIndex);
 
     // private data members
     //
     DirectMapping _directMapping;
+    std::array<std::optional<DecorationRun>, std::numeric_limits<Decorator>::count()> pendingRuns_;
     Decorator hyperlinkNormal_ = Decorator::DottedUnderline;
     Decorator hyperlinkHover_ = Decorator::Underline;
 };
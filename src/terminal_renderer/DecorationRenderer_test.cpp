@@ -0,0 +1,221 @@
+/**
+ * This file is part of the "contour" project.
+ *   Copyright (c) 2022 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal_renderer/DecorationRenderer.h>
+#include <terminal_renderer/GridMetrics.h>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace terminal;
+using namespace terminal::renderer;
+
+namespace
+{
+
+// {{{ mock render target
+class MockAtlasBackend: public atlas::AtlasBackend
+{
+  public:
+    std::vector<atlas::RenderTile> renderedTiles;
+
+    [[nodiscard]] ImageSize atlasSize() const noexcept override { return atlasSize_; }
+    void configureAtlas(atlas::ConfigureAtlas atlas) override { atlasSize_ = atlas.size; }
+    void uploadTile(atlas::UploadTile /*tile*/) override {}
+    void renderTile(atlas::RenderTile tile) override { renderedTiles.emplace_back(tile); }
+
+  private:
+    ImageSize atlasSize_ {};
+};
+
+class MockRenderTarget: public RenderTarget
+{
+  public:
+    MockAtlasBackend backend;
+
+    void setRenderSize(ImageSize /*_size*/) override {}
+    void setMargin(renderer::PageMargin /*_margin*/) override {}
+    atlas::AtlasBackend& textureScheduler() override { return backend; }
+    void setBackgroundImage(std::shared_ptr<BackgroundImage const> const& /*_backgroundImage*/) override {}
+    void renderRectangle(int, int, Width, Height, RGBAColor) override {}
+    void scheduleScreenshot(ScreenshotCallback /*_callback*/) override {}
+    void clear(RGBAColor /*_fillColor*/) override {}
+    void execute() override {}
+    void clearCache() override {}
+    std::optional<AtlasTextureScreenshot> readAtlas() override { return std::nullopt; }
+    void inspect(std::ostream& /*output*/) const override {}
+};
+// }}}
+
+auto constexpr CellWidth = 8;
+auto constexpr CellHeight = 16;
+
+auto constexpr Red = RGBColor { 0xFF, 0x00, 0x00 };
+auto constexpr Blue = RGBColor { 0x00, 0x00, 0xFF };
+
+GridMetrics makeGridMetrics()
+{
+    auto gridMetrics = GridMetrics {};
+    gridMetrics.pageSize = PageSize { LineCount(3), ColumnCount(10) };
+    gridMetrics.cellSize = ImageSize { Width(CellWidth), Height(CellHeight) };
+    gridMetrics.baseline = 3;
+    gridMetrics.underline.position = 2;
+    gridMetrics.underline.thickness = 2;
+    return gridMetrics;
+}
+
+/// Wires up a DecorationRenderer with a mock render target, recording all rendered tiles.
+struct Fixture
+{
+    GridMetrics gridMetrics = makeGridMetrics();
+    MockRenderTarget renderTarget;
+    Renderable::DirectMappingAllocator directMappingAllocator;
+    Renderable::TextureAtlas textureAtlas;
+    DecorationRenderer renderer;
+
+    Fixture():
+        textureAtlas { renderTarget.backend,
+                       atlas::AtlasProperties { atlas::Format::RGBA,
+                                                gridMetrics.cellSize,
+                                                crispy::StrongHashtableSize { 32 },
+                                                crispy::LRUCapacity { 32 },
+                                                16 } },
+        renderer { gridMetrics, Decorator::DottedUnderline, Decorator::Underline }
+    {
+        renderer.setRenderTarget(renderTarget, directMappingAllocator);
+        renderer.setTextureAtlas(textureAtlas);
+    }
+
+    void renderCell(LineOffset line, ColumnOffset column, CellFlags flags, RGBColor color)
+    {
+        auto cell = RenderCell {};
+        cell.position = CellLocation { line, column };
+        cell.flags = flags;
+        cell.decorationColor = color;
+        renderer.renderCell(cell);
+    }
+
+    std::vector<atlas::RenderTile> const& renderedTiles() const noexcept
+    {
+        return renderTarget.backend.renderedTiles;
+    }
+};
+
+bool sameTile(atlas::TileLocation const& a, atlas::TileLocation const& b) noexcept
+{
+    return a.x.value == b.x.value && a.y.value == b.y.value;
+}
+
+/// Y coordinate of the given line in the page of three lines.
+constexpr int yOf(int line) noexcept
+{
+    return (3 - line - 1) * CellHeight;
+}
+
+} // namespace
+
+TEST_CASE("DecorationRenderer.runs", "[renderer]")
+{
+    auto fixture = Fixture {};
+
+    fixture.renderCell(LineOffset(0), ColumnOffset(0), CellFlags::Underline, Red);
+    fixture.renderCell(LineOffset(0), ColumnOffset(1), CellFlags::Underline, Red);
+    fixture.renderCell(LineOffset(0), ColumnOffset(2), CellFlags::Underline, Red);
+    fixture.renderCell(LineOffset(0), ColumnOffset(3), CellFlags::Underline, Blue); // color change
+    fixture.renderCell(LineOffset(0), ColumnOffset(5), CellFlags::Underline, Blue); // gap
+    fixture.renderCell(LineOffset(0), ColumnOffset(6), CellFlags::Underline, Blue);
+    fixture.renderCell(LineOffset(1), ColumnOffset(7), CellFlags::Underline, Blue); // line change
+
+    // Runs are only emitted once they are known to end.
+    CHECK(fixture.renderedTiles().size() == 3);
+
+    fixture.renderer.endFrame();
+
+    auto const& tiles = fixture.renderedTiles();
+    REQUIRE(tiles.size() == 4);
+
+    auto const checkRun = [&](size_t index, int x, int y, int columns, RGBColor color) {
+        INFO(fmt::format("run {}", index));
+        CHECK(tiles[index].x.value == x);
+        CHECK(tiles[index].y.value == y);
+        CHECK(tiles[index].targetSize.width == Width(columns * CellWidth));
+        CHECK(tiles[index].targetSize.height == tiles[index].bitmapSize.height);
+        CHECK(tiles[index].color == atlas::normalize(color, 1.0f));
+        CHECK(sameTile(tiles[index].tileLocation, tiles[0].tileLocation));
+    };
+
+    checkRun(0, 0 * CellWidth, yOf(0), 3, Red);
+    checkRun(1, 3 * CellWidth, yOf(0), 1, Blue);
+    checkRun(2, 5 * CellWidth, yOf(0), 2, Blue);
+    checkRun(3, 7 * CellWidth, yOf(1), 1, Blue);
+
+    // No pending runs are left over for the next frame.
+    fixture.renderer.endFrame();
+    CHECK(fixture.renderedTiles().size() == 4);
+}
+
+TEST_CASE("DecorationRenderer.repeated", "[renderer]")
+{
+    // Decorations that vary horizontally are not stretched but repeated per column.
+    auto fixture = Fixture {};
+
+    fixture.renderCell(LineOffset(0), ColumnOffset(1), CellFlags::CurlyUnderlined, Red);
+    fixture.renderCell(LineOffset(0), ColumnOffset(2), CellFlags::CurlyUnderlined, Red);
+    fixture.renderCell(LineOffset(0), ColumnOffset(3), CellFlags::CurlyUnderlined, Red);
+    fixture.renderer.endFrame();
+
+    auto const& tiles = fixture.renderedTiles();
+    REQUIRE(tiles.size() == 3);
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        INFO(fmt::format("tile {}", i));
+        CHECK(tiles[i].x.value == int(i + 1) * CellWidth);
+        CHECK(tiles[i].y.value == yOf(0));
+        CHECK(tiles[i].targetSize == tiles[i].bitmapSize);
+        CHECK(sameTile(tiles[i].tileLocation, tiles[0].tileLocation));
+    }
+}
+
+TEST_CASE("DecorationRenderer.framed", "[renderer]")
+{
+    auto fixture = Fixture {};
+
+    fixture.renderCell(LineOffset(2), ColumnOffset(4), CellFlags::Framed, Red);
+    fixture.renderCell(LineOffset(2), ColumnOffset(5), CellFlags::Framed, Red);
+    fixture.renderCell(LineOffset(2), ColumnOffset(6), CellFlags::Framed, Red);
+    fixture.renderer.endFrame();
+
+    auto const& tiles = fixture.renderedTiles();
+    REQUIRE(tiles.size() == 3);
+
+    // The top and bottom lines are stretched across the whole run.
+    auto const& frame = tiles[0];
+    CHECK(frame.x.value == 4 * CellWidth);
+    CHECK(frame.y.value == yOf(2));
+    CHECK(frame.targetSize == ImageSize { Width(3 * CellWidth), Height(CellHeight) });
+
+    // The left and right edges are only drawn at the run's ends.
+    auto const& left = tiles[1];
+    auto const& right = tiles[2];
+    auto const edgeWidth = unbox<int>(left.bitmapSize.width);
+    CHECK(edgeWidth == 1);
+    CHECK(sameTile(left.tileLocation, right.tileLocation));
+    CHECK(!sameTile(left.tileLocation, frame.tileLocation));
+    CHECK(left.x.value == 4 * CellWidth);
+    CHECK(right.x.value == 7 * CellWidth - edgeWidth);
+    CHECK(left.y.value == yOf(2));
+    CHECK(right.y.value == yOf(2));
+    CHECK(left.targetSize == ImageSize { Width(edgeWidth), Height(CellHeight) });
+    CHECK(right.targetSize == left.targetSize);
+}
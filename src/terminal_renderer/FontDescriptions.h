@@ -43,13 +43,18 @@ struct FontDescriptions
 inline bool operator==(FontDescriptions const& a, FontDescriptions const& b) noexcept
 {
     // clang-format off
-    return a.size.pt == b.size.pt
+    return a.dpiScale == b.dpiScale
+        && a.dpi == b.dpi
+        && a.size.pt == b.size.pt
         && a.regular == b.regular
         && a.bold == b.bold
         && a.italic == b.italic
         && a.boldItalic == b.boldItalic
         && a.emoji == b.emoji
-        && a.renderMode == b.renderMode;
+        && a.renderMode == b.renderMode
+        && a.textShapingEngine == b.textShapingEngine
+        && a.fontLocator == b.fontLocator
+        && a.builtinBoxDrawing == b.builtinBoxDrawing;
     // clang-format on
 }
 
@@ -22,6 +22,8 @@
     #include <text_shaper/directwrite_shaper.h>
 #endif
 
+#include <crispy/StartupProfile.h>
+
 #include <array>
 #include <functional>
 #include <memory>
@@ -72,6 +74,8 @@ GridMetrics loadGridMetrics(text::font_key _font, PageSize _pageSize, text::shap
 
 FontKeys loadFontKeys(FontDescriptions const& _fd, text::shaper& _shaper)
 {
+    auto const _ = crispy::StartupProfile::get().phase("fonts");
+
     FontKeys output {};
     auto const regularOpt = _shaper.load_font(_fd.regular, _fd.size);
     Require(regularOpt.has_value());
@@ -148,6 +152,10 @@ Renderer::Renderer(PageSize pageSize,
     textRenderer_.updateFontMetrics();
     imageRenderer_.setCellSize(cellSize());
 
+    // Rasterize the direct-mapped glyphs while the render target is being set up.
+    if (_atlasDirectMapping)
+        textRenderer_.startDirectMappingWarmup();
+
     // clang-format off
     if (_atlasTileCount.value > atlasTileCount.value)
         RendererLog()("Increasing atlas tile count configuration to {} to satisfy worst-case rendering scenario.",
@@ -242,6 +250,8 @@ void Renderer::clearCache()
 
 void Renderer::setFonts(FontDescriptions _fontDescriptions)
 {
+    textRenderer_.finishDirectMappingWarmup();
+
     if (fontDescriptions_.textShapingEngine == _fontDescriptions.textShapingEngine)
     {
         textShaper_->clear_cache();
@@ -267,6 +277,7 @@ bool Renderer::setFontSize(text::font_size _fontSize)
     if (_fontSize.pt > 200.)
         return false;
 
+    textRenderer_.finishDirectMappingWarmup();
     fontDescriptions_.size = _fontSize;
     fonts_ = loadFontKeys(fontDescriptions_, *textShaper_);
     updateFontMetrics();
@@ -278,6 +289,8 @@ void Renderer::updateFontMetrics()
 {
     RendererLog()("Updating grid metrics: {}", gridMetrics_);
 
+    textRenderer_.finishDirectMappingWarmup();
+
     gridMetrics_ = loadGridMetrics(fonts_.regular, gridMetrics_.pageSize, *textShaper_);
 
     if (_renderTarget)
@@ -312,6 +325,7 @@ uint64_t Renderer::render(Terminal& _terminal, bool _pressure)
         cursorOpt = renderBuffer.get().cursor;
         renderCells(renderBuffer.get().screen);
     }
+    decorationRenderer_.endFrame();
     textRenderer_.endFrame();
 
     if (cursorOpt && cursorOpt.value().shape != CursorShape::Block)
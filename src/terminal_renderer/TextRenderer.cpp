@@ -140,6 +140,7 @@ Making use of reserved glyph slots
     #include <text_shaper/coretext_locator.h>
 #endif
 
+#include <crispy/StartupProfile.h>
 #include <crispy/algorithm.h>
 #include <crispy/assert.h>
 #include <crispy/indexed.h>
@@ -329,6 +330,44 @@ void TextRenderer::clearCache()
     boxDrawingRenderer_.clearCache();
 }
 
+void TextRenderer::startDirectMappingWarmup()
+{
+    if (directMappingWarmup_.valid())
+        return;
+
+    directMappingWarmup_ = std::async(std::launch::async, [this]() {
+        auto const _ = crispy::StartupProfile::get().phase("glyph warmup");
+        return prepareDirectMapping();
+    });
+}
+
+void TextRenderer::finishDirectMappingWarmup()
+{
+    if (directMappingWarmup_.valid())
+        preparedDirectMapping_ = directMappingWarmup_.get();
+}
+
+auto TextRenderer::prepareDirectMapping() -> PreparedDirectMapping
+{
+    auto result = PreparedDirectMapping { fonts_.regular, fontDescriptions_.renderMode, {} };
+    result.glyphs.reserve(DirectMappedCharsCount);
+
+    for (char32_t codepoint = FirstReservedChar; codepoint <= LastReservedChar; ++codepoint)
+    {
+        optional<text::glyph_position> gposOpt = textShaper_.shape(fonts_.regular, codepoint);
+        if (!gposOpt)
+            continue;
+
+        auto glyphOpt = textShaper_.rasterize(gposOpt->glyph, fontDescriptions_.renderMode);
+        if (!glyphOpt)
+            continue;
+
+        result.glyphs.emplace_back(PreparedGlyph { codepoint, move(*gposOpt), move(*glyphOpt) });
+    }
+
+    return result;
+}
+
 void TextRenderer::initializeDirectMapping()
 {
     Require(_textureAtlas);
@@ -339,12 +378,18 @@ void TextRenderer::initializeDirectMapping()
     _directMappedGlyphKeyToTileIndex.clear();
     _directMappedGlyphKeyToTileIndex.resize(LastReservedChar + 1);
 
-    for (char32_t codepoint = FirstReservedChar; codepoint <= LastReservedChar; ++codepoint)
+    // Use the glyphs of the warmup, unless the fonts have changed since.
+    finishDirectMappingWarmup();
+    auto prepared = move(preparedDirectMapping_);
+    preparedDirectMapping_.reset();
+    if (!prepared || !(prepared->font == fonts_.regular)
+        || prepared->renderMode != fontDescriptions_.renderMode)
+        prepared = prepareDirectMapping();
+
+    for (PreparedGlyph& preparedGlyph: prepared->glyphs)
     {
-        optional<text::glyph_position> gposOpt = textShaper_.shape(fonts_.regular, codepoint);
-        if (!gposOpt)
-            continue;
-        text::glyph_position& gpos = *gposOpt;
+        auto const codepoint = preparedGlyph.codepoint;
+        text::glyph_position const& gpos = preparedGlyph.position;
 
         if (gpos.glyph.index.value >= _directMappedGlyphKeyToTileIndex.size())
             _directMappedGlyphKeyToTileIndex.resize(gpos.glyph.index.value
@@ -352,9 +397,8 @@ void TextRenderer::initializeDirectMapping()
 
         auto const tileIndex = _directMapping.toTileIndex(codepoint - FirstReservedChar);
         auto const tileLocation = _textureAtlas->tileLocation(tileIndex);
-        auto tileCreateData = createRasterizedGlyph(tileLocation, gpos.glyph, presentation);
-        if (!tileCreateData)
-            continue;
+        auto tileCreateData =
+            createRasterizedGlyph(tileLocation, gpos.glyph, move(preparedGlyph.glyph), presentation);
 
         // Require(tileCreateData->bitmapSize.width <= textureAtlas().tileSize().width);
 
@@ -366,13 +410,16 @@ void TextRenderer::initializeDirectMapping()
         //            tileCreateData->bitmapSize,
         //            tileCreateData->metadata);
 
-        _textureAtlas->setDirectMapping(tileIndex, move(*tileCreateData));
+        _textureAtlas->setDirectMapping(tileIndex, move(tileCreateData));
         _directMappedGlyphKeyToTileIndex[gpos.glyph.index.value] = tileIndex;
     }
 }
 
 void TextRenderer::updateFontMetrics()
 {
+    if (fontDescriptions_.builtinBoxDrawing)
+        boxDrawingRenderer_.startTilePreparation();
+
     if (!renderTargetAvailable())
         return;
 
@@ -695,7 +742,15 @@ auto TextRenderer::createRasterizedGlyph(atlas::TileLocation tileLocation,
     if (!theGlyphOpt.has_value())
         return nullopt;
 
-    text::rasterized_glyph& glyph = theGlyphOpt.value();
+    return createRasterizedGlyph(tileLocation, glyphKey, move(theGlyphOpt.value()), presentation);
+}
+
+auto TextRenderer::createRasterizedGlyph(atlas::TileLocation tileLocation,
+                                         text::glyph_key const& glyphKey,
+                                         text::rasterized_glyph glyph,
+                                         unicode::PresentationStyle presentation)
+    -> TextureAtlas::TileCreateData
+{
     Require(glyph.bitmap.size()
             == text::pixel_size(glyph.format) * unbox<size_t>(glyph.bitmapSize.width)
                    * unbox<size_t>(glyph.bitmapSize.height));
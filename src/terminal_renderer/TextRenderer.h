@@ -37,8 +37,10 @@
 #include <gsl/span_ext>
 
 #include <functional>
+#include <future>
 #include <list>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -74,6 +76,15 @@ class TextRenderer: public Renderable
 
     void updateFontMetrics();
 
+    /// Shapes and rasterizes the direct-mapped glyphs on a worker thread,
+    /// to be uploaded once the texture atlas is available.
+    ///
+    /// The text shaper must not be used otherwise until finishDirectMappingWarmup() returned.
+    void startDirectMappingWarmup();
+
+    /// Waits for a pending direct mapping warmup to complete.
+    void finishDirectMappingWarmup();
+
     void setPressure(bool _pressure) noexcept { pressure_ = _pressure; }
 
     /// Must be invoked before a new terminal frame is rendered.
@@ -87,6 +98,22 @@ class TextRenderer: public Renderable
     void endFrame();
 
   private:
+    struct PreparedGlyph
+    {
+        char32_t codepoint;
+        text::glyph_position position;
+        text::rasterized_glyph glyph;
+    };
+
+    /// The shaped and rasterized direct-mapped glyphs, not yet uploaded to the texture atlas.
+    struct PreparedDirectMapping
+    {
+        text::font_key font;
+        text::render_mode renderMode;
+        std::vector<PreparedGlyph> glyphs;
+    };
+
+    PreparedDirectMapping prepareDirectMapping();
     void initializeDirectMapping();
 
     /// Puts a sequence of codepoints that belong to the same grid cell at @p _pos
@@ -116,6 +143,11 @@ class TextRenderer: public Renderable
     std::optional<TextureAtlas::TileCreateData> createRasterizedGlyph(
         atlas::TileLocation tileLocation, text::glyph_key const& id, unicode::PresentationStyle presentation);
 
+    TextureAtlas::TileCreateData createRasterizedGlyph(atlas::TileLocation tileLocation,
+                                                       text::glyph_key const& id,
+                                                       text::rasterized_glyph glyph,
+                                                       unicode::PresentationStyle presentation);
+
     crispy::Point applyGlyphPositionToPen(crispy::Point pen,
                                           AtlasTileAttributes const& tileAttributes,
                                           text::glyph_position const& gpos) const noexcept;
@@ -145,6 +177,9 @@ class TextRenderer: public Renderable
     // Maps from glyph index to tile index.
     std::vector<uint32_t> _directMappedGlyphKeyToTileIndex {};
 
+    std::future<PreparedDirectMapping> directMappingWarmup_;
+    std::optional<PreparedDirectMapping> preparedDirectMapping_;
+
     bool isGlyphDirectMapped(text::glyph_key const& glyph) const noexcept
     {
         return _directMapping                  // Is direct mapping enabled?
@@ -21,6 +21,7 @@
 #include <gsl/span>
 #include <gsl/span_ext>
 
+#include <memory>
 #include <optional>
 #include <variant>
 #include <vector>
@@ -28,10 +29,22 @@
 namespace text
 {
 
+/// Codepoint coverage of a font, as known to the font locator without loading the font file.
+class font_coverage
+{
+  public:
+    virtual ~font_coverage() = default;
+
+    [[nodiscard]] virtual bool contains(char32_t codepoint) const noexcept = 0;
+};
+
 /// Holds the system path to a font file.
 struct font_path
 {
     std::string value;
+
+    /// Optional coverage information, provided by the locator if cheaply available.
+    std::shared_ptr<font_coverage const> coverage {};
 };
 
 /// Holds a view into the contents of a font file.
@@ -14,12 +14,18 @@
 #include <text_shaper/font.h>
 #include <text_shaper/fontconfig_locator.h>
 
+#include <crispy/StartupProfile.h>
+
 #include <range/v3/view/iota.hpp>
 
 #include <fontconfig/fontconfig.h>
 
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string_view>
 
+using std::make_shared;
 using std::nullopt;
 using std::optional;
 using std::string;
@@ -116,6 +122,37 @@ namespace
         }
     }
 
+    /// Font coverage backed by the character set from fontconfig's font cache,
+    /// so that fallback fonts can be tested without loading them.
+    class fontconfig_coverage final: public font_coverage
+    {
+      public:
+        explicit fontconfig_coverage(FcCharSet* _charset): charset_ { FcCharSetCopy(_charset) } {}
+        fontconfig_coverage(fontconfig_coverage const&) = delete;
+        fontconfig_coverage& operator=(fontconfig_coverage const&) = delete;
+        ~fontconfig_coverage() override { FcCharSetDestroy(charset_); }
+
+        [[nodiscard]] bool contains(char32_t _codepoint) const noexcept override
+        {
+            return FcCharSetHasChar(charset_, static_cast<FcChar32>(_codepoint));
+        }
+
+      private:
+        FcCharSet* charset_;
+    };
+
+    std::mutex preloadLock;
+    std::future<FcConfig*> preloadedConfig;
+
+    /// Returns the configuration loaded by fontconfig_locator::preload(), if any.
+    FcConfig* takePreloadedConfig()
+    {
+        auto const _ = std::lock_guard { preloadLock };
+        if (!preloadedConfig.valid())
+            return nullptr;
+        return preloadedConfig.get();
+    }
+
 } // namespace
 
 struct fontconfig_locator::Private
@@ -125,8 +162,10 @@ struct fontconfig_locator::Private
 
     Private()
     {
+        ftConfig = takePreloadedConfig();
         FcInit();
-        ftConfig = FcInitLoadConfigAndFonts(); // Most convenient of all the alternatives
+        if (!ftConfig)
+            ftConfig = FcInitLoadConfigAndFonts(); // Most convenient of all the alternatives
     }
 
     ~Private()
@@ -148,6 +187,18 @@ fontconfig_locator::~fontconfig_locator()
 {
 }
 
+void fontconfig_locator::preload()
+{
+    auto const _ = std::lock_guard { preloadLock };
+    if (preloadedConfig.valid())
+        return;
+
+    preloadedConfig = std::async(std::launch::async, []() {
+        auto const _ = crispy::StartupProfile::get().phase("fontconfig");
+        return FcInitLoadConfigAndFonts();
+    });
+}
+
 font_source_list fontconfig_locator::locate(font_description const& _fd)
 {
     LocatorLog()("Locating font chain for: {}", _fd);
@@ -245,7 +296,11 @@ font_source_list fontconfig_locator::locate(font_description const& _fd)
             }
         }
 
-        output.emplace_back(font_path { string { (char const*) (file) } });
+        auto coverage = std::shared_ptr<font_coverage const> {};
+        if (FcCharSet* charset = nullptr; FcPatternGetCharSet(font, FC_CHARSET, 0, &charset) == FcResultMatch)
+            coverage = make_shared<fontconfig_coverage>(charset);
+
+        output.emplace_back(font_path { string { (char const*) (file) }, std::move(coverage) });
         LocatorLog()("Font {} (spacing {}) in chain: {}", output.size(), spacing, (char const*) file);
     }
 
@@ -33,6 +33,12 @@ class fontconfig_locator: public font_locator
     fontconfig_locator();
     ~fontconfig_locator() override;
 
+    /// Starts loading fontconfig's configuration and font cache on a background thread,
+    /// to be picked up by the next fontconfig_locator instance.
+    ///
+    /// This allows the (potentially slow) font discovery to overlap with other startup work.
+    static void preload();
+
     font_source_list locate(font_description const& description) override;
     font_source_list all() override;
     font_source_list resolve(gsl::span<const char32_t> codepoints) override;
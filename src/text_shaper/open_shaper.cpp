@@ -43,6 +43,7 @@
 #include <stdexcept>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 using ranges::views::iota;
@@ -61,9 +62,11 @@ using std::size_t;
 using std::string;
 using std::string_view;
 using std::tuple;
+using std::u32string;
 using std::u32string_view;
 using std::unique_ptr;
 using std::unordered_map;
+using std::unordered_set;
 using std::vector;
 
 using namespace std::string_literals;
@@ -112,6 +115,22 @@ using FtFacePtr = unique_ptr<FT_FaceRec_, void (*)(FT_FaceRec_*)>;
 
 auto constexpr MissingGlyphId = 0xFFFDu;
 
+/// Number of consecutive codepoints that are assumed to be covered by the same fallback font.
+auto constexpr FallbackBlockSize = 128u;
+
+/// Maximum number of codepoint sequences remembered as not being covered by any fallback font.
+auto constexpr MaxUnresolvableCount = 4096u;
+
+/// Remembers the outcome of fallback font lookups of a primary font for the current session.
+struct FallbackCache
+{
+    /// Maps a codepoint block to the index of the fallback font that last covered it.
+    unordered_map<char32_t, size_t> fontByBlock {};
+
+    /// Codepoint sequences that none of the fallback fonts could handle.
+    unordered_set<u32string> unresolvable {};
+};
+
 struct HbFontInfo
 {
     font_source primary;
@@ -121,6 +140,8 @@ struct HbFontInfo
     HbFontPtr hbFont;
     std::optional<font_metrics> metrics {};
     font_description description {};
+    FallbackCache shapingFallbacks {}; // used when text shaping
+    FallbackCache glyphFallbacks {};   // used when looking up a single codepoint's glyph
 };
 
 namespace
@@ -134,6 +155,28 @@ namespace
         throw invalid_argument("source");
     }
 
+    /// Tests whether the given codepoint only modifies the preceding one
+    /// and is thus not necessarily listed in a font's coverage.
+    constexpr bool isCoverageNeutral(char32_t _codepoint) noexcept
+    {
+        return _codepoint == 0x200C || _codepoint == 0x200D          // ZWNJ, ZWJ
+               || (0xFE00 <= _codepoint && _codepoint <= 0xFE0F)     // variation selectors
+               || (0xE0020 <= _codepoint && _codepoint <= 0xE007F)   // tags
+               || (0xE0100 <= _codepoint && _codepoint <= 0xE01EF); // variation selectors supplement
+    }
+
+    /// Tests, without loading the font, whether it may cover all of the given codepoints.
+    bool mayCover(font_source const& _source, u32string_view _codepoints)
+    {
+        auto const* path = std::get_if<font_path>(&_source);
+        if (!path || !path->coverage)
+            return true; // Coverage is unknown, so the font must be tried.
+
+        return std::all_of(_codepoints.begin(), _codepoints.end(), [&](char32_t _codepoint) {
+            return isCoverageNeutral(_codepoint) || path->coverage->contains(_codepoint);
+        });
+    }
+
     // clang-format off
     static string ftErrorStr(FT_Error _errorCode)
     {
@@ -492,6 +535,62 @@ struct open_shaper::Private // {{{
 #endif
     }
 
+    /// Tries the fallback fonts of the given primary font in order, until @p _tryFont succeeds.
+    ///
+    /// Fallback fonts known not to cover the codepoints are skipped without being loaded.
+    /// The fallback font that succeeded last for the codepoint block is tried first, and
+    /// sequences no fallback font could handle are remembered, so that rare glyphs
+    /// do not cause the fallback list to be walked (and loaded) over and over again.
+    template <typename TryFont>
+    bool tryFallbacks(HbFontInfo& _fontInfo,
+                      FallbackCache& _cache,
+                      u32string_view _codepoints,
+                      TryFont _tryFont)
+    {
+        if (_codepoints.empty())
+            return false;
+
+        auto const sequence = u32string(_codepoints);
+        if (_cache.unresolvable.count(sequence))
+            return false;
+
+        auto const tryFallback = [&](size_t _index) -> bool {
+            font_source const& fallbackFont = _fontInfo.fallbacks[_index];
+            if (!mayCover(fallbackFont, _codepoints))
+                return false;
+
+            optional<font_key> fallbackKeyOpt = getOrCreateKeyForFont(fallbackFont, _fontInfo.size);
+            if (!fallbackKeyOpt.has_value())
+                return false;
+
+            Require(fontKeyToHbFontInfoMapping.count(fallbackKeyOpt.value()) == 1);
+            return _tryFont(fallbackKeyOpt.value(), fontKeyToHbFontInfoMapping.at(fallbackKeyOpt.value()));
+        };
+
+        auto const block = _codepoints.front() / FallbackBlockSize;
+        auto cachedIndex = _fontInfo.fallbacks.size();
+        if (auto const i = _cache.fontByBlock.find(block); i != _cache.fontByBlock.end())
+        {
+            cachedIndex = i->second;
+            if (tryFallback(cachedIndex))
+                return true;
+        }
+
+        for (size_t i = 0; i < _fontInfo.fallbacks.size(); ++i)
+        {
+            if (i != cachedIndex && tryFallback(i))
+            {
+                _cache.fontByBlock[block] = i;
+                return true;
+            }
+        }
+
+        if (_cache.unresolvable.size() >= MaxUnresolvableCount)
+            _cache.unresolvable.clear();
+        _cache.unresolvable.emplace(sequence);
+        return false;
+    }
+
     bool tryShapeWithFallback(font_key _font,
                               HbFontInfo& _fontInfo,
                               hb_buffer_t* _hbBuf,
@@ -508,45 +607,38 @@ struct open_shaper::Private // {{{
                 _font, _fontInfo, _hbBuf, _hbFont, _script, _presentation, _codepoints, _clusters, _result))
             return true;
 
-        for (font_source const& fallbackFont: _fontInfo.fallbacks)
-        {
-            _result.resize(initialResultOffset); // rollback to initial size
-
-            optional<font_key> fallbackKeyOpt = getOrCreateKeyForFont(fallbackFont, _fontInfo.size);
-            if (!fallbackKeyOpt.has_value())
-                continue;
-
-            // Skip if main font is monospace but fallbacks font is not.
-            if (_fontInfo.description.strict_spacing
-                && _fontInfo.description.spacing != font_spacing::proportional)
-            {
-                Require(fontKeyToHbFontInfoMapping.count(fallbackKeyOpt.value()) == 1);
-                HbFontInfo const& fallbackFontInfo = fontKeyToHbFontInfoMapping.at(fallbackKeyOpt.value());
-                bool const fontIsMonospace = fallbackFontInfo.ftFace->face_flags & FT_FACE_FLAG_FIXED_WIDTH;
-                if (!fontIsMonospace)
-                    continue;
-            }
+        return tryFallbacks(
+            _fontInfo,
+            _fontInfo.shapingFallbacks,
+            _codepoints,
+            [&](font_key _fallbackKey, HbFontInfo& _fallbackFontInfo) {
+                // Skip if main font is monospace but fallbacks font is not.
+                if (_fontInfo.description.strict_spacing
+                    && _fontInfo.description.spacing != font_spacing::proportional)
+                {
+                    bool const fontIsMonospace =
+                        _fallbackFontInfo.ftFace->face_flags & FT_FACE_FLAG_FIXED_WIDTH;
+                    if (!fontIsMonospace)
+                        return false;
+                }
 
-            Require(fontKeyToHbFontInfoMapping.count(fallbackKeyOpt.value()) == 1);
-            HbFontInfo& fallbackFontInfo = fontKeyToHbFontInfoMapping.at(fallbackKeyOpt.value());
-            // clang-format off
-            TextShapingLog()("Try fallbacks font key:{}, source: {}",
-                             fallbackKeyOpt.value(),
-                             fallbackFontInfo.primary);
-            // clang-format on
-            if (tryShape(fallbackKeyOpt.value(),
-                         fallbackFontInfo,
-                         _hbBuf,
-                         fallbackFontInfo.hbFont.get(),
-                         _script,
-                         _presentation,
-                         _codepoints,
-                         _clusters,
-                         _result))
-                return true;
-        }
+                _result.resize(initialResultOffset); // rollback to initial size
 
-        return false;
+                // clang-format off
+                TextShapingLog()("Try fallbacks font key:{}, source: {}",
+                                 _fallbackKey,
+                                 _fallbackFontInfo.primary);
+                // clang-format on
+                return tryShape(_fallbackKey,
+                                _fallbackFontInfo,
+                                _hbBuf,
+                                _fallbackFontInfo.hbFont.get(),
+                                _script,
+                                _presentation,
+                                _codepoints,
+                                _clusters,
+                                _result);
+            });
     }
 }; // }}}
 
@@ -592,6 +684,8 @@ optional<font_key> open_shaper::load_font(font_description const& _description,
     HbFontInfo& fontInfo = d->fontKeyToHbFontInfoMapping.at(*fontKeyOpt);
     fontInfo.fallbacks = move(sources);
     fontInfo.description = _description;
+    fontInfo.shapingFallbacks = {};
+    fontInfo.glyphFallbacks = {};
 
     return fontKeyOpt;
 }
@@ -616,17 +710,14 @@ optional<glyph_position> open_shaper::shape(font_key _font, char32_t _codepoint)
     glyph_index glyphIndex { FT_Get_Char_Index(fontInfo.ftFace.get(), _codepoint) };
     if (!glyphIndex.value)
     {
-        for (font_source const& fallbackFont: fontInfo.fallbacks)
-        {
-            optional<font_key> fallbackKeyOpt = d->getOrCreateKeyForFont(fallbackFont, fontInfo.size);
-            if (!fallbackKeyOpt.has_value())
-                continue;
-            Require(d->fontKeyToHbFontInfoMapping.count(fallbackKeyOpt.value()) == 1);
-            HbFontInfo const& fallbackFontInfo = d->fontKeyToHbFontInfoMapping.at(fallbackKeyOpt.value());
-            glyphIndex = glyph_index { FT_Get_Char_Index(fallbackFontInfo.ftFace.get(), _codepoint) };
-            if (glyphIndex.value)
-                break;
-        }
+        d->tryFallbacks(fontInfo,
+                        fontInfo.glyphFallbacks,
+                        u32string_view(&_codepoint, 1),
+                        [&](font_key, HbFontInfo const& _fallbackFontInfo) {
+                            glyphIndex =
+                                glyph_index { FT_Get_Char_Index(_fallbackFontInfo.ftFace.get(), _codepoint) };
+                            return glyphIndex.value != 0;
+                        });
     }
     if (!glyphIndex.value)
         return nullopt;